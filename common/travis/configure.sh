@@ -23,6 +23,14 @@ if [ "$POLYBAR_BUILD_TYPE" == "minimal" ]; then
   )
 fi
 
+# The optional libraries are installed for the tests, so fail instead
+# of silently skipping the adapter tests if one of them is not found
+if [ "$POLYBAR_BUILD_TYPE" == "tests" ]; then
+  FLAGS=(
+  "-DENABLE_MPD=ON"
+  )
+fi
+
 cmake \
   -DCMAKE_C_COMPILER="${CC}" \
   -DCMAKE_CXX_COMPILER="${CXX}" \
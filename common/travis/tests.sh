@@ -3,6 +3,14 @@ r=0
 
 make all_unit_tests
 
+# Tests of optional modules that have to be built in this configuration
+for test in unit_test.adapters_mpd; do
+  if [ ! -x "tests/$test" ]; then
+    r=1
+    printf "\033[1;31m%s\033[0m\n" "$test was not built"
+  fi
+done
+
 for test in tests/unit_test.*; do
   [ -x "$test" ] || continue
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <poll.h>
 #include <mutex>
 
 #include "common.hpp"
@@ -16,6 +17,10 @@ typedef struct _snd_hctl snd_hctl_t;
 POLYBAR_NS
 
 namespace alsa {
+  /**
+   * Control element of a jack, the plugged state is
+   * only read again when ALSA reports a value change
+   */
   class control {
    public:
     explicit control(int numid);
@@ -25,12 +30,15 @@ namespace alsa {
     control& operator=(const control& o) = delete;
 
     int get_numid();
-    bool wait(int timeout = -1);
+    void get_poll_descriptors(vector<pollfd>& fds);
     bool test_device_plugged();
-    void process_events();
+    bool process_events();
 
    private:
+    bool read_plugged();
+
     int m_numid{0};
+    bool m_plugged{false};
 
     snd_ctl_t* m_ctl{nullptr};
     snd_hctl_t* m_hctl{nullptr};
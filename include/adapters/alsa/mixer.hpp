@@ -1,5 +1,6 @@
 #pragma once
 
+#include <poll.h>
 #include <mutex>
 
 #include "common.hpp"
@@ -16,6 +17,13 @@ typedef struct _snd_mixer_selem_id snd_mixer_selem_id_t;
 POLYBAR_NS
 
 namespace alsa {
+  /**
+   * Simple mixer element
+   *
+   * The element handle, its ranges and channels are looked up once and
+   * the volume and mute state are only read again when ALSA reports a
+   * change of the element while processing events
+   */
   class mixer {
    public:
     explicit mixer(string&& mixer_selem_name, string&& soundcard_name);
@@ -27,8 +35,8 @@ namespace alsa {
     const string& get_name();
     const string& get_sound_card();
 
-    bool wait(int timeout = -1);
-    int process_events();
+    void get_poll_descriptors(vector<pollfd>& fds);
+    bool process_events();
 
     int get_volume();
     int get_normalized_volume();
@@ -39,9 +47,24 @@ namespace alsa {
     bool is_muted();
 
    private:
+    static int elem_callback(snd_mixer_elem_t* elem, unsigned int mask);
+    void load_ranges();
+    void refresh();
+
     snd_mixer_t* m_mixer{nullptr};
     snd_mixer_elem_t* m_elem{nullptr};
 
+    vector<int> m_channels;
+    long m_volume_min{0};
+    long m_volume_max{0};
+    long m_db_min{0};
+    long m_db_max{0};
+
+    int m_volume{0};
+    int m_normalized_volume{0};
+    bool m_muted{false};
+    bool m_changed{false};
+
     string m_name;
     string s_name;
   };
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "adapters/provider.hpp"
+#include "common.hpp"
+#include "errors.hpp"
+#include "utils/socket.hpp"
+
+POLYBAR_NS
+
+// fwd
+class logger;
+
+namespace i3 {
+  DEFINE_ERROR(ipc_error);
+
+  // types {{{
+
+  enum class message_type : uint32_t {
+    RUN_COMMAND = 0,
+    GET_WORKSPACES = 1,
+    SUBSCRIBE = 2,
+    EVENT_WORKSPACE = 0x80000000,
+    EVENT_MODE = 0x80000002,
+  };
+
+  /**
+   * Fields of a workspace used by the i3 module
+   *
+   * Workspace containers in events only have `num`
+   * and `output` with recent versions of i3
+   */
+  struct workspace {
+    int num{-1};
+    string name;
+    string output;
+    bool visible{false};
+    bool focused{false};
+    bool urgent{false};
+  };
+
+  struct workspace_event {
+    string change;
+    bool has_current{false};
+    workspace current;
+  };
+
+  struct mode_event {
+    string change;
+  };
+
+  /**
+   * Event as handed to the subscribers of an ipc_source
+   *
+   * RESYNC is sent after the source reconnected or failed to decode
+   * a workspace event, the subscribers may have missed changes
+   */
+  struct event {
+    enum class kind { WORKSPACE, MODE, RESYNC };
+
+    kind type{kind::RESYNC};
+    workspace_event workspace;
+    mode_event mode;
+  };
+
+  // }}}
+  // decoding {{{
+
+  /**
+   * Decoders for the payloads consumed by polybar
+   *
+   * The JSON is scanned once and only the required fields are copied,
+   * into the given structs so that their storage is reused. Everything
+   * else, e.g. the container tree in workspace events, is skipped
+   */
+  bool decode(const string& payload, vector<workspace>& workspaces);
+  bool decode(const string& payload, workspace_event& event);
+  bool decode(const string& payload, mode_event& event);
+
+  // }}}
+  // class : ipc_connection {{{
+
+  /**
+   * Connection to the i3 IPC socket
+   */
+  class ipc_connection : public socket_util::unix_connection {
+   public:
+    explicit ipc_connection(string path);
+
+    void send(message_type type, const string& payload = "");
+    message_type receive(string& payload);
+    void query(message_type type, const string& payload, string& reply);
+
+   protected:
+    void read(void* data, size_t len);
+  };
+
+  // }}}
+  // class : event_queue {{{
+
+  /**
+   * Events of one subscriber, in the order they were received
+   */
+  class event_queue {
+   public:
+    void push(shared_ptr<const event> ev);
+    bool wait(shared_ptr<const event>& ev);
+    void close();
+
+   private:
+    std::mutex m_mutex;
+    std::condition_variable m_pushed;
+    std::deque<shared_ptr<const event>> m_events;
+    bool m_closed{false};
+  };
+
+  // }}}
+  // class : ipc_source {{{
+
+  /**
+   * Connections to i3, shared by all modules using the same socket
+   *
+   * A thread receives the workspace and mode events, decodes each of them
+   * once and pushes it to the queue of every subscriber. Queries and
+   * commands go through a second connection shared behind a lock
+   */
+  class ipc_source {
+   public:
+    explicit ipc_source(const logger& logger, string path);
+    ~ipc_source();
+
+    ipc_source(const ipc_source& o) = delete;
+    ipc_source& operator=(const ipc_source& o) = delete;
+
+    static shared_ptr<ipc_source> acquire(const logger& logger, const string& path);
+
+    shared_ptr<event_queue> subscribe();
+    void query(message_type type, const string& payload, string& reply);
+
+   protected:
+    unique_ptr<ipc_connection> connect();
+    void run();
+    bool reconnect(const exception& reason);
+    void publish(shared_ptr<const event> ev);
+
+   private:
+    const logger& m_log;
+    string m_path;
+
+    /**
+     * Connection subscribed to events, only replaced by the thread
+     * of the source and with m_mutex held
+     */
+    unique_ptr<ipc_connection> m_events;
+    string m_payload;
+
+    std::mutex m_commandlock;
+    unique_ptr<ipc_connection> m_command;
+
+    std::mutex m_mutex;
+    std::condition_variable m_stopped;
+    bool m_stopping{false};
+    vector<std::weak_ptr<event_queue>> m_queues;
+
+    std::thread m_thread;
+  };
+
+  // }}}
+}
+
+POLYBAR_NS_END
@@ -2,11 +2,17 @@
 
 #include <mpd/client.h>
 #include <stdlib.h>
+#include <array>
 #include <chrono>
+#include <condition_variable>
 #include <csignal>
+#include <mutex>
+#include <thread>
 
+#include "adapters/provider.hpp"
 #include "common.hpp"
 #include "errors.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -90,6 +96,8 @@ namespace mpd {
     bool retry_connection(int interval = 1);
 
     int get_fd();
+    bool poll(int timeout_ms);
+    void interrupt();
     void idle();
     int noidle();
 
@@ -126,6 +134,9 @@ namespace mpd {
     bool m_idle = false;
     int m_fd = -1;
 
+    // used to make poll() return early, from any thread
+    array<unique_ptr<file_descriptor>, 2> m_wakeupfd{};
+
     string m_host;
     unsigned int m_port;
     string m_password;
@@ -141,6 +152,7 @@ namespace mpd {
 
     void fetch_data(mpdconnection* conn);
     void update(int event, mpdconnection* connection);
+    void update_timer();
 
     bool random() const;
     bool repeat() const;
@@ -153,16 +165,15 @@ namespace mpd {
     int get_queuelen() const;
     unsigned get_total_time() const;
     unsigned get_elapsed_time() const;
+    unsigned long get_elapsed_time_ms() const;
     unsigned get_elapsed_percentage();
     string get_formatted_elapsed();
     string get_formatted_total();
     int get_seek_position(int percentage);
 
    private:
-    mpd_status_t m_status{};
-    unique_ptr<mpdsong> m_song{};
     mpdstate m_state{mpdstate::UNKNOWN};
-    chrono::system_clock::time_point m_updated_at{};
+    chrono::steady_clock::time_point m_updated_at{};
 
     bool m_random{false};
     bool m_repeat{false};
@@ -177,6 +188,73 @@ namespace mpd {
     unsigned long m_elapsed_time_ms{0UL};
   };
 
+  // }}}
+  // class : mpdsource {{{
+
+  /**
+   * Connection to a server, shared by all modules showing it
+   *
+   * A thread keeps the connection in idle mode and refreshes the status
+   * and the current song once the server reports a change. The result is
+   * published as an immutable snapshot and the subscribers are notified.
+   * Commands of the modules are run by the same thread in between
+   */
+  class mpdsource {
+   public:
+    struct state {
+      bool connected{false};
+      unique_ptr<mpdstatus> status;
+      string artist;
+      string album_artist;
+      string album;
+      string title;
+      string date;
+    };
+
+    using command = function<void(mpdconnection&)>;
+
+    explicit mpdsource(const logger& logger, string host, unsigned int port, string password);
+    ~mpdsource();
+
+    mpdsource(const mpdsource& o) = delete;
+    mpdsource& operator=(const mpdsource& o) = delete;
+
+    static shared_ptr<mpdsource> acquire(
+        const logger& logger, const string& host, unsigned int port, const string& password);
+
+    size_t subscribe(subscribers::callback&& on_change);
+    void unsubscribe(size_t id);
+
+    shared_ptr<const state> get();
+    void send(command&& cmd);
+
+   protected:
+    void run();
+    void connect();
+    void wait_for_change();
+    void publish(bool connected, bool fetchsong);
+    bool sleep(chrono::milliseconds duration);
+
+   private:
+    const logger& m_log;
+    mpdconnection m_connection;
+    subscribers m_subscribers;
+
+    /**
+     * Only used by the thread of the source once it is running
+     */
+    unique_ptr<mpdstatus> m_status;
+    int m_attempts{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_stopped;
+    bool m_stopping{false};
+    shared_ptr<const state> m_state;
+    vector<command> m_commands;
+
+    std::thread m_thread;
+  };
+
   // }}}
 }
 
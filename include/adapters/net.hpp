@@ -10,6 +10,8 @@
 #undef inline
 #endif
 
+#include "adapters/procfs.hpp"
+#include "adapters/provider.hpp"
 #include "common.hpp"
 #include "settings.hpp"
 #include "errors.hpp"
@@ -20,6 +22,7 @@
 #include <net/if.h>
 
 struct nl_msg;
+struct nl_sock;
 struct nlattr;
 #else
 #include <iwlib.h>
@@ -28,6 +31,7 @@ struct nlattr;
 POLYBAR_NS
 
 class file_descriptor;
+class file_reader;
 
 namespace net {
   DEFINE_ERROR(network_error);
@@ -63,6 +67,22 @@ namespace net {
     link_activity current{};
   };
 
+  /**
+   * Addresses and counters of all interfaces, as returned by getifaddrs(3)
+   */
+  struct interface_list {
+    std::chrono::system_clock::time_point time;
+    unique_ptr<struct ifaddrs, void (*)(struct ifaddrs*)> addrs{nullptr, freeifaddrs};
+  };
+
+  // }}}
+  // class : interface_provider {{{
+
+  class interface_provider : public provider<interface_provider, interface_list> {
+   public:
+    value_type read() const;
+  };
+
   // }}}
   // class : network {{{
 
@@ -73,24 +93,38 @@ namespace net {
 
     virtual bool query(bool accumulate = false);
     virtual bool connected() const = 0;
-    virtual bool ping() const;
 
     string ip() const;
     string ip6() const;
     string downspeed(int minwidth = 3) const;
     string upspeed(int minwidth = 3) const;
     void set_unknown_up(bool unknown = true);
+    void set_interval(std::chrono::duration<double> interval);
+
+    bool subscribed() const;
+    bool wait_for_change(int wait_ms);
 
    protected:
     void check_tuntap();
     bool test_interface() const;
     string format_speedrate(float bytes_diff, int minwidth) const;
-    void query_ip6();
+    bool query_addresses();
+    bool read_link_events();
+
+    virtual int event_fd() const;
+    virtual bool read_events();
 
     const logger& m_log;
     unique_ptr<file_descriptor> m_socketfd;
+    unique_ptr<file_descriptor> m_rtnl;
+    unique_ptr<file_reader> m_operstate;
+    shared_ptr<interface_provider> m_interfaces;
+    shared_ptr<procfs::netdev_provider> m_counters;
+    std::chrono::duration<double> m_max_age{0.0};
     link_status m_status{};
     string m_interface;
+    int m_ifindex{0};
+    bool m_refresh_addresses{true};
     bool m_tuntap{false};
     bool m_unknown_up{false};
   };
@@ -117,7 +151,7 @@ namespace net {
 
   class wireless_network : public network {
    public:
-    wireless_network(string interface) : network(interface), m_ifid(if_nametoindex(interface.c_str())){};
+    explicit wireless_network(string interface);
 
     bool query(bool accumulate = false) override;
     bool connected() const override;
@@ -126,7 +160,12 @@ namespace net {
     int quality() const;
 
    protected:
+    int event_fd() const override;
+    bool read_events() override;
+
+    bool connect();
     static int scan_cb(struct nl_msg* msg, void* instance);
+    static int event_cb(struct nl_msg* msg, void* instance);
 
     bool associated_or_joined(struct nlattr** bss);
     void parse_essid(struct nlattr** bss);
@@ -135,6 +174,15 @@ namespace net {
     void parse_signal(struct nlattr** bss);
 
    private:
+    struct socket_deleter {
+      void operator()(struct nl_sock* sk) const;
+    };
+
+    unique_ptr<struct nl_sock, socket_deleter> m_socket;
+    unique_ptr<struct nl_sock, socket_deleter> m_events;
+    int m_nl80211{-1};
+    bool m_changed{false};
+
     unsigned int m_ifid{};
     string m_essid{};
     int m_frequency{};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace net {
+  /**
+   * Outcome of a connectivity probe
+   */
+  struct probe_result {
+    int sent{0};
+    int received{0};
+    std::chrono::duration<double, std::milli> latency{0.0};  // average round trip
+
+    int loss() const;
+  };
+
+  /**
+   * Connectivity test that runs in the background
+   *
+   * Echo requests are sent through an unprivileged ICMP socket. If these
+   * aren't permitted (see net.ipv4.ping_group_range), the round trip of
+   * a TCP handshake with the target is measured instead
+   */
+  class probe {
+   public:
+    using duration = std::chrono::duration<double, std::milli>;
+
+    explicit probe(string target, int count, std::chrono::duration<double> timeout, unsigned short fallback_port);
+    ~probe();
+
+    bool start(string source = "");
+    bool result(probe_result& result);
+
+   protected:
+    void run(string source);
+    bool resolve(struct sockaddr_in& addr) const;
+    bool echo(int fd, int seq, const struct sockaddr_in& addr, duration& rtt) const;
+    bool handshake(const struct sockaddr_in& source, const struct sockaddr_in& addr, duration& rtt) const;
+    bool await(int fd, short events, std::chrono::steady_clock::time_point deadline) const;
+
+   private:
+    const string m_target;
+    const int m_count;
+    const std::chrono::steady_clock::duration m_timeout;
+    const unsigned short m_port;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stop{false};
+
+    std::mutex m_mutex;
+    probe_result m_result{};
+    bool m_pending{false};
+  };
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+
+#include "adapters/provider.hpp"
+#include "common.hpp"
+#include "utils/file.hpp"
+
+POLYBAR_NS
+
+namespace procfs {
+  struct cpu_time {
+    unsigned long long user;
+    unsigned long long nice;
+    unsigned long long system;
+    unsigned long long idle;
+    unsigned long long total;
+  };
+
+  /**
+   * Per core cpu times, parsed from /proc/stat
+   */
+  using cpu_times = vector<cpu_time>;
+
+  class stat_provider : public provider<stat_provider, cpu_times> {
+   public:
+    explicit stat_provider(string path);
+
+    value_type read() const;
+
+   private:
+    mutable file_reader m_reader;
+  };
+
+  /**
+   * Memory usage in kB, parsed from /proc/meminfo
+   */
+  struct meminfo {
+    unsigned long long total{0ULL};
+    unsigned long long avail{0ULL};
+    unsigned long long swap_total{0ULL};
+    unsigned long long swap_free{0ULL};
+  };
+
+  class meminfo_provider : public provider<meminfo_provider, meminfo> {
+   public:
+    explicit meminfo_provider(string path);
+
+    value_type read() const;
+
+   private:
+    mutable file_reader m_reader;
+  };
+
+  struct netdev_counters {
+    string name;
+    unsigned long long received{0ULL};
+    unsigned long long transmitted{0ULL};
+  };
+
+  /**
+   * Byte counters of all interfaces, parsed from /proc/net/dev
+   */
+  struct netdev {
+    std::chrono::system_clock::time_point time;
+    vector<netdev_counters> interfaces;
+  };
+
+  class netdev_provider : public provider<netdev_provider, netdev> {
+   public:
+    explicit netdev_provider(string path);
+
+    value_type read() const;
+
+   private:
+    mutable file_reader m_reader;
+  };
+
+  /**
+   * Filesystem type and source of mounted filesystems, by mountpoint
+   */
+  using mounts = std::map<string, std::pair<string, string>>;
+
+  void parse_mountinfo(const char* data, size_t size, const vector<string>& mountpoints, mounts& mounted);
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+/**
+ * One instance of T per key, shared by everyone who acquired it
+ *
+ * The instance is created on first use and released with the last
+ * shared pointer to it, so sources nobody uses are closed
+ */
+template <typename T>
+class shared_instances {
+ public:
+  template <typename... Args>
+  static shared_ptr<T> acquire(const string& key, Args&&... args) {
+    auto& r = instances();
+    std::lock_guard<std::mutex> guard(r.mutex);
+    auto& instance = r.map[key];
+    auto ptr = instance.lock();
+
+    if (!ptr) {
+      ptr = make_shared<T>(forward<Args>(args)...);
+      instance = ptr;
+    }
+
+    return ptr;
+  }
+
+ private:
+  struct registry {
+    std::mutex mutex;
+    std::unordered_map<string, std::weak_ptr<T>> map;
+  };
+
+  /**
+   * Kept outside of acquire() so that all its instantiations share it
+   */
+  static registry& instances() {
+    static registry r;
+    return r;
+  }
+};
+
+/**
+ * Callbacks of the modules subscribed to an event driven source
+ *
+ * The callbacks are run by the thread of the source and have to return
+ * quickly, e.g. by flagging the change and waking up the module thread.
+ * remove() waits for a notification in progress, so the subscriber can
+ * be destroyed once it returns
+ */
+class subscribers {
+ public:
+  using callback = function<void()>;
+
+  size_t add(callback&& cb) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_callbacks.emplace(++m_last, move(cb));
+    return m_last;
+  }
+
+  void remove(size_t id) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_callbacks.erase(id);
+  }
+
+  void notify() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto&& cb : m_callbacks) {
+      cb.second();
+    }
+  }
+
+ private:
+  std::mutex m_mutex;
+  size_t m_last{0};
+  std::map<size_t, callback> m_callbacks;
+};
+
+/**
+ * Data source shared by all modules that read it
+ *
+ * Instances are keyed by source, e.g. a procfs path or an interface
+ * name. The source is read at most once per `max_age` and the parsed
+ * snapshot is handed out as an immutable shared pointer, so modules
+ * polling the same source on the same interval share a single read.
+ *
+ * Impl must define `value_type read()`, returning nullptr on failure
+ */
+template <typename Impl, typename T>
+class provider {
+ public:
+  using value_type = shared_ptr<const T>;
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * Get the provider of given source
+   *
+   * @see shared_instances
+   */
+  template <typename... Args>
+  static shared_ptr<Impl> acquire(const string& key, Args&&... args) {
+    return shared_instances<Impl>::acquire(key, forward<Args>(args)...);
+  }
+
+  /**
+   * Get the latest snapshot, reading the source again
+   * if the current one is older than `max_age`
+   */
+  template <typename Duration>
+  value_type get(Duration max_age) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto now = clock::now();
+
+    if (!m_value || now - m_time >= std::chrono::duration_cast<clock::duration>(max_age)) {
+      m_value = static_cast<Impl*>(this)->read();
+      m_time = now;
+    }
+
+    return m_value;
+  }
+
+ protected:
+  std::mutex m_mutex;
+  value_type m_value;
+  clock::time_point m_time;
+};
+
+POLYBAR_NS_END
@@ -1,8 +1,9 @@
 #pragma once
 
 #include <pulse/pulseaudio.h>
-#include <queue>
+#include <atomic>
 
+#include "adapters/provider.hpp"
 #include "common.hpp"
 #include "settings.hpp"
 #include "errors.hpp"
@@ -20,61 +21,111 @@ class logger;
 
 DEFINE_ERROR(pulseaudio_error);
 
-class pulseaudio {
-  // events to add to our queue
-  enum class evtype { NEW = 0, CHANGE, REMOVE, SERVER };
-  using queue = std::queue<evtype>;
+/**
+ * Coalesces the sink info queries of a pulseaudio connection
+ *
+ * At most one query is in flight, requests arriving meanwhile are merged
+ * into a single follow-up query that is sent once the current one is done.
+ * Not thread safe, only used with the mainloop locked
+ */
+class sink_query {
+ public:
+  enum class target { NONE = 0, INDEX, NAME, DEFAULT };
+
+  explicit sink_query(bool named) : m_named(named) {}
+
+  target request(bool lookup = false, bool use_default = false);
+  void abort();
+  void found();
+  target complete(bool& notify);
+
+  bool querying() const;
+
+ private:
+  bool m_named;
+
+  bool m_querying{false};
+  bool m_requery{false};
+  bool m_lookup{false};
+  bool m_found{false};
+  bool m_default{false};
+};
 
+/**
+ * Tracks the volume of a sink without blocking the caller
+ *
+ * Sink events are coalesced: at most one info query is in flight and
+ * events arriving meanwhile only cause a single follow-up query. The
+ * results are stored and the subscribers are notified from the mainloop
+ * thread. All modules showing the same sink share one instance
+ */
+class pulseaudio {
   public:
-    explicit pulseaudio(const logger& logger, string&& sink_name, bool m_max_volume);
+    using callback = subscribers::callback;
+
+    explicit pulseaudio(const logger& logger, string sink_name);
     ~pulseaudio();
 
     pulseaudio(const pulseaudio& o) = delete;
     pulseaudio& operator=(const pulseaudio& o) = delete;
 
-    const string& get_name();
+    static shared_ptr<pulseaudio> acquire(const logger& logger, const string& sink_name);
 
-    bool wait();
-    int process_events();
+    size_t subscribe(callback&& on_change);
+    void unsubscribe(size_t id);
+
+    string get_name();
 
     int get_volume();
     void set_volume(float percentage);
-    void inc_volume(int delta_perc);
+    void inc_volume(int delta_perc, bool ui_max);
     void set_mute(bool mode);
     void toggle_mute();
     bool is_muted();
 
   private:
-    void update_volume(pa_operation *o);
-    static void check_mute_callback(pa_context *context, const pa_sink_info *info, int eol, void *userdata);
-    static void get_sink_volume_callback(pa_context *context, const pa_sink_info *info, int is_last, void *userdata);
+    /**
+     * Result of an operation, owned by the thread waiting for it
+     * since the mainloop lock is released while waiting
+     */
+    struct operation_result {
+      pa_threaded_mainloop* mainloop;
+      int success;
+    };
+
+    void query_sink(bool lookup = false, bool use_default = false);
+    void send_query(sink_query::target target);
+
     static void subscribe_callback(pa_context* context, pa_subscription_event_type_t t, uint32_t idx, void* userdata);
     static void simple_callback(pa_context *context, int success, void *userdata);
     static void sink_info_callback(pa_context *context, const pa_sink_info *info, int eol, void *userdata);
     static void context_state_callback(pa_context *context, void *userdata);
 
-    inline void wait_loop(pa_operation *op, pa_threaded_mainloop *loop);
+    inline bool wait_loop(pa_operation *op, operation_result& result);
 
     const logger& m_log;
 
-    // used for temporary callback results
-    int success{0};
+    // volume of the sink, only accessed with the mainloop locked
     pa_cvolume cv;
-    bool muted{false};
     // default sink name
     static constexpr auto DEFAULT_SINK{"@DEFAULT_SINK@"};
 
     pa_context* m_context{nullptr};
     pa_threaded_mainloop* m_mainloop{nullptr};
 
-    queue m_events;
+    // only accessed with the mainloop locked
+    sink_query m_query;
+
+    // results of the last query
+    std::atomic<int> m_volume{0};
+    std::atomic<bool> m_muted{false};
+    subscribers m_subscribers;
 
     // specified sink name
     string spec_s_name;
+    // name of the sink in use, only accessed with the mainloop locked
     string s_name;
     uint32_t m_index{0};
-
-    pa_volume_t m_max_volume{PA_VOLUME_UI_MAX};
 };
 
 POLYBAR_NS_END
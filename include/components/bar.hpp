@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <atomic>
 #include <mutex>
+#include <set>
 
 #include "common.hpp"
 #include "components/types.hpp"
@@ -52,22 +53,21 @@ inline double geom_format_to_pixels(std::string str, double max) {
 
 class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::property_notify, evt::enter_notify,
                 evt::leave_notify, evt::motion_notify, evt::destroy_notify, evt::client_message>,
-            public signal_receiver<SIGN_PRIORITY_BAR, signals::eventqueue::start, signals::ui::tick,
-                signals::ui::shade_window, signals::ui::unshade_window, signals::ui::dim_window
-#if WITH_XCURSOR
-                , signals::ui::cursor_change
-#endif
-		> {
+            public signal_receiver<SIGN_PRIORITY_BAR, signals::eventqueue::start, signals::ui::shade_window,
+                signals::ui::unshade_window> {
  public:
   using make_type = unique_ptr<bar>;
-  static make_type make(bool only_initialize_values = false);
+  static make_type make(string section = "", bool only_initialize_values = false);
 
   explicit bar(connection&, signal_emitter&, const config&, const logger&, unique_ptr<screen>&&,
-      unique_ptr<tray_manager>&&, unique_ptr<parser>&&, unique_ptr<taskqueue>&&, bool only_initialize_values);
+      unique_ptr<tray_manager>&&, unique_ptr<parser>&&, unique_ptr<taskqueue>&&, string&& section,
+      bool only_initialize_values);
   ~bar();
 
   const bar_settings settings() const;
 
+  bool reload(const std::set<string>& keys);
+
   void parse(string&& data, bool force = false);
 
   void hide();
@@ -75,11 +75,13 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   void toggle();
 
  protected:
+  void load_layout();
   void restack_window();
   void reconfigure_pos();
   void reconfigure_struts();
   void reconfigure_wm_hints();
   void broadcast_visibility();
+  void dim(double value);
 
   void handle(const evt::client_message& evt);
   void handle(const evt::destroy_notify& evt);
@@ -1,14 +1,13 @@
 #pragma once
 
-#include <map>
+#include <array>
 
 #include "common.hpp"
 #include "components/types.hpp"
+#include "utils/color.hpp"
 
 POLYBAR_NS
 
-using std::map;
-
 // fwd decl
 namespace drawtypes {
   class label;
@@ -23,9 +22,10 @@ class builder {
   explicit builder(const bar_settings& bar);
 
   string flush();
-  void append(string text);
-  void node(string str, bool add_space = false);
-  void node(string str, int font_index, bool add_space = false);
+  void flush(string& output);
+  void append(const string& text);
+  void node(const string& str, bool add_space = false);
+  void node(const string& str, int font_index, bool add_space = false);
   void node(const label_t& label, bool add_space = false);
   void node_repeat(const string& str, size_t n, bool add_space = false);
   void node_repeat(const label_t& label, size_t n, bool add_space = false);
@@ -36,46 +36,52 @@ class builder {
   void remove_trailing_space();
   void font(int index);
   void font_close();
-  void background(string color);
+  void background(const string& color);
+  void background(const argb& color);
   void background_close();
-  void color(string color);
-  void color_alpha(string alpha);
+  void color(const string& color);
+  void color(const argb& color);
+  void color_alpha(const string& alpha);
   void color_close();
   void line_color(const string& color);
+  void line_color(const argb& color);
   void line_color_close();
-  void overline_color(string color);
+  void overline_color(const string& color);
+  void overline_color(const argb& color);
   void overline_color_close();
-  void underline_color(string color);
+  void underline_color(const string& color);
+  void underline_color(const argb& color);
   void underline_color_close();
-  void overline(const string& color = "");
+  void overline(const string& color);
+  void overline(const argb& color = argb{});
   void overline_close();
-  void underline(const string& color = "");
+  void underline(const string& color);
+  void underline(const argb& color = argb{});
   void underline_close();
-  void cmd(mousebtn index, string action, bool condition = true);
-  void cmd(mousebtn index, string action, const label_t& label);
+  void cmd(mousebtn index, const string& action, bool condition = true);
+  void cmd(mousebtn index, const string& action, const label_t& label);
   void cmd_close(bool condition = true);
 
  protected:
-  string background_hex();
-  string foreground_hex();
+  void codeblock(const string& str, size_t start, size_t end);
 
   void tag_open(syntaxtag tag, const string& value);
+  void tag_open(syntaxtag tag, unsigned int color);
   void tag_open(attribute attr);
   void tag_close(syntaxtag tag);
   void tag_close(attribute attr);
 
  private:
+  static constexpr size_t TAG_COUNT{static_cast<size_t>(syntaxtag::u) + 1};
+
   const bar_settings m_bar;
   string m_output;
 
-  map<syntaxtag, int> m_tags{};
-  map<syntaxtag, string> m_colors{};
+  array<int, TAG_COUNT> m_tags{};
+  array<unsigned int, TAG_COUNT> m_colors{};
 
   int m_attributes{0};
   int m_fontindex{0};
-
-  string m_background{};
-  string m_foreground{};
 };
 
 POLYBAR_NS_END
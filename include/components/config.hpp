@@ -1,8 +1,10 @@
 #pragma once
 
+#include <set>
 #include <unordered_map>
 
 #include "common.hpp"
+#include "components/config_snapshot.hpp"
 #include "components/logger.hpp"
 #include "errors.hpp"
 #include "settings.hpp"
@@ -15,48 +17,60 @@
 
 POLYBAR_NS
 
-DEFINE_ERROR(value_error);
-DEFINE_ERROR(key_error);
-
 class config {
  public:
   using valuemap_t = std::unordered_map<string, string>;
   using sectionmap_t = std::map<string, valuemap_t>;
 
+  using changes_t = std::map<string, std::set<string>>;
+
   using make_type = const config&;
   static make_type make(string path = "", string bar = "");
+  static config& make_mutable();
 
   explicit config(const logger& logger, string&& path = "", string&& bar = "");
 
   string filepath() const;
   string section() const;
 
+  changes_t reload();
+
   void warn_deprecated(const string& section, const string& key, string replacement) const;
 
+  /**
+   * Returns true if the section is defined
+   */
+  bool has_section(const string& section) const {
+    return m_overrides.find(section) != m_overrides.end() || m_table.has_section(section);
+  }
+
   /**
    * Returns true if a given parameter exists
    */
   bool has(const string& section, const string& key) const {
-    auto it = m_sections.find(section);
-    return it != m_sections.end() && it->second.find(key) != it->second.end();
+    return find(section, key) != nullptr || find(m_invalid, section, key) != nullptr;
+  }
+
+  /**
+   * Get the resolved value of a parameter without throwing,
+   * returns nullptr if the parameter isn't defined
+   */
+  const char* find(const string& section, const string& key) const {
+    const string* value{find(m_overrides, section, key)};
+    if (value != nullptr) {
+      return value->c_str();
+    } else if (find(m_invalid, section, key) != nullptr) {
+      return nullptr;
+    }
+    return m_table.find(section, key);
   }
 
   /**
    * Set parameter value
    */
   void set(const string& section, const string& key, string&& value) {
-    auto it = m_sections.find(section);
-    if (it == m_sections.end()) {
-      valuemap_t values;
-      values[key] = value;
-      m_sections[section] = move(values);
-    }
-    auto it2 = it->second.find(key);
-    if ((it2 = it->second.find(key)) == it->second.end()) {
-      it2 = it->second.emplace_hint(it2, key, value);
-    } else {
-      it2->second = value;
-    }
+    m_overrides[section][key] = forward<string>(value);
+    index_lists(section);
   }
 
   /**
@@ -72,11 +86,11 @@ class config {
    */
   template <typename T = string>
   T get(const string& section, const string& key) const {
-    auto it = m_sections.find(section);
-    if (it == m_sections.end() || it->second.find(key) == it->second.end()) {
-      throw key_error("Missing parameter \"" + section + "." + key + "\"");
+    const char* value{find(section, key)};
+    if (value == nullptr) {
+      throw_missing(section, key);
     }
-    return dereference<T>(section, key, it->second.at(key), convert<T>(string{it->second.at(key)}));
+    return convert<T>(string{value});
   }
 
   /**
@@ -85,13 +99,12 @@ class config {
    */
   template <typename T = string>
   T get(const string& section, const string& key, const T& default_value) const {
-    try {
-      string string_value{get<string>(section, key)};
-      T result{convert<T>(string{string_value})};
-      return dereference<T>(move(section), move(key), move(string_value), move(result));
-    } catch (const key_error& err) {
+    const char* value{find(section, key)};
+    if (value == nullptr) {
+      check_invalid(section, key);
       return default_value;
     }
+    return convert<T>(string{value});
   }
 
   /**
@@ -107,28 +120,11 @@ class config {
    */
   template <typename T = string>
   vector<T> get_list(const string& section, const string& key) const {
-    vector<T> results;
-
-    while (true) {
-      try {
-        string string_value{get<string>(section, key + "-" + to_string(results.size()))};
-        T value{convert<T>(string{string_value})};
-
-        if (!string_value.empty()) {
-          results.emplace_back(dereference<T>(section, key, move(string_value), move(value)));
-        } else {
-          results.emplace_back(move(value));
-        }
-      } catch (const key_error& err) {
-        break;
-      }
-    }
-
-    if (results.empty()) {
-      throw key_error("Missing parameter \"" + section + "." + key + "-0\"");
+    const vector<string>* list{find_list(section, key)};
+    if (list == nullptr) {
+      throw_missing(section, key + "-0");
     }
-
-    return results;
+    return convert_list<T>(section, key, *list);
   }
 
   /**
@@ -137,29 +133,12 @@ class config {
    */
   template <typename T = string>
   vector<T> get_list(const string& section, const string& key, const vector<T>& default_value) const {
-    vector<T> results;
-
-    while (true) {
-      try {
-        string string_value{get<string>(section, key + "-" + to_string(results.size()))};
-        T value{convert<T>(string{string_value})};
-
-        if (!string_value.empty()) {
-          results.emplace_back(dereference<T>(section, key, move(string_value), move(value)));
-        } else {
-          results.emplace_back(move(value));
-        }
-      } catch (const key_error& err) {
-        break;
-      }
-    }
-
-    if (!results.empty()) {
-      return results;
-      ;
+    const vector<string>* list{find_list(section, key)};
+    if (list == nullptr) {
+      check_invalid(section, key + "-0");
+      return default_value;
     }
-
-    return default_value;
+    return convert_list<T>(section, key, *list);
   }
 
   /**
@@ -169,13 +148,12 @@ class config {
    */
   template <typename T = string>
   T deprecated(const string& section, const string& old, const string& newkey, const T& fallback) const {
-    try {
+    if (has(section, old)) {
       T value{get<T>(section, old)};
       warn_deprecated(section, old, newkey);
       return value;
-    } catch (const key_error& err) {
-      return get<T>(section, newkey, fallback);
     }
+    return get<T>(section, newkey, fallback);
   }
 
   /**
@@ -183,179 +161,94 @@ class config {
    */
   template <typename T = string>
   T deprecated_list(const string& section, const string& old, const string& newkey, const vector<T>& fallback) const {
-    try {
+    if (find_list(section, old) != nullptr || has(section, old + "-0")) {
       vector<T> value{get_list<T>(section, old)};
       warn_deprecated(section, old, newkey);
       return value;
-    } catch (const key_error& err) {
-      return get_list<T>(section, newkey, fallback);
     }
+    return get_list<T>(section, newkey, fallback);
   }
 
  protected:
+  using listmap_t = std::unordered_map<string, vector<string>>;
+
   void parse_file();
   void copy_inherited();
+  void resolve_references();
+  void index_lists(const string& section);
+  sectionmap_t values() const;
+
+  string snapshot_path() const;
+  bool load_snapshot(const string& path);
+  void save_snapshot(const string& path) const;
+
+  static bool is_reference(const string& value);
+  static bool is_reference(const config_snapshot::string_ref& value);
+  void resolve_param(const string& section, const string& key);
+  string resolve(const string& section, const string& key, const string& value, vector<string>& chain);
+  string resolve_local(string section, const string& key, const string& current_section, vector<string>& chain);
+  string resolve_env(string var) const;
+  string resolve_xrdb(string var) const;
+  string resolve_file(string var) const;
+
+  const char* lookup(const string& section, const string& key) const;
+  const vector<string>* find_list(const string& section, const string& key) const;
+  void check_invalid(const string& section, const string& key) const;
+  [[noreturn]] void throw_missing(const string& section, const string& key) const;
+
+  static const string* find(const sectionmap_t& sections, const string& section, const string& key) {
+    auto it = sections.find(section);
+    if (it == sections.end()) {
+      return nullptr;
+    }
+    auto value = it->second.find(key);
+    return value != it->second.end() ? &value->second : nullptr;
+  }
 
   template <typename T>
   T convert(string&& value) const;
 
-  /**
-   * Dereference value reference
-   */
   template <typename T>
-  T dereference(const string& section, const string& key, const string& var, const T& fallback) const {
-    if (var.substr(0, 2) != "${" || var.substr(var.length() - 1) != "}") {
-      return fallback;
-    }
-
-    auto path = var.substr(2, var.length() - 3);
-    size_t pos;
-
-    if (path.compare(0, 4, "env:") == 0) {
-      return dereference_env<T>(path.substr(4));
-    } else if (path.compare(0, 5, "xrdb:") == 0) {
-      return dereference_xrdb<T>(path.substr(5));
-    } else if (path.compare(0, 5, "file:") == 0) {
-      return dereference_file<T>(path.substr(5));
-    } else if ((pos = path.find(".")) != string::npos) {
-      return dereference_local<T>(path.substr(0, pos), path.substr(pos + 1), section);
-    } else {
-      throw value_error("Invalid reference defined at \"" + section + "." + key + "\"");
+  vector<T> convert_list(const string& section, const string& key, const vector<string>& list) const {
+    vector<T> results;
+    results.reserve(list.size());
+    for (auto&& value : list) {
+      results.emplace_back(convert<T>(string{value}));
     }
+    check_invalid(section, key + "-" + to_string(list.size()));
+    return results;
   }
 
+ private:
+  const logger& m_log;
+  string m_file;
+  string m_barname;
+
   /**
-   * Dereference local value reference defined using:
-   *  ${root.key}
-   *  ${root.key:fallback}
-   *  ${self.key}
-   *  ${self.key:fallback}
-   *  ${section.key}
-   *  ${section.key:fallback}
+   * @brief Parameters as defined in the config files
    */
-  template <typename T>
-  T dereference_local(string section, const string& key, const string& current_section) const {
-    if (section == "BAR") {
-      m_log.warn("${BAR.key} is deprecated. Use ${root.key} instead");
-    }
-
-    section = string_util::replace(section, "BAR", this->section(), 0, 3);
-    section = string_util::replace(section, "root", this->section(), 0, 4);
-    section = string_util::replace(section, "self", current_section, 0, 4);
-
-    try {
-      string string_value{get<string>(section, key)};
-      T result{convert<T>(string{string_value})};
-      return dereference<T>(string(section), move(key), move(string_value), move(result));
-    } catch (const key_error& err) {
-      size_t pos;
-      if ((pos = key.find(':')) != string::npos) {
-        string fallback = key.substr(pos + 1);
-        m_log.info("The reference ${%s.%s} does not exist, using defined fallback value \"%s\"", section,
-            key.substr(0, pos), fallback);
-        return convert<T>(move(fallback));
-      }
-      throw value_error("The reference ${" + section + "." + key + "} does not exist (no fallback set)");
-    }
-  }
+  config_snapshot::table m_table{};
 
   /**
-   * Dereference environment variable reference defined using:
-   *  ${env:key}
-   *  ${env:key:fallback value}
+   * @brief Values replacing or extending the parsed parameters:
+   * inherited parameters, resolved references and values set at runtime
    */
-  template <typename T>
-  T dereference_env(string var) const {
-    size_t pos;
-    string env_default;
-
-    if ((pos = var.find(':')) != string::npos) {
-      env_default = var.substr(pos + 1);
-      var.erase(pos);
-    }
-
-    if (env_util::has(var.c_str())) {
-      string env_value{env_util::get(var.c_str())};
-      m_log.info("Environment var reference ${%s} found (value=%s)", var, env_value);
-      return convert<T>(move(env_value));
-    } else if (!env_default.empty()) {
-      m_log.info("Environment var ${%s} is undefined, using defined fallback value \"%s\"", var, env_default);
-      return convert<T>(move(env_default));
-    } else {
-      throw value_error(sstream() << "Environment var ${" << var << "} does not exist (no fallback set)");
-    }
-  }
+  sectionmap_t m_overrides{};
 
   /**
-   * Dereference X resource db value defined using:
-   *  ${xrdb:key}
-   *  ${xrdb:key:fallback value}
+   * @brief Error messages for parameters with unresolvable references
    */
-  template <typename T>
-  T dereference_xrdb(string var) const {
-    size_t pos;
-#if not WITH_XRM
-    m_log.warn("No built-in support to dereference ${xrdb:%s} references (requires `xcb-util-xrm`)", var);
-    if ((pos = var.find(':')) != string::npos) {
-      return convert<T>(var.substr(pos + 1));
-    }
-    return convert<T>("");
-#else
-    if (!m_xrm) {
-      throw application_error("xrm is not initialized");
-    }
-
-    string fallback;
-    if ((pos = var.find(':')) != string::npos) {
-      fallback = var.substr(pos + 1);
-      var.erase(pos);
-    }
-
-    try {
-      auto value = m_xrm->require<string>(var.c_str());
-      m_log.info("Found matching X resource \"%s\" (value=%s)", var, value);
-      return convert<T>(move(value));
-    } catch (const xresource_error& err) {
-      if (!fallback.empty()) {
-        m_log.warn("%s, using defined fallback value \"%s\"", err.what(), fallback);
-        return convert<T>(move(fallback));
-      }
-      throw value_error(sstream() << err.what() << " (no fallback set)");
-    }
-#endif
-  }
+  sectionmap_t m_invalid{};
 
   /**
-   * Dereference file reference by reading its contents
-   *  ${file:/absolute/file/path}
-   *  ${file:/absolute/file/path:fallback value}
+   * @brief Values of parameters named key-0, key-1, ... by list key
    */
-  template <typename T>
-  T dereference_file(string var) const {
-    size_t pos;
-    string fallback;
-    if ((pos = var.find(':')) != string::npos) {
-      fallback = var.substr(pos + 1);
-      var.erase(pos);
-    }
-    var = file_util::expand(var);
-
-    if (file_util::exists(var)) {
-      m_log.info("File reference \"%s\" found", var);
-      return convert<T>(string_util::trim(file_util::contents(var), '\n'));
-    } else if (!fallback.empty()) {
-      m_log.warn("File reference \"%s\" not found, using defined fallback value \"%s\"", var, fallback);
-      return convert<T>(move(fallback));
-    } else {
-      throw value_error(sstream() << "The file \"" << var << "\" does not exist (no fallback set)");
-    }
-  }
+  std::map<string, listmap_t> m_lists{};
 
- private:
-  const logger& m_log;
-  string m_file;
-  string m_barname;
-  sectionmap_t m_sections{};
+  /**
+   * @brief Main config file followed by all included files
+   */
+  vector<string> m_files{};
 #if WITH_XRM
   unique_ptr<xresource_manager> m_xrm;
 #endif
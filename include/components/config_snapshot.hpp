@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+#include "errors.hpp"
+
+POLYBAR_NS
+
+class logger;
+
+DEFINE_ERROR(value_error);
+DEFINE_ERROR(key_error);
+
+/**
+ * Flat, read-only form of the parsed config files
+ *
+ * The parameters are either parsed from the config text or mapped from
+ * a binary snapshot written by a previous run. A snapshot stores every
+ * file that was read together with a hash of its contents, so that it
+ * is only used while none of them changed
+ */
+namespace config_snapshot {
+  /**
+   * Non-owning reference to a NUL-terminated string in a table
+   */
+  struct string_ref {
+    const char* data;
+    size_t size;
+
+    string str() const {
+      return string{data, size};
+    }
+
+    bool starts_with(const char* prefix) const;
+    bool contains(const char* needle) const;
+  };
+
+  /**
+   * Parameters sorted by section and key
+   *
+   * The records and the string pool either point into a mapped snapshot
+   * or into a buffer owned by the table. Lookups are binary searches on
+   * the records, nothing is copied when a snapshot is loaded
+   */
+  class table {
+   public:
+    struct record {
+      uint32_t section;
+      uint32_t section_size;
+      uint32_t key;
+      uint32_t key_size;
+      uint32_t value;
+      uint32_t value_size;
+    };
+
+    struct param {
+      string section;
+      string key;
+      string value;
+    };
+
+    table() = default;
+    table(table&& other) noexcept;
+    table& operator=(table&& other) noexcept;
+    table(const table&) = delete;
+    table& operator=(const table&) = delete;
+    ~table();
+
+    static table build(vector<param>&& params);
+    static table map(void* data, size_t size, size_t offset);
+
+    bool valid() const;
+
+    size_t size() const {
+      return m_count;
+    }
+
+    string_ref section(size_t index) const {
+      return ref(m_records[index].section, m_records[index].section_size);
+    }
+
+    string_ref key(size_t index) const {
+      return ref(m_records[index].key, m_records[index].key_size);
+    }
+
+    string_ref value(size_t index) const {
+      return ref(m_records[index].value, m_records[index].value_size);
+    }
+
+    const char* find(const string& section, const string& key) const;
+    pair<size_t, size_t> range(const string& section) const;
+    bool has_section(const string& section) const;
+
+    const char* data() const {
+      return m_data;
+    }
+
+    size_t bytes() const {
+      return m_bytes;
+    }
+
+   protected:
+    void attach();
+
+    string_ref ref(uint32_t offset, uint32_t size) const {
+      return string_ref{m_pool + offset, size};
+    }
+
+    int compare(size_t index, const string& section, const string& key) const;
+
+   private:
+    /**
+     * Serialized table: record count, pool size, records and string pool
+     */
+    const char* m_data{nullptr};
+    size_t m_offset{0};
+    size_t m_bytes{0};
+
+    const record* m_records{nullptr};
+    size_t m_count{0};
+    const char* m_pool{nullptr};
+
+    /**
+     * Storage of a built table, or the mapping the table points into
+     */
+    string m_buffer;
+    void* m_map{nullptr};
+    size_t m_mapsize{0};
+  };
+
+  string path(const string& file);
+  table parse(const string& mainfile, vector<string>& files, const logger& log);
+  bool load(const string& path, const string& mainfile, vector<string>& files, table& params);
+  bool save(const string& path, const vector<string>& files, const table& params);
+}
+
+POLYBAR_NS_END
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <moodycamel/blockingconcurrentqueue.h>
+#include <mutex>
 #include <thread>
 
 #include "common.hpp"
@@ -17,6 +18,7 @@ POLYBAR_NS
 
 enum class alignment;
 class bar;
+struct bar_settings;
 class command;
 class config;
 class connection;
@@ -29,7 +31,8 @@ namespace modules {
   class input_handler;
 }
 using module_t = unique_ptr<modules::module_interface>;
-using modulemap_t = std::map<alignment, vector<module_t>>;
+using modulemap_t = std::map<string, module_t>;
+using layout_t = std::map<alignment, vector<modules::module_interface*>>;
 
 // }}}
 
@@ -38,10 +41,11 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
                        signals::ipc::command, signals::ipc::hook, signals::ui::ready, signals::ui::button_press> {
  public:
   using make_type = unique_ptr<controller>;
-  static make_type make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch);
+  static make_type make(
+      const vector<string>& bars, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch);
 
-  explicit controller(connection&, signal_emitter&, const logger&, const config&, unique_ptr<bar>&&, unique_ptr<ipc>&&,
-      unique_ptr<inotify_watch>&&);
+  explicit controller(connection&, signal_emitter&, const logger&, config&, vector<unique_ptr<bar>>&&,
+      unique_ptr<ipc>&&, unique_ptr<inotify_watch>&&);
   ~controller();
 
   bool run(bool writeback, string snapshot_dst);
@@ -50,10 +54,19 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   bool enqueue(string&& input_data);
 
  protected:
+  vector<modules::module_interface*> setup_modules(modulemap_t& reusable);
+  bool start_module(modules::module_interface& module);
+  void stop_module(module_t& module);
+  void collect_inputhandlers();
+
   void read_events();
   void process_eventqueue();
+  void dequeued(const event& evt);
+  void process_check();
+  void process_reload();
   void process_inputdata();
   bool process_update(bool force);
+  string build_contents(const bar_settings& bar, const layout_t& layout);
 
   bool on(const signals::eventqueue::notify_change& evt);
   bool on(const signals::eventqueue::notify_forcechange& evt);
@@ -70,8 +83,8 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   connection& m_connection;
   signal_emitter& m_sig;
   const logger& m_log;
-  const config& m_conf;
-  unique_ptr<bar> m_bar;
+  config& m_conf;
+  vector<unique_ptr<bar>> m_bars;
   unique_ptr<ipc> m_ipc;
   unique_ptr<inotify_watch> m_confwatch;
   unique_ptr<command> m_command;
@@ -83,6 +96,12 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
    */
   std::atomic<bool> m_process_events{false};
 
+  /**
+   * @brief Set while an update event is queued but not yet processed
+   */
+  std::atomic<bool> m_pending_update{false};
+  std::atomic<bool> m_pending_forceupdate{false};
+
   /**
    * @brief Destination path of generated snapshot
    */
@@ -99,10 +118,21 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   moodycamel::BlockingConcurrentQueue<event> m_queue;
 
   /**
-   * @brief Loaded modules
+   * @brief Loaded modules, shared by bars with the same module settings
    */
   modulemap_t m_modules;
 
+  /**
+   * @brief Modules placed in each bar, in the order of m_bars
+   */
+  vector<layout_t> m_layouts;
+
+  /**
+   * @brief Guards m_modules against a reload while ipc hooks are
+   * dispatched from the main thread
+   */
+  std::mutex m_modules_mutex;
+
   /**
    * @brief Module input handlers
    */
@@ -1,14 +1,12 @@
 #pragma once
 
 #include "common.hpp"
+#include "components/types.hpp"
 #include "errors.hpp"
 
 POLYBAR_NS
 
 class signal_emitter;
-enum class attribute;
-enum class mousebtn;
-struct bar_settings;
 
 DEFINE_ERROR(parser_error);
 DEFINE_CHILD_ERROR(unrecognized_token, parser_error);
@@ -22,21 +20,23 @@ class parser {
 
  public:
   explicit parser(signal_emitter& emitter);
-  void parse(const bar_settings& bar, string data);
+  void parse(const bar_settings& bar, const string& data);
 
  protected:
-  void codeblock(string&& data, const bar_settings& bar);
-  size_t text(string&& data);
+  void codeblock(const string& data, size_t pos, size_t end, const bar_settings& bar);
+  void text(const string& data, size_t start, size_t end);
 
   unsigned int parse_color(const string& s, unsigned int fallback = 0);
   int parse_fontindex(const string& s);
   attribute parse_attr(const char attr);
-  mousebtn parse_action_btn(const string& data);
-  string parse_action_cmd(string&& data);
+  mousebtn parse_action_btn(const char btn);
+  size_t parse_action_cmd(const string& data, size_t start, size_t end);
 
  private:
   signal_emitter& m_sig;
   vector<int> m_actions;
+  string m_value;
+  action m_action;
   unique_ptr<parser> m_parser;
 };
 
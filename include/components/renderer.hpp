@@ -130,6 +130,10 @@ class renderer
 
   bool m_fixedcenter;
   string m_snapshot_dst;
+
+  // Parser signals are only handled between begin() and end() so
+  // that each bar's contents reach its own renderer
+  bool m_drawing{false};
 };
 
 POLYBAR_NS_END
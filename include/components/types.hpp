@@ -148,6 +148,7 @@ struct bar_settings {
   int spacing{0};
   string separator{};
 
+  string section{};
   string wmname{};
   string locale{};
 
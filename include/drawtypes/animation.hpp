@@ -1,6 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "common.hpp"
 #include "components/config.hpp"
@@ -38,6 +41,45 @@ namespace drawtypes {
 
   using animation_t = shared_ptr<animation>;
 
+  /**
+   * Single timer thread that schedules the redraws of all animations,
+   * so that modules don't need a thread of their own to step frames
+   *
+   * Callbacks run with the clock locked, so once unsubscribe() returns
+   * the callbacks of the owner are guaranteed to not run anymore
+   */
+  class animation_clock : public non_copyable_mixin<animation_clock> {
+   public:
+    using clock = chrono::steady_clock;
+    using callback = function<void()>;
+
+    using make_type = animation_clock&;
+    static make_type make();
+
+    explicit animation_clock() = default;
+    ~animation_clock();
+
+    void subscribe(const void* owner, chrono::milliseconds framerate, callback fn);
+    void unsubscribe(const void* owner);
+
+   protected:
+    void run();
+
+   private:
+    struct subscriber {
+      const void* owner;
+      chrono::milliseconds framerate;
+      callback fn;
+      clock::time_point next;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    vector<subscriber> m_subscribers;
+    std::thread m_thread;
+    bool m_running{true};
+  };
+
   animation_t load_animation(
       const config& conf, const string& section, string name = "animation", bool required = true);
 }
@@ -3,6 +3,7 @@
 #include "common.hpp"
 #include "components/config.hpp"
 #include "components/types.hpp"
+#include "utils/color.hpp"
 #include "utils/mixins.hpp"
 
 POLYBAR_NS
@@ -30,19 +31,21 @@ namespace drawtypes {
 
   class label : public non_copyable_mixin<label> {
    public:
-    string m_foreground{};
-    string m_background{};
-    string m_underline{};
-    string m_overline{};
+    argb m_foreground{};
+    argb m_background{};
+    argb m_underline{};
+    argb m_overline{};
     int m_font{0};
     side_values m_padding{0U,0U};
     side_values m_margin{0U,0U};
     size_t m_maxlen{0_z};
     bool m_ellipsis{true};
 
-    explicit label(string text, int font) : m_font(font), m_text(text), m_tokenized(m_text) {}
-    explicit label(string text, string foreground = ""s, string background = ""s, string underline = ""s,
-        string overline = ""s, int font = 0, struct side_values padding = {0U,0U}, struct side_values margin = {0U,0U},
+    explicit label(string text, int font) : m_font(font), m_text(text) {
+      compile();
+    }
+    explicit label(string text, argb foreground = {}, argb background = {}, argb underline = {},
+        argb overline = {}, int font = 0, struct side_values padding = {0U,0U}, struct side_values margin = {0U,0U},
         size_t maxlen = 0_z, bool ellipsis = true, vector<token>&& tokens = {})
         : m_foreground(foreground)
         , m_background(background)
@@ -54,24 +57,43 @@ namespace drawtypes {
         , m_maxlen(maxlen)
         , m_ellipsis(ellipsis)
         , m_text(text)
-        , m_tokenized(m_text)
-        , m_tokens(forward<vector<token>>(tokens)) {}
+        , m_tokens(forward<vector<token>>(tokens)) {
+      compile();
+    }
 
-    string get() const;
+    const string& get() const;
     operator bool();
     label_t clone();
     void clear();
     void reset_tokens();
-    void reset_tokens(const string& tokenized);
     bool has_token(const string& token) const;
-    void replace_token(const string& token, string replacement);
+    void replace_token(const string& token, const string& replacement);
     void replace_defined_values(const label_t& label);
     void copy_undefined(const label_t& label);
 
+   protected:
+    void compile();
+    void rebuild();
+
    private:
+    /**
+     * Literal text followed by an (optional) token slot.
+     * The template text is split into segments once when the
+     * label is created, so that replacing tokens only needs
+     * to fill in the slot values.
+     */
+    struct segment {
+      string text{};
+      size_t token{string::npos};
+      string value{};
+      bool filled{false};
+    };
+
     string m_text{};
-    string m_tokenized{};
     const vector<token> m_tokens{};
+    vector<segment> m_segments{};
+    bool m_cleared{false};
+    string m_tokenized{};
   };
 
   label_t load_label(const config& conf, const string& section, string name, bool required = true, string def = ""s);
@@ -23,16 +23,22 @@ namespace drawtypes {
     void set_empty(icon_t&& empty);
     void set_indicator(icon_t&& indicator);
     void set_gradient(bool mode);
-    void set_colors(vector<string>&& colors);
+    void set_colors(vector<argb>&& colors);
 
-    string output(float percentage);
+    const string& output(float percentage);
 
    protected:
+    void invalidate();
+    void render(string& output, unsigned int perc, unsigned int fill_width);
     void fill(unsigned int perc, unsigned int fill_width);
 
    private:
     unique_ptr<builder> m_builder;
-    vector<string> m_colors;
+    vector<argb> m_colors;
+    vector<string> m_outputs;
+    string m_fill_output;
+    string m_indicator_output;
+    string m_empty_output;
     string m_format;
     unsigned int m_width;
     unsigned int m_colorstep = 1;
@@ -51,6 +51,14 @@ namespace signals {
         return *static_cast<ValueType*>(m_ptr);
       }
 
+      /**
+       * Access the value without copying it, only valid
+       * for as long as the signal is being handled
+       */
+      inline const ValueType& get() const {
+        return *static_cast<const ValueType*>(m_ptr);
+      }
+
      private:
       void* m_ptr;
     };
@@ -1,14 +1,163 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "common.hpp"
 #include "events/signal_receiver.hpp"
 
 POLYBAR_NS
 
 /**
- * @brief Holds all signal receivers attached to the emitter
+ * Receivers attached to a single signal type, ordered by priority
+ *
+ * Emitting iterates an immutable snapshot of the list without taking
+ * any lock. Attaching and detaching publish a modified copy and the
+ * replaced snapshots are released once no emit is in progress.
+ *
+ * Detaching waits for the emits that may still use the old snapshot,
+ * so a receiver is not called anymore once detach() returns. Emits
+ * in progress on the calling thread are not waited for, which allows
+ * receivers to detach from within their handlers.
  */
-extern signal_receivers_t g_signal_receivers;
+template <typename Signal>
+class signal_receiver_list {
+ public:
+  struct entry {
+    signal_receiver_interface::prio priority;
+    signal_receiver_interface* receiver;
+    signal_receiver_impl<Signal>* sink;
+  };
+
+  using snapshot = vector<entry>;
+
+  static signal_receiver_list& instance() {
+    static signal_receiver_list list;
+    return list;
+  }
+
+  ~signal_receiver_list() {
+    delete m_current.load();
+  }
+
+  bool emit(const Signal& sig) {
+    reader guard{*this};
+
+    for (auto&& item : *m_current.load()) {
+      if (item.sink->on(sig)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void attach(signal_receiver_interface* receiver, signal_receiver_impl<Signal>* sink) {
+    std::lock_guard<std::mutex> guard(m_writelock);
+
+    auto list = make_unique<snapshot>(*m_current.load());
+    auto prio = receiver->priority();
+    auto it = std::find_if(list->begin(), list->end(), [&](const entry& e) { return e.priority > prio; });
+    list->insert(it, entry{prio, receiver, sink});
+
+    publish(move(list));
+  }
+
+  void detach(signal_receiver_interface* receiver) {
+    std::lock_guard<std::mutex> guard(m_writelock);
+
+    auto list = make_unique<snapshot>(*m_current.load());
+    auto it = std::remove_if(list->begin(), list->end(), [&](const entry& e) { return e.receiver == receiver; });
+
+    if (it != list->end()) {
+      list->erase(it, list->end());
+      publish(move(list));
+      synchronize();
+    }
+  }
+
+ protected:
+  /**
+   * Marks an emit as being in progress for the lifetime of the object,
+   * counted in the epoch that is still current after registering
+   */
+  struct reader {
+    explicit reader(signal_receiver_list& list) : m_list(list) {
+      while (true) {
+        auto epoch = m_list.m_epoch.load();
+        m_parity = epoch & 1;
+        m_list.m_readers[m_parity].fetch_add(1);
+        if (m_list.m_epoch.load() == epoch) {
+          break;
+        }
+        m_list.m_readers[m_parity].fetch_sub(1);
+      }
+      local_readers()[m_parity]++;
+    }
+    ~reader() {
+      local_readers()[m_parity]--;
+      m_list.m_readers[m_parity].fetch_sub(1);
+    }
+    signal_receiver_list& m_list;
+    size_t m_parity{0};
+  };
+
+  /**
+   * Emits in progress on the current thread, per epoch parity
+   */
+  static array<size_t, 2>& local_readers() {
+    static thread_local array<size_t, 2> readers{};
+    return readers;
+  }
+
+  explicit signal_receiver_list() = default;
+
+  /**
+   * Swap in the new snapshot
+   *
+   * A reader that picked up one of the retired snapshots registered
+   * itself before the swap, so none of them can still be in use once
+   * the reader count has dropped to zero
+   */
+  void publish(unique_ptr<snapshot>&& list) {
+    m_retired.emplace_back(m_current.exchange(list.release()));
+
+    if (m_readers[0].load() == 0 && m_readers[1].load() == 0) {
+      m_retired.clear();
+    }
+  }
+
+  /**
+   * Wait for all emits that may have picked up a retired snapshot
+   *
+   * Emits registered in the previous epoch were either waited for by the
+   * last call or loaded the snapshot after it was published. Emits
+   * starting after the epoch is advanced only count towards the new
+   * one, so the wait can't be starved by new emits
+   */
+  void synchronize() {
+    auto parity = m_epoch.fetch_add(1) & 1;
+
+    while (m_readers[parity].load() > local_readers()[parity]) {
+      std::this_thread::yield();
+    }
+
+    if (local_readers()[0] == 0 && local_readers()[1] == 0) {
+      m_retired.clear();
+    }
+  }
+
+ private:
+  std::atomic<const snapshot*> m_current{new snapshot{}};
+  std::atomic<size_t> m_epoch{0};
+  std::atomic<size_t> m_readers[2]{};
+
+  std::mutex m_writelock;
+  vector<unique_ptr<const snapshot>> m_retired;
+};
 
 /**
  * Wrapper used to delegate emitted signals
@@ -23,17 +172,8 @@ class signal_emitter {
   virtual ~signal_emitter() {}
 
   template <typename Signal>
-  bool emit(const Signal& sig) {
-    try {
-      for (auto&& item : g_signal_receivers.at(id<Signal>())) {
-        if (item.second->on(sig)) {
-          return true;
-        }
-      }
-    } catch (...) {
-    }
-
-    return false;
+  bool emit(const Signal& sig) const {
+    return signal_receiver_list<Signal>::instance().emit(sig);
   }
 
   template <typename Signal, typename Next, typename... Signals>
@@ -52,52 +192,27 @@ class signal_emitter {
   }
 
  protected:
-  template <typename Signal>
-  std::type_index id() const {
-    return typeid(Signal);
-  }
-
   template <typename Receiver, typename Signal>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    signal_receiver_list<Signal>::instance().attach(s, s);
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    attach<Receiver, Signal>(s);
     attach<Receiver, Next, Signals...>(s);
   }
 
-  void attach(signal_receiver_interface* s, std::type_index id) {
-    g_signal_receivers[id].emplace(s->priority(), s);
-  }
-
   template <typename Receiver, typename Signal>
   void detach(Receiver* s) {
-    detach(s, id<Signal>());
+    signal_receiver_list<Signal>::instance().detach(s);
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void detach(Receiver* s) {
-    detach(s, id<Signal>());
+    detach<Receiver, Signal>(s);
     detach<Receiver, Next, Signals...>(s);
   }
-
-  void detach(signal_receiver_interface* d, std::type_index id) {
-    try {
-      auto& prio_map = g_signal_receivers.at(id);
-      const auto& prio_sink_pair = prio_map.equal_range(d->priority());
-
-      for (auto it = prio_sink_pair.first; it != prio_sink_pair.second;) {
-        if (d == it->second) {
-          it = prio_map.erase(it);
-        } else {
-          ++it;
-        }
-      }
-    } catch (...) {
-    }
-  }
 };
 
 POLYBAR_NS_END
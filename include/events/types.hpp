@@ -12,6 +12,7 @@ enum class event_type {
   CHECK,
   INPUT,
   QUIT,
+  RELOAD,
 };
 
 struct event {
@@ -54,6 +55,13 @@ namespace {
   inline event make_check_evt() {
     return event{static_cast<int>(event_type::CHECK)};
   }
+
+  /**
+   * Create RELOAD event
+   */
+  inline event make_reload_evt() {
+    return event{static_cast<int>(event_type::RELOAD)};
+  }
 }
 
 POLYBAR_NS_END
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <poll.h>
+
 #include "settings.hpp"
 #include "modules/meta/event_module.hpp"
 #include "modules/meta/input_handler.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -24,10 +27,12 @@ namespace modules {
     explicit alsa_module(const bar_settings&, string);
 
     void teardown();
+    void idle();
+    void wakeup();
     bool has_event();
     bool update();
-    string get_format() const;
-    string get_output();
+    const char* get_format() const;
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
@@ -56,6 +61,11 @@ namespace modules {
 
     map<mixer, mixer_t> m_mixer;
     map<control, control_t> m_ctrl;
+
+    // descriptors of all mixers and controls, followed by the wakeup pipe
+    vector<pollfd> m_fds;
+    array<unique_ptr<file_descriptor>, 2> m_wakeupfd{};
+
     int m_headphoneid{0};
     bool m_mapped{false};
     atomic<bool> m_muted{false};
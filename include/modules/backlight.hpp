@@ -3,6 +3,7 @@
 #include "components/config.hpp"
 #include "settings.hpp"
 #include "modules/meta/inotify_module.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -11,10 +12,10 @@ namespace modules {
    public:
     struct brightness_handle {
       void filepath(const string& path);
-      float read() const;
+      float read();
 
      private:
-      string m_path;
+      unique_ptr<file_reader> m_reader;
     };
 
    public:
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <set>
+
 #include "common.hpp"
-#include "modules/meta/inotify_module.hpp"
+#include "modules/meta/event_module.hpp"
+#include "utils/uevent.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  class battery_module : public inotify_module<battery_module> {
+  class battery_module : public event_module<battery_module> {
    public:
     enum class state {
       NONE = 0,
@@ -47,11 +50,10 @@ namespace modules {
    public:
     explicit battery_module(const bar_settings&, string);
 
-    void start();
     void teardown();
-    void idle();
-    bool on_event(inotify_event* event);
-    string get_format() const;
+    bool has_event();
+    bool update();
+    const char* get_format() const;
     bool build(builder* builder, const string& tag) const;
 
    protected:
@@ -59,7 +61,7 @@ namespace modules {
     int current_percentage(state state);
     string current_time();
     string current_consumption();
-    void subthread();
+    void animate(state state);
 
    private:
     static constexpr const char* FORMAT_CHARGING{"format-charging"};
@@ -107,7 +109,7 @@ vector<struct battery_context*> m_batteries;
     progressbar_t m_bar_capacity;
     ramp_t m_ramp_capacity;
 
-    state m_state{state::DISCHARGING};
+    std::atomic<state> m_state{state::NONE};
     int m_percentage{0};
 
     int m_fullat{100};
@@ -115,7 +117,9 @@ vector<struct battery_context*> m_batteries;
     size_t m_unchanged{SKIP_N_UNCHANGED};
     chrono::duration<double> m_interval{};
     chrono::system_clock::time_point m_lastpoll;
-    thread m_subthread;
+
+    unique_ptr<uevent_monitor> m_monitor;
+    std::set<string> m_supplies;
   };
 }
 
@@ -30,8 +30,16 @@ namespace modules {
       NODE_PRIVATE
     };
 
+    struct bspwm_workspace {
+      unsigned int mask{0U};
+      size_t index{0U};
+      string name;
+      label_t label;
+    };
+
     struct bspwm_monitor {
-      vector<pair<unsigned int, label_t>> workspaces;
+      vector<bspwm_workspace> workspaces;
+      vector<mode> mode_flags;
       vector<label_t> modes;
       label_t label;
       string name;
@@ -44,14 +52,16 @@ namespace modules {
     void stop();
     bool has_event();
     bool update();
-    string get_output();
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
     bool input(string&& cmd);
 
    private:
-    bool handle_status(string& data);
+    bool handle_status(const char* begin, const char* end);
+    void parse_status(const char* begin, const char* end, vector<unique_ptr<bspwm_monitor>>& monitors);
+    label_t make_workspace_label(const bspwm_workspace& ws, bool focused_monitor) const;
 
     static constexpr auto DEFAULT_ICON = "ws-icon-default";
     static constexpr auto DEFAULT_LABEL = "%icon% %name%";
@@ -67,6 +77,12 @@ namespace modules {
     static constexpr const char* EVENT_SCROLL_DOWN{"bspwm-deskprev"};
 
     bspwm_util::connection_t m_subscriber;
+    bool m_reconnect{false};
+
+    /**
+     * Data received from the subscriber, up to an incomplete report
+     */
+    string m_buffer;
 
     vector<unique_ptr<bspwm_monitor>> m_monitors;
 
@@ -85,11 +101,11 @@ namespace modules {
     bool m_revscroll{true};
     bool m_pinworkspaces{true};
     bool m_inlinemode{false};
-    string_util::hash_type m_hash{0U};
     bool m_fuzzy_match{false};
 
     // used while formatting output
     size_t m_index{0U};
+    string m_monitoroutput;
   };
 }
 
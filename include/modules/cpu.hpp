@@ -1,21 +1,12 @@
 #pragma once
 
+#include "adapters/procfs.hpp"
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  struct cpu_time {
-    unsigned long long user;
-    unsigned long long nice;
-    unsigned long long system;
-    unsigned long long idle;
-    unsigned long long total;
-  };
-
-  using cpu_time_t = unique_ptr<cpu_time>;
-
   class cpu_module : public timer_module<cpu_module> {
    public:
     explicit cpu_module(const bar_settings&, string);
@@ -38,8 +29,9 @@ namespace modules {
     ramp_t m_rampload_core;
     label_t m_label;
 
-    vector<cpu_time_t> m_cputimes;
-    vector<cpu_time_t> m_cputimes_prev;
+    shared_ptr<procfs::stat_provider> m_provider;
+    procfs::stat_provider::value_type m_cputimes;
+    procfs::stat_provider::value_type m_cputimes_prev;
 
     float m_total = 0;
     vector<float> m_load;
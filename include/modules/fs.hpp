@@ -1,8 +1,14 @@
 #pragma once
 
+#include <sys/statvfs.h>
+#include <condition_variable>
+#include <deque>
+
+#include "adapters/procfs.hpp"
 #include "components/config.hpp"
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -13,6 +19,7 @@ namespace modules {
   struct fs_mount {
     string mountpoint;
     bool mounted = false;
+    bool unresponsive = false;
 
     string type;
     string fsname;
@@ -30,6 +37,52 @@ namespace modules {
 
   using fs_mount_t = unique_ptr<fs_mount>;
 
+  /**
+   * Result of the last statvfs(3) call on a mountpoint
+   */
+  struct fs_stat {
+    bool pending{false};
+    // The call outlived a query timeout and its worker was replaced
+    bool hung{false};
+    int error{0};
+    struct statvfs buffer {};
+  };
+
+  /**
+   * Pool of detached threads calling statvfs(3), so that a hung
+   * mount only blocks one of the workers instead of the module
+   *
+   * Workers whose call outlives a query timeout no longer count
+   * against the limit, so a hung mount cannot starve the others
+   */
+  class fs_stat_pool {
+   public:
+    explicit fs_stat_pool(size_t max_workers);
+    ~fs_stat_pool();
+
+    map<string, fs_stat> query(const vector<string>& mountpoints, chrono::duration<double> timeout);
+
+   private:
+    struct shared_state {
+      std::mutex mtx;
+      std::condition_variable queued;
+      std::condition_variable finished;
+      std::deque<string> queue;
+      map<string, fs_stat> stats;
+      size_t workers{0};
+      size_t idle{0};
+      size_t hung{0};
+      size_t max_workers{0};
+      bool stopped{false};
+    };
+
+    void grow();
+    static void work(shared_ptr<shared_state> state);
+
+    // Outlives the pool, as workers stuck in statvfs cannot be joined
+    shared_ptr<shared_state> m_state;
+  };
+
   /**
    * Module used to display filesystem stats.
    */
@@ -37,34 +90,52 @@ namespace modules {
    public:
     explicit fs_module(const bar_settings&, string);
 
+    void sleep(chrono::duration<double> duration);
     bool update();
-    string get_format() const;
-    string get_output();
+    const char* get_format() const;
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
+   protected:
+    bool mountinfo_changed(int wait_ms);
+    void parse_mountinfo();
+
    private:
     static constexpr auto FORMAT_MOUNTED = "format-mounted";
     static constexpr auto FORMAT_UNMOUNTED = "format-unmounted";
+    static constexpr auto FORMAT_UNRESPONSIVE = "format-unresponsive";
     static constexpr auto TAG_LABEL_MOUNTED = "<label-mounted>";
     static constexpr auto TAG_LABEL_UNMOUNTED = "<label-unmounted>";
+    static constexpr auto TAG_LABEL_UNRESPONSIVE = "<label-unresponsive>";
     static constexpr auto TAG_BAR_USED = "<bar-used>";
     static constexpr auto TAG_BAR_FREE = "<bar-free>";
     static constexpr auto TAG_RAMP_CAPACITY = "<ramp-capacity>";
 
     label_t m_labelmounted;
     label_t m_labelunmounted;
+    label_t m_labelunresponsive;
     progressbar_t m_barused;
     progressbar_t m_barfree;
     ramp_t m_rampcapacity;
 
     vector<string> m_mountpoints;
     vector<fs_mount_t> m_mounts;
+
+    // type and fsname of the configured mountpoints that are mounted
+    procfs::mounts m_mounted;
+    unique_ptr<file_reader> m_mountinfo;
+    bool m_remount{true};
+
+    unique_ptr<fs_stat_pool> m_pool;
+    chrono::duration<double> m_timeout{1.0};
+
     bool m_fixed{false};
     bool m_remove_unmounted{false};
     int m_spacing{2};
 
     // used while formatting output
     size_t m_index{0_z};
+    string m_mountoutput;
   };
 }
 
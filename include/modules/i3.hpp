@@ -1,7 +1,9 @@
 #pragma once
 
 #include <i3ipc++/ipc.hpp>
+#include <set>
 
+#include "adapters/i3.hpp"
 #include "components/config.hpp"
 #include "modules/meta/event_module.hpp"
 #include "modules/meta/input_handler.hpp"
@@ -48,6 +50,7 @@ namespace modules {
     explicit i3_module(const bar_settings&, string);
 
     void stop();
+    void teardown();
     bool has_event();
     bool update();
     bool build(builder* builder, const string& tag) const;
@@ -55,6 +58,11 @@ namespace modules {
    protected:
     bool input(string&& cmd);
 
+    void query_workspaces(vector<i3::workspace>& workspaces);
+    void apply_event(const i3::workspace_event& event);
+    void resync();
+    unique_ptr<workspace> make_workspace(const i3::workspace& ws) const;
+
    private:
     static constexpr const char* DEFAULT_TAGS{"<label-state> <label-mode>"};
     static constexpr const char* DEFAULT_MODE{"default"};
@@ -71,6 +79,15 @@ namespace modules {
 
     map<state, label_t> m_statelabels;
     vector<unique_ptr<workspace>> m_workspaces;
+
+    /**
+     * Workspaces as last reported by i3, kept up to date by applying
+     * the workspace events. The names of changed workspaces are collected
+     * until their labels are rebuilt
+     */
+    vector<i3::workspace> m_model;
+    std::set<string> m_changed;
+    bool m_resync{true};
     iconset_t m_icons;
 
     label_t m_modelabel;
@@ -90,7 +107,20 @@ namespace modules {
     bool m_strip_wsnumbers{false};
     bool m_fuzzy_match{false};
 
-    unique_ptr<i3_util::connection_t> m_ipc;
+    string m_socketpath;
+
+    /**
+     * Connections shared with the other modules using the same socket
+     * and the queue of events received through it
+     */
+    shared_ptr<i3::ipc_source> m_source;
+    shared_ptr<i3::event_queue> m_events;
+
+    /**
+     * Reply to the last query, used by the module and the input thread
+     */
+    string m_reply;
+    std::mutex m_commandlock;
   };
 }
 
@@ -30,7 +30,7 @@ namespace modules {
 
     void start();
     void update() {}
-    string get_output();
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
     void on_message(const string& message);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "adapters/procfs.hpp"
 #include "modules/meta/timer_module.hpp"
 #include "settings.hpp"
 
@@ -22,6 +23,8 @@ namespace modules {
     static constexpr const char* TAG_RAMP_USED{"<ramp-used>"};
     static constexpr const char* TAG_RAMP_FREE{"<ramp-free>"};
 
+    shared_ptr<procfs::meminfo_provider> m_provider;
+
     label_t m_label;
     progressbar_t m_bar_memused;
     progressbar_t m_bar_memfree;
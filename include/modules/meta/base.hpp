@@ -9,6 +9,7 @@
 #include "common.hpp"
 #include "components/types.hpp"
 #include "errors.hpp"
+#include "utils/color.hpp"
 #include "utils/concurrency.hpp"
 #include "utils/functional.hpp"
 #include "utils/inotify.hpp"
@@ -64,10 +65,10 @@ namespace modules {
     vector<string> tags{};
     label_t prefix{};
     label_t suffix{};
-    string fg{};
-    string bg{};
-    string ul{};
-    string ol{};
+    argb fg{};
+    argb bg{};
+    argb ul{};
+    argb ol{};
     size_t ulsize{0};
     size_t olsize{0};
     size_t spacing{0};
@@ -75,7 +76,26 @@ namespace modules {
     size_t margin{0};
     int offset{0};
 
-    string decorate(builder* builder, string output);
+    /**
+     * Literal text preceding a format tag, also kept without its
+     * leading spaces for when no tag has been built before it
+     */
+    struct segment {
+      string text;
+      string trimmed;
+      string tag;
+    };
+
+    /**
+     * Segments parsed from the value, followed by the trailing
+     * text after the last tag
+     */
+    vector<segment> segments{};
+    string tail{};
+    string compiled{};
+
+    void decorate(builder* builder, string& output);
+    void compile();
   };
 
   // }}}
@@ -88,12 +108,12 @@ namespace modules {
     void add(string name, string fallback, vector<string>&& tags, vector<string>&& whitelist = {});
     bool has(const string& tag, const string& format_name);
     bool has(const string& tag);
-    shared_ptr<module_format> get(const string& format_name);
+    shared_ptr<module_format> get(const char* format_name);
 
    protected:
     const config& m_conf;
     string m_modname;
-    map<string, shared_ptr<module_format>> m_formats;
+    map<string, shared_ptr<module_format>, std::less<>> m_formats;
   };
 
   // }}}
@@ -110,7 +130,7 @@ namespace modules {
     virtual void start() = 0;
     virtual void stop() = 0;
     virtual void halt(string error_message) = 0;
-    virtual string contents() = 0;
+    virtual const string& contents() = 0;
   };
 
   // }}}
@@ -127,15 +147,15 @@ namespace modules {
     void stop();
     void halt(string error_message);
     void teardown();
-    string contents();
+    const string& contents();
 
    protected:
     void broadcast();
     void idle();
     void sleep(chrono::duration<double> duration);
     void wakeup();
-    string get_format() const;
-    string get_output();
+    const char* get_format() const;
+    void get_output(string& output);
 
    protected:
     signal_emitter& m_sig;
@@ -54,15 +54,16 @@ namespace modules {
     m_log.info("%s: Stopping", name());
     m_enabled = false;
 
-    std::lock(m_buildlock, m_updatelock);
-    std::lock_guard<std::mutex> guard_a(m_buildlock, std::adopt_lock);
-    std::lock_guard<std::mutex> guard_b(m_updatelock, std::adopt_lock);
     {
+      std::lock(m_buildlock, m_updatelock);
+      std::lock_guard<std::mutex> guard_a(m_buildlock, std::adopt_lock);
+      std::lock_guard<std::mutex> guard_b(m_updatelock, std::adopt_lock);
+
       CAST_MOD(Impl)->wakeup();
       CAST_MOD(Impl)->teardown();
-
-      m_sig.emit(signals::eventqueue::check_state{});
     }
+
+    m_sig.emit(signals::eventqueue::check_state{});
   }
 
   template <typename Impl>
@@ -76,10 +77,10 @@ namespace modules {
   void module<Impl>::teardown() {}
 
   template <typename Impl>
-  string module<Impl>::contents() {
+  const string& module<Impl>::contents() {
     if (m_changed) {
       m_log.info("%s: Rebuilding cache", name());
-      m_cache = CAST_MOD(Impl)->get_output();
+      CAST_MOD(Impl)->get_output(m_cache);
       m_changed = false;
     }
     return m_cache;
@@ -116,60 +117,41 @@ namespace modules {
   }
 
   template <typename Impl>
-  string module<Impl>::get_format() const {
+  const char* module<Impl>::get_format() const {
     return DEFAULT_FORMAT;
   }
 
   template <typename Impl>
-  string module<Impl>::get_output() {
+  void module<Impl>::get_output(string& output) {
     std::lock_guard<std::mutex> guard(m_buildlock);
     auto format_name = CONST_MOD(Impl).get_format();
     auto format = m_formatter->get(format_name);
     bool no_tag_built{true};
-    bool fake_no_tag_built{false};
     bool tag_built{false};
     auto mingap = std::max(1_z, format->spacing);
-    size_t start, end;
-    string value{format->value};
-    while ((start = value.find('<')) != string::npos && (end = value.find('>', start)) != string::npos) {
-      if (start > 0) {
-        if (no_tag_built) {
-          // If no module tag has been built we do not want to add
-          // whitespace defined between the format tags, but we do still
-          // want to output other non-tag content
-          auto trimmed = string_util::ltrim(value.substr(0, start), ' ');
-          if (!trimmed.empty()) {
-            fake_no_tag_built = false;
-            m_builder->node(move(trimmed));
-          }
-        } else {
-          m_builder->node(value.substr(0, start));
-        }
-        value.erase(0, start);
-        end -= start;
-        start = 0;
-      }
-      string tag{value.substr(start, end + 1)};
-      if (tag.empty()) {
-        continue;
-      } else if (tag[0] == '<' && tag[tag.size() - 1] == '>') {
-        if (!no_tag_built)
-          m_builder->space(format->spacing);
-        else if (fake_no_tag_built)
-          no_tag_built = false;
-        if (!(tag_built = CONST_MOD(Impl).build(m_builder.get(), tag)) && !no_tag_built)
-          m_builder->remove_trailing_space(mingap);
-        if (tag_built)
-          no_tag_built = false;
-      }
-      value.erase(0, tag.size());
+
+    format->compile();
+
+    for (auto&& segment : format->segments) {
+      // If no module tag has been built we do not want to add
+      // whitespace defined between the format tags, but we do still
+      // want to output other non-tag content
+      m_builder->node(no_tag_built ? segment.trimmed : segment.text);
+
+      if (!no_tag_built)
+        m_builder->space(format->spacing);
+      if (!(tag_built = CONST_MOD(Impl).build(m_builder.get(), segment.tag)) && !no_tag_built)
+        m_builder->remove_trailing_space(mingap);
+      if (tag_built)
+        no_tag_built = false;
     }
 
-    if (!value.empty()) {
-      m_builder->append(value);
+    if (!format->tail.empty()) {
+      m_builder->append(format->tail);
     }
 
-    return format->decorate(&*m_builder, m_builder->flush());
+    m_builder->flush(output);
+    format->decorate(&*m_builder, output);
   }
 
   // }}}
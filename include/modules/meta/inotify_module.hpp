@@ -1,7 +1,11 @@
 #pragma once
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "components/builder.hpp"
 #include "modules/meta/base.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -9,12 +13,29 @@ namespace modules {
   template <class Impl>
   class inotify_module : public module<Impl> {
    public:
-    using module<Impl>::module;
+    inotify_module(const bar_settings& bar, string name) : module<Impl>(bar, move(name)) {
+      int fds[2];
+      if (pipe2(fds, O_CLOEXEC) != 0) {
+        throw module_error("Failed to create wakeup pipe");
+      }
+      m_wakeupfd[PIPE_READ] = make_unique<file_descriptor>(fds[PIPE_READ]);
+      m_wakeupfd[PIPE_WRITE] = make_unique<file_descriptor>(fds[PIPE_WRITE]);
+    }
 
     void start() {
       this->m_mainthread = thread(&inotify_module::runner, this);
     }
 
+    /**
+     * Interrupt both the wait for events and idle()
+     */
+    void wakeup() {
+      if (write(*m_wakeupfd[PIPE_WRITE], "", 1) == -1) {
+        this->m_log.err("%s: Failed to wake up module thread", this->name());
+      }
+      module<Impl>::wakeup();
+    }
+
    protected:
     void runner() {
       this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
@@ -26,7 +47,6 @@ namespace modules {
         guard.unlock();
 
         while (this->running()) {
-          std::lock_guard<std::mutex> guard(this->m_updatelock);
           CAST_MOD(Impl)->poll_events();
         }
       } catch (const module_error& err) {
@@ -36,7 +56,8 @@ namespace modules {
       }
     }
 
-    void watch(string path, int mask = IN_ALL_EVENTS) {
+    // Events caused by reading the watched files are left out by default
+    void watch(string path, int mask = IN_ALL_EVENTS & ~(IN_ACCESS | IN_OPEN | IN_CLOSE_NOWRITE)) {
       this->m_log.trace("%s: Attach inotify at %s", this->name(), path);
       m_watchlist.insert(make_pair(path, mask));
     }
@@ -45,48 +66,70 @@ namespace modules {
       this->sleep(200ms);
     }
 
+    /**
+     * Wait for events on any of the watches, all queued
+     * events are handled by a single call to on_event()
+     *
+     * The watches stay attached between calls so that no events are lost
+     * while the module is idle, they are only attached again if one of
+     * them got removed by the kernel, e.g. because the file was deleted
+     */
     void poll_events() {
-      vector<unique_ptr<inotify_watch>> watches;
-
-      try {
-        for (auto&& w : m_watchlist) {
-          watches.emplace_back(inotify_util::make_watch(w.first));
-          watches.back()->attach(w.second);
+      if (!m_inotify) {
+        try {
+          m_inotify = factory_util::unique<inotify_instance>();
+          for (auto&& w : m_watchlist) {
+            m_inotify->attach(w.first, w.second);
+          }
+        } catch (const system_error& e) {
+          m_inotify.reset();
+          this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
+          CAST_MOD(Impl)->sleep(0.1s);
+          return;
         }
-      } catch (const system_error& e) {
-        watches.clear();
-        this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
-        CAST_MOD(Impl)->sleep(0.1s);
-        return;
       }
 
-      while (this->running()) {
-        for (auto&& w : watches) {
-          this->m_log.trace_x("%s: Poll inotify watch %s", this->name(), w->path());
+      struct pollfd fds[2]{};
+      fds[0].fd = m_inotify->get_file_descriptor();
+      fds[0].events = POLLIN;
+      fds[1].fd = *m_wakeupfd[PIPE_READ];
+      fds[1].events = POLLIN;
 
-          if (w->poll(1000 / watches.size())) {
-            auto event = w->get_event();
+      if (::poll(fds, 2, -1) <= 0) {
+        return;
+      }
 
-            for (auto&& w : watches) {
-              w->remove(true);
-            }
+      if (fds[1].revents & POLLIN) {
+        char buffer[16];
+        if (read(fds[1].fd, buffer, sizeof(buffer)) == -1) {
+          this->m_log.err("%s: Failed to read from wakeup pipe", this->name());
+        }
+      }
 
-            if (CAST_MOD(Impl)->on_event(event.get())) {
-              CAST_MOD(Impl)->broadcast();
-            }
-            CAST_MOD(Impl)->idle();
-            return;
-          }
+      if (!this->running() || !(fds[0].revents & POLLIN)) {
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(this->m_updatelock);
+        auto event = m_inotify->get_event();
+        this->m_log.trace_x("%s: inotify event mask %i", this->name(), event->mask);
 
-          if (!this->running())
-            break;
+        if (event->mask & IN_IGNORED) {
+          m_inotify.reset();
+        }
+        if (CAST_MOD(Impl)->on_event(event.get())) {
+          CAST_MOD(Impl)->broadcast();
         }
-        CAST_MOD(Impl)->idle();
       }
+
+      CAST_MOD(Impl)->idle();
     }
 
    private:
     map<string, int> m_watchlist;
+    unique_ptr<inotify_instance> m_inotify;
+    array<unique_ptr<file_descriptor>, 2> m_wakeupfd{};
   };
 }
 
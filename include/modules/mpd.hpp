@@ -18,15 +18,18 @@ namespace modules {
 
     void teardown();
     inline bool connected() const;
+    void take_state();
     void idle();
+    void wakeup();
     bool has_event();
     bool update();
-    string get_format() const;
-    string get_output();
+    const char* get_format() const;
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
     bool input(string&& cmd);
+    chrono::milliseconds next_tick() const;
 
    private:
     static constexpr const char* FORMAT_ONLINE{"format-online"};
@@ -73,10 +76,19 @@ namespace modules {
     static constexpr const char* EVENT_CONSUME{"mpdconsume"};
     static constexpr const char* EVENT_SEEK{"mpdseek"};
 
-    unique_ptr<mpdconnection> m_mpd;
+    /*
+     * Shared with the other modules showing the same server, the
+     * module is notified when the source published a new state
+     */
+    shared_ptr<mpdsource> m_source;
+    size_t m_subscription{0};
+    atomic<bool> m_changed{false};
+    shared_ptr<const mpdsource::state> m_state;
+    bool m_newstate{true};
 
     /*
-     * Stores the mpdstatus instance for the current connection
+     * Copy of the published status, of which the elapsed time
+     * is advanced locally while playing.
      * m_status is not initialized if mpd is not connect, you always have to
      * make sure that m_status is not NULL before dereferencing it
      */
@@ -86,11 +98,9 @@ namespace modules {
     string m_pass;
     unsigned int m_port{6600U};
 
-    chrono::system_clock::time_point m_lastsync{};
+    chrono::steady_clock::time_point m_nexttick{};
     float m_synctime{1.0f};
 
-    int m_quick_attempts{0};
-
     // This flag is used to let thru a broadcast once every time
     // the connection state changes
     connection_state m_statebroadcasted{connection_state::NONE};
@@ -101,8 +111,8 @@ namespace modules {
     label_t m_label_time;
     label_t m_label_offline;
 
-    string m_toggle_on_color;
-    string m_toggle_off_color;
+    argb m_toggle_on_color;
+    argb m_toggle_off_color;
   };
 }
 
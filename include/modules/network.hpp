@@ -1,6 +1,7 @@
 #pragma once
 
 #include "adapters/net.hpp"
+#include "adapters/probe.hpp"
 #include "components/config.hpp"
 #include "modules/meta/timer_module.hpp"
 
@@ -14,13 +15,11 @@ namespace modules {
     explicit network_module(const bar_settings&, string);
 
     void teardown();
+    void sleep(chrono::duration<double> duration);
     bool update();
-    string get_format() const;
+    const char* get_format() const;
     bool build(builder* builder, const string& tag) const;
 
-   protected:
-    void subthread_routine();
-
    private:
     static constexpr auto FORMAT_CONNECTED = "format-connected";
     static constexpr auto FORMAT_PACKETLOSS = "format-packetloss";
@@ -34,6 +33,7 @@ namespace modules {
 
     net::wired_t m_wired;
     net::wireless_t m_wireless;
+    unique_ptr<net::probe> m_probe;
 
     ramp_t m_ramp_signal;
     ramp_t m_ramp_quality;
@@ -46,6 +46,8 @@ namespace modules {
     int m_signal{0};
     int m_quality{0};
     int m_counter{-1};  // -1 to ignore the first run
+    string m_latency{"N/A"};
+    int m_loss{0};
 
     string m_interface;
     int m_ping_nth_update{0};
@@ -17,10 +17,12 @@ namespace modules {
     explicit pulseaudio_module(const bar_settings&, string);
 
     void teardown();
+    void idle();
+    void wakeup();
     bool has_event();
     bool update();
-    string get_format() const;
-    string get_output();
+    const char* get_format() const;
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
@@ -45,10 +47,16 @@ namespace modules {
     label_t m_label_volume;
     label_t m_label_muted;
 
+    /**
+     * Shared with the other modules showing the same sink
+     */
     pulseaudio_t m_pulseaudio;
+    size_t m_subscription{0};
+    bool m_max_volume{true};
 
     atomic<bool> m_muted{false};
     atomic<int> m_volume{0};
+    atomic<bool> m_sinkchanged{false};
   };
 }
 
@@ -15,7 +15,7 @@ namespace modules {
     void start();
     void stop();
 
-    string get_output();
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
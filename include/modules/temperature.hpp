@@ -1,9 +1,8 @@
 #pragma once
 
-#include <istream>
-
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -15,7 +14,7 @@ namespace modules {
     explicit temperature_module(const bar_settings&, string);
 
     bool update();
-    string get_format() const;
+    const char* get_format() const;
     bool build(builder* builder, const string& tag) const;
 
    private:
@@ -28,6 +27,7 @@ namespace modules {
     ramp_t m_ramp;
 
     string m_path;
+    unique_ptr<file_reader> m_reader;
     int m_zone = 0;
     int m_tempwarn = 0;
     int m_temp = 0;
@@ -10,8 +10,11 @@ namespace modules {
     explicit text_module(const bar_settings&, string);
 
     void update() {}
-    string get_format() const;
-    string get_output();
+    const char* get_format() const;
+    void get_output(string& output);
+
+   private:
+    vector<pair<mousebtn, string>> m_actions;
   };
 }
 
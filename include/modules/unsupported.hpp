@@ -26,9 +26,12 @@ namespace modules {
     void start() {}                                                                     \
     void stop() {}                                                                      \
     void halt(string) {}                                                                \
-    string contents() {                                                                 \
-      return "";                                                                        \
+    const string& contents() {                                                          \
+      return m_contents;                                                                \
     }                                                                                   \
+                                                                                        \
+   private:                                                                             \
+    string m_contents;                                                                  \
   }
 
 #if not ENABLE_I3
@@ -32,7 +32,7 @@ namespace modules {
     explicit xbacklight_module(const bar_settings& bar, string name_);
 
     void update();
-    string get_output();
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
@@ -11,17 +11,13 @@ POLYBAR_NS
 class connection;
 
 namespace modules {
-  class active_window {
-   public:
-    explicit active_window(xcb_connection_t* conn, xcb_window_t win);
-    ~active_window();
-
-    bool match(const xcb_window_t win) const;
-    string title() const;
-
-   private:
-    xcb_connection_t* m_connection{nullptr};
-    xcb_window_t m_window{XCB_NONE};
+  /**
+   * Cached title of a recently active window
+   */
+  struct window_title {
+    xcb_window_t window;
+    string title;
+    bool valid;
   };
 
   /**
@@ -37,17 +33,31 @@ namespace modules {
     };
     explicit xwindow_module(const bar_settings&, string);
 
-    void update(bool force = false);
+    void update();
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
     void handle(const evt::property_notify& evt);
 
+    window_title& track(xcb_window_t win);
+    vector<window_title>::iterator find(xcb_window_t win);
+    void refresh(xcb_window_t win);
+    string fetch_title(xcb_window_t win) const;
+
    private:
     static constexpr const char* TAG_LABEL{"<label>"};
+    static constexpr size_t MAX_CACHED_TITLES{16U};
 
     connection& m_connection;
-    unique_ptr<active_window> m_active;
+    xcb_window_t m_active{XCB_NONE};
+
+    /**
+     * Titles of the recently active windows, ordered by activation
+     * with the active window last
+     */
+    vector<window_title> m_titles;
+
     map<state, label_t> m_statelabels;
     label_t m_label;
   };
@@ -39,6 +39,14 @@ namespace modules {
     label_t label;
   };
 
+  /**
+   * Cached state of a managed client window
+   */
+  struct client {
+    unsigned int desktop;
+    bool urgent;
+  };
+
   struct viewport {
     position pos;
     string name;
@@ -57,16 +65,15 @@ namespace modules {
     explicit xworkspaces_module(const bar_settings& bar, string name_);
 
     void update();
-    string get_output();
+    void get_output(string& output);
     bool build(builder* builder, const string& tag) const;
 
    protected:
     void handle(const evt::property_notify& evt);
 
-    void rebuild_clientlist();
-    void rebuild_desktops();
+    void rebuild_clientlist(const vector<xcb_window_t>& windows);
+    void rebuild_desktops(vector<position>&& bounds);
     void rebuild_desktop_states();
-    void set_desktop_urgent(xcb_window_t window);
 
     bool input(string&& cmd);
 
@@ -92,7 +99,7 @@ namespace modules {
     vector<string> m_desktop_names;
     unsigned int m_current_desktop;
 
-    vector<xcb_window_t> m_clientlist;
+    map<xcb_window_t, client> m_clients;
     vector<unique_ptr<viewport>> m_viewports;
     map<desktop_state, label_t> m_labels;
     label_t m_monitorlabel;
@@ -101,6 +108,7 @@ namespace modules {
     bool m_click{true};
     bool m_scroll{true};
     size_t m_index{0};
+    string m_viewportoutput;
 
     event_timer m_timer{0L, 25L};
   };
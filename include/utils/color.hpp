@@ -1,17 +1,35 @@
 #pragma once
 
-#include <cstdlib>
+#include <cstdio>
 
 #include "common.hpp"
-#include "utils/cache.hpp"
 
 POLYBAR_NS
 
-static cache<string, unsigned int> g_cache_hex;
-static cache<unsigned int, string> g_cache_colors;
-
 struct rgba;
 
+/**
+ * Packed 0xAARRGGBB color resolved from its hex string
+ * when the configuration is loaded
+ *
+ * Alpha-only values (#aa) keep the rgb channels of the
+ * default color they are drawn with
+ */
+struct argb {
+  enum class type { NONE = 0, ARGB, ALPHA };
+
+  unsigned int value{0U};
+  type kind{type::NONE};
+
+  unsigned int resolve(unsigned int base) const {
+    return kind == type::ALPHA ? (value & 0xFF000000) | (base & 0x00FFFFFF) : value;
+  }
+
+  explicit operator bool() const {
+    return kind != type::NONE;
+  }
+};
+
 namespace color_util {
   template <typename T = unsigned char>
   T alpha_channel(const unsigned int value) {
@@ -60,23 +78,21 @@ namespace color_util {
 
   template <typename T>
   string hex(unsigned int color) {
-    return *g_cache_hex.object(color, [&] {
-      char s[12];
-      size_t len = 0;
-
-      unsigned char a = alpha_channel<T>(color);
-      unsigned char r = red_channel<T>(color);
-      unsigned char g = green_channel<T>(color);
-      unsigned char b = blue_channel<T>(color);
-
-      if (std::is_same<T, unsigned short int>::value) {
-        len = snprintf(s, sizeof(s), "#%02x%02x%02x%02x", a, r, g, b);
-      } else if (std::is_same<T, unsigned char>::value) {
-        len = snprintf(s, sizeof(s), "#%02x%02x%02x", r, g, b);
-      }
+    char s[12];
+    size_t len = 0;
 
-      return string(s, len);
-    }());
+    unsigned char a = alpha_channel<T>(color);
+    unsigned char r = red_channel<T>(color);
+    unsigned char g = green_channel<T>(color);
+    unsigned char b = blue_channel<T>(color);
+
+    if (std::is_same<T, unsigned short int>::value) {
+      len = snprintf(s, sizeof(s), "#%02x%02x%02x%02x", a, r, g, b);
+    } else if (std::is_same<T, unsigned char>::value) {
+      len = snprintf(s, sizeof(s), "#%02x%02x%02x", r, g, b);
+    }
+
+    return string(s, len);
   }
 
   inline string parse_hex(string hex) {
@@ -91,10 +107,67 @@ namespace color_util {
     return hex;
   }
 
-  inline unsigned int parse(string hex, unsigned int fallback = 0) {
-    if ((hex = parse_hex(hex)).empty())
-      return fallback;
-    return std::strtoul(&hex[1], nullptr, 16);
+  inline int hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  /**
+   * Parse #rgb, #rrggbb or #aarrggbb without building
+   * any intermediate strings
+   */
+  inline bool try_parse(const string& hex, unsigned int& value) {
+    size_t pos{!hex.empty() && hex[0] == '#' ? 1U : 0U};
+    size_t len{hex.size() - pos};
+
+    if (len != 3 && len != 6 && len != 8)
+      return false;
+
+    unsigned int result{len == 8 ? 0U : 0xFFU};
+    for (; pos < hex.size(); pos++) {
+      int digit{hex_digit(hex[pos])};
+      if (digit == -1)
+        return false;
+      else if (len == 3)
+        result = result << 8 | digit * 0x11;
+      else
+        result = result << 4 | digit;
+    }
+
+    value = result;
+    return true;
+  }
+
+  inline unsigned int parse(const string& hex, unsigned int fallback = 0) {
+    unsigned int value{fallback};
+    try_parse(hex, value);
+    return value;
+  }
+
+  /**
+   * Parse a configured color, including the alpha-only form #aa
+   */
+  inline argb parse_argb(const string& hex) {
+    argb color{};
+    size_t pos{!hex.empty() && hex[0] == '#' ? 1U : 0U};
+
+    if (hex.size() - pos == 2) {
+      int hi{hex_digit(hex[pos])};
+      int lo{hex_digit(hex[pos + 1])};
+      if (hi != -1 && lo != -1) {
+        color.value = static_cast<unsigned int>(hi << 4 | lo) << 24;
+        color.kind = argb::type::ALPHA;
+      }
+    } else if (try_parse(hex, color.value)) {
+      color.kind = argb::type::ARGB;
+    }
+
+    return color;
   }
 
   inline string simplify_hex(string hex) {
@@ -112,6 +185,32 @@ namespace color_util {
 
     return hex;
   }
+
+  /**
+   * Get the shortest hex string for a packed color, i.e:
+   * #rgb, #rrggbb or #aarrggbb
+   */
+  inline string simplify_hex(unsigned int color) {
+    const char* digits{"0123456789abcdef"};
+    char s[9]{'#'};
+    size_t len{1};
+
+    if (color >> 24 != 0xFF) {
+      for (int shift = 28; shift >= 0; shift -= 4) {
+        s[len++] = digits[color >> shift & 0xF];
+      }
+    } else if ((color >> 4 & 0x0F0F0F) == (color & 0x0F0F0F)) {
+      for (int shift = 16; shift >= 0; shift -= 8) {
+        s[len++] = digits[color >> shift & 0xF];
+      }
+    } else {
+      for (int shift = 20; shift >= 0; shift -= 4) {
+        s[len++] = digits[color >> shift & 0xF];
+      }
+    }
+
+    return string(s, len);
+  }
 }
 
 struct rgb {
@@ -100,6 +100,40 @@ class fd_stream : public StreamType {
   fd_streambuf m_buf;
 };
 
+/**
+ * Reader for procfs and sysfs files that are read repeatedly
+ *
+ * The descriptor is kept open and each read is a single pread(2) from
+ * offset 0 into a reused buffer, so values can be parsed in place
+ * without allocating
+ *
+ * Constructing a reader never throws. A file that can't be opened makes
+ * read() fail until it can be opened again, so readers can be created for
+ * files that come and go with a device. Callers that require the file
+ * have to check that it exists first
+ */
+class file_reader {
+ public:
+  explicit file_reader(string path);
+
+  bool read();
+  long long integer();
+
+  const char* data() const;
+  size_t size() const;
+
+  explicit operator int();
+  operator int() const;
+
+ private:
+  enum { bufsize = 4096 };
+
+  const string m_path;
+  file_descriptor m_fd;
+  vector<char> m_buffer;
+  size_t m_size{0};
+};
+
 namespace file_util {
   bool exists(const string& filename);
   string pick(const vector<string>& filenames);
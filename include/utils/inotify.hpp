@@ -3,6 +3,7 @@
 #include <poll.h>
 #include <sys/inotify.h>
 #include <cstdio>
+#include <map>
 
 #include "common.hpp"
 #include "utils/factory.hpp"
@@ -37,6 +38,29 @@ class inotify_watch {
   int m_mask{0};
 };
 
+/**
+ * Inotify instance with any number of watches attached
+ *
+ * The descriptor is non-blocking, `get_event` drains all queued
+ * events and merges them into a single event
+ */
+class inotify_instance {
+ public:
+  explicit inotify_instance();
+  ~inotify_instance();
+
+  inotify_instance(const inotify_instance& o) = delete;
+  inotify_instance& operator=(const inotify_instance& o) = delete;
+
+  void attach(const string& path, int mask = IN_MODIFY);
+  unique_ptr<inotify_event> get_event() const;
+  int get_file_descriptor() const;
+
+ protected:
+  int m_fd{-1};
+  std::map<int, string> m_watches;
+};
+
 namespace inotify_util {
   template <typename... Args>
   decltype(auto) make_watch(Args&&... args) {
@@ -21,6 +21,7 @@ namespace socket_util {
 
     string receive(const ssize_t receive_bytes, int flags = 0);
     string receive(const ssize_t receive_bytes, ssize_t* bytes_received, int flags = 0);
+    bool receive_available(string& buffer);
 
     bool peek(const size_t peek_bytes);
     bool poll(short int events = POLLIN, int timeout_ms = -1);
@@ -40,7 +41,7 @@ namespace socket_util {
    *   conn->receive(...);
    * @endcode
    */
-  auto make_unix_connection = [](string&& path) -> unique_ptr<unix_connection> {
+  const auto make_unix_connection = [](string&& path) -> unique_ptr<unix_connection> {
     return factory_util::unique<unix_connection>(forward<string>(path));
   };
 }
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <poll.h>
+#include <map>
+
+#include "common.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Kernel device event, e.g. "change@/devices/.../power_supply/BAT0"
+ */
+struct uevent {
+  string action;
+  string devpath;
+  std::map<string, string> properties;
+
+  string property(const string& key) const;
+};
+
+/**
+ * Listener for the kernel uevents of a single subsystem
+ */
+class uevent_monitor {
+ public:
+  explicit uevent_monitor(string subsystem);
+  explicit uevent_monitor(string subsystem, int fd);
+  ~uevent_monitor();
+
+  bool poll(int wait_ms = 1000) const;
+  unique_ptr<uevent> get_event() const;
+  int get_file_descriptor() const;
+
+ protected:
+  string m_subsystem;
+  int m_fd{-1};
+};
+
+namespace uevent_util {
+  unique_ptr<uevent> parse(const char* data, size_t len);
+
+  template <typename... Args>
+  decltype(auto) make_monitor(Args&&... args) {
+    return factory_util::unique<uevent_monitor>(forward<Args>(args)...);
+  }
+}
+
+POLYBAR_NS_END
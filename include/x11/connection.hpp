@@ -2,6 +2,8 @@
 
 #include <xcb/xcb.h>
 #include <cstdlib>
+#include <map>
+#include <mutex>
 #include <xpp/core.hpp>
 #include <xpp/generic/factory.hpp>
 #include <xpp/proto/x.hpp>
@@ -119,7 +121,8 @@ class connection : public detail::connection_base<connection&, XPP_EXTENSION_LIS
   string id(xcb_window_t w) const;
 
   void ensure_event_mask(xcb_window_t win, unsigned int event);
-  void clear_event_mask(xcb_window_t win);
+  void ensure_event_mask(const vector<xcb_window_t>& windows, unsigned int event);
+  void release_event_mask(const vector<xcb_window_t>& windows, unsigned int event);
 
   shared_ptr<xcb_client_message_event_t> make_client_message(xcb_atom_t type, xcb_window_t target) const;
   void send_client_message(const shared_ptr<xcb_client_message_event_t>& message, xcb_window_t target,
@@ -154,19 +157,33 @@ class connection : public detail::connection_base<connection&, XPP_EXTENSION_LIS
     }
   }
 
+  /**
+   * Sinks may be attached and detached from other threads than the one
+   * dispatching events, e.g. when modules are replaced on reload
+   */
   template <typename Sink>
   void attach_sink(Sink&& sink, registry::priority prio = 0) {
+    std::lock_guard<std::recursive_mutex> guard(m_registry_mutex);
     m_registry.attach(prio, forward<Sink>(sink));
   }
 
   template <typename Sink>
   void detach_sink(Sink&& sink, registry::priority prio = 0) {
+    std::lock_guard<std::recursive_mutex> guard(m_registry_mutex);
     m_registry.detach(prio, forward<Sink>(sink));
   }
 
  protected:
   registry m_registry{*this};
+  mutable std::recursive_mutex m_registry_mutex;
   xcb_screen_t* m_screen{nullptr};
+
+  /**
+   * Number of times each event was selected on a window, the
+   * event is deselected once all selections were released
+   */
+  std::map<pair<xcb_window_t, unsigned int>, size_t> m_eventmasks;
+  std::mutex m_eventmasks_mutex;
 };
 
 POLYBAR_NS_END
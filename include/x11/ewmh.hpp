@@ -17,7 +17,9 @@ namespace ewmh_util {
   bool supports(xcb_atom_t atom, int screen = 0);
 
   string get_wm_name(xcb_window_t win);
+  string get_wm_name(xcb_get_property_cookie_t cookie);
   string get_visible_name(xcb_window_t win);
+  string get_visible_name(xcb_get_property_cookie_t cookie);
   string get_icon_name(xcb_window_t win);
   string get_reply_string(xcb_ewmh_get_utf8_strings_reply_t* reply);
 
@@ -41,6 +43,16 @@ namespace ewmh_util {
   void set_wm_window_opacity(xcb_window_t win, unsigned long int values);
 
   vector<xcb_window_t> get_client_list(int screen = 0);
+
+  /**
+   * Collect the replies of requests sent earlier, so that several
+   * queries can be answered within a single round trip
+   */
+  vector<position> get_desktop_viewports(xcb_get_property_cookie_t cookie);
+  vector<string> get_desktop_names(xcb_get_property_cookie_t cookie);
+  unsigned int get_current_desktop(xcb_get_property_cookie_t cookie);
+  unsigned int get_desktop_from_window(xcb_get_property_cookie_t cookie);
+  vector<xcb_window_t> get_client_list(xcb_get_property_cookie_t cookie);
 }
 
 POLYBAR_NS_END
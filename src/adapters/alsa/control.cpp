@@ -48,6 +48,8 @@ namespace alsa {
     if ((err = snd_ctl_subscribe_events(m_ctl, 1)) == -1) {
       throw control_error("Could not subscribe to events: " + to_string(snd_ctl_elem_id_get_numid(m_id)));
     }
+
+    m_plugged = read_plugged();
   }
 
   /**
@@ -67,35 +69,63 @@ namespace alsa {
   }
 
   /**
-   * Wait for events
+   * Add the descriptors that become readable on control events
    */
-  bool control::wait(int timeout) {
+  void control::get_poll_descriptors(vector<pollfd>& fds) {
     assert(m_ctl);
 
-    int err{0};
+    int count = snd_ctl_poll_descriptors_count(m_ctl);
+    if (count < 0) {
+      throw_exception<control_error>("Failed to get poll descriptors", count);
+    }
+
+    auto offset = fds.size();
+    fds.resize(offset + count);
 
-    if ((err = snd_ctl_wait(m_ctl, timeout)) == -1) {
-      throw_exception<control_error>("Failed to wait for events", err);
+    if ((count = snd_ctl_poll_descriptors(m_ctl, fds.data() + offset, count)) < 0) {
+      throw_exception<control_error>("Failed to get poll descriptors", count);
     }
 
+    fds.resize(offset + count);
+  }
+
+  /**
+   * Check if the interface is in use
+   */
+  bool control::test_device_plugged() {
+    return m_plugged;
+  }
+
+  /**
+   * Read all queued events, returns true if the plugged state changed
+   */
+  bool control::process_events() {
+    assert(m_ctl);
+
     snd_ctl_event_t* event{nullptr};
     snd_ctl_event_alloca(&event);
 
-    if ((err = snd_ctl_read(m_ctl, event)) == -1) {
-      return false;
+    bool changed{false};
+
+    // The control is opened in non-blocking mode
+    while (snd_ctl_read(m_ctl, event) > 0) {
+      if (snd_ctl_event_get_type(event) == SND_CTL_EVENT_ELEM &&
+          snd_ctl_event_elem_get_numid(event) == static_cast<unsigned int>(m_numid) &&
+          snd_ctl_event_elem_get_mask(event) & SND_CTL_EVENT_MASK_VALUE) {
+        changed = true;
+      }
     }
 
-    if (snd_ctl_event_get_type(event) == SND_CTL_EVENT_ELEM) {
-      return snd_ctl_event_elem_get_mask(event) & SND_CTL_EVENT_MASK_VALUE;
+    if (!changed) {
+      return false;
     }
 
-    return false;
+    auto plugged = m_plugged;
+    m_plugged = read_plugged();
+    return plugged != m_plugged;
   }
 
-  /**
-   * Check if the interface is in use
-   */
-  bool control::test_device_plugged() {
+  bool control::read_plugged() {
     assert(m_elem);
 
     snd_ctl_elem_value_t* m_value{nullptr};
@@ -109,13 +139,6 @@ namespace alsa {
 
     return snd_ctl_elem_value_get_boolean(m_value, 0);
   }
-
-  /**
-   * Process queued events
-   */
-  void control::process_events() {
-    wait(0);
-  }
 }
 
 POLYBAR_NS_END
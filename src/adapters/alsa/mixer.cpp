@@ -40,6 +40,12 @@ namespace alsa {
     if ((m_elem = snd_mixer_find_selem(m_mixer, sid)) == nullptr) {
       throw mixer_error("Cannot find simple element");
     }
+
+    snd_mixer_elem_set_callback(m_elem, &mixer::elem_callback);
+    snd_mixer_elem_set_callback_private(m_elem, this);
+
+    load_ranges();
+    refresh();
   }
 
   /**
@@ -66,83 +72,57 @@ namespace alsa {
   }
 
   /**
-   * Wait for events
+   * Add the descriptors that become readable on mixer events
    */
-  bool mixer::wait(int timeout) {
+  void mixer::get_poll_descriptors(vector<pollfd>& fds) {
     assert(m_mixer);
 
-    int err = 0;
+    int count = snd_mixer_poll_descriptors_count(m_mixer);
+    if (count < 0) {
+      throw_exception<mixer_error>("Failed to get poll descriptors", count);
+    }
+
+    auto offset = fds.size();
+    fds.resize(offset + count);
 
-    if ((err = snd_mixer_wait(m_mixer, timeout)) == -1) {
-      throw_exception<mixer_error>("Failed to wait for events", err);
+    if ((count = snd_mixer_poll_descriptors(m_mixer, fds.data() + offset, count)) < 0) {
+      throw_exception<mixer_error>("Failed to get poll descriptors", count);
     }
 
-    return process_events() > 0;
+    fds.resize(offset + count);
   }
 
   /**
-   * Process queued mixer events
+   * Process queued mixer events, returns true if
+   * the value of the element was changed
    */
-  int mixer::process_events() {
-    int num_events{0};
-    if ((num_events = snd_mixer_handle_events(m_mixer)) == -1) {
-      throw_exception<mixer_error>("Failed to process pending events", num_events);
+  bool mixer::process_events() {
+    int err{0};
+    if ((err = snd_mixer_handle_events(m_mixer)) < 0) {
+      throw_exception<mixer_error>("Failed to process pending events", err);
     }
 
-    return num_events;
+    if (!m_changed) {
+      return false;
+    }
+
+    m_changed = false;
+    refresh();
+    return true;
   }
 
   /**
    * Get volume in percentage
    */
   int mixer::get_volume() {
-    assert(m_elem != nullptr);
-
-    long chan_n = 0, vol_total = 0, vol, vol_min, vol_max;
-
-    snd_mixer_selem_get_playback_volume_range(m_elem, &vol_min, &vol_max);
-
-    for (int i = 0; i <= SND_MIXER_SCHN_LAST; i++) {
-      if (snd_mixer_selem_has_playback_channel(m_elem, static_cast<snd_mixer_selem_channel_id_t>(i))) {
-        snd_mixer_selem_get_playback_volume(m_elem, static_cast<snd_mixer_selem_channel_id_t>(i), &vol);
-        vol_total += vol;
-        chan_n++;
-      }
-    }
-
-    return math_util::percentage(vol_total / chan_n, vol_min, vol_max);
+    return m_volume;
   }
 
   /**
    * Get normalized volume in percentage
    */
   int mixer::get_normalized_volume() {
-    assert(m_elem != nullptr);
-
-    long chan_n = 0, vol_total = 0, vol, vol_min, vol_max;
-    double normalized, min_norm;
-
-    snd_mixer_selem_get_playback_dB_range(m_elem, &vol_min, &vol_max);
-
-    for (int i = 0; i <= SND_MIXER_SCHN_LAST; i++) {
-      if (snd_mixer_selem_has_playback_channel(m_elem, static_cast<snd_mixer_selem_channel_id_t>(i))) {
-        snd_mixer_selem_get_playback_dB(m_elem, static_cast<snd_mixer_selem_channel_id_t>(i), &vol);
-        vol_total += vol;
-        chan_n++;
-      }
-    }
-
-    if (vol_max - vol_min <= MAX_LINEAR_DB_SCALE * 100) {
-      return math_util::percentage(vol_total / chan_n, vol_min, vol_max);
-    }
-
-    normalized = pow(10, (vol_total / chan_n - vol_max) / 6000.0);
-    if (vol_min != SND_CTL_TLV_DB_GAIN_MUTE) {
-      min_norm = pow(10, (vol_min - vol_max) / 6000.0);
-      normalized = (normalized - min_norm) / (1 - min_norm);
-    }
-
-    return 100.0f * normalized + 0.5f;
+    return m_normalized_volume;
   }
 
   /**
@@ -155,9 +135,9 @@ namespace alsa {
       return;
     }
 
-    long vol_min, vol_max;
-    snd_mixer_selem_get_playback_volume_range(m_elem, &vol_min, &vol_max);
-    snd_mixer_selem_set_playback_volume_all(m_elem, math_util::percentage_to_value<int>(percentage, vol_min, vol_max));
+    snd_mixer_selem_set_playback_volume_all(
+        m_elem, math_util::percentage_to_value<int>(percentage, m_volume_min, m_volume_max));
+    refresh();
   }
 
   /**
@@ -170,23 +150,22 @@ namespace alsa {
       return;
     }
 
-    long vol_min, vol_max;
     double min_norm;
     percentage = percentage / 100.0f;
 
-    snd_mixer_selem_get_playback_dB_range(m_elem, &vol_min, &vol_max);
-
-    if (vol_max - vol_min <= MAX_LINEAR_DB_SCALE * 100) {
-      snd_mixer_selem_set_playback_dB_all(m_elem, lrint(percentage * (vol_max - vol_min)) + vol_min, 0);
+    if (m_db_max - m_db_min <= MAX_LINEAR_DB_SCALE * 100) {
+      snd_mixer_selem_set_playback_dB_all(m_elem, lrint(percentage * (m_db_max - m_db_min)) + m_db_min, 0);
+      refresh();
       return;
     }
 
-    if (vol_min != SND_CTL_TLV_DB_GAIN_MUTE) {
-      min_norm = pow(10, (vol_min - vol_max) / 6000.0);
+    if (m_db_min != SND_CTL_TLV_DB_GAIN_MUTE) {
+      min_norm = pow(10, (m_db_min - m_db_max) / 6000.0);
       percentage = percentage * (1 - min_norm) + min_norm;
     }
 
-    snd_mixer_selem_set_playback_dB_all(m_elem, lrint(6000.0 * log10(percentage)) + vol_max, 0);
+    snd_mixer_selem_set_playback_dB_all(m_elem, lrint(6000.0 * log10(percentage)) + m_db_max, 0);
+    refresh();
   }
 
   /**
@@ -196,6 +175,7 @@ namespace alsa {
     assert(m_elem != nullptr);
 
     snd_mixer_selem_set_playback_switch_all(m_elem, mode);
+    refresh();
   }
 
   /**
@@ -208,24 +188,100 @@ namespace alsa {
 
     snd_mixer_selem_get_playback_switch(m_elem, SND_MIXER_SCHN_MONO, &state);
     snd_mixer_selem_set_playback_switch_all(m_elem, !state);
+    refresh();
   }
 
   /**
    * Get current mute state
    */
   bool mixer::is_muted() {
-    assert(m_elem != nullptr);
+    return m_muted;
+  }
 
-    int state = 0;
+  /**
+   * Called by alsa-lib while handling events of the element
+   */
+  int mixer::elem_callback(snd_mixer_elem_t* elem, unsigned int mask) {
+    auto* This = static_cast<mixer*>(snd_mixer_elem_get_callback_private(elem));
+
+    if (mask == SND_CTL_EVENT_MASK_REMOVE) {
+      return 0;
+    }
+    if (mask & SND_CTL_EVENT_MASK_INFO) {
+      This->load_ranges();
+    }
+    if (mask & (SND_CTL_EVENT_MASK_VALUE | SND_CTL_EVENT_MASK_INFO)) {
+      This->m_changed = true;
+    }
+
+    return 0;
+  }
+
+  /**
+   * Look up the playback channels and the volume ranges of the element
+   */
+  void mixer::load_ranges() {
+    m_channels.clear();
 
     for (int i = 0; i <= SND_MIXER_SCHN_LAST; i++) {
       if (snd_mixer_selem_has_playback_channel(m_elem, static_cast<snd_mixer_selem_channel_id_t>(i))) {
-        int state_ = 0;
-        snd_mixer_selem_get_playback_switch(m_elem, static_cast<snd_mixer_selem_channel_id_t>(i), &state_);
-        state = state || state_;
+        m_channels.emplace_back(i);
       }
     }
-    return !state;
+
+    if (snd_mixer_selem_get_playback_volume_range(m_elem, &m_volume_min, &m_volume_max) < 0) {
+      m_volume_min = m_volume_max = 0;
+    }
+    if (snd_mixer_selem_get_playback_dB_range(m_elem, &m_db_min, &m_db_max) < 0) {
+      m_db_min = m_db_max = 0;
+    }
+  }
+
+  /**
+   * Read the volume and mute state of all playback channels
+   */
+  void mixer::refresh() {
+    long vol_total = 0, db_total = 0, vol;
+    int state = 0;
+
+    for (auto&& i : m_channels) {
+      auto channel = static_cast<snd_mixer_selem_channel_id_t>(i);
+      int state_ = 0;
+
+      snd_mixer_selem_get_playback_volume(m_elem, channel, &vol);
+      vol_total += vol;
+      snd_mixer_selem_get_playback_dB(m_elem, channel, &vol);
+      db_total += vol;
+      snd_mixer_selem_get_playback_switch(m_elem, channel, &state_);
+      state = state || state_;
+    }
+
+    m_muted = !state;
+
+    if (m_channels.empty()) {
+      m_volume = m_normalized_volume = 0;
+      return;
+    }
+
+    long chan_n = m_channels.size();
+    m_volume = m_volume_max > m_volume_min ? math_util::percentage(vol_total / chan_n, m_volume_min, m_volume_max) : 0;
+
+    // Elements without dB information fall back to the raw volume
+    if (m_db_max <= m_db_min) {
+      m_normalized_volume = m_volume;
+      return;
+    } else if (m_db_max - m_db_min <= MAX_LINEAR_DB_SCALE * 100) {
+      m_normalized_volume = math_util::percentage(db_total / chan_n, m_db_min, m_db_max);
+      return;
+    }
+
+    double normalized = pow(10, (db_total / chan_n - m_db_max) / 6000.0);
+    if (m_db_min != SND_CTL_TLV_DB_GAIN_MUTE) {
+      double min_norm = pow(10, (m_db_min - m_db_max) / 6000.0);
+      normalized = (normalized - min_norm) / (1 - min_norm);
+    }
+
+    m_normalized_volume = 100.0f * normalized + 0.5f;
   }
 }
 
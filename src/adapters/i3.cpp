@@ -0,0 +1,676 @@
+#include "adapters/i3.hpp"
+
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "components/logger.hpp"
+
+POLYBAR_NS
+
+namespace i3 {
+  namespace {
+    constexpr char MAGIC[] = "i3-ipc";
+    constexpr size_t MAGIC_LEN = sizeof(MAGIC) - 1;
+
+    // class : json_cursor {{{
+
+    /**
+     * Cursor over a JSON document that decodes values on demand
+     * and skips everything else without allocating
+     */
+    class json_cursor {
+     public:
+      explicit json_cursor(const string& json) : m_pos(json.c_str()), m_end(json.c_str() + json.size()) {}
+
+      /**
+       * Consume the given character if it is next
+       */
+      bool consume(char c) {
+        whitespace();
+        if (m_pos < m_end && *m_pos == c) {
+          m_pos++;
+          return true;
+        }
+        return false;
+      }
+
+      bool null() {
+        whitespace();
+        if (m_end - m_pos >= 4 && strncmp(m_pos, "null", 4) == 0) {
+          m_pos += 4;
+          return true;
+        }
+        return false;
+      }
+
+      bool boolean(bool& value) {
+        whitespace();
+        if (m_end - m_pos >= 4 && strncmp(m_pos, "true", 4) == 0) {
+          m_pos += 4;
+          value = true;
+        } else if (m_end - m_pos >= 5 && strncmp(m_pos, "false", 5) == 0) {
+          m_pos += 5;
+          value = false;
+        } else {
+          return false;
+        }
+        return true;
+      }
+
+      bool integer(int& value) {
+        whitespace();
+        char* end{nullptr};
+        auto result = strtol(m_pos, &end, 10);
+        if (end == m_pos || end > m_end) {
+          return false;
+        }
+        value = static_cast<int>(result);
+        m_pos = end;
+        // Fractions and exponents are not used by i3 for integers
+        return true;
+      }
+
+      /**
+       * Decode a string, reusing the storage of the given one
+       */
+      bool text(string& value) {
+        if (!consume('"')) {
+          return false;
+        }
+
+        value.clear();
+
+        while (m_pos < m_end) {
+          // Copy runs without escapes at once
+          auto run = m_pos;
+          while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\') {
+            m_pos++;
+          }
+          value.append(run, m_pos);
+
+          if (m_pos == m_end) {
+            return false;
+          }
+
+          auto c = *m_pos++;
+
+          if (c == '"') {
+            return true;
+          } else if (m_pos == m_end) {
+            return false;
+          } else {
+            switch (c = *m_pos++) {
+              case 'b':
+                value += '\b';
+                break;
+              case 'f':
+                value += '\f';
+                break;
+              case 'n':
+                value += '\n';
+                break;
+              case 'r':
+                value += '\r';
+                break;
+              case 't':
+                value += '\t';
+                break;
+              case 'u':
+                if (!codepoint(value)) {
+                  return false;
+                }
+                break;
+              default:
+                value += c;
+                break;
+            }
+          }
+        }
+
+        return false;
+      }
+
+      /**
+       * Skip the next value of any type
+       */
+      bool skip() {
+        whitespace();
+
+        if (m_pos == m_end) {
+          return false;
+        } else if (*m_pos == '"') {
+          return skip_string();
+        } else if (*m_pos != '{' && *m_pos != '[') {
+          auto begin = m_pos;
+          while (m_pos < m_end && strchr(",:}] \t\r\n", *m_pos) == nullptr) {
+            m_pos++;
+          }
+          return m_pos != begin;
+        }
+
+        size_t depth{0};
+
+        while (m_pos < m_end) {
+          auto c = *m_pos;
+
+          if (c == '"') {
+            if (!skip_string()) {
+              return false;
+            }
+            continue;
+          } else if (c == '{' || c == '[') {
+            depth++;
+          } else if ((c == '}' || c == ']') && --depth == 0) {
+            m_pos++;
+            return true;
+          }
+
+          m_pos++;
+        }
+
+        return false;
+      }
+
+      /**
+       * Iterate the members of an object, the callback gets the key
+       * and has to consume the value
+       */
+      template <typename Callback>
+      bool object(Callback&& callback) {
+        if (!consume('{')) {
+          return false;
+        } else if (consume('}')) {
+          return true;
+        }
+
+        do {
+          if (!text(m_key) || !consume(':') || !callback(m_key)) {
+            return false;
+          }
+        } while (consume(','));
+
+        return consume('}');
+      }
+
+      /**
+       * Iterate the elements of an array, the callback has to consume them
+       */
+      template <typename Callback>
+      bool array(Callback&& callback) {
+        if (!consume('[')) {
+          return false;
+        } else if (consume(']')) {
+          return true;
+        }
+
+        do {
+          if (!callback()) {
+            return false;
+          }
+        } while (consume(','));
+
+        return consume(']');
+      }
+
+      bool finished() {
+        whitespace();
+        return m_pos == m_end;
+      }
+
+     protected:
+      void whitespace() {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n')) {
+          m_pos++;
+        }
+      }
+
+      bool skip_string() {
+        for (m_pos++; m_pos < m_end; m_pos++) {
+          if (*m_pos == '\\') {
+            m_pos++;
+          } else if (*m_pos == '"') {
+            m_pos++;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      bool hex(unsigned int& value) {
+        if (m_end - m_pos < 4) {
+          return false;
+        }
+
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+          auto c = *m_pos++;
+          value <<= 4;
+          if (c >= '0' && c <= '9') {
+            value |= c - '0';
+          } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+          } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+          } else {
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      /**
+       * Append the UTF-8 encoding of a \u escape, including surrogate pairs
+       */
+      bool codepoint(string& value) {
+        unsigned int cp{0};
+
+        if (!hex(cp)) {
+          return false;
+        } else if (cp >= 0xD800 && cp <= 0xDBFF) {
+          unsigned int low{0};
+          if (m_end - m_pos < 2 || m_pos[0] != '\\' || m_pos[1] != 'u') {
+            return false;
+          }
+          m_pos += 2;
+          if (!hex(low) || low < 0xDC00 || low > 0xDFFF) {
+            return false;
+          }
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (cp < 0x80) {
+          value += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+          value += static_cast<char>(0xC0 | (cp >> 6));
+          value += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+          value += static_cast<char>(0xE0 | (cp >> 12));
+          value += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+          value += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+          value += static_cast<char>(0xF0 | (cp >> 18));
+          value += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+          value += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+          value += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+
+        return true;
+      }
+
+     private:
+      const char* m_pos;
+      const char* m_end;
+      string m_key;
+    };
+
+    // }}}
+
+    /**
+     * Decode a workspace or workspace container, resetting all fields
+     * that are missing from the object
+     */
+    bool decode_workspace(json_cursor& json, workspace& ws) {
+      ws.num = -1;
+      ws.name.clear();
+      ws.output.clear();
+      ws.visible = ws.focused = ws.urgent = false;
+
+      return json.object([&](const string& key) {
+        if (key == "num") {
+          return json.integer(ws.num);
+        } else if (key == "name") {
+          return json.text(ws.name);
+        } else if (key == "output") {
+          return json.null() || json.text(ws.output);
+        } else if (key == "visible") {
+          return json.boolean(ws.visible);
+        } else if (key == "focused") {
+          return json.boolean(ws.focused);
+        } else if (key == "urgent") {
+          return json.boolean(ws.urgent);
+        }
+        return json.skip();
+      });
+    }
+  }
+
+  // decoding {{{
+
+  /**
+   * Decode a GET_WORKSPACES reply
+   */
+  bool decode(const string& payload, vector<workspace>& workspaces) {
+    json_cursor json(payload);
+    size_t count{0};
+
+    bool result = json.array([&] {
+      if (count == workspaces.size()) {
+        workspaces.emplace_back();
+      }
+      return decode_workspace(json, workspaces[count++]);
+    });
+
+    workspaces.resize(count);
+    return result && json.finished();
+  }
+
+  /**
+   * Decode a workspace event
+   */
+  bool decode(const string& payload, workspace_event& event) {
+    json_cursor json(payload);
+    event.change.clear();
+    event.has_current = false;
+
+    return json.object([&](const string& key) {
+      if (key == "change") {
+        return json.text(event.change);
+      } else if (key == "current") {
+        if (json.null()) {
+          return true;
+        }
+        return event.has_current = decode_workspace(json, event.current);
+      }
+      return json.skip();
+    }) && json.finished();
+  }
+
+  /**
+   * Decode a mode event
+   */
+  bool decode(const string& payload, mode_event& event) {
+    json_cursor json(payload);
+    event.change.clear();
+
+    return json.object([&](const string& key) {
+      if (key == "change") {
+        return json.text(event.change);
+      }
+      return json.skip();
+    }) && json.finished();
+  }
+
+  // }}}
+  // class : ipc_connection {{{
+
+  ipc_connection::ipc_connection(string path) : unix_connection(move(path)) {}
+
+  /**
+   * Send a message with the given type and payload
+   */
+  void ipc_connection::send(message_type type, const string& payload) {
+    string message{MAGIC, MAGIC_LEN};
+    uint32_t header[2]{static_cast<uint32_t>(payload.size()), static_cast<uint32_t>(type)};
+    message.append(reinterpret_cast<const char*>(header), sizeof(header));
+    message.append(payload);
+
+    size_t sent{0};
+    while (sent < message.size()) {
+      sent += unix_connection::send(message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+    }
+  }
+
+  /**
+   * Wait for the next message and return its type, the payload
+   * is read into the given string to reuse its storage
+   */
+  message_type ipc_connection::receive(string& payload) {
+    char magic[MAGIC_LEN];
+    uint32_t header[2]{};
+
+    read(magic, sizeof(magic));
+    read(header, sizeof(header));
+
+    if (strncmp(magic, MAGIC, MAGIC_LEN) != 0) {
+      throw ipc_error("Invalid message header");
+    }
+
+    payload.resize(header[0]);
+    read(&payload[0], payload.size());
+
+    return static_cast<message_type>(header[1]);
+  }
+
+  /**
+   * Send a request and wait for its reply, events are
+   * discarded since the connection is not subscribed
+   */
+  void ipc_connection::query(message_type type, const string& payload, string& reply) {
+    send(type, payload);
+
+    while (receive(reply) != type) {
+    }
+  }
+
+  void ipc_connection::read(void* data, size_t len) {
+    auto buffer = static_cast<char*>(data);
+
+    while (len > 0) {
+      auto bytes = recv(m_fd, buffer, len, 0);
+
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1) {
+        throw system_error("Failed to receive from i3");
+      } else if (bytes == 0) {
+        throw ipc_error("Connection closed by i3");
+      }
+
+      buffer += bytes;
+      len -= bytes;
+    }
+  }
+
+  // }}}
+  // class : event_queue {{{
+
+  void event_queue::push(shared_ptr<const event> ev) {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_events.emplace_back(move(ev));
+    }
+    m_pushed.notify_all();
+  }
+
+  /**
+   * Wait for the next event
+   *
+   * @return false once the queue is closed
+   */
+  bool event_queue::wait(shared_ptr<const event>& ev) {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    m_pushed.wait(guard, [&] { return m_closed || !m_events.empty(); });
+
+    if (m_closed) {
+      return false;
+    }
+
+    ev = move(m_events.front());
+    m_events.pop_front();
+    return true;
+  }
+
+  /**
+   * Make wait() return, used when the subscriber stops
+   */
+  void event_queue::close() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_closed = true;
+    }
+    m_pushed.notify_all();
+  }
+
+  // }}}
+  // class : ipc_source {{{
+
+  ipc_source::ipc_source(const logger& logger, string path) : m_log(logger), m_path(move(path)) {
+    m_events = connect();
+    m_thread = std::thread(&ipc_source::run, this);
+  }
+
+  ipc_source::~ipc_source() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_stopping = true;
+
+      // Make the pending receive fail
+      if (m_events) {
+        m_events->disconnect();
+      }
+    }
+    m_stopped.notify_all();
+    m_thread.join();
+  }
+
+  /**
+   * Get the source of given socket
+   *
+   * @see shared_instances
+   */
+  shared_ptr<ipc_source> ipc_source::acquire(const logger& logger, const string& path) {
+    return shared_instances<ipc_source>::acquire(path, logger, path);
+  }
+
+  /**
+   * Get a queue receiving all events from now on,
+   * the subscription ends with the last reference to it
+   */
+  shared_ptr<event_queue> ipc_source::subscribe() {
+    auto queue = make_shared<event_queue>();
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_queues.emplace_back(queue);
+    return queue;
+  }
+
+  /**
+   * Send a request through the connection used for queries and commands,
+   * which is opened on first use and reopened after errors
+   */
+  void ipc_source::query(message_type type, const string& payload, string& reply) {
+    std::lock_guard<std::mutex> guard(m_commandlock);
+
+    try {
+      if (!m_command) {
+        m_command = make_unique<ipc_connection>(m_path);
+      }
+      m_command->query(type, payload, reply);
+    } catch (const exception& err) {
+      m_command.reset();
+      throw;
+    }
+  }
+
+  /**
+   * Open a connection subscribed to the events used by the modules
+   */
+  unique_ptr<ipc_connection> ipc_source::connect() {
+    auto conn = make_unique<ipc_connection>(m_path);
+    conn->query(message_type::SUBSCRIBE, R"(["workspace","mode"])", m_payload);
+
+    if (m_payload.find("true") == string::npos) {
+      throw ipc_error("Failed to subscribe to events (" + m_payload + ")");
+    }
+
+    return conn;
+  }
+
+  void ipc_source::run() {
+    while (true) {
+      try {
+        auto ev = make_shared<event>();
+
+        switch (m_events->receive(m_payload)) {
+          case message_type::EVENT_WORKSPACE:
+            if (decode(m_payload, ev->workspace)) {
+              ev->type = event::kind::WORKSPACE;
+            } else {
+              m_log.warn("i3: Failed to decode workspace event");
+            }
+            break;
+          case message_type::EVENT_MODE:
+            if (!decode(m_payload, ev->mode)) {
+              continue;
+            }
+            ev->type = event::kind::MODE;
+            break;
+          default:
+            continue;
+        }
+
+        publish(move(ev));
+      } catch (const exception& err) {
+        if (!reconnect(err)) {
+          return;
+        }
+      }
+    }
+  }
+
+  /**
+   * Reopen the event connection after an error, retrying every second.
+   * The subscribers get a RESYNC event since events may have been missed
+   *
+   * @return false if the source was stopped
+   */
+  bool ipc_source::reconnect(const exception& reason) {
+    std::unique_lock<std::mutex> guard(m_mutex);
+
+    if (m_stopping) {
+      return false;
+    }
+
+    m_log.warn("i3: Attempting to reconnect socket (reason: %s)", reason.what());
+
+    while (true) {
+      guard.unlock();
+
+      try {
+        auto conn = connect();
+        guard.lock();
+
+        if (m_stopping) {
+          return false;
+        }
+
+        m_events = move(conn);
+        guard.unlock();
+
+        m_log.info("i3: Reconnecting socket succeeded");
+        publish(make_shared<event>());
+        return true;
+      } catch (const exception& err) {
+        m_log.err("i3: Failed to reconnect socket (reason: %s)", err.what());
+      }
+
+      guard.lock();
+      if (m_stopped.wait_for(guard, std::chrono::seconds{1}, [&] { return m_stopping; })) {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * Push an event to the queues of all subscribers, dropping the
+   * queues of subscribers that are gone
+   */
+  void ipc_source::publish(shared_ptr<const event> ev) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    for (auto it = m_queues.begin(); it != m_queues.end();) {
+      if (auto queue = it->lock()) {
+        queue->push(ev);
+        ++it;
+      } else {
+        it = m_queues.erase(it);
+      }
+    }
+  }
+
+  // }}}
+}
+
+POLYBAR_NS_END
@@ -1,3 +1,7 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
 #include <csignal>
 #include <thread>
@@ -133,6 +137,13 @@ namespace mpd {
     if (sigaction(SIGPIPE, &m_signal_action, nullptr) == -1) {
       throw mpd_exception("Could not setup signal handler: "s + std::strerror(errno));
     }
+
+    int wakeupfd[2];
+    if (pipe2(wakeupfd, O_CLOEXEC | O_NONBLOCK) != 0) {
+      throw mpd_exception("Could not create wakeup pipe: "s + std::strerror(errno));
+    }
+    m_wakeupfd[PIPE_READ] = make_unique<file_descriptor>(wakeupfd[PIPE_READ]);
+    m_wakeupfd[PIPE_WRITE] = make_unique<file_descriptor>(wakeupfd[PIPE_WRITE]);
   }
 
   mpdconnection::~mpdconnection() {
@@ -192,6 +203,38 @@ namespace mpd {
     return m_fd;
   }
 
+  /**
+   * Wait until the server sent data, e.g. the response to idle
+   *
+   * Returns false on timeout or if the wait was cut short by interrupt()
+   */
+  bool mpdconnection::poll(int timeout_ms) {
+    check_connection(m_connection.get());
+    struct pollfd fds[2]{{m_fd, POLLIN, 0}, {*m_wakeupfd[PIPE_READ], POLLIN, 0}};
+
+    if (::poll(fds, 2, timeout_ms) <= 0) {
+      return false;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      char buffer[16];
+      while (read(*m_wakeupfd[PIPE_READ], buffer, sizeof(buffer)) > 0) {
+      }
+    }
+
+    return fds[0].revents != 0;
+  }
+
+  /**
+   * Make the current or next call to poll() return right away
+   */
+  void mpdconnection::interrupt() {
+    // A full pipe already has a wakeup pending
+    if (write(*m_wakeupfd[PIPE_WRITE], "", 1) == -1 && errno != EAGAIN) {
+      m_log.err("mpdconnection.interrupt: %s", std::strerror(errno));
+    }
+  }
+
   void mpdconnection::idle() {
     check_connection(m_connection.get());
     if (!m_idle) {
@@ -374,41 +417,36 @@ namespace mpd {
   // class: mpdstatus {{{
 
   mpdstatus::mpdstatus(mpdconnection* conn, bool autoupdate) {
-    fetch_data(conn);
     if (autoupdate) {
       update(-1, conn);
+    } else {
+      fetch_data(conn);
     }
   }
 
+  /**
+   * Copy the fields of the current status, the mpd_status
+   * itself is not kept so that the status can be copied
+   */
   void mpdstatus::fetch_data(mpdconnection* conn) {
-    m_status.reset(mpd_run_status(*conn));
-    m_updated_at = chrono::system_clock::now();
-    m_songid = mpd_status_get_song_id(m_status.get());
-    m_queuelen = mpd_status_get_queue_length(m_status.get());
-    m_random = mpd_status_get_random(m_status.get());
-    m_repeat = mpd_status_get_repeat(m_status.get());
-    m_single = mpd_status_get_single(m_status.get());
-    m_consume = mpd_status_get_consume(m_status.get());
-    m_elapsed_time = mpd_status_get_elapsed_time(m_status.get());
-    m_total_time = mpd_status_get_total_time(m_status.get());
-  }
-
-  void mpdstatus::update(int event, mpdconnection* connection) {
-    /*
-     * Only update if either the player state (play, stop, pause, seek, ...), the options (random, repeat, ...),
-     * or the playlist has been changed
-     */
-    if (connection == nullptr || !static_cast<bool>(event & (MPD_IDLE_PLAYER | MPD_IDLE_OPTIONS | MPD_IDLE_QUEUE))) {
+    mpd_status_t status{mpd_run_status(*conn)};
+    if (!status) {
+      check_errors(*conn);
       return;
     }
 
-    fetch_data(connection);
-
-    m_elapsed_time_ms = m_elapsed_time * 1000;
-
-    auto state = mpd_status_get_state(m_status.get());
-
-    switch (state) {
+    m_updated_at = chrono::steady_clock::now();
+    m_songid = mpd_status_get_song_id(status.get());
+    m_queuelen = mpd_status_get_queue_length(status.get());
+    m_random = mpd_status_get_random(status.get());
+    m_repeat = mpd_status_get_repeat(status.get());
+    m_single = mpd_status_get_single(status.get());
+    m_consume = mpd_status_get_consume(status.get());
+    m_elapsed_time = mpd_status_get_elapsed_time(status.get());
+    m_elapsed_time_ms = mpd_status_get_elapsed_ms(status.get());
+    m_total_time = mpd_status_get_total_time(status.get());
+
+    switch (mpd_status_get_state(status.get())) {
       case MPD_STATE_PAUSE:
         m_state = mpdstate::PAUSED;
         break;
@@ -423,6 +461,26 @@ namespace mpd {
     }
   }
 
+  void mpdstatus::update(int event, mpdconnection* connection) {
+    /*
+     * Only update if either the player state (play, stop, pause, seek, ...), the options (random, repeat, ...),
+     * or the playlist has been changed
+     */
+    if (connection == nullptr || !static_cast<bool>(event & (MPD_IDLE_PLAYER | MPD_IDLE_OPTIONS | MPD_IDLE_QUEUE))) {
+      return;
+    }
+
+    fetch_data(connection);
+  }
+
+  /**
+   * Advance the elapsed time by the time played since the last
+   * status update, so that it does not have to be queried
+   */
+  void mpdstatus::update_timer() {
+    m_elapsed_time = get_elapsed_time_ms() / 1000;
+  }
+
   bool mpdstatus::random() const {
     return m_random;
   }
@@ -459,6 +517,22 @@ namespace mpd {
     return m_elapsed_time;
   }
 
+  unsigned long mpdstatus::get_elapsed_time_ms() const {
+    if (m_state != mpdstate::PLAYING) {
+      return m_elapsed_time_ms;
+    }
+
+    auto played = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - m_updated_at);
+    auto elapsed = m_elapsed_time_ms + played.count();
+
+    // Streams have no total time
+    if (m_total_time > 0) {
+      elapsed = std::min(elapsed, m_total_time * 1000);
+    }
+
+    return elapsed;
+  }
+
   unsigned mpdstatus::get_elapsed_percentage() {
     if (m_total_time == 0) {
       return 0;
@@ -486,6 +560,204 @@ namespace mpd {
     return math_util::percentage_to_value<double>(percentage, m_total_time);
   }
 
+  // }}}
+  // class: mpdsource {{{
+
+  mpdsource::mpdsource(const logger& logger, string host, unsigned int port, string password)
+      : m_log(logger), m_connection(logger, move(host), port, move(password)), m_state(make_shared<state>()) {
+    // The first attempt is made right away so that the modules start with the state of the server
+    connect();
+    m_thread = std::thread(&mpdsource::run, this);
+  }
+
+  mpdsource::~mpdsource() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_stopping = true;
+    }
+    m_stopped.notify_all();
+    m_connection.interrupt();
+    m_thread.join();
+  }
+
+  /**
+   * Get the source of given server
+   *
+   * @see shared_instances
+   */
+  shared_ptr<mpdsource> mpdsource::acquire(
+      const logger& logger, const string& host, unsigned int port, const string& password) {
+    return shared_instances<mpdsource>::acquire(
+        host + ":" + to_string(port) + ":" + password, logger, host, port, password);
+  }
+
+  /**
+   * Call `on_change` from the thread of the source whenever a new state is published
+   *
+   * @return Id to unsubscribe with
+   */
+  size_t mpdsource::subscribe(subscribers::callback&& on_change) {
+    return m_subscribers.add(move(on_change));
+  }
+
+  /**
+   * Remove a subscription, a notification in progress is waited for
+   */
+  void mpdsource::unsubscribe(size_t id) {
+    m_subscribers.remove(id);
+  }
+
+  /**
+   * Get the last published state
+   */
+  shared_ptr<const mpdsource::state> mpdsource::get() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_state;
+  }
+
+  /**
+   * Run a command on the connection of the source
+   *
+   * Commands are dropped while disconnected, there is nothing to
+   * control and they should not pile up until the server is back
+   */
+  void mpdsource::send(command&& cmd) {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (!m_state->connected) {
+        m_log.warn("mpd: Not connected, dropping command");
+        return;
+      }
+      m_commands.emplace_back(move(cmd));
+    }
+    m_connection.interrupt();
+  }
+
+  void mpdsource::run() {
+    while (true) {
+      {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_stopping) {
+          return;
+        }
+      }
+
+      if (!m_connection.connected()) {
+        if (sleep(m_attempts++ < 5 ? chrono::milliseconds{500} : chrono::milliseconds{2000})) {
+          connect();
+        }
+        continue;
+      }
+
+      try {
+        wait_for_change();
+      } catch (const mpd_exception& err) {
+        m_log.err("mpd: %s", err.what());
+        m_connection.disconnect();
+        m_status.reset();
+        publish(false, false);
+      }
+    }
+  }
+
+  /**
+   * Connect and publish the state of the server
+   */
+  void mpdsource::connect() {
+    try {
+      m_connection.connect();
+      m_status = m_connection.get_status();
+      publish(true, true);
+      m_attempts = 0;
+    } catch (const mpd_exception& err) {
+      m_log.err("mpd: %s", err.what());
+      m_connection.disconnect();
+      m_status.reset();
+      if (get()->connected) {
+        publish(false, false);
+      }
+    }
+  }
+
+  /**
+   * Run the queued commands and wait until the server reports
+   * a change or more commands are queued
+   */
+  void mpdsource::wait_for_change() {
+    vector<command> commands;
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      commands.swap(m_commands);
+    }
+    for (auto&& cmd : commands) {
+      cmd(m_connection);
+    }
+
+    m_connection.idle();
+    m_connection.poll(-1);
+
+    // Interrupted waits leave idle mode without changes
+    int flags = m_connection.noidle();
+    if (flags & (MPD_IDLE_PLAYER | MPD_IDLE_OPTIONS | MPD_IDLE_QUEUE)) {
+      m_status->update(flags, &m_connection);
+      // The current song only changes with player or queue events
+      publish(true, flags & (MPD_IDLE_PLAYER | MPD_IDLE_QUEUE));
+    }
+  }
+
+  /**
+   * Replace the published state and notify the subscribers
+   *
+   * The song is only fetched if requested, it is taken
+   * from the previous state otherwise
+   */
+  void mpdsource::publish(bool connected, bool fetchsong) {
+    auto next = make_shared<state>();
+    next->connected = connected;
+
+    if (connected) {
+      next->status = make_unique<mpdstatus>(*m_status);
+
+      if (fetchsong) {
+        auto song = m_connection.get_song();
+        if (song && *song) {
+          next->artist = song->get_artist();
+          next->album_artist = song->get_album_artist();
+          next->album = song->get_album();
+          next->title = song->get_title();
+          next->date = song->get_date();
+        }
+      } else {
+        auto current = get();
+        next->artist = current->artist;
+        next->album_artist = current->album_artist;
+        next->album = current->album;
+        next->title = current->title;
+        next->date = current->date;
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_state = move(next);
+      if (!connected) {
+        m_commands.clear();
+      }
+    }
+
+    m_subscribers.notify();
+  }
+
+  /**
+   * Wait before the next connection attempt
+   *
+   * @return false if the source was stopped meanwhile
+   */
+  bool mpdsource::sleep(chrono::milliseconds duration) {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    return !m_stopped.wait_for(guard, duration, [&] { return m_stopping; });
+  }
+
   // }}}
 }
 
@@ -5,12 +5,16 @@
 #include <arpa/inet.h>
 #include <linux/ethtool.h>
 #include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #ifdef inline
 #undef inline
@@ -18,7 +22,6 @@
 
 #include "common.hpp"
 #include "settings.hpp"
-#include "utils/command.hpp"
 #include "utils/file.hpp"
 #include "utils/string.hpp"
 
@@ -34,6 +37,26 @@ namespace net {
 
   static const string NO_IP6 = string("N/A");
 
+  // class : interface_provider {{{
+
+  /**
+   * List the addresses of all interfaces
+   */
+  interface_provider::value_type interface_provider::read() const {
+    auto list = make_shared<interface_list>();
+    struct ifaddrs* ifaddr;
+
+    if (getifaddrs(&ifaddr) == -1 || ifaddr == nullptr) {
+      return nullptr;
+    }
+
+    list->time = std::chrono::system_clock::now();
+    list->addrs.reset(ifaddr);
+
+    return list;
+  }
+
+  // }}}
   // class : network {{{
 
   /**
@@ -49,6 +72,27 @@ namespace net {
       throw network_error("Failed to open socket");
     }
 
+    m_interfaces = interface_provider::acquire("getifaddrs");
+    m_counters = procfs::netdev_provider::acquire("/proc/net/dev", "/proc/net/dev");
+    m_operstate = make_unique<file_reader>("/sys/class/net/" + m_interface + "/operstate");
+    m_ifindex = if_nametoindex(m_interface.c_str());
+
+    // Get notified about link and address changes
+    struct sockaddr_nl addr {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+    int rtnl = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+
+    if (rtnl == -1 || bind(rtnl, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      m_log.warn("Failed to subscribe to link changes of %s, polling instead", m_interface);
+      if (rtnl != -1) {
+        close(rtnl);
+      }
+    } else {
+      m_rtnl = file_util::make_file_descriptor(rtnl);
+    }
+
     check_tuntap();
   }
 
@@ -56,26 +100,53 @@ namespace net {
    * Query device driver for information
    */
   bool network::query(bool accumulate) {
-    struct ifaddrs* ifaddr;
-    if (getifaddrs(&ifaddr) == -1 || ifaddr == nullptr) {
+    // The counters are shared by all network modules
+    auto counters = m_counters->get(m_max_age);
+    if (!counters) {
       return false;
     }
 
+    // Without link events the addresses are read on every query
+    if ((m_refresh_addresses || !m_rtnl) && !query_addresses()) {
+      return false;
+    }
+
+    // Keep the rates of the last interval when queried early because of an event
+    if (counters->time == m_status.current.time) {
+      return true;
+    }
+
     m_status.previous = m_status.current;
     m_status.current.transmitted = 0;
     m_status.current.received = 0;
-    m_status.current.time = std::chrono::system_clock::now();
-    m_status.ip6 = NO_IP6;
+    m_status.current.time = counters->time;
 
-    for (auto ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-      if (ifa->ifa_addr == nullptr) {
-        continue;
+    for (auto&& dev : counters->interfaces) {
+      if (accumulate || dev.name == m_interface) {
+        m_status.current.transmitted += dev.transmitted;
+        m_status.current.received += dev.received;
       }
+    }
 
-      if (m_interface.compare(0, m_interface.length(), ifa->ifa_name) != 0) {
-        if (!accumulate || (ifa->ifa_data == nullptr && ifa->ifa_addr->sa_family != AF_PACKET)) {
-          continue;
-        }
+    return true;
+  }
+
+  /**
+   * Read the addresses of the interface
+   */
+  bool network::query_addresses() {
+    // Always read a new list, the addresses have changed since the last one
+    auto interfaces = m_interfaces->get(std::chrono::seconds{0});
+    if (!interfaces) {
+      return false;
+    }
+
+    m_refresh_addresses = false;
+    m_status.ip6 = NO_IP6;
+
+    for (auto ifa = interfaces->addrs.get(); ifa != nullptr; ifa = ifa->ifa_next) {
+      if (ifa->ifa_addr == nullptr || m_interface.compare(0, m_interface.length(), ifa->ifa_name) != 0) {
+        continue;
       }
 
       struct sockaddr_in6* sa6;
@@ -88,7 +159,7 @@ namespace net {
           break;
 
         case AF_INET6:
-          char ip6_buffer[INET_ADDRSTRLEN];
+          char ip6_buffer[INET6_ADDRSTRLEN];
           sa6 = reinterpret_cast<decltype(sa6)>(ifa->ifa_addr);
           if (IN6_IS_ADDR_LINKLOCAL(&sa6->sin6_addr)) {
               continue;
@@ -100,43 +171,103 @@ namespace net {
               /* Skip Unique Local Addresses (fc00::/7) */
               continue;
           }
-          if (inet_ntop(AF_INET6, &sa6->sin6_addr, ip6_buffer, NI_MAXHOST) == 0) {
+          if (inet_ntop(AF_INET6, &sa6->sin6_addr, ip6_buffer, INET6_ADDRSTRLEN) == 0) {
               m_log.warn("inet_ntop() " + string(strerror(errno)));
               continue;
           }
           m_status.ip6 = string{ip6_buffer};
           break;
-
-        case AF_PACKET:
-          if (ifa->ifa_data == nullptr) {
-            continue;
-          }
-          struct rtnl_link_stats* link_state = reinterpret_cast<decltype(link_state)>(ifa->ifa_data);
-          if (link_state == nullptr) {
-            continue;
-          }
-          m_status.current.transmitted += link_state->tx_bytes;
-          m_status.current.received += link_state->rx_bytes;
-          break;
       }
     }
 
-    freeifaddrs(ifaddr);
-
     return true;
   }
 
   /**
-   * Run ping command to test internet connectivity
+   * Check if changes of the interface are reported as events,
+   * otherwise the caller has to poll
    */
-  bool network::ping() const {
-    try {
-      auto exec = "ping -c 2 -W 2 -I " + m_interface + " " + string(CONNECTION_TEST_IP);
-      auto ping = command_util::make_command(exec);
-      return ping && ping->exec(true) == EXIT_SUCCESS;
-    } catch (const std::exception& err) {
+  bool network::subscribed() const {
+    return m_rtnl || event_fd() != -1;
+  }
+
+  /**
+   * Wait until a link, address or association change of the interface
+   * is reported, returns false if nothing changed within `wait_ms`
+   */
+  bool network::wait_for_change(int wait_ms) {
+    struct pollfd fds[2]{};
+    nfds_t count{0};
+
+    if (m_rtnl) {
+      fds[count].fd = *m_rtnl;
+      fds[count++].events = POLLIN;
+    }
+    if (event_fd() != -1) {
+      fds[count].fd = event_fd();
+      fds[count++].events = POLLIN;
+    }
+
+    if (count == 0 || ::poll(fds, count, wait_ms) <= 0) {
       return false;
     }
+
+    bool changed{false};
+
+    for (nfds_t i = 0; i < count; i++) {
+      if (fds[i].revents & POLLIN) {
+        changed = (fds[i].fd == event_fd() ? read_events() : read_link_events()) || changed;
+      }
+    }
+
+    return changed;
+  }
+
+  /**
+   * Drain the rtnetlink socket, returns true if
+   * any of the messages concerns the interface
+   */
+  bool network::read_link_events() {
+    alignas(struct nlmsghdr) char buffer[8192];
+    bool changed{false};
+    ssize_t bytes;
+
+    while ((bytes = recv(*m_rtnl, buffer, sizeof(buffer), 0)) > 0) {
+      int len = bytes;
+
+      for (auto hdr = reinterpret_cast<struct nlmsghdr*>(buffer); NLMSG_OK(hdr, len); hdr = NLMSG_NEXT(hdr, len)) {
+        switch (hdr->nlmsg_type) {
+          case RTM_NEWLINK:
+          case RTM_DELLINK:
+            changed = changed || static_cast<struct ifinfomsg*>(NLMSG_DATA(hdr))->ifi_index == m_ifindex;
+            break;
+          case RTM_NEWADDR:
+          case RTM_DELADDR:
+            changed = changed || static_cast<int>(static_cast<struct ifaddrmsg*>(NLMSG_DATA(hdr))->ifa_index) == m_ifindex;
+            break;
+        }
+      }
+    }
+
+    // The socket buffer overran, events of the interface may have been dropped
+    if (bytes == -1 && errno == ENOBUFS) {
+      changed = true;
+    }
+
+    m_refresh_addresses = m_refresh_addresses || changed;
+
+    return changed;
+  }
+
+  /**
+   * Socket of additional events, e.g. wireless association
+   */
+  int network::event_fd() const {
+    return -1;
+  }
+
+  bool network::read_events() {
+    return false;
   }
 
   /**
@@ -176,6 +307,14 @@ namespace net {
     m_unknown_up = unknown;
   }
 
+  /**
+   * Set the interval of the caller, interface lists read by
+   * other modules within half of it are reused
+   */
+  void network::set_interval(std::chrono::duration<double> interval) {
+    m_max_age = interval / 2;
+  }
+
   /**
    * Query driver info to check if the
    * interface is a TUN/TAP device
@@ -214,9 +353,11 @@ namespace net {
    * Test if the network interface is in a valid state
    */
   bool network::test_interface() const {
-    auto operstate = file_util::contents("/sys/class/net/" + m_interface + "/operstate");
-    bool up = operstate.compare(0, 2, "up") == 0;
-    return m_unknown_up ? (up || operstate.compare(0, 7, "unknown") == 0) : up;
+    if (!m_operstate->read()) {
+      return false;
+    }
+    bool up = strncmp(m_operstate->data(), "up", 2) == 0;
+    return m_unknown_up ? (up || strncmp(m_operstate->data(), "unknown", 7) == 0) : up;
   }
 
   /**
@@ -224,7 +365,7 @@ namespace net {
    */
   string network::format_speedrate(float bytes_diff, int minwidth) const {
     const auto duration = m_status.current.time - m_status.previous.time;
-    float time_diff = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
+    float time_diff = std::chrono::duration<float>(duration).count();
     float speedrate = bytes_diff / (time_diff ? time_diff : 1);
 
     vector<string> suffixes{"GB", "MB"};
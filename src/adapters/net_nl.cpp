@@ -11,59 +11,132 @@ POLYBAR_NS
 namespace net {
   // class : wireless_network {{{
 
+  void wireless_network::socket_deleter::operator()(struct nl_sock* sk) const {
+    nl_socket_free(sk);
+  }
+
+  /**
+   * Construct wireless interface and subscribe to association changes
+   */
+  wireless_network::wireless_network(string interface)
+      : network(interface), m_ifid(if_nametoindex(m_interface.c_str())) {
+    m_events.reset(nl_socket_alloc());
+    int group{-1};
+
+    if (!m_events || genl_connect(m_events.get()) < 0 ||
+        (group = genl_ctrl_resolve_grp(m_events.get(), "nl80211", "mlme")) < 0 ||
+        nl_socket_add_membership(m_events.get(), group) < 0 ||
+        nl_socket_modify_cb(m_events.get(), NL_CB_VALID, NL_CB_CUSTOM, event_cb, this) != 0 ||
+        nl_socket_set_nonblocking(m_events.get()) < 0) {
+      m_log.warn("Failed to subscribe to association changes of %s, polling instead", m_interface);
+      m_events.reset();
+      return;
+    }
+
+    // Events are not replies to our requests
+    nl_socket_disable_seq_check(m_events.get());
+  }
+
   /**
    * Query the wireless device for information
    * about the current connection
    */
   bool wireless_network::query(bool accumulate) {
-    if (!network::query(accumulate)) {
+    if (!network::query(accumulate) || !connect()) {
       return false;
     }
 
-    struct nl_sock* sk = nl_socket_alloc();
-    if (sk == nullptr) {
+    struct nl_msg* msg = nlmsg_alloc();
+    if (msg == nullptr) {
       return false;
     }
 
-    if (genl_connect(sk) < 0) {
+    if ((genlmsg_put(msg, NL_AUTO_PORT, NL_AUTO_SEQ, m_nl80211, 0, NLM_F_DUMP, NL80211_CMD_GET_SCAN, 0) == nullptr) ||
+        nla_put_u32(msg, NL80211_ATTR_IFINDEX, m_ifid) < 0) {
+      nlmsg_free(msg);
       return false;
     }
 
-    int driver_id = genl_ctrl_resolve(sk, "nl80211");
-    if (driver_id < 0) {
-      nl_socket_free(sk);
+    // Only set again if still associated
+    m_essid.clear();
+
+    // nl_send_sync always frees msg
+    if (nl_send_sync(m_socket.get(), msg) < 0) {
+      // Reconnect on the next query
+      m_socket.reset();
       return false;
     }
 
-    if (nl_socket_modify_cb(sk, NL_CB_VALID, NL_CB_CUSTOM, scan_cb, this) != 0) {
-      nl_socket_free(sk);
-      return false;
+    return true;
+  }
+
+  /**
+   * Open the socket used for queries, the nl80211
+   * family is resolved once per connection
+   */
+  bool wireless_network::connect() {
+    if (m_socket) {
+      return true;
     }
 
-    struct nl_msg* msg = nlmsg_alloc();
-    if (msg == nullptr) {
-      nl_socket_free(sk);
+    unique_ptr<struct nl_sock, socket_deleter> sk{nl_socket_alloc()};
+
+    if (!sk || genl_connect(sk.get()) < 0) {
       return false;
     }
 
-    if ((genlmsg_put(msg, NL_AUTO_PORT, NL_AUTO_SEQ, driver_id, 0, NLM_F_DUMP, NL80211_CMD_GET_SCAN, 0) == nullptr) ||
-        nla_put_u32(msg, NL80211_ATTR_IFINDEX, m_ifid) < 0) {
-      nlmsg_free(msg);
-      nl_socket_free(sk);
+    if ((m_nl80211 = genl_ctrl_resolve(sk.get(), "nl80211")) < 0) {
       return false;
     }
 
-    // nl_send_sync always frees msg
-    if (nl_send_sync(sk, msg) < 0) {
-      nl_socket_free(sk);
+    if (nl_socket_modify_cb(sk.get(), NL_CB_VALID, NL_CB_CUSTOM, scan_cb, this) != 0) {
       return false;
     }
 
-    nl_socket_free(sk);
+    m_socket = move(sk);
 
     return true;
   }
 
+  /**
+   * Socket subscribed to the nl80211 mlme group
+   */
+  int wireless_network::event_fd() const {
+    return m_events ? nl_socket_get_fd(m_events.get()) : -1;
+  }
+
+  /**
+   * Drain the mlme socket, returns true if any
+   * of the events concerns the interface
+   */
+  bool wireless_network::read_events() {
+    m_changed = false;
+
+    while (nl_recvmsgs_default(m_events.get()) >= 0) {
+    }
+
+    return m_changed;
+  }
+
+  /**
+   * Callback to check the interface of (dis)association events
+   */
+  int wireless_network::event_cb(struct nl_msg* msg, void* instance) {
+    auto wn = static_cast<wireless_network*>(instance);
+    auto gnlh = static_cast<genlmsghdr*>(nlmsg_data(nlmsg_hdr(msg)));
+    struct nlattr* tb[NL80211_ATTR_MAX + 1];
+
+    if (nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0), genlmsg_attrlen(gnlh, 0), nullptr) < 0) {
+      return NL_SKIP;
+    }
+
+    if (tb[NL80211_ATTR_IFINDEX] != nullptr && nla_get_u32(tb[NL80211_ATTR_IFINDEX]) == wn->m_ifid) {
+      wn->m_changed = true;
+    }
+
+    return NL_SKIP;
+  }
+
   /**
    * Check current connection state
    */
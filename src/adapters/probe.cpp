@@ -0,0 +1,230 @@
+#include "adapters/probe.hpp"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+
+POLYBAR_NS
+
+namespace net {
+  /**
+   * Percentage of requests without reply
+   */
+  int probe_result::loss() const {
+    return sent > 0 ? 100 * (sent - received) / sent : 0;
+  }
+
+  probe::probe(string target, int count, std::chrono::duration<double> timeout, unsigned short fallback_port)
+      : m_target(move(target))
+      , m_count(count)
+      , m_timeout(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout))
+      , m_port(fallback_port) {}
+
+  /**
+   * Abort a running probe
+   */
+  probe::~probe() {
+    m_stop = true;
+
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  /**
+   * Start probing the target in the background, unless the
+   * previous probe is still running. Requests are sent from
+   * the given address to test a specific interface
+   */
+  bool probe::start(string source) {
+    if (m_running.exchange(true)) {
+      return false;
+    }
+
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+
+    m_thread = std::thread(&probe::run, this, move(source));
+    return true;
+  }
+
+  /**
+   * Get the result of the last finished probe,
+   * returns false if there's no new result
+   */
+  bool probe::result(probe_result& result) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    if (!m_pending) {
+      return false;
+    }
+
+    result = m_result;
+    m_pending = false;
+    return true;
+  }
+
+  void probe::run(string source) {
+    probe_result result{};
+    struct sockaddr_in addr {};
+    struct sockaddr_in src {};
+
+    src.sin_family = AF_INET;
+    if (!source.empty()) {
+      inet_pton(AF_INET, source.c_str(), &src.sin_addr);
+    }
+
+    if (resolve(addr)) {
+      int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, IPPROTO_ICMP);
+
+      if (fd != -1 && src.sin_addr.s_addr != INADDR_ANY) {
+        bind(fd, reinterpret_cast<struct sockaddr*>(&src), sizeof(src));
+      }
+
+      duration total{0.0};
+
+      for (int i = 0; i < m_count && !m_stop; i++) {
+        duration rtt{0.0};
+        bool reply = fd != -1 ? echo(fd, i, addr, rtt) : handshake(src, addr, rtt);
+
+        result.sent++;
+
+        if (reply) {
+          result.received++;
+          total += rtt;
+        }
+      }
+
+      if (fd != -1) {
+        close(fd);
+      }
+      if (result.received > 0) {
+        result.latency = total / result.received;
+      }
+    } else {
+      result.sent = m_count;
+    }
+
+    if (!m_stop) {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_result = result;
+      m_pending = true;
+    }
+
+    m_running = false;
+  }
+
+  /**
+   * Resolve the target to an IPv4 address
+   */
+  bool probe::resolve(struct sockaddr_in& addr) const {
+    struct addrinfo hints {};
+    struct addrinfo* info{nullptr};
+
+    hints.ai_family = AF_INET;
+
+    if (getaddrinfo(m_target.c_str(), nullptr, &hints, &info) != 0 || info == nullptr) {
+      return false;
+    }
+
+    addr = *reinterpret_cast<struct sockaddr_in*>(info->ai_addr);
+    freeaddrinfo(info);
+    return true;
+  }
+
+  /**
+   * Send an echo request and wait for its reply. The identifier and
+   * checksum are filled in by the kernel for ICMP datagram sockets
+   */
+  bool probe::echo(int fd, int seq, const struct sockaddr_in& addr, duration& rtt) const {
+    struct icmphdr request {};
+    request.type = ICMP_ECHO;
+    request.un.echo.sequence = htons(seq);
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + m_timeout;
+
+    if (sendto(fd, &request, sizeof(request), 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      return false;
+    }
+
+    while (await(fd, POLLIN, deadline)) {
+      struct icmphdr reply {};
+
+      if (recv(fd, &reply, sizeof(reply), 0) >= static_cast<ssize_t>(sizeof(reply)) && reply.type == ICMP_ECHOREPLY &&
+          reply.un.echo.sequence == request.un.echo.sequence) {
+        rtt = std::chrono::steady_clock::now() - start;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Open a TCP connection to the target. A refused
+   * connection still proves that the target is reachable
+   */
+  bool probe::handshake(const struct sockaddr_in& source, const struct sockaddr_in& addr, duration& rtt) const {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+    if (fd == -1) {
+      return false;
+    }
+
+    if (source.sin_addr.s_addr != INADDR_ANY) {
+      bind(fd, reinterpret_cast<const struct sockaddr*>(&source), sizeof(source));
+    }
+
+    struct sockaddr_in target = addr;
+    target.sin_port = htons(m_port);
+
+    auto start = std::chrono::steady_clock::now();
+    bool reachable{false};
+
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&target), sizeof(target)) == 0 || errno == ECONNREFUSED) {
+      reachable = true;
+    } else if (errno == EINPROGRESS && await(fd, POLLOUT, start + m_timeout)) {
+      int err{0};
+      socklen_t len = sizeof(err);
+      reachable = getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && (err == 0 || err == ECONNREFUSED);
+    }
+
+    rtt = std::chrono::steady_clock::now() - start;
+    close(fd);
+    return reachable;
+  }
+
+  /**
+   * Wait for the socket to become ready, in short steps
+   * so that an aborted probe returns quickly
+   */
+  bool probe::await(int fd, short events, std::chrono::steady_clock::time_point deadline) const {
+    while (!m_stop) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+      if (remaining.count() <= 0) {
+        return false;
+      }
+
+      struct pollfd fds[1];
+      fds[0].fd = fd;
+      fds[0].events = events;
+      fds[0].revents = 0;
+
+      if (::poll(fds, 1, std::min(remaining, std::chrono::milliseconds{100}).count()) > 0) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+}
+
+POLYBAR_NS_END
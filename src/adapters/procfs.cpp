@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cstring>
+
+#include "adapters/procfs.hpp"
+
+POLYBAR_NS
+
+namespace procfs {
+  stat_provider::stat_provider(string path) : m_reader(move(path)) {}
+
+  /**
+   * Read the times of each core
+   */
+  stat_provider::value_type stat_provider::read() const {
+    if (!m_reader.read()) {
+      return nullptr;
+    }
+
+    auto times = make_shared<cpu_times>();
+
+    for (const char* line = m_reader.data(); strncmp(line, "cpu", 3) == 0;) {
+      const char* eol = strchr(line, '\n');
+
+      // skip line with accumulated value
+      if (line[3] != ' ') {
+        char* pos = const_cast<char*>(strchr(line, ' '));
+
+        if (pos == nullptr) {
+          break;
+        }
+
+        cpu_time time{};
+        time.user = std::strtoull(pos, &pos, 10);
+        time.nice = std::strtoull(pos, &pos, 10);
+        time.system = std::strtoull(pos, &pos, 10);
+        time.idle = std::strtoull(pos, &pos, 10);
+        time.total = time.user + time.nice + time.system + time.idle;
+        times->emplace_back(time);
+      }
+
+      if (eol == nullptr) {
+        break;
+      }
+
+      line = eol + 1;
+    }
+
+    if (times->empty()) {
+      return nullptr;
+    }
+
+    return times;
+  }
+
+  meminfo_provider::meminfo_provider(string path) : m_reader(move(path)) {}
+
+  /**
+   * Read total and available memory and swap
+   */
+  meminfo_provider::value_type meminfo_provider::read() const {
+    if (!m_reader.read()) {
+      return nullptr;
+    }
+
+    auto info = make_shared<meminfo>();
+    unsigned long long memfree{0ULL};
+    unsigned long long buffers{0ULL};
+    unsigned long long cached{0ULL};
+    unsigned long long sreclaimable{0ULL};
+    unsigned long long shmem{0ULL};
+    bool has_avail{false};
+
+    const std::pair<const char*, unsigned long long*> fields[]{
+        {"MemTotal", &info->total},
+        {"MemAvailable", &info->avail},
+        {"MemFree", &memfree},
+        {"Buffers", &buffers},
+        {"Cached", &cached},
+        {"SReclaimable", &sreclaimable},
+        {"Shmem", &shmem},
+        {"SwapTotal", &info->swap_total},
+        {"SwapFree", &info->swap_free},
+    };
+
+    for (const char* line = m_reader.data(); *line != '\0';) {
+      const char* sep = strchr(line, ':');
+
+      if (sep == nullptr) {
+        break;
+      }
+
+      for (auto&& field : fields) {
+        size_t len = strlen(field.first);
+        if (static_cast<size_t>(sep - line) == len && strncmp(line, field.first, len) == 0) {
+          *field.second = std::strtoull(sep + 1, nullptr, 10);
+          has_avail = has_avail || field.second == &info->avail;
+          break;
+        }
+      }
+
+      const char* eol = strchr(sep, '\n');
+
+      if (eol == nullptr) {
+        break;
+      }
+
+      line = eol + 1;
+    }
+
+    // newer kernels (3.4+) have an accurate available memory field,
+    // see https://git.kernel.org/cgit/linux/kernel/git/torvalds/linux.git/commit/?id=34e431b0ae398fc54ea69ff85ec700722c9da773
+    // for details
+    if (!has_avail) {
+      // old kernel; give a best-effort approximation of available memory
+      info->avail = memfree + buffers + cached + sreclaimable - shmem;
+    }
+
+    return info;
+  }
+
+  netdev_provider::netdev_provider(string path) : m_reader(move(path)) {}
+
+  /**
+   * Read the received and transmitted bytes of each interface
+   */
+  netdev_provider::value_type netdev_provider::read() const {
+    if (!m_reader.read()) {
+      return nullptr;
+    }
+
+    auto dev = make_shared<netdev>();
+    dev->time = std::chrono::system_clock::now();
+
+    // the first two lines are column headers
+    const char* line = strchr(m_reader.data(), '\n');
+    line = line != nullptr ? strchr(line + 1, '\n') : nullptr;
+
+    while (line != nullptr && *++line != '\0') {
+      const char* sep = strchr(line, ':');
+      const char* eol = strchr(line, '\n');
+
+      if (sep == nullptr || (eol != nullptr && sep > eol)) {
+        break;
+      }
+
+      const char* name = line + strspn(line, " ");
+      char* pos = const_cast<char*>(sep + 1);
+
+      netdev_counters counters{};
+      counters.name = string(name, sep);
+      counters.received = std::strtoull(pos, &pos, 10);
+
+      // skip packets, errs, drop, fifo, frame, compressed and multicast
+      for (int i = 0; i < 7; i++) {
+        std::strtoull(pos, &pos, 10);
+      }
+
+      counters.transmitted = std::strtoull(pos, &pos, 10);
+      dev->interfaces.emplace_back(move(counters));
+
+      line = eol;
+    }
+
+    return dev;
+  }
+
+  /**
+   * Find the given mountpoints in the contents of /proc/self/mountinfo
+   *
+   * Lines are split in place and only those of the given
+   * mountpoints are copied
+   */
+  void parse_mountinfo(const char* data, size_t size, const vector<string>& mountpoints, mounts& mounted) {
+    mounted.clear();
+
+    const char* pos = data;
+    const char* end = data + size;
+
+    while (pos < end) {
+      auto eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+      eol = eol != nullptr ? eol : end;
+
+      const auto next_field = [&](size_t& length) {
+        while (pos < eol && *pos == ' ') {
+          pos++;
+        }
+        auto field = pos;
+        while (pos < eol && *pos != ' ') {
+          pos++;
+        }
+        length = pos - field;
+        return field;
+      };
+
+      // Fields: id, parent id, major:minor, root, mountpoint, options,
+      // optional fields terminated by "-", type, source, super options
+      size_t length{0};
+      for (int i = 0; i < 4; i++) {
+        next_field(length);
+      }
+
+      auto dir = next_field(length);
+      auto mountpoint = std::find_if(mountpoints.begin(), mountpoints.end(),
+          [&](const string& m) { return m.size() == length && m.compare(0, length, dir, length) == 0; });
+
+      if (mountpoint != mountpoints.end()) {
+        const char* field;
+        do {
+          field = next_field(length);
+        } while (length > 0 && !(length == 1 && *field == '-'));
+
+        auto type = next_field(length);
+        string fstype{type, length};
+        auto fsname = next_field(length);
+
+        // Later entries are mounted on top of earlier ones
+        mounted[*mountpoint] = make_pair(move(fstype), string{fsname, length});
+      }
+
+      pos = eol + 1;
+    }
+  }
+}
+
+POLYBAR_NS_END
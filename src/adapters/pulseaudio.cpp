@@ -6,7 +6,8 @@ POLYBAR_NS
 /**
  * Construct pulseaudio object
  */
-pulseaudio::pulseaudio(const logger& logger, string&& sink_name, bool max_volume) : m_log(logger), spec_s_name(sink_name) {
+pulseaudio::pulseaudio(const logger& logger, string sink_name)
+    : m_log(logger), m_query(!sink_name.empty()), spec_s_name(move(sink_name)) {
   m_mainloop = pa_threaded_mainloop_new();
   if (!m_mainloop) {
     throw pulseaudio_error("Could not create pulseaudio threaded mainloop.");
@@ -50,31 +51,25 @@ pulseaudio::pulseaudio(const logger& logger, string&& sink_name, bool max_volume
     throw pulseaudio_error("Could not connect to pulseaudio server.");
   }
 
-  pa_operation *op{nullptr};
-  if (!sink_name.empty()) {
-    op = pa_context_get_sink_info_by_name(m_context, sink_name.c_str(), sink_info_callback, this);
-    wait_loop(op, m_mainloop);
+  // Look up the sink and wait for the result
+  query_sink(true);
+  while (m_query.querying()) {
+    pa_threaded_mainloop_wait(m_mainloop);
   }
-  if (s_name.empty()) {
-    // get the sink index
-    op = pa_context_get_sink_info_by_name(m_context, DEFAULT_SINK, sink_info_callback, this);
-    wait_loop(op, m_mainloop);
-    m_log.warn("pulseaudio: using default sink %s", s_name);
-  } else {
-    m_log.trace("pulseaudio: using sink %s", s_name);
-  }
-
-  m_max_volume = max_volume ? PA_VOLUME_UI_MAX : PA_VOLUME_NORM;
 
   auto event_types = static_cast<pa_subscription_mask_t>(PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SERVER);
-  op = pa_context_subscribe(m_context, event_types, simple_callback, this);
-  wait_loop(op, m_mainloop);
-  if (!success)
+  operation_result result{m_mainloop, 0};
+  pa_operation *op = pa_context_subscribe(m_context, event_types, simple_callback, &result);
+  if (!wait_loop(op, result)) {
+    pa_threaded_mainloop_unlock(m_mainloop);
+    pa_threaded_mainloop_stop(m_mainloop);
+    pa_context_disconnect(m_context);
+    pa_context_unref(m_context);
+    pa_threaded_mainloop_free(m_mainloop);
     throw pulseaudio_error("Failed to subscribe to sink.");
+  }
   pa_context_set_subscribe_callback(m_context, subscribe_callback, this);
 
-  update_volume(op);
-
   pa_threaded_mainloop_unlock(m_mainloop);
 
 }
@@ -91,67 +86,47 @@ pulseaudio::~pulseaudio() {
 }
 
 /**
- * Get sink name
+ * Get the instance tracking given sink, an empty name
+ * refers to the default sink
+ */
+shared_ptr<pulseaudio> pulseaudio::acquire(const logger& logger, const string& sink_name) {
+  return shared_instances<pulseaudio>::acquire(sink_name, logger, sink_name);
+}
+
+/**
+ * Call `on_change` from the mainloop thread whenever the sink changed
+ *
+ * @return Id to unsubscribe with
  */
-const string& pulseaudio::get_name() {
-  return s_name;
+size_t pulseaudio::subscribe(callback&& on_change) {
+  return m_subscribers.add(move(on_change));
 }
 
 /**
- * Wait for events
+ * Remove a subscription, a notification in progress is waited for
  */
-bool pulseaudio::wait() {
-  return m_events.size() > 0;
+void pulseaudio::unsubscribe(size_t id) {
+  m_subscribers.remove(id);
 }
 
 /**
- * Process queued pulseaudio events
+ * Get sink name
+ *
+ * The name is changed from the mainloop thread,
+ * so a copy is made with the mainloop locked
  */
-int pulseaudio::process_events() {
-  int ret = m_events.size();
+string pulseaudio::get_name() {
   pa_threaded_mainloop_lock(m_mainloop);
-  pa_operation *o{nullptr};
-  // clear the queue
-  while (!m_events.empty()) {
-    switch (m_events.front()) {
-      // try to get specified sink
-      case evtype::NEW:
-        // redundant if already using specified sink
-        if (!spec_s_name.empty()) {
-          o = pa_context_get_sink_info_by_name(m_context, spec_s_name.c_str(), sink_info_callback, this);
-          wait_loop(o, m_mainloop);
-          break;
-        }
-        // FALLTHRU
-      case evtype::SERVER:
-        // don't fallthrough only if always using default sink
-        if (!spec_s_name.empty()) {
-          break;
-        }
-        // FALLTHRU
-      // get default sink
-      case evtype::REMOVE:
-        o = pa_context_get_sink_info_by_name(m_context, DEFAULT_SINK, sink_info_callback, this);
-        wait_loop(o, m_mainloop);
-        if (spec_s_name != s_name)
-          m_log.warn("pulseaudio: using default sink %s", s_name);
-        break;
-      default:
-        break;
-    }
-    update_volume(o);
-    m_events.pop();
-  }
+  string name{s_name};
   pa_threaded_mainloop_unlock(m_mainloop);
-  return ret;
+  return name;
 }
 
 /**
  * Get volume in percentage
  */
 int pulseaudio::get_volume() {
-  // alternatively, user pa_cvolume_avg_mask() to average selected channels
-  return static_cast<int>(pa_cvolume_max(&cv) * 100.0f / PA_VOLUME_NORM + 0.5f);
+  return m_volume;
 }
 
 /**
@@ -161,32 +136,36 @@ void pulseaudio::set_volume(float percentage) {
   pa_threaded_mainloop_lock(m_mainloop);
   pa_volume_t vol = math_util::percentage_to_value<pa_volume_t>(percentage, PA_VOLUME_MUTED, PA_VOLUME_NORM);
   pa_cvolume_scale(&cv, vol);
-  pa_operation *op = pa_context_set_sink_volume_by_index(m_context, m_index, &cv, simple_callback, this);
-  wait_loop(op, m_mainloop);
+  operation_result result{m_mainloop, 0};
+  pa_operation *op = pa_context_set_sink_volume_by_index(m_context, m_index, &cv, simple_callback, &result);
+  bool success = wait_loop(op, result);
+  pa_threaded_mainloop_unlock(m_mainloop);
   if (!success)
     throw pulseaudio_error("Failed to set sink volume.");
-  pa_threaded_mainloop_unlock(m_mainloop);
 }
 
 /**
  * Increment or decrement volume by given percentage (prevents accumulation of rounding errors from get_volume)
+ *
+ * The volume is raised up to PA_VOLUME_UI_MAX if `ui_max` is set, otherwise up to 100%
  */
-void pulseaudio::inc_volume(int delta_perc) {
+void pulseaudio::inc_volume(int delta_perc, bool ui_max) {
   pa_threaded_mainloop_lock(m_mainloop);
   pa_volume_t vol = math_util::percentage_to_value<pa_volume_t>(abs(delta_perc), PA_VOLUME_NORM);
   if (delta_perc > 0) {
-    if (pa_cvolume_max(&cv) + vol <= m_max_volume) {
+    if (pa_cvolume_max(&cv) + vol <= (ui_max ? PA_VOLUME_UI_MAX : PA_VOLUME_NORM)) {
       pa_cvolume_inc(&cv, vol);
     } else {
       m_log.warn("pulseaudio: maximum volume reached");
     }
   } else
     pa_cvolume_dec(&cv, vol);
-  pa_operation *op = pa_context_set_sink_volume_by_index(m_context, m_index, &cv, simple_callback, this);
-  wait_loop(op, m_mainloop);
+  operation_result result{m_mainloop, 0};
+  pa_operation *op = pa_context_set_sink_volume_by_index(m_context, m_index, &cv, simple_callback, &result);
+  bool success = wait_loop(op, result);
+  pa_threaded_mainloop_unlock(m_mainloop);
   if (!success)
     throw pulseaudio_error("Failed to set sink volume.");
-  pa_threaded_mainloop_unlock(m_mainloop);
 }
 
 /**
@@ -194,11 +173,12 @@ void pulseaudio::inc_volume(int delta_perc) {
  */
 void pulseaudio::set_mute(bool mode) {
   pa_threaded_mainloop_lock(m_mainloop);
-  pa_operation *op = pa_context_set_sink_mute_by_index(m_context, m_index, mode, simple_callback, this);
-  wait_loop(op, m_mainloop);
+  operation_result result{m_mainloop, 0};
+  pa_operation *op = pa_context_set_sink_mute_by_index(m_context, m_index, mode, simple_callback, &result);
+  bool success = wait_loop(op, result);
+  pa_threaded_mainloop_unlock(m_mainloop);
   if (!success)
     throw pulseaudio_error("Failed to mute sink.");
-  pa_threaded_mainloop_unlock(m_mainloop);
 }
 
 /**
@@ -212,27 +192,43 @@ void pulseaudio::toggle_mute() {
  * Get current mute state
  */
 bool pulseaudio::is_muted() {
-  return muted;
+  return m_muted;
 }
 
 /**
- * Update local volume cache
+ * Query the sink, looking it up by name again if requested
+ *
+ * @see sink_query
  */
-void pulseaudio::update_volume(pa_operation *o) {
-  o = pa_context_get_sink_info_by_index(m_context, m_index, get_sink_volume_callback, this);
-  wait_loop(o, m_mainloop);
+void pulseaudio::query_sink(bool lookup, bool use_default) {
+  send_query(m_query.request(lookup, use_default));
 }
 
 /**
- * Callback when getting volume
+ * Send the sink info query for given target
  */
-void pulseaudio::get_sink_volume_callback(pa_context *, const pa_sink_info *info, int, void *userdata) {
-  pulseaudio* This = static_cast<pulseaudio *>(userdata);
-  if (info) {
-    This->cv = info->volume;
-    This->muted = info->mute;
+void pulseaudio::send_query(sink_query::target target) {
+  pa_operation* op{nullptr};
+
+  switch (target) {
+    case sink_query::target::NONE:
+      return;
+    case sink_query::target::DEFAULT:
+      op = pa_context_get_sink_info_by_name(m_context, DEFAULT_SINK, sink_info_callback, this);
+      break;
+    case sink_query::target::NAME:
+      op = pa_context_get_sink_info_by_name(m_context, spec_s_name.c_str(), sink_info_callback, this);
+      break;
+    case sink_query::target::INDEX:
+      op = pa_context_get_sink_info_by_index(m_context, m_index, sink_info_callback, this);
+      break;
+  }
+
+  if (op != nullptr) {
+    pa_operation_unref(op);
+  } else {
+    m_query.abort();
   }
-  pa_threaded_mainloop_signal(This->m_mainloop, 0);
 }
 
 /**
@@ -244,49 +240,75 @@ void pulseaudio::subscribe_callback(pa_context *, pa_subscription_event_type_t t
     case PA_SUBSCRIPTION_EVENT_SERVER:
       switch(t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) {
         case PA_SUBSCRIPTION_EVENT_CHANGE:
-          This->m_events.emplace(evtype::SERVER);
+          // the default sink may have changed
+          if (This->s_name != This->spec_s_name)
+            This->query_sink(true);
         break;
       }
       break;
     case PA_SUBSCRIPTION_EVENT_SINK:
       switch(t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) {
         case PA_SUBSCRIPTION_EVENT_NEW:
-            This->m_events.emplace(evtype::NEW);
+          // try to get specified sink
+          if (!This->spec_s_name.empty() && This->s_name != This->spec_s_name)
+            This->query_sink(true);
           break;
         case PA_SUBSCRIPTION_EVENT_CHANGE:
           if (idx == This->m_index)
-            This->m_events.emplace(evtype::CHANGE);
+            This->query_sink();
           break;
         case PA_SUBSCRIPTION_EVENT_REMOVE:
           if (idx == This->m_index)
-            This->m_events.emplace(evtype::REMOVE);
+            This->query_sink(true);
           break;
       }
       break;
   }
-  pa_threaded_mainloop_signal(This->m_mainloop, 0);
 }
 
 /**
  * Simple callback to check for success
  */
 void pulseaudio::simple_callback(pa_context *, int success, void *userdata) {
-  pulseaudio *This = static_cast<pulseaudio *>(userdata);
-  This->success = success;
-  pa_threaded_mainloop_signal(This->m_mainloop, 0);
+  auto result = static_cast<operation_result *>(userdata);
+  result->success = success;
+  pa_threaded_mainloop_signal(result->mainloop, 0);
 }
 
 
 /**
- * Callback when getting sink info & existence
+ * Callback when getting sink info & existence, completes the current query
  */
 void pulseaudio::sink_info_callback(pa_context *, const pa_sink_info *info, int eol, void *userdata) {
   pulseaudio *This = static_cast<pulseaudio *>(userdata);
+
   if (!eol && info) {
+    This->m_query.found();
     This->m_index = info->index;
-    This->s_name = info->name;
+    This->cv = info->volume;
+    // alternatively, user pa_cvolume_avg_mask() to average selected channels
+    This->m_volume = static_cast<int>(pa_cvolume_max(&info->volume) * 100.0f / PA_VOLUME_NORM + 0.5f);
+    This->m_muted = info->mute;
+
+    if (This->s_name != info->name) {
+      This->s_name = info->name;
+      if (This->spec_s_name != This->s_name)
+        This->m_log.warn("pulseaudio: using default sink %s", This->s_name);
+      else
+        This->m_log.trace("pulseaudio: using sink %s", This->s_name);
+    }
+    return;
   }
+
+  bool notify{false};
+  auto next = This->m_query.complete(notify);
+
   pa_threaded_mainloop_signal(This->m_mainloop, 0);
+
+  if (notify)
+    This->m_subscribers.notify();
+
+  This->send_query(next);
 }
 
 /**
@@ -309,10 +331,86 @@ void pulseaudio::context_state_callback(pa_context *context, void *userdata) {
   }
 }
 
-inline void pulseaudio::wait_loop(pa_operation *op, pa_threaded_mainloop *loop) {
+/**
+ * Request a query of the sink
+ *
+ * @return The query to send now, or NONE if one is already in flight
+ */
+sink_query::target sink_query::request(bool lookup, bool use_default) {
+  m_lookup = m_lookup || lookup;
+
+  if (m_querying) {
+    m_requery = true;
+    return target::NONE;
+  }
+
+  m_querying = true;
+  m_found = false;
+  m_default = m_lookup && (use_default || !m_named);
+
+  target result{m_default ? target::DEFAULT : m_lookup ? target::NAME : target::INDEX};
+  m_lookup = false;
+  return result;
+}
+
+/**
+ * Drop the query in flight, used if it could not be sent
+ */
+void sink_query::abort() {
+  m_querying = false;
+}
+
+/**
+ * Record that the query in flight returned the sink
+ */
+void sink_query::found() {
+  m_found = true;
+}
+
+/**
+ * Complete the query in flight
+ *
+ * If the sink was not found, the default sink is looked up next.
+ * Otherwise the merged follow-up query is sent, if there is one
+ *
+ * @param notify Set if the sink was found and its state should be reported
+ * @return The query to send next
+ */
+sink_query::target sink_query::complete(bool& notify) {
+  m_querying = false;
+  notify = false;
+
+  // fall back to the default sink if the sink does not exist (anymore)
+  if (!m_found && !m_default) {
+    return request(true, true);
+  }
+
+  notify = m_found;
+
+  if (m_requery) {
+    m_requery = false;
+    return request();
+  }
+
+  return target::NONE;
+}
+
+bool sink_query::querying() const {
+  return m_querying;
+}
+
+/**
+ * Wait for an operation to complete, with the mainloop locked
+ *
+ * @return The success reported by the operation, false if it could not be sent
+ */
+inline bool pulseaudio::wait_loop(pa_operation *op, operation_result& result) {
+  if (op == nullptr)
+    return false;
   while (pa_operation_get_state(op) != PA_OPERATION_DONE)
-    pa_threaded_mainloop_wait(loop);
+    pa_threaded_mainloop_wait(result.mainloop);
   pa_operation_unref(op);
+  return result.success != 0;
 }
 
 POLYBAR_NS_END
@@ -36,7 +36,7 @@ using namespace signals::ui;
 /**
  * Create instance
  */
-bar::make_type bar::make(bool only_initialize_values) {
+bar::make_type bar::make(string section, bool only_initialize_values) {
   // clang-format off
   return factory_util::unique<bar>(
         connection::make(),
@@ -47,6 +47,7 @@ bar::make_type bar::make(bool only_initialize_values) {
         tray_manager::make(),
         parser::make(),
         taskqueue::make(),
+        move(section),
         only_initialize_values);
   // clang-format on
 }
@@ -58,7 +59,7 @@ bar::make_type bar::make(bool only_initialize_values) {
  */
 bar::bar(connection& conn, signal_emitter& emitter, const config& config, const logger& logger,
     unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager, unique_ptr<parser>&& parser,
-    unique_ptr<taskqueue>&& taskqueue, bool only_initialize_values)
+    unique_ptr<taskqueue>&& taskqueue, string&& section, bool only_initialize_values)
     : m_connection(conn)
     , m_sig(emitter)
     , m_conf(config)
@@ -67,7 +68,12 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
     , m_tray(forward<decltype(tray_manager)>(tray_manager))
     , m_parser(forward<decltype(parser)>(parser))
     , m_taskqueue(forward<decltype(taskqueue)>(taskqueue)) {
-  string bs{m_conf.section()};
+  m_opts.section = section.empty() ? m_conf.section() : move(section);
+  string bs{m_opts.section};
+
+  if (!m_conf.has_section(bs)) {
+    throw application_error("Undefined bar: " + bs.substr(4));
+  }
 
   // Get available RandR outputs
   auto monitor_name = m_conf.get(bs, "monitor", ""s);
@@ -150,20 +156,13 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
   // Load configuration values
   m_opts.origin = m_conf.get(bs, "bottom", false) ? edge::BOTTOM : edge::TOP;
   m_opts.spacing = m_conf.get(bs, "spacing", m_opts.spacing);
-  m_opts.separator = m_conf.get(bs, "separator", ""s);
   m_opts.locale = m_conf.get(bs, "locale", ""s);
 
   auto radius = m_conf.get<double>(bs, "radius", 0.0);
   m_opts.radius.top = m_conf.get(bs, "radius-top", radius);
   m_opts.radius.bottom = m_conf.get(bs, "radius-bottom", radius);
 
-  auto padding = m_conf.get<unsigned int>(bs, "padding", 0U);
-  m_opts.padding.left = m_conf.get(bs, "padding-left", padding);
-  m_opts.padding.right = m_conf.get(bs, "padding-right", padding);
-
-  auto margin = m_conf.get<unsigned int>(bs, "module-margin", 0U);
-  m_opts.module_margin.left = m_conf.get(bs, "module-margin-left", margin);
-  m_opts.module_margin.right = m_conf.get(bs, "module-margin-right", margin);
+  load_layout();
 
   if (only_initialize_values) {
     return;
@@ -243,10 +242,10 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
   m_opts.borders[edge::RIGHT].color = parse_or_throw("border-right-color", border_color);
 
   // Load geometry values
-  auto w = m_conf.get(m_conf.section(), "width", "100%"s);
-  auto h = m_conf.get(m_conf.section(), "height", "24"s);
-  auto offsetx = m_conf.get(m_conf.section(), "offset-x", ""s);
-  auto offsety = m_conf.get(m_conf.section(), "offset-y", ""s);
+  auto w = m_conf.get(bs, "width", "100%"s);
+  auto h = m_conf.get(bs, "height", "24"s);
+  auto offsetx = m_conf.get(bs, "offset-x", ""s);
+  auto offsety = m_conf.get(bs, "offset-y", ""s);
 
   m_opts.size.w = geom_format_to_pixels(w, m_opts.monitor->w);
   m_opts.size.h = geom_format_to_pixels(h, m_opts.monitor->h);;
@@ -300,6 +299,30 @@ bar::~bar() {
   m_sig.detach(this);
 }
 
+/**
+ * Apply changed parameters of the bar section in place
+ *
+ * Only the values used to lay out the module contents can be changed
+ * without recreating the window. Returns false if any of the given
+ * keys requires a restart
+ */
+bool bar::reload(const std::set<string>& keys) {
+  static const std::set<string> layout_keys{"modules-left", "modules-center", "modules-right", "separator",
+      "padding", "padding-left", "padding-right", "module-margin", "module-margin-left", "module-margin-right"};
+
+  for (auto&& key : keys) {
+    if (layout_keys.find(key) == layout_keys.end()) {
+      m_log.info("bar: Parameter `%s` changed, restart required", key);
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(m_mutex);
+  load_layout();
+  m_lastinput.clear();
+  return true;
+}
+
 /**
  * Get the bar settings container
  */
@@ -373,6 +396,23 @@ void bar::parse(string&& data, bool force) {
   m_dblclicks = check_dblclicks();
 }
 
+/**
+ * Load the separator, padding and margins placed around module contents
+ */
+void bar::load_layout() {
+  const string& bs{m_opts.section};
+
+  m_opts.separator = m_conf.get(bs, "separator", ""s);
+
+  auto padding = m_conf.get<unsigned int>(bs, "padding", 0U);
+  m_opts.padding.left = m_conf.get(bs, "padding-left", padding);
+  m_opts.padding.right = m_conf.get(bs, "padding-right", padding);
+
+  auto margin = m_conf.get<unsigned int>(bs, "module-margin", 0U);
+  m_opts.module_margin.left = m_conf.get(bs, "module-margin-left", margin);
+  m_opts.module_margin.right = m_conf.get(bs, "module-margin-right", margin);
+}
+
 /**
  * Hide the bar by unmapping its X window
  */
@@ -432,7 +472,7 @@ void bar::restack_window() {
   string wm_restack;
 
   try {
-    wm_restack = m_conf.get(m_conf.section(), "wm-restack");
+    wm_restack = m_conf.get(m_opts.section, "wm-restack");
   } catch (const key_error& err) {
     return;
   }
@@ -554,7 +594,11 @@ void bar::handle(const evt::destroy_notify& evt) {
  * Used to brighten the window by setting the
  * _NET_WM_WINDOW_OPACITY atom value
  */
-void bar::handle(const evt::enter_notify&) {
+void bar::handle(const evt::enter_notify& evt) {
+  if (evt->event != m_opts.window) {
+    return;
+  }
+
 #if 0
 #ifdef DEBUG_SHADED
   if (m_opts.origin == edge::TOP) {
@@ -566,7 +610,7 @@ void bar::handle(const evt::enter_notify&) {
   if (m_opts.dimmed) {
     m_taskqueue->defer_unique("window-dim", 25ms, [&](size_t) {
       m_opts.dimmed = false;
-      m_sig.emit(dim_window{1.0});
+      dim(1.0);
     });
   } else if (m_taskqueue->exist("window-dim")) {
     m_taskqueue->purge("window-dim");
@@ -579,7 +623,11 @@ void bar::handle(const evt::enter_notify&) {
  * Used to dim the window by setting the
  * _NET_WM_WINDOW_OPACITY atom value
  */
-void bar::handle(const evt::leave_notify&) {
+void bar::handle(const evt::leave_notify& evt) {
+  if (evt->event != m_opts.window) {
+    return;
+  }
+
 #if 0
 #ifdef DEBUG_SHADED
   if (m_opts.origin == edge::TOP) {
@@ -591,7 +639,7 @@ void bar::handle(const evt::leave_notify&) {
   if (!m_opts.dimmed) {
     m_taskqueue->defer_unique("window-dim", 3s, [&](size_t) {
       m_opts.dimmed = true;
-      m_sig.emit(dim_window{double(m_opts.dimvalue)});
+      dim(m_opts.dimvalue);
     });
   }
 }
@@ -602,7 +650,7 @@ void bar::handle(const evt::leave_notify&) {
  * Used to change the cursor depending on the module
  */
 void bar::handle(const evt::motion_notify& evt) {
-  if (!m_mutex.try_lock()) {
+  if (evt->event != m_opts.window || !m_mutex.try_lock()) {
     return;
   }
 
@@ -617,7 +665,7 @@ void bar::handle(const evt::motion_notify& evt) {
     if (!m_opts.cursor_click.empty() && !(action.button == mousebtn::SCROLL_UP || action.button == mousebtn::SCROLL_DOWN || action.button == mousebtn::NONE)) {
       if (!string_util::compare(m_opts.cursor, m_opts.cursor_click)) {
         m_opts.cursor = m_opts.cursor_click;
-        m_sig.emit(cursor_change{string{m_opts.cursor}});
+        on(cursor_change{string{m_opts.cursor}});
       }
       return true;
     } else if (!m_opts.cursor_scroll.empty() && (action.button == mousebtn::SCROLL_UP || action.button == mousebtn::SCROLL_DOWN)) {
@@ -638,7 +686,7 @@ void bar::handle(const evt::motion_notify& evt) {
   if(found_scroll) {
     if (!string_util::compare(m_opts.cursor, m_opts.cursor_scroll)) {
       m_opts.cursor = m_opts.cursor_scroll;
-      m_sig.emit(cursor_change{string{m_opts.cursor}});
+      on(cursor_change{string{m_opts.cursor}});
     }
     return;
   }
@@ -652,14 +700,14 @@ void bar::handle(const evt::motion_notify& evt) {
   if(found_scroll) {
     if (!string_util::compare(m_opts.cursor, m_opts.cursor_scroll)) {
       m_opts.cursor = m_opts.cursor_scroll;
-      m_sig.emit(cursor_change{string{m_opts.cursor}});
+      on(cursor_change{string{m_opts.cursor}});
     }
     return;
   }
   if (!string_util::compare(m_opts.cursor, "default")) {
     m_log.trace("No matching cursor area found");
     m_opts.cursor = "default";
-    m_sig.emit(cursor_change{string{m_opts.cursor}});
+    on(cursor_change{string{m_opts.cursor}});
     return;
   }
 #endif
@@ -671,7 +719,7 @@ void bar::handle(const evt::motion_notify& evt) {
  * Used to map mouse clicks to bar actions
  */
 void bar::handle(const evt::button_press& evt) {
-  if (!m_mutex.try_lock()) {
+  if (evt->event != m_opts.window || !m_mutex.try_lock()) {
     return;
   }
 
@@ -816,7 +864,8 @@ bool bar::on(const signals::eventqueue::start&) {
 
   broadcast_visibility();
 
-  return true;
+  // let the event reach the other bars
+  return false;
 }
 
 bool bar::on(const signals::ui::unshade_window&) {
@@ -833,14 +882,14 @@ bool bar::on(const signals::ui::unshade_window&) {
   m_taskqueue->defer_unique("window-shade", 25ms,
       [&](size_t remaining) {
         if (!m_opts.shaded) {
-          m_sig.emit(signals::ui::tick{});
+          on(signals::ui::tick{});
         }
         if (!remaining) {
           m_renderer->flush();
         }
         if (m_opts.dimmed) {
           m_opts.dimmed = false;
-          m_sig.emit(dim_window{1.0});
+          dim(1.0);
         }
       },
       taskqueue::deferred::duration{25ms}, 10U);
@@ -872,14 +921,14 @@ bool bar::on(const signals::ui::shade_window&) {
   m_taskqueue->defer_unique("window-shade", 25ms,
       [&](size_t remaining) {
         if (m_opts.shaded) {
-          m_sig.emit(signals::ui::tick{});
+          on(signals::ui::tick{});
         }
         if (!remaining) {
           m_renderer->flush();
         }
         if (!m_opts.dimmed) {
           m_opts.dimmed = true;
-          m_sig.emit(dim_window{double{m_opts.dimvalue}});
+          dim(m_opts.dimvalue);
         }
       },
       move(offset), 10U);
@@ -921,6 +970,20 @@ bool bar::on(const signals::ui::tick&) {
   return false;
 }
 
+/**
+ * Change the opacity of the bar window
+ *
+ * The signal is handled directly instead of being emitted since other
+ * bars share the emitter. Only the tray placed in this bar follows
+ */
+void bar::dim(double value) {
+  on(dim_window{value});
+
+  if (m_tray && m_tray->settings().running) {
+    m_sig.emit(dim_window{value});
+  }
+}
+
 bool bar::on(const signals::ui::dim_window& sig) {
   m_opts.dimmed = sig.cast() != 1.0;
   ewmh_util::set_wm_window_opacity(m_opts.window, sig.cast() * 0xFFFFFFFF);
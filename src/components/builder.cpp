@@ -8,23 +8,7 @@
 #include "utils/time.hpp"
 POLYBAR_NS
 
-#ifndef BUILDER_SPACE_TOKEN
-#define BUILDER_SPACE_TOKEN "%__"
-#endif
-
-builder::builder(const bar_settings& bar) : m_bar(bar) {
-  m_tags[syntaxtag::A] = 0;
-  m_tags[syntaxtag::B] = 0;
-  m_tags[syntaxtag::F] = 0;
-  m_tags[syntaxtag::T] = 0;
-  m_tags[syntaxtag::o] = 0;
-  m_tags[syntaxtag::u] = 0;
-
-  m_colors[syntaxtag::B] = string();
-  m_colors[syntaxtag::F] = string();
-  m_colors[syntaxtag::o] = string();
-  m_colors[syntaxtag::u] = string();
-}
+builder::builder(const bar_settings& bar) : m_bar(bar) {}
 
 /**
  * Flush contents of the builder and return built string
@@ -32,19 +16,31 @@ builder::builder(const bar_settings& bar) : m_bar(bar) {
  * This will also close any unclosed tags
  */
 string builder::flush() {
-  if (m_tags[syntaxtag::B]) {
+  string output;
+  flush(output);
+  return output;
+}
+
+/**
+ * Flush contents of the builder into the given output buffer
+ *
+ * The buffers are swapped so that both the builder and the
+ * caller can keep reusing their allocated storage
+ */
+void builder::flush(string& output) {
+  if (m_tags[static_cast<size_t>(syntaxtag::B)]) {
     background_close();
   }
-  if (m_tags[syntaxtag::F]) {
+  if (m_tags[static_cast<size_t>(syntaxtag::F)]) {
     color_close();
   }
-  if (m_tags[syntaxtag::T]) {
+  if (m_tags[static_cast<size_t>(syntaxtag::T)]) {
     font_close();
   }
-  if (m_tags[syntaxtag::o]) {
+  if (m_tags[static_cast<size_t>(syntaxtag::o)]) {
     overline_color_close();
   }
-  if (m_tags[syntaxtag::u]) {
+  if (m_tags[static_cast<size_t>(syntaxtag::u)]) {
     underline_color_close();
   }
   if ((m_attributes >> static_cast<int>(attribute::UNDERLINE)) & 1) {
@@ -54,27 +50,24 @@ string builder::flush() {
     overline_close();
   }
 
-  while (m_tags[syntaxtag::A]) {
+  while (m_tags[static_cast<size_t>(syntaxtag::A)]) {
     cmd_close();
   }
 
-  string output{m_output};
+  output.swap(m_output);
 
   // reset values
-  m_tags.clear();
-  m_colors.clear();
+  m_tags.fill(0);
+  m_colors.fill(0U);
   m_output.clear();
   m_fontindex = 1;
-
-  return string_util::replace_all(output, BUILDER_SPACE_TOKEN, " ");
 }
 
 /**
  * Insert raw text string
  */
-void builder::append(string text) {
-  m_output.reserve(text.size());
-  m_output += move(text);
+void builder::append(const string& text) {
+  m_output += text;
 }
 
 /**
@@ -82,106 +75,38 @@ void builder::append(string text) {
  *
  * This will also parse raw syntax tags
  */
-void builder::node(string str, bool add_space) {
+void builder::node(const string& str, bool add_space) {
   if (str.empty()) {
     return;
   }
 
-  string::size_type n, m;
-  string s(move(str));
+  size_t pos{0}, end{str.size()};
 
-  if ((n = s.size()) > 2 && s[0] == '"' && s[n - 1] == '"') {
-    s = s.substr(1, n - 2);
+  if (end > 2 && str[0] == '"' && str[end - 1] == '"') {
+    pos++;
+    end--;
   }
 
-  while (true) {
-    if (s.empty()) {
+  while (pos < end) {
+    size_t n{str.find("%{", pos)};
+    if (n == string::npos || n >= end) {
+      m_output.append(str, pos, end - pos);
       break;
+    } else if (n > pos) {
+      m_output.append(str, pos, n - pos);
+      pos = n;
+    }
 
-    } else if ((n = s.find("%{F-}")) == 0) {
-      color_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{F#")) == 0 && (m = s.find('}')) != string::npos) {
-      if (m - n - 4 == 2) {
-        color_alpha(s.substr(n + 3, m - 3));
-      } else {
-        color(s.substr(n + 3, m - 3));
-      }
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{B-}")) == 0) {
-      background_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{B#")) == 0 && (m = s.find('}')) != string::npos) {
-      background(s.substr(n + 3, m - 3));
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{T-}")) == 0) {
-      font_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{T")) == 0 && (m = s.find('}')) != string::npos) {
-      font(strtol(s.substr(n + 3, m - 3).c_str(), nullptr, 10));
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{U-}")) == 0) {
-      line_color_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{u-}")) == 0) {
-      underline_color_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{o-}")) == 0) {
-      overline_color_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{u#")) == 0 && (m = s.find('}')) != string::npos) {
-      underline_color(s.substr(n + 3, m - 3));
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{o#")) == 0 && (m = s.find('}')) != string::npos) {
-      overline_color(s.substr(n + 3, m - 3));
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{U#")) == 0 && (m = s.find('}')) != string::npos) {
-      line_color(s.substr(n + 3, m - 3));
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{+u}")) == 0) {
-      underline();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{+o}")) == 0) {
-      overline();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{-u}")) == 0) {
-      underline_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{-o}")) == 0) {
-      overline_close();
-      s.erase(0, 5);
-
-    } else if ((n = s.find("%{")) == 0 && (m = s.find('}')) != string::npos) {
-      append(s.substr(n, m + 1));
-      s.erase(n, m + 1);
-
-    } else if ((n = s.find("%{")) > 0) {
-      append(s.substr(0, n));
-      s.erase(0, n);
-
-    } else {
+    size_t m{str.find('}', pos)};
+    if (m == string::npos || m >= end) {
+      m_output.append(str, pos, end - pos);
       break;
     }
-  }
 
-  if (!s.empty()) {
-    append(s);
+    codeblock(str, pos + 2, m);
+    pos = m + 1;
   }
+
   if (add_space) {
     space();
   }
@@ -192,46 +117,103 @@ void builder::node(string str, bool add_space) {
  *
  * @see builder::node
  */
-void builder::node(string str, int font_index, bool add_space) {
+void builder::node(const string& str, int font_index, bool add_space) {
   font(font_index);
-  node(move(str), add_space);
+  node(str, add_space);
   font_close();
 }
 
+/**
+ * Process raw syntax tag found at str[start - 2, end], i.e: %{...}
+ */
+void builder::codeblock(const string& str, size_t start, size_t end) {
+  size_t len{end - start};
+  char tag{len > 0 ? str[start] : '\0'};
+  char value{len > 1 ? str[start + 1] : '\0'};
+
+  if (len == 2 && value == '-' && tag == 'F') {
+    color_close();
+  } else if (len == 2 && value == '-' && tag == 'B') {
+    background_close();
+  } else if (len == 2 && value == '-' && tag == 'T') {
+    font_close();
+  } else if (len == 2 && value == '-' && tag == 'U') {
+    line_color_close();
+  } else if (len == 2 && value == '-' && tag == 'u') {
+    underline_color_close();
+  } else if (len == 2 && value == '-' && tag == 'o') {
+    overline_color_close();
+  } else if (len == 2 && tag == '+' && value == 'u') {
+    underline();
+  } else if (len == 2 && tag == '+' && value == 'o') {
+    overline();
+  } else if (len == 2 && tag == '-' && value == 'u') {
+    underline_close();
+  } else if (len == 2 && tag == '-' && value == 'o') {
+    overline_close();
+  } else if (value == '#' && tag == 'F' && len == 4) {
+    color_alpha(str.substr(start + 1, len - 1));
+  } else if (value == '#' && tag == 'F') {
+    color(str.substr(start + 1, len - 1));
+  } else if (value == '#' && tag == 'B') {
+    background(str.substr(start + 1, len - 1));
+  } else if (value == '#' && tag == 'u') {
+    underline_color(str.substr(start + 1, len - 1));
+  } else if (value == '#' && tag == 'o') {
+    overline_color(str.substr(start + 1, len - 1));
+  } else if (value == '#' && tag == 'U') {
+    line_color(str.substr(start + 1, len - 1));
+  } else if (tag == 'T') {
+    font(strtol(&str[start + 1], nullptr, 10));
+  } else {
+    m_output.append(str, start - 2, len + 3);
+  }
+}
+
 /**
  * Insert tags for given label
  */
 void builder::node(const label_t& label, bool add_space) {
-  if (!label || !*label) {
-    return;
-  }
+  node_repeat(label, 1, add_space);
+}
 
-  string text{label->get()};
+/**
+ * Repeat text string n times
+ */
+void builder::node_repeat(const string& str, size_t n, bool add_space) {
+  while (n--) {
+    node(str);
+  }
+  if (add_space) {
+    space();
+  }
+}
 
-  if (label->m_maxlen > 0 && string_util::char_len(text) > label->m_maxlen) {
-    text = string_util::utf8_truncate(std::move(text), label->m_maxlen) + "...";
+/**
+ * Repeat label contents n times
+ */
+void builder::node_repeat(const label_t& label, size_t n, bool add_space) {
+  if (!label || !*label || n == 0) {
+    return;
   }
 
-  // if ((label->m_overline.empty() && m_tags[syntaxtag::o] > 0) || (m_tags[syntaxtag::o] > 0 && label->m_margin > 0))
-  //   overline_close();
-  // if ((label->m_underline.empty() && m_tags[syntaxtag::u] > 0) || (m_tags[syntaxtag::u] > 0 && label->m_margin > 0))
-  //   underline_close();
+  const string& text{label->get()};
 
   if (label->m_margin.left > 0) {
     space(label->m_margin.left);
   }
 
-  if (!label->m_overline.empty()) {
+  if (label->m_overline) {
     overline(label->m_overline);
   }
-  if (!label->m_underline.empty()) {
+  if (label->m_underline) {
     underline(label->m_underline);
   }
 
-  if (!label->m_background.empty()) {
+  if (label->m_background) {
     background(label->m_background);
   }
-  if (!label->m_foreground.empty()) {
+  if (label->m_foreground) {
     color(label->m_foreground);
   }
 
@@ -239,23 +221,44 @@ void builder::node(const label_t& label, bool add_space) {
     space(label->m_padding.left);
   }
 
-  node(text, label->m_font, add_space);
+  font(label->m_font);
+
+  if (label->m_maxlen > 0 && string_util::char_len(text) * n > label->m_maxlen) {
+    string repeated;
+    repeated.reserve(text.size() * n);
+    while (n--) {
+      repeated += text;
+    }
+    node(string_util::utf8_truncate(move(repeated), label->m_maxlen) + "...");
+  } else {
+    while (n--) {
+      node(text);
+    }
+  }
+
+  if (add_space) {
+    space();
+  }
+
+  font_close();
 
   if (label->m_padding.right > 0) {
     space(label->m_padding.right);
   }
 
-  if (!label->m_background.empty()) {
+  if (label->m_background) {
     background_close();
   }
-  if (!label->m_foreground.empty()) {
+  if (label->m_foreground) {
     color_close();
   }
 
-  if (!label->m_underline.empty() || (label->m_margin.right > 0 && m_tags[syntaxtag::u] > 0)) {
+  if (label->m_underline ||
+      (label->m_margin.right > 0 && m_tags[static_cast<size_t>(syntaxtag::u)] > 0)) {
     underline_close();
   }
-  if (!label->m_overline.empty() || (label->m_margin.right > 0 && m_tags[syntaxtag::o] > 0)) {
+  if (label->m_overline ||
+      (label->m_margin.right > 0 && m_tags[static_cast<size_t>(syntaxtag::o)] > 0)) {
     overline_close();
   }
 
@@ -264,33 +267,6 @@ void builder::node(const label_t& label, bool add_space) {
   }
 }
 
-/**
- * Repeat text string n times
- */
-void builder::node_repeat(const string& str, size_t n, bool add_space) {
-  string text;
-  text.reserve(str.size() * n);
-  while (n--) {
-    text += str;
-  }
-  node(text, add_space);
-}
-
-/**
- * Repeat label contents n times
- */
-void builder::node_repeat(const label_t& label, size_t n, bool add_space) {
-  string text;
-  string label_text{label->get()};
-  text.reserve(label_text.size() * n);
-  while (n--) {
-    text += label_text;
-  }
-  label_t tmp{new label_t::element_type{text}};
-  tmp->replace_defined_values(label);
-  node(tmp, add_space);
-}
-
 /**
  * Insert tag that will offset the contents by given pixels
  */
@@ -321,7 +297,7 @@ void builder::space() {
 void builder::remove_trailing_space(size_t len) {
   if (len == 0_z || len > m_output.size()) {
     return;
-  } else if (m_output.substr(m_output.size() - len) == string(len, ' ')) {
+  } else if (m_output.find_first_not_of(' ', m_output.size() - len) == string::npos) {
     m_output.erase(m_output.size() - len);
   }
 }
@@ -351,66 +327,65 @@ void builder::font_close() {
 /**
  * Insert tag to alter the current background color
  */
-void builder::background(string color) {
-  if (color.length() == 2 || (color.find('#') == 0 && color.length() == 3)) {
-    string bg{background_hex()};
-    color = "#" + color.substr(color.length() - 2);
-    color += bg.substr(bg.length() - (bg.length() < 6 ? 3 : 6));
-  }
+void builder::background(const string& color) {
+  background(color_util::parse_argb(color));
+}
 
-  color = color_util::simplify_hex(color);
-  m_colors[syntaxtag::B] = color;
-  tag_open(syntaxtag::B, color);
+/**
+ * Insert tag to alter the current background color
+ *
+ * Alpha-only colors are applied to the default background
+ */
+void builder::background(const argb& color) {
+  if (!color) {
+    return;
+  }
+  unsigned int value{color.resolve(m_bar.background)};
+  m_colors[static_cast<size_t>(syntaxtag::B)] = value;
+  tag_open(syntaxtag::B, value);
 }
 
 /**
  * Insert tag to reset the background color
  */
 void builder::background_close() {
-  m_colors[syntaxtag::B].clear();
+  m_colors[static_cast<size_t>(syntaxtag::B)] = 0U;
   tag_close(syntaxtag::B);
 }
 
 /**
  * Insert tag to alter the current foreground color
  */
-void builder::color(string color) {
-  if (color.length() == 2 || (color[0] == '#' && color.length() == 3)) {
-    string fg{foreground_hex()};
-    if (!fg.empty()) {
-      color = "#" + color.substr(color.length() - 2);
-      color += fg.substr(fg.length() - (fg.length() < 6 ? 3 : 6));
-    }
-  }
+void builder::color(const string& color) {
+  this->color(color_util::parse_argb(color));
+}
 
-  color = color_util::simplify_hex(color);
-  m_colors[syntaxtag::F] = color;
-  tag_open(syntaxtag::F, color);
+/**
+ * Insert tag to alter the current foreground color
+ *
+ * Alpha-only colors are applied to the default foreground
+ */
+void builder::color(const argb& color) {
+  if (!color) {
+    return;
+  }
+  unsigned int value{color.resolve(m_bar.foreground)};
+  m_colors[static_cast<size_t>(syntaxtag::F)] = value;
+  tag_open(syntaxtag::F, value);
 }
 
 /**
  * Insert tag to alter the alpha value of the default foreground color
  */
-void builder::color_alpha(string alpha) {
-  if (alpha.find('#') == string::npos) {
-    alpha = "#" + alpha;
-  }
-  if (alpha.size() == 4) {
-    color(alpha);
-  } else {
-    string val{foreground_hex()};
-    if (val.size() < 6 && val.size() > 2) {
-      val.append(val.substr(val.size() - 3));
-    }
-    color((alpha.substr(0, 3) + val.substr(val.size() - 6)).substr(0, 9));
-  }
+void builder::color_alpha(const string& alpha) {
+  color(color_util::parse_argb(alpha));
 }
 
 /**
  * Insert tag to reset the foreground color
  */
 void builder::color_close() {
-  m_colors[syntaxtag::F].clear();
+  m_colors[static_cast<size_t>(syntaxtag::F)] = 0U;
   tag_close(syntaxtag::F);
 }
 
@@ -418,6 +393,13 @@ void builder::color_close() {
  * Insert tag to alter the current overline/underline color
  */
 void builder::line_color(const string& color) {
+  line_color(color_util::parse_argb(color));
+}
+
+/**
+ * Insert tag to alter the current overline/underline color
+ */
+void builder::line_color(const argb& color) {
   overline_color(color);
   underline_color(color);
 }
@@ -433,10 +415,20 @@ void builder::line_color_close() {
 /**
  * Insert tag to alter the current overline color
  */
-void builder::overline_color(string color) {
-  color = color_util::simplify_hex(color);
-  m_colors[syntaxtag::o] = color;
-  tag_open(syntaxtag::o, color);
+void builder::overline_color(const string& color) {
+  overline_color(color_util::parse_argb(color));
+}
+
+/**
+ * Insert tag to alter the current overline color
+ */
+void builder::overline_color(const argb& color) {
+  if (!color) {
+    return;
+  }
+  unsigned int value{color.resolve(m_bar.overline.color)};
+  m_colors[static_cast<size_t>(syntaxtag::o)] = value;
+  tag_open(syntaxtag::o, value);
   tag_open(attribute::OVERLINE);
 }
 
@@ -444,17 +436,27 @@ void builder::overline_color(string color) {
  * Close underline color tag
  */
 void builder::overline_color_close() {
-  m_colors[syntaxtag::o].clear();
+  m_colors[static_cast<size_t>(syntaxtag::o)] = 0U;
   tag_close(syntaxtag::o);
 }
 
 /**
  * Insert tag to alter the current underline color
  */
-void builder::underline_color(string color) {
-  color = color_util::simplify_hex(color);
-  m_colors[syntaxtag::u] = color;
-  tag_open(syntaxtag::u, color);
+void builder::underline_color(const string& color) {
+  underline_color(color_util::parse_argb(color));
+}
+
+/**
+ * Insert tag to alter the current underline color
+ */
+void builder::underline_color(const argb& color) {
+  if (!color) {
+    return;
+  }
+  unsigned int value{color.resolve(m_bar.underline.color)};
+  m_colors[static_cast<size_t>(syntaxtag::u)] = value;
+  tag_open(syntaxtag::u, value);
   tag_open(attribute::UNDERLINE);
 }
 
@@ -463,14 +465,21 @@ void builder::underline_color(string color) {
  */
 void builder::underline_color_close() {
   tag_close(syntaxtag::u);
-  m_colors[syntaxtag::u].clear();
+  m_colors[static_cast<size_t>(syntaxtag::u)] = 0U;
 }
 
 /**
  * Insert tag to enable the overline attribute
  */
 void builder::overline(const string& color) {
-  if (!color.empty()) {
+  overline(color_util::parse_argb(color));
+}
+
+/**
+ * Insert tag to enable the overline attribute
+ */
+void builder::overline(const argb& color) {
+  if (color) {
     overline_color(color);
   } else {
     tag_open(attribute::OVERLINE);
@@ -488,7 +497,14 @@ void builder::overline_close() {
  * Insert tag to enable the underline attribute
  */
 void builder::underline(const string& color) {
-  if (!color.empty()) {
+  underline(color_util::parse_argb(color));
+}
+
+/**
+ * Insert tag to enable the underline attribute
+ */
+void builder::underline(const argb& color) {
+  if (color) {
     underline_color(color);
   } else {
     tag_open(attribute::UNDERLINE);
@@ -505,21 +521,30 @@ void builder::underline_close() {
 /**
  * Open command tag
  */
-void builder::cmd(mousebtn index, string action, bool condition) {
+void builder::cmd(mousebtn index, const string& action, bool condition) {
   if (condition && !action.empty()) {
-    size_t p{0};
-    while ((p = action.find(':', p)) != string::npos && action[p - 1] != '\\') {
-      action.insert(p, 1, '\\');
-      p++;
+    m_tags[static_cast<size_t>(syntaxtag::A)]++;
+
+    m_output += "%{A";
+    m_output += static_cast<char>('0' + static_cast<int>(index));
+    m_output += ':';
+
+    // Escape all unescaped colons in the command
+    for (size_t i = 0; i < action.size(); i++) {
+      if (action[i] == ':' && (i == 0 || action[i - 1] != '\\')) {
+        m_output += '\\';
+      }
+      m_output += action[i];
     }
-    tag_open(syntaxtag::A, to_string(static_cast<int>(index)) + ":" + action + ":");
+
+    m_output += ":}";
   }
 }
 
 /**
  * Wrap label in command block
  */
-void builder::cmd(mousebtn index, string action, const label_t& label) {
+void builder::cmd(mousebtn index, const string& action, const label_t& label) {
   if (label && *label) {
     cmd(index, action, true);
     node(label);
@@ -536,64 +561,50 @@ void builder::cmd_close(bool condition) {
   }
 }
 
-/**
- * Get default background hex string
- */
-string builder::background_hex() {
-  if (m_background.empty()) {
-    m_background = color_util::hex<unsigned short int>(m_bar.background);
-  }
-  return m_background;
-}
-
-/**
- * Get default foreground hex string
- */
-string builder::foreground_hex() {
-  if (m_foreground.empty()) {
-    m_foreground = color_util::hex<unsigned short int>(m_bar.foreground);
-  }
-  return m_foreground;
-}
-
 /**
  * Insert directive to change value of given tag
  */
 void builder::tag_open(syntaxtag tag, const string& value) {
-  if (m_tags.find(tag) == m_tags.end()) {
-    m_tags[tag] = 0;
-  }
-
-  m_tags[tag]++;
+  m_tags[static_cast<size_t>(tag)]++;
 
   switch (tag) {
     case syntaxtag::NONE:
-      break;
+      return;
     case syntaxtag::A:
-      append("%{A" + value + "}");
+      m_output += "%{A";
       break;
     case syntaxtag::F:
-      append("%{F" + value + "}");
+      m_output += "%{F";
       break;
     case syntaxtag::B:
-      append("%{B" + value + "}");
+      m_output += "%{B";
       break;
     case syntaxtag::T:
-      append("%{T" + value + "}");
+      m_output += "%{T";
       break;
     case syntaxtag::u:
-      append("%{u" + value + "}");
+      m_output += "%{u";
       break;
     case syntaxtag::o:
-      append("%{o" + value + "}");
+      m_output += "%{o";
       break;
     case syntaxtag::R:
-      append("%{R}");
-      break;
+      m_output += "%{R}";
+      return;
     case syntaxtag::O:
-      append("%{O" + value + "}");
+      m_output += "%{O";
       break;
   }
+
+  m_output += value;
+  m_output += '}';
+}
+
+/**
+ * Insert directive to change the color of given tag
+ */
+void builder::tag_open(syntaxtag tag, unsigned int color) {
+  tag_open(tag, color_util::simplify_hex(color));
 }
 
 /**
@@ -610,10 +621,10 @@ void builder::tag_open(attribute attr) {
     case attribute::NONE:
       break;
     case attribute::UNDERLINE:
-      append("%{+u}");
+      m_output += "%{+u}";
       break;
     case attribute::OVERLINE:
-      append("%{+o}");
+      m_output += "%{+o}";
       break;
   }
 }
@@ -622,32 +633,32 @@ void builder::tag_open(attribute attr) {
  * Insert directive to reset given tag if it's open and closable
  */
 void builder::tag_close(syntaxtag tag) {
-  if (m_tags.find(tag) == m_tags.end() || !m_tags[tag]) {
+  if (!m_tags[static_cast<size_t>(tag)]) {
     return;
   }
 
-  m_tags[tag]--;
+  m_tags[static_cast<size_t>(tag)]--;
 
   switch (tag) {
     case syntaxtag::NONE:
       break;
     case syntaxtag::A:
-      append("%{A}");
+      m_output += "%{A}";
       break;
     case syntaxtag::F:
-      append("%{F-}");
+      m_output += "%{F-}";
       break;
     case syntaxtag::B:
-      append("%{B-}");
+      m_output += "%{B-}";
       break;
     case syntaxtag::T:
-      append("%{T-}");
+      m_output += "%{T-}";
       break;
     case syntaxtag::u:
-      append("%{u-}");
+      m_output += "%{u-}";
       break;
     case syntaxtag::o:
-      append("%{o-}");
+      m_output += "%{o-}";
       break;
     case syntaxtag::R:
       break;
@@ -670,10 +681,10 @@ void builder::tag_close(attribute attr) {
     case attribute::NONE:
       break;
     case attribute::UNDERLINE:
-      append("%{-u}");
+      m_output += "%{-u}";
       break;
     case attribute::OVERLINE:
-      append("%{-o}");
+      m_output += "%{-o}";
       break;
   }
 }
@@ -1,8 +1,10 @@
+#include <cerrno>
 #include <climits>
-#include <fstream>
+#include <cstring>
 
 #include "cairo/utils.hpp"
 #include "components/config.hpp"
+#include "components/config_snapshot.hpp"
 #include "utils/color.hpp"
 #include "utils/env.hpp"
 #include "utils/factory.hpp"
@@ -12,11 +14,53 @@
 
 POLYBAR_NS
 
+namespace {
+  /**
+   * Add the keys that differ between two section maps to `changes`
+   */
+  void diff_sections(
+      const config::sectionmap_t& prev, const config::sectionmap_t& next, config::changes_t& changes) {
+    static const config::valuemap_t empty;
+
+    for (auto&& section : prev) {
+      auto it = next.find(section.first);
+      const auto& values = it != next.end() ? it->second : empty;
+      for (auto&& param : section.second) {
+        auto value = values.find(param.first);
+        if (value == values.end() || value->second != param.second) {
+          changes[section.first].emplace(param.first);
+        }
+      }
+    }
+
+    for (auto&& section : next) {
+      auto it = prev.find(section.first);
+      const auto& values = it != prev.end() ? it->second : empty;
+      for (auto&& param : section.second) {
+        if (values.find(param.first) == values.end()) {
+          changes[section.first].emplace(param.first);
+        }
+      }
+    }
+  }
+}
+
 /**
  * Create instance
  */
 config::make_type config::make(string path, string bar) {
-  return *factory_util::singleton<std::remove_reference_t<config::make_type>>(logger::make(), move(path), move(bar));
+  return *factory_util::singleton<config>(logger::make(), move(path), move(bar));
+}
+
+/**
+ * Get the instance created by make() with write access
+ *
+ * Only the controller uses this, to reload the config in-process.
+ * Everything else reads the config through make() while it's being
+ * constructed and doesn't keep reading it afterwards
+ */
+config& config::make_mutable() {
+  return *factory_util::singleton<config>(logger::make(), string{}, string{});
 }
 
 /**
@@ -30,18 +74,28 @@ config::config(const logger& logger, string&& path, string&& bar)
 
   m_log.info("Loading config: %s", m_file);
 
-  parse_file();
-  copy_inherited();
+  string snapshot{snapshot_path()};
+  if (snapshot.empty() || !load_snapshot(snapshot)) {
+    parse_file();
+    if (!snapshot.empty()) {
+      save_snapshot(snapshot);
+    }
+  }
 
-  bool found_bar{false};
-  for (auto&& p : m_sections) {
-    if (p.first == section()) {
-      found_bar = true;
-      break;
+#if WITH_XRM
+  // Initialize the xresource manage if there are any xrdb refs
+  // present in the configuration
+  for (size_t i = 0; i < m_table.size() && !m_xrm; i++) {
+    if (m_table.value(i).contains("${xrdb")) {
+      m_xrm.reset(new xresource_manager{connection::make()});
     }
   }
+#endif
+
+  copy_inherited();
+  resolve_references();
 
-  if (!found_bar) {
+  if (!has_section(section())) {
     throw application_error("Undefined bar: " + m_barname);
   }
 
@@ -62,15 +116,40 @@ string config::section() const {
   return "bar/" + m_barname;
 }
 
+/**
+ * Parse the config file again and replace the current values
+ *
+ * Returns the parameters that were added, removed or changed. The
+ * current values are left untouched if the new config fails to load
+ */
+config::changes_t config::reload() {
+  config next{m_log, string{m_file}, string{m_barname}};
+
+  changes_t changes;
+  diff_sections(values(), next.values(), changes);
+  diff_sections(m_invalid, next.m_invalid, changes);
+
+  std::swap(m_table, next.m_table);
+  std::swap(m_overrides, next.m_overrides);
+  std::swap(m_invalid, next.m_invalid);
+  std::swap(m_lists, next.m_lists);
+  std::swap(m_files, next.m_files);
+#if WITH_XRM
+  std::swap(m_xrm, next.m_xrm);
+#endif
+
+  m_log.info("Reloaded config: %s (%lu sections changed)", m_file, changes.size());
+
+  return changes;
+}
+
 /**
  * Print a deprecation warning if the given parameter is set
  */
 void config::warn_deprecated(const string& section, const string& key, string replacement) const {
-  try {
-    auto value = get<string>(section, key);
+  if (has(section, key)) {
     m_log.warn(
         "The config parameter `%s.%s` is deprecated, use `%s.%s` instead.", section, key, section, move(replacement));
-  } catch (const key_error& err) {
   }
 }
 
@@ -78,135 +157,435 @@ void config::warn_deprecated(const string& section, const string& key, string re
  * Parse key/value pairs from the configuration file
  */
 void config::parse_file() {
-  vector<pair<int, string>> lines;
-  vector<string> files{m_file};
+  m_table = config_snapshot::parse(m_file, m_files, m_log);
+}
 
-  std::function<void(int, string&&)> pushline = [&](int lineno, string&& line) {
-    // Ignore empty lines and comments
-    if (line.empty() || line[0] == ';' || line[0] == '#') {
-      return;
+/**
+ * Get the path of the parsed snapshot for the loaded file
+ */
+string config::snapshot_path() const {
+  return config_snapshot::path(m_file);
+}
+
+/**
+ * Map the parsed parameters from a snapshot created by a previous run
+ */
+bool config::load_snapshot(const string& path) {
+  if (!config_snapshot::load(path, m_file, m_files, m_table)) {
+    return false;
+  }
+
+  m_log.trace("config: Using parsed snapshot \"%s\"", path);
+
+  return true;
+}
+
+/**
+ * Store the parsed parameters so that the next run
+ * can skip parsing the unchanged files
+ */
+void config::save_snapshot(const string& path) const {
+  if (!config_snapshot::save(path, m_files, m_table)) {
+    m_log.warn("Failed to write config snapshot \"%s\" (reason: %s)", path, strerror(errno));
+  }
+}
+
+/**
+ * Look for sections set up to inherit from a base section
+ * and copy the missing parameters
+ *
+ *   [sub/seciton]
+ *   inherit = base/section
+ */
+void config::copy_inherited() {
+  for (size_t i = 0; i < m_table.size(); i++) {
+    if (!m_table.key(i).starts_with("inherit")) {
+      continue;
     }
 
-    string key, value;
-    string::size_type pos;
+    // Get name of base section
+    string section{m_table.section(i).str()};
+    string key{m_table.key(i).str()};
+    vector<string> chain{section + "." + key};
+    string inherit{resolve(section, key, m_table.value(i).str(), chain)};
 
-    // Filter lines by:
-    // - key/value pairs
-    // - section headers
-    if ((pos = line.find('=')) != string::npos) {
-      key = forward<string>(string_util::trim(forward<string>(line.substr(0, pos))));
-      value = forward<string>(string_util::trim(line.substr(pos + 1)));
-    } else if (line[0] != '[' || line[line.length() - 1] != ']') {
-      return;
+    if (inherit.empty()) {
+      throw value_error("Invalid section \"\" defined for \"" + section + ".inherit\"");
+    } else if (!has_section(inherit)) {
+      throw value_error("Invalid section \"" + inherit + "\" defined for \"" + section + ".inherit\"");
     }
 
-    if (key == "include-file") {
-      auto file_path = file_util::expand(value);
-      if (file_path.empty() || !file_util::exists(file_path)) {
-        throw value_error("Invalid include file \"" + file_path + "\" defined on line " + to_string(lineno));
-      }
-      if (std::find(files.begin(), files.end(), file_path) != files.end()) {
-        throw value_error("Recursive include file \"" + file_path + "\"");
+    m_log.trace("config: Copying missing params (sub=\"%s\", base=\"%s\")", section, inherit);
+
+    // Iterate the base and copy the parameters
+    // that hasn't been defined for the sub-section
+    auto& values = m_overrides[section];
+    auto copy = [&](const string& name, string&& value) {
+      if (m_table.find(section, name) == nullptr) {
+        values.emplace(name, forward<string>(value));
       }
-      files.push_back(file_util::expand(file_path));
-      m_log.trace("config: Including file \"%s\"", file_path);
-      for (auto&& l : string_util::split(file_util::contents(file_path), '\n')) {
-        pushline(lineno, forward<string>(l));
+    };
+
+    auto base = m_table.range(inherit);
+    for (size_t j = base.first; j < base.second; j++) {
+      copy(m_table.key(j).str(), m_table.value(j).str());
+    }
+
+    auto base_overrides = m_overrides.find(inherit);
+    if (base_overrides != m_overrides.end() && inherit != section) {
+      for (auto&& param : base_overrides->second) {
+        copy(param.first, string{param.second});
       }
-      files.pop_back();
-    } else {
-      lines.emplace_back(make_pair(lineno, line));
     }
-  };
+  }
+}
 
-  int lineno{0};
-  string line;
-  std::ifstream in(m_file);
-  while (std::getline(in, line)) {
-    pushline(++lineno, string_util::replace_all(line, "\t", ""));
+/**
+ * Resolve all value references once so that lookups
+ * don't need to dereference anything
+ *
+ * Parameters whose reference can't be resolved are moved
+ * apart and only raise an error when they are requested
+ */
+void config::resolve_references() {
+  vector<pair<string, string>> references;
+
+  for (size_t i = 0; i < m_table.size(); i++) {
+    if (is_reference(m_table.value(i))) {
+      references.emplace_back(m_table.section(i).str(), m_table.key(i).str());
+    }
   }
 
-  string section;
-  for (auto&& l : lines) {
-    auto& lineno = l.first;
-    auto& line = l.second;
+  // Inherited parameters
+  for (auto&& section : m_overrides) {
+    for (auto&& param : section.second) {
+      if (is_reference(param.second)) {
+        references.emplace_back(section.first, param.first);
+      }
+    }
+  }
 
-    // New section
-    if (line[0] == '[' && line[line.length() - 1] == ']') {
-      section = line.substr(1, line.length() - 2);
-      continue;
-    } else if (section.empty()) {
-      continue;
+  for (auto&& param : references) {
+    resolve_param(param.first, param.second);
+  }
+
+  for (auto&& section : m_invalid) {
+    for (auto&& param : section.second) {
+      m_overrides[section.first].erase(param.first);
     }
+  }
 
-    size_t equal_pos;
+  m_lists.clear();
 
-    // Check for key-value pair equal sign
-    if ((equal_pos = line.find('=')) == string::npos) {
-      continue;
+  for (size_t i = 0; i < m_table.size(); i++) {
+    if (i == 0 || m_table.section(i).data != m_table.section(i - 1).data) {
+      index_lists(m_table.section(i).str());
+    }
+  }
+  for (auto&& section : m_overrides) {
+    if (!m_table.has_section(section.first)) {
+      index_lists(section.first);
     }
+  }
+}
 
-    string key{forward<string>(string_util::trim(forward<string>(line.substr(0, equal_pos))))};
-    string value;
+/**
+ * Resolve the reference of given parameter, unless an earlier
+ * reference to it already resolved it in place
+ */
+void config::resolve_param(const string& section, const string& key) {
+  const char* value{lookup(section, key)};
+  if (value == nullptr || !is_reference(string{value})) {
+    return;
+  }
+  try {
+    vector<string> chain{section + "." + key};
+    string resolved{resolve(section, key, string{value}, chain)};
+    m_overrides[section][key] = move(resolved);
+  } catch (const value_error& err) {
+    m_invalid[section].emplace(key, err.what());
+  }
+}
+
+/**
+ * Collect the values of all list parameters (key-0, key-1, ...)
+ * defined in given section
+ */
+void config::index_lists(const string& section) {
+  auto& lists = m_lists[section];
+  lists.clear();
 
-    auto it = m_sections[section].find(key);
-    if (it != m_sections[section].end()) {
-      throw key_error("Duplicate key name \"" + key + "\" defined on line " + to_string(lineno));
+  auto add = [&](const char* data, size_t size) {
+    if (size < 2 || data[size - 2] != '-' || data[size - 1] != '0') {
+      return;
     }
 
-    if (equal_pos + 1 < line.size()) {
-      value = forward<string>(string_util::trim(line.substr(equal_pos + 1)));
-      size_t len{value.size()};
-      if (len > 2 && value[0] == '"' && value[len - 1] == '"') {
-        value.erase(len - 1, 1).erase(0, 1);
-      }
+    string key{data, size - 2};
+    if (lists.find(key) != lists.end()) {
+      return;
     }
 
-#if WITH_XRM
-    // Initialize the xresource manage if there are any xrdb refs
-    // present in the configuration
-    if (!m_xrm && value.find("${xrdb") != string::npos) {
-      m_xrm.reset(new xresource_manager{connection::make()});
+    auto& list = lists[key];
+    for (size_t i = 0;; i++) {
+      const char* value{find(section, key + "-" + to_string(i))};
+      if (value == nullptr) {
+        break;
+      }
+      list.emplace_back(value);
     }
-#endif
+  };
 
-    m_sections[section].emplace_hint(it, move(key), move(value));
+  auto range = m_table.range(section);
+  for (size_t i = range.first; i < range.second; i++) {
+    add(m_table.key(i).data, m_table.key(i).size);
+  }
+
+  auto overrides = m_overrides.find(section);
+  if (overrides != m_overrides.end()) {
+    for (auto&& param : overrides->second) {
+      add(param.first.data(), param.first.size());
+    }
   }
 }
 
 /**
- * Look for sections set up to inherit from a base section
- * and copy the missing parameters
- *
- *   [sub/seciton]
- *   inherit = base/section
+ * Get the merged values of all valid parameters
  */
-void config::copy_inherited() {
-  for (auto&& section : m_sections) {
+config::sectionmap_t config::values() const {
+  sectionmap_t values;
+
+  for (size_t i = 0; i < m_table.size(); i++) {
+    values[m_table.section(i).str()].emplace(m_table.key(i).str(), m_table.value(i).str());
+  }
+
+  for (auto&& section : m_overrides) {
+    auto& dst = values[section.first];
     for (auto&& param : section.second) {
-      if (param.first.find("inherit") == 0) {
-        // Get name of base section
-        auto inherit = param.second;
-        if ((inherit = dereference<string>(section.first, param.first, inherit, inherit)).empty()) {
-          throw value_error("Invalid section \"\" defined for \"" + section.first + ".inherit\"");
-        }
+      dst[param.first] = param.second;
+    }
+  }
 
-        // Find and validate base section
-        auto base_section = m_sections.find(inherit);
-        if (base_section == m_sections.end()) {
-          throw value_error("Invalid section \"" + inherit + "\" defined for \"" + section.first + ".inherit\"");
-        }
+  for (auto&& section : m_invalid) {
+    for (auto&& param : section.second) {
+      values[section.first].erase(param.first);
+    }
+  }
 
-        m_log.trace("config: Copying missing params (sub=\"%s\", base=\"%s\")", section.first, inherit);
+  return values;
+}
 
-        // Iterate the base and copy the parameters
-        // that hasn't been defined for the sub-section
-        for (auto&& base_param : base_section->second) {
-          section.second.insert(make_pair(base_param.first, base_param.second));
-        }
-      }
+/**
+ * Check if the value is a ${...} reference
+ */
+bool config::is_reference(const string& value) {
+  return value.size() > 2 && value.compare(0, 2, "${") == 0 && value.back() == '}';
+}
+
+bool config::is_reference(const config_snapshot::string_ref& value) {
+  return value.size > 2 && value.starts_with("${") && value.data[value.size - 1] == '}';
+}
+
+/**
+ * Resolve value reference
+ */
+string config::resolve(const string& section, const string& key, const string& value, vector<string>& chain) {
+  if (!is_reference(value)) {
+    return value;
+  }
+
+  auto path = value.substr(2, value.length() - 3);
+  size_t pos;
+
+  if (path.compare(0, 4, "env:") == 0) {
+    return resolve_env(path.substr(4));
+  } else if (path.compare(0, 5, "xrdb:") == 0) {
+    return resolve_xrdb(path.substr(5));
+  } else if (path.compare(0, 5, "file:") == 0) {
+    return resolve_file(path.substr(5));
+  } else if ((pos = path.find(".")) != string::npos) {
+    return resolve_local(path.substr(0, pos), path.substr(pos + 1), section, chain);
+  } else {
+    throw value_error("Invalid reference defined at \"" + section + "." + key + "\"");
+  }
+}
+
+/**
+ * Resolve local value reference defined using:
+ *  ${root.key}
+ *  ${root.key:fallback}
+ *  ${self.key}
+ *  ${self.key:fallback}
+ *  ${section.key}
+ *  ${section.key:fallback}
+ */
+string config::resolve_local(string section, const string& key, const string& current_section, vector<string>& chain) {
+  if (section == "BAR") {
+    m_log.warn("${BAR.key} is deprecated. Use ${root.key} instead");
+  }
+
+  section = string_util::replace(section, "BAR", this->section(), 0, 3);
+  section = string_util::replace(section, "root", this->section(), 0, 4);
+  section = string_util::replace(section, "self", current_section, 0, 4);
+
+  size_t pos{key.find(':')};
+  string name{key.substr(0, pos)};
+
+  const char* raw{lookup(section, name)};
+
+  if (raw == nullptr) {
+    if (pos != string::npos) {
+      string fallback{key.substr(pos + 1)};
+      m_log.info("The reference ${%s.%s} does not exist, using defined fallback value \"%s\"", section, name, fallback);
+      return fallback;
+    }
+    throw value_error("The reference ${" + section + "." + key + "} does not exist (no fallback set)");
+  }
+
+  string id{section + "." + name};
+  if (std::find(chain.begin(), chain.end(), id) != chain.end()) {
+    throw value_error("Circular reference ${" + id + "} defined at \"" + chain.front() + "\"");
+  }
+
+  // The referenced value is resolved in place, so that
+  // it doesn't need to be resolved again later on
+  string value{raw};
+  if (is_reference(value)) {
+    chain.emplace_back(move(id));
+    value = resolve(section, name, value, chain);
+    chain.pop_back();
+    m_overrides[section][name] = value;
+  }
+
+  return value;
+}
+
+/**
+ * Resolve environment variable reference defined using:
+ *  ${env:key}
+ *  ${env:key:fallback value}
+ */
+string config::resolve_env(string var) const {
+  size_t pos;
+  string env_default;
+
+  if ((pos = var.find(':')) != string::npos) {
+    env_default = var.substr(pos + 1);
+    var.erase(pos);
+  }
+
+  if (env_util::has(var.c_str())) {
+    string env_value{env_util::get(var.c_str())};
+    m_log.info("Environment var reference ${%s} found (value=%s)", var, env_value);
+    return env_value;
+  } else if (!env_default.empty()) {
+    m_log.info("Environment var ${%s} is undefined, using defined fallback value \"%s\"", var, env_default);
+    return env_default;
+  } else {
+    throw value_error(sstream() << "Environment var ${" << var << "} does not exist (no fallback set)");
+  }
+}
+
+/**
+ * Resolve X resource db value defined using:
+ *  ${xrdb:key}
+ *  ${xrdb:key:fallback value}
+ */
+string config::resolve_xrdb(string var) const {
+  size_t pos;
+#if not WITH_XRM
+  m_log.warn("No built-in support to dereference ${xrdb:%s} references (requires `xcb-util-xrm`)", var);
+  if ((pos = var.find(':')) != string::npos) {
+    return var.substr(pos + 1);
+  }
+  return "";
+#else
+  if (!m_xrm) {
+    throw application_error("xrm is not initialized");
+  }
+
+  string fallback;
+  if ((pos = var.find(':')) != string::npos) {
+    fallback = var.substr(pos + 1);
+    var.erase(pos);
+  }
+
+  try {
+    auto value = m_xrm->require<string>(var.c_str());
+    m_log.info("Found matching X resource \"%s\" (value=%s)", var, value);
+    return value;
+  } catch (const xresource_error& err) {
+    if (!fallback.empty()) {
+      m_log.warn("%s, using defined fallback value \"%s\"", err.what(), fallback);
+      return fallback;
     }
+    throw value_error(sstream() << err.what() << " (no fallback set)");
   }
+#endif
+}
+
+/**
+ * Resolve file reference by reading its contents
+ *  ${file:/absolute/file/path}
+ *  ${file:/absolute/file/path:fallback value}
+ */
+string config::resolve_file(string var) const {
+  size_t pos;
+  string fallback;
+  if ((pos = var.find(':')) != string::npos) {
+    fallback = var.substr(pos + 1);
+    var.erase(pos);
+  }
+  var = file_util::expand(var);
+
+  if (file_util::exists(var)) {
+    m_log.info("File reference \"%s\" found", var);
+    return string_util::trim(file_util::contents(var), '\n');
+  } else if (!fallback.empty()) {
+    m_log.warn("File reference \"%s\" not found, using defined fallback value \"%s\"", var, fallback);
+    return fallback;
+  } else {
+    throw value_error(sstream() << "The file \"" << var << "\" does not exist (no fallback set)");
+  }
+}
+
+/**
+ * Get the raw or resolved value of a parameter, including
+ * parameters whose reference failed to resolve
+ */
+const char* config::lookup(const string& section, const string& key) const {
+  const string* value{find(m_overrides, section, key)};
+  return value != nullptr ? value->c_str() : m_table.find(section, key);
+}
+
+/**
+ * Get the values of given list parameter, returns
+ * nullptr if the list isn't defined
+ */
+const vector<string>* config::find_list(const string& section, const string& key) const {
+  auto it = m_lists.find(section);
+  if (it == m_lists.end()) {
+    return nullptr;
+  }
+  auto list = it->second.find(key);
+  return list != it->second.end() ? &list->second : nullptr;
+}
+
+/**
+ * Throw the resolution error of given parameter, if any
+ */
+void config::check_invalid(const string& section, const string& key) const {
+  const string* err{find(m_invalid, section, key)};
+  if (err != nullptr) {
+    throw value_error(*err);
+  }
+}
+
+/**
+ * Throw the error for a parameter that was requested but is not available
+ */
+void config::throw_missing(const string& section, const string& key) const {
+  check_invalid(section, key);
+  throw key_error("Missing parameter \"" + section + "." + key + "\"");
 }
 
 template <>
@@ -318,6 +697,11 @@ rgba config::convert(string&& value) const {
   return rgba{color_util::parse(value, 0)};
 }
 
+template <>
+argb config::convert(string&& value) const {
+  return color_util::parse_argb(value);
+}
+
 template <>
 cairo_operator_t config::convert(string&& value) const {
   return cairo::utils::str2operator(forward<string>(value), CAIRO_OPERATOR_OVER);
@@ -0,0 +1,653 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include "components/config_snapshot.hpp"
+#include "components/logger.hpp"
+#include "utils/env.hpp"
+#include "utils/file.hpp"
+#include "utils/string.hpp"
+
+POLYBAR_NS
+
+namespace config_snapshot {
+  namespace {
+    /**
+     * Identifies the snapshot format, bump when the layout changes
+     */
+    constexpr const char SNAPSHOT_MAGIC[8]{'P', 'B', 'C', 'O', 'N', 'F', '0', '2'};
+
+    /**
+     * Size of the table header (record count and pool size)
+     */
+    constexpr size_t TABLE_HEADER{2 * sizeof(uint32_t)};
+
+    /**
+     * 64-bit FNV-1a hash, used instead of std::hash since
+     * the values are persisted between runs
+     */
+    constexpr uint64_t FNV_OFFSET{0xcbf29ce484222325ULL};
+    constexpr uint64_t FNV_PRIME{0x100000001b3ULL};
+
+    uint64_t fnv1a(const char* data, size_t len, uint64_t hash = FNV_OFFSET) {
+      for (size_t i = 0; i < len; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= FNV_PRIME;
+      }
+      return hash;
+    }
+
+    /**
+     * Hash the raw contents of given file
+     */
+    bool fnv1a_file(const string& path, uint64_t& hash) {
+      int fd{open(path.c_str(), O_RDONLY)};
+      if (fd == -1) {
+        return false;
+      }
+
+      char buffer[BUFSIZ];
+      ssize_t bytes;
+      hash = FNV_OFFSET;
+      while ((bytes = read(fd, buffer, sizeof(buffer))) > 0) {
+        hash = fnv1a(buffer, bytes, hash);
+      }
+
+      close(fd);
+      return bytes == 0;
+    }
+
+    /**
+     * Compare a table string with given string, ordered like std::string
+     */
+    int compare(const string_ref& ref, const string& str) {
+      int result{std::memcmp(ref.data, str.data(), std::min(ref.size, str.size()))};
+      if (result != 0) {
+        return result;
+      }
+      return ref.size < str.size() ? -1 : ref.size > str.size() ? 1 : 0;
+    }
+
+    int compare(const string_ref& a, const string_ref& b) {
+      int result{std::memcmp(a.data, b.data, std::min(a.size, b.size))};
+      if (result != 0) {
+        return result;
+      }
+      return a.size < b.size ? -1 : a.size > b.size ? 1 : 0;
+    }
+
+    /**
+     * Read-only view of a mapped snapshot header
+     */
+    class snapshot_reader {
+     public:
+      explicit snapshot_reader(const char* data, size_t size) : m_begin(data), m_pos(data), m_end(data + size) {}
+
+      bool read(uint32_t& value) {
+        return read(&value, sizeof(value));
+      }
+
+      bool read(uint64_t& value) {
+        return read(&value, sizeof(value));
+      }
+
+      bool read(string& value) {
+        uint32_t len;
+        if (!read(len) || static_cast<size_t>(m_end - m_pos) < len) {
+          return false;
+        }
+        value.assign(m_pos, len);
+        m_pos += len;
+        return true;
+      }
+
+      bool read(void* dst, size_t len) {
+        if (static_cast<size_t>(m_end - m_pos) < len) {
+          return false;
+        }
+        std::memcpy(dst, m_pos, len);
+        m_pos += len;
+        return true;
+      }
+
+      bool align(size_t alignment) {
+        size_t offset{this->offset()};
+        return skip((alignment - offset % alignment) % alignment);
+      }
+
+      bool skip(size_t len) {
+        if (static_cast<size_t>(m_end - m_pos) < len) {
+          return false;
+        }
+        m_pos += len;
+        return true;
+      }
+
+      size_t offset() const {
+        return m_pos - m_begin;
+      }
+
+     private:
+      const char* m_begin;
+      const char* m_pos;
+      const char* m_end;
+    };
+
+    void write(string& buffer, uint32_t value) {
+      buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void write(string& buffer, uint64_t value) {
+      buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void write(string& buffer, const string& value) {
+      write(buffer, static_cast<uint32_t>(value.size()));
+      buffer.append(value);
+    }
+
+    /**
+     * Read the snapshot header, making sure that the stored
+     * content hashes match the current state of the files
+     */
+    bool read_files(snapshot_reader& reader, const string& mainfile, vector<string>& files) {
+      char magic[sizeof(SNAPSHOT_MAGIC)];
+      uint32_t count;
+
+      if (!reader.read(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        return false;
+      }
+
+      if (!reader.read(count) || count == 0) {
+        return false;
+      }
+      for (uint32_t i = 0; i < count; i++) {
+        string file;
+        uint64_t hash, current;
+        if (!reader.read(file) || !reader.read(hash)) {
+          return false;
+        } else if (i == 0 && file != mainfile) {
+          return false;
+        } else if (!fnv1a_file(file, current) || current != hash) {
+          return false;
+        }
+        files.emplace_back(move(file));
+      }
+
+      return reader.align(alignof(table::record));
+    }
+
+    /**
+     * Create the directory containing given path and its parents
+     */
+    bool make_parents(const string& path) {
+      for (size_t pos = path.find('/', 1); pos != string::npos; pos = path.find('/', pos + 1)) {
+        string dir{path.substr(0, pos)};
+        if (mkdir(dir.c_str(), 0700) == -1 && errno != EEXIST) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  /**
+   * Check if the referenced string starts with given prefix
+   */
+  bool string_ref::starts_with(const char* prefix) const {
+    size_t len{std::strlen(prefix)};
+    return size >= len && std::memcmp(data, prefix, len) == 0;
+  }
+
+  /**
+   * Check if the referenced string contains given substring
+   */
+  bool string_ref::contains(const char* needle) const {
+    const char* end{data + size};
+    return std::search(data, end, needle, needle + std::strlen(needle)) != end;
+  }
+
+  table::table(table&& other) noexcept {
+    *this = move(other);
+  }
+
+  table& table::operator=(table&& other) noexcept {
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_map, other.m_map);
+    std::swap(m_mapsize, other.m_mapsize);
+    std::swap(m_offset, other.m_offset);
+    std::swap(m_bytes, other.m_bytes);
+    // The pointers are recomputed since a moved buffer may have relocated
+    attach();
+    other.attach();
+    return *this;
+  }
+
+  table::~table() {
+    if (m_map != nullptr) {
+      munmap(m_map, m_mapsize);
+    }
+  }
+
+  /**
+   * Build a table owning the given parameters
+   *
+   * The parameters must not contain duplicate keys within a section
+   */
+  table table::build(vector<param>&& params) {
+    std::sort(params.begin(), params.end(), [](const param& a, const param& b) {
+      int result{a.section.compare(b.section)};
+      return result < 0 || (result == 0 && a.key < b.key);
+    });
+
+    vector<record> records(params.size());
+    string pool;
+
+    auto intern = [&](const string& value, uint32_t& offset, uint32_t& size) {
+      offset = pool.size();
+      size = value.size();
+      pool.append(value);
+      pool.push_back('\0');
+    };
+
+    for (size_t i = 0; i < params.size(); i++) {
+      auto& rec = records[i];
+      if (i > 0 && params[i].section == params[i - 1].section) {
+        rec.section = records[i - 1].section;
+        rec.section_size = records[i - 1].section_size;
+      } else {
+        intern(params[i].section, rec.section, rec.section_size);
+      }
+      intern(params[i].key, rec.key, rec.key_size);
+      intern(params[i].value, rec.value, rec.value_size);
+    }
+
+    table result;
+    result.m_buffer.reserve(TABLE_HEADER + records.size() * sizeof(record) + pool.size());
+    write(result.m_buffer, static_cast<uint32_t>(records.size()));
+    write(result.m_buffer, static_cast<uint32_t>(pool.size()));
+    result.m_buffer.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(record));
+    result.m_buffer.append(pool);
+    result.m_bytes = result.m_buffer.size();
+    result.attach();
+    return result;
+  }
+
+  /**
+   * Create a table pointing into the given mapping, starting at offset
+   *
+   * The table takes ownership of the mapping. Use valid() before
+   * accessing the parameters of a mapped table
+   */
+  table table::map(void* data, size_t size, size_t offset) {
+    table result;
+    result.m_map = data;
+    result.m_mapsize = size;
+    result.m_offset = offset;
+    result.m_bytes = size - offset;
+    result.attach();
+    return result;
+  }
+
+  /**
+   * Set up the record and pool pointers from the table header
+   */
+  void table::attach() {
+    const char* base{m_map != nullptr ? static_cast<const char*>(m_map) : m_buffer.data()};
+    uint32_t count{0};
+    uint32_t pool{0};
+
+    m_data = base + m_offset;
+
+    if (m_bytes >= TABLE_HEADER) {
+      std::memcpy(&count, m_data, sizeof(count));
+      std::memcpy(&pool, m_data + sizeof(count), sizeof(pool));
+    }
+
+    if (m_bytes < TABLE_HEADER || (m_bytes - TABLE_HEADER) / sizeof(record) < count ||
+        TABLE_HEADER + count * sizeof(record) + pool != m_bytes) {
+      m_records = nullptr;
+      m_pool = nullptr;
+      m_count = 0;
+    } else {
+      m_records = reinterpret_cast<const record*>(m_data + TABLE_HEADER);
+      m_pool = m_data + TABLE_HEADER + count * sizeof(record);
+      m_count = count;
+    }
+  }
+
+  /**
+   * Check that all records point inside the pool and are sorted
+   */
+  bool table::valid() const {
+    if (m_bytes == 0) {
+      return true;
+    } else if (m_records == nullptr || reinterpret_cast<uintptr_t>(m_records) % alignof(record) != 0) {
+      return false;
+    }
+
+    size_t pool{m_bytes - TABLE_HEADER - m_count * sizeof(record)};
+    auto in_pool = [&](uint32_t offset, uint32_t size) {
+      return offset < pool && size < pool - offset && m_pool[offset + size] == '\0';
+    };
+
+    for (size_t i = 0; i < m_count; i++) {
+      const auto& rec = m_records[i];
+      if (!in_pool(rec.section, rec.section_size) || !in_pool(rec.key, rec.key_size) ||
+          !in_pool(rec.value, rec.value_size)) {
+        return false;
+      }
+      if (i > 0) {
+        int result{config_snapshot::compare(section(i - 1), section(i))};
+        if (result > 0 || (result == 0 && config_snapshot::compare(key(i - 1), key(i)) >= 0)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Compare the record at given index with a section and key
+   */
+  int table::compare(size_t index, const string& section, const string& key) const {
+    int result{config_snapshot::compare(this->section(index), section)};
+    return result != 0 ? result : config_snapshot::compare(this->key(index), key);
+  }
+
+  /**
+   * Get the NUL-terminated value of a parameter,
+   * returns nullptr if it isn't defined
+   */
+  const char* table::find(const string& section, const string& key) const {
+    size_t first{0};
+    size_t count{m_count};
+
+    while (count > 0) {
+      size_t step{count / 2};
+      if (compare(first + step, section, key) < 0) {
+        first += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+
+    if (first < m_count && compare(first, section, key) == 0) {
+      return value(first).data;
+    }
+    return nullptr;
+  }
+
+  /**
+   * Get the range of record indices belonging to given section
+   */
+  pair<size_t, size_t> table::range(const string& section) const {
+    auto bound = [&](bool upper) {
+      size_t first{0};
+      size_t count{m_count};
+      while (count > 0) {
+        size_t step{count / 2};
+        int result{config_snapshot::compare(this->section(first + step), section)};
+        if (result < 0 || (upper && result == 0)) {
+          first += step + 1;
+          count -= step + 1;
+        } else {
+          count = step;
+        }
+      }
+      return first;
+    };
+    return make_pair(bound(false), bound(true));
+  }
+
+  /**
+   * Returns true if any parameter is defined in given section
+   */
+  bool table::has_section(const string& section) const {
+    auto indices = range(section);
+    return indices.first != indices.second;
+  }
+
+  /**
+   * Get the path of the snapshot for given config file
+   *
+   * Snapshots are stored under $XDG_CACHE_HOME/polybar and
+   * are named after the hash of the config file path
+   */
+  string path(const string& file) {
+    string dir{env_util::get("XDG_CACHE_HOME")};
+    if (dir.empty() && !(dir = env_util::get("HOME")).empty()) {
+      dir += "/.cache";
+    }
+    if (dir.empty()) {
+      return "";
+    }
+
+    char name[32];
+    auto hash = static_cast<unsigned long long>(fnv1a(file.data(), file.size()));
+    snprintf(name, sizeof(name), "/config-%016llx", hash);
+    return dir + "/polybar" + name;
+  }
+
+  /**
+   * Parse key/value pairs from the main config file and its includes
+   *
+   * All files that were read are added to `files`, starting with the main file
+   */
+  table parse(const string& mainfile, vector<string>& files, const logger& log) {
+    vector<pair<int, string>> lines;
+    vector<string> stack{mainfile};
+
+    files = stack;
+
+    std::function<void(int, string&&)> pushline = [&](int lineno, string&& line) {
+      // Ignore empty lines and comments
+      if (line.empty() || line[0] == ';' || line[0] == '#') {
+        return;
+      }
+
+      string key, value;
+      string::size_type pos;
+
+      // Filter lines by:
+      // - key/value pairs
+      // - section headers
+      if ((pos = line.find('=')) != string::npos) {
+        key = forward<string>(string_util::trim(forward<string>(line.substr(0, pos))));
+        value = forward<string>(string_util::trim(line.substr(pos + 1)));
+      } else if (line[0] != '[' || line[line.length() - 1] != ']') {
+        return;
+      }
+
+      if (key == "include-file") {
+        auto file_path = file_util::expand(value);
+        if (file_path.empty() || !file_util::exists(file_path)) {
+          throw value_error("Invalid include file \"" + file_path + "\" defined on line " + to_string(lineno));
+        }
+        if (std::find(stack.begin(), stack.end(), file_path) != stack.end()) {
+          throw value_error("Recursive include file \"" + file_path + "\"");
+        }
+        stack.push_back(file_util::expand(file_path));
+        files.push_back(stack.back());
+        log.trace("config: Including file \"%s\"", file_path);
+        for (auto&& l : string_util::split(file_util::contents(file_path), '\n')) {
+          pushline(lineno, forward<string>(l));
+        }
+        stack.pop_back();
+      } else {
+        lines.emplace_back(make_pair(lineno, move(line)));
+      }
+    };
+
+    int lineno{0};
+    string line;
+    std::ifstream in(mainfile);
+    while (std::getline(in, line)) {
+      pushline(++lineno, string_util::replace_all(line, "\t", ""));
+    }
+
+    vector<table::param> params;
+    vector<int> linenos;
+    string section;
+
+    for (auto&& l : lines) {
+      auto& line = l.second;
+
+      // New section
+      if (line[0] == '[' && line[line.length() - 1] == ']') {
+        section = line.substr(1, line.length() - 2);
+        continue;
+      } else if (section.empty()) {
+        continue;
+      }
+
+      size_t equal_pos;
+
+      // Check for key-value pair equal sign
+      if ((equal_pos = line.find('=')) == string::npos) {
+        continue;
+      }
+
+      string key{forward<string>(string_util::trim(forward<string>(line.substr(0, equal_pos))))};
+      string value;
+
+      if (equal_pos + 1 < line.size()) {
+        value = forward<string>(string_util::trim(line.substr(equal_pos + 1)));
+        size_t len{value.size()};
+        if (len > 2 && value[0] == '"' && value[len - 1] == '"') {
+          value.erase(len - 1, 1).erase(0, 1);
+        }
+      }
+
+      params.emplace_back(table::param{section, move(key), move(value)});
+      linenos.emplace_back(l.first);
+    }
+
+    // Report the first redefinition in file order
+    vector<size_t> order(params.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      int result{params[a].section.compare(params[b].section)};
+      return result < 0 || (result == 0 && params[a].key < params[b].key);
+    });
+
+    const table::param* duplicate{nullptr};
+    int duplicate_line{0};
+    for (size_t i = 1; i < order.size(); i++) {
+      const auto& prev = params[order[i - 1]];
+      const auto& param = params[order[i]];
+      if (param.section == prev.section && param.key == prev.key &&
+          (duplicate == nullptr || linenos[order[i]] < duplicate_line)) {
+        duplicate = &param;
+        duplicate_line = linenos[order[i]];
+      }
+    }
+    if (duplicate != nullptr) {
+      throw key_error("Duplicate key name \"" + duplicate->key + "\" defined on line " + to_string(duplicate_line));
+    }
+
+    return table::build(move(params));
+  }
+
+  /**
+   * Map the parameters stored in given snapshot
+   *
+   * Fails if the snapshot was created for a different main file or if
+   * the content hash of any of the stored files no longer matches
+   */
+  bool load(const string& path, const string& mainfile, vector<string>& files, table& params) {
+    int fd{open(path.c_str(), O_RDONLY)};
+    if (fd == -1) {
+      return false;
+    }
+
+    file_descriptor guard{fd};
+    struct stat st {};
+
+    if (fstat(fd, &st) == -1 || st.st_size < static_cast<off_t>(sizeof(SNAPSHOT_MAGIC))) {
+      return false;
+    }
+
+    size_t size{static_cast<size_t>(st.st_size)};
+    void* data{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+    if (data == MAP_FAILED) {
+      return false;
+    }
+
+    snapshot_reader reader{static_cast<const char*>(data), size};
+    vector<string> stored;
+    bool valid{read_files(reader, mainfile, stored)};
+
+    // The table owns the mapping from here on
+    table mapped{table::map(data, size, valid ? reader.offset() : size)};
+
+    if (!valid || !mapped.valid() || mapped.size() == 0) {
+      return false;
+    }
+
+    files.swap(stored);
+    params = move(mapped);
+
+    return true;
+  }
+
+  /**
+   * Store the given files and parameters in a snapshot,
+   * creating the parent directories if needed
+   *
+   * On failure errno is left as set by the failing call
+   */
+  bool save(const string& path, const vector<string>& files, const table& params) {
+    string buffer{SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)};
+
+    write(buffer, static_cast<uint32_t>(files.size()));
+    for (auto&& file : files) {
+      uint64_t hash;
+      if (!fnv1a_file(file, hash)) {
+        return false;
+      }
+      write(buffer, file);
+      write(buffer, hash);
+    }
+
+    // Records are read in place, so they need to be aligned in the file
+    buffer.append((alignof(table::record) - buffer.size() % alignof(table::record)) % alignof(table::record), '\0');
+    buffer.append(params.data(), params.bytes());
+
+    if (!make_parents(path)) {
+      return false;
+    }
+
+    // Write to a temporary file first so that a concurrently
+    // starting instance never maps a partially written snapshot
+    string tmp{path + "." + to_string(getpid())};
+    int fd{open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600)};
+    if (fd == -1) {
+      return false;
+    }
+
+    bool written{::write(fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size())};
+    int err{errno};
+    close(fd);
+
+    if (!written || rename(tmp.c_str(), path.c_str()) == -1) {
+      err = written ? errno : err;
+      unlink(tmp.c_str());
+      errno = err;
+      return false;
+    }
+
+    return true;
+  }
+}
+
+POLYBAR_NS_END
@@ -25,6 +25,21 @@ array<int, 2> g_eventpipe{{-1, -1}};
 sig_atomic_t g_reload{0};
 sig_atomic_t g_terminate{0};
 
+namespace {
+  /**
+   * Key of a module instance in the module map
+   *
+   * Modules take the monitor, the locale, the spacing and the colors
+   * from the settings of the bar they are created for, so bars only
+   * share an instance if all of these are the same
+   */
+  string module_key(const string& name, const bar_settings& bar) {
+    return name + "@" + (bar.monitor ? bar.monitor->name : "") + "/" + bar.locale + "/" + to_string(bar.spacing) +
+           "/" + to_string(bar.background) + "/" + to_string(bar.foreground) + "/" + to_string(bar.underline.color) +
+           "/" + to_string(bar.overline.color);
+  }
+}
+
 void interrupt_handler(int signum) {
   g_terminate = 1;
   g_reload = (signum == SIGUSR1);
@@ -36,21 +51,27 @@ void interrupt_handler(int signum) {
 /**
  * Build controller instance
  */
-controller::make_type controller::make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch) {
-  return factory_util::unique<controller>(connection::make(), signal_emitter::make(), logger::make(), config::make(),
-      bar::make(), forward<decltype(ipc)>(ipc), forward<decltype(config_watch)>(config_watch));
+controller::make_type controller::make(
+    const vector<string>& bars, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch) {
+  vector<unique_ptr<bar>> instances;
+  for (auto&& name : bars) {
+    instances.emplace_back(bar::make("bar/" + name));
+  }
+  return factory_util::unique<controller>(connection::make(), signal_emitter::make(), logger::make(),
+      config::make_mutable(), move(instances), forward<decltype(ipc)>(ipc),
+      forward<decltype(config_watch)>(config_watch));
 }
 
 /**
  * Construct controller
  */
-controller::controller(connection& conn, signal_emitter& emitter, const logger& logger, const config& config,
-    unique_ptr<bar>&& bar, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& confwatch)
+controller::controller(connection& conn, signal_emitter& emitter, const logger& logger, config& config,
+    vector<unique_ptr<bar>>&& bars, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& confwatch)
     : m_connection(conn)
     , m_sig(emitter)
     , m_log(logger)
     , m_conf(config)
-    , m_bar(forward<decltype(bar)>(bar))
+    , m_bars(forward<decltype(bars)>(bars))
     , m_ipc(forward<decltype(ipc)>(ipc))
     , m_confwatch(forward<decltype(confwatch)>(confwatch)) {
   m_swallow_input = m_conf.get("settings", "throttle-input-for", m_swallow_input);
@@ -75,41 +96,9 @@ controller::controller(connection& conn, signal_emitter& emitter, const logger&
   sigaction(SIGALRM, &act, nullptr);
 
   m_log.trace("controller: Setup user-defined modules");
-  size_t created_modules{0};
-
-  for (int i = 0; i < 3; i++) {
-    alignment align{static_cast<alignment>(i + 1)};
-    string configured_modules;
-
-    if (align == alignment::LEFT) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-left", ""s);
-    } else if (align == alignment::CENTER) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-center", ""s);
-    } else if (align == alignment::RIGHT) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-right", ""s);
-    }
-
-    for (auto& module_name : string_util::split(configured_modules, ' ')) {
-      if (module_name.empty()) {
-        continue;
-      }
-
-      try {
-        auto type = m_conf.get("module/" + module_name, "type");
+  modulemap_t reusable;
 
-        if (type == "custom/ipc" && !m_ipc) {
-          throw application_error("Inter-process messaging needs to be enabled");
-        }
-
-        m_modules[align].emplace_back(make_module(move(type), m_bar->settings(), module_name, m_log));
-        created_modules++;
-      } catch (const runtime_error& err) {
-        m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
-      }
-    }
-  }
-
-  if (!created_modules) {
+  if (setup_modules(reusable).empty()) {
     throw application_error("No modules created");
   }
 }
@@ -127,15 +116,9 @@ controller::~controller() {
   m_sig.detach(this);
 
   m_log.trace("controller: Stop modules");
-  for (auto&& block : m_modules) {
-    for (auto&& module : block.second) {
-      auto module_name = module->name();
-      auto cleanup_ms = time_util::measure([&module] {
-        module->stop();
-        module.reset();
-      });
-      m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
-    }
+  m_layouts.clear();
+  for (auto&& module : m_modules) {
+    stop_module(module.second);
   }
 
   m_log.trace("controller: Joining threads");
@@ -161,29 +144,14 @@ bool controller::run(bool writeback, string snapshot_dst) {
   m_sig.attach(this);
 
   size_t started_modules{0};
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      auto inp_handler = dynamic_cast<input_handler*>(&*module);
-      auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
-
-      if (inp_handler != nullptr) {
-        m_inputhandlers.emplace_back(inp_handler);
-      }
-
-      if (evt_handler != nullptr) {
-        evt_handler->connect(m_connection);
-      }
-
-      try {
-        m_log.info("Starting %s", module->name());
-        module->start();
-        started_modules++;
-      } catch (const application_error& err) {
-        m_log.err("Failed to start '%s' (reason: %s)", module->name(), err.what());
-      }
+  for (const auto& module : m_modules) {
+    if (start_module(*module.second)) {
+      started_modules++;
     }
   }
 
+  collect_inputhandlers();
+
   if (!started_modules) {
     throw application_error("No modules started");
   }
@@ -207,7 +175,8 @@ bool controller::run(bool writeback, string snapshot_dst) {
  * Enqueue event
  */
 bool controller::enqueue(event&& evt) {
-  if (!m_process_events && evt.type != event_type::QUIT) {
+  if (!m_process_events && evt.type != event_type::QUIT && evt.type != event_type::CHECK &&
+      evt.type != event_type::RELOAD) {
     return false;
   }
   if (!m_queue.enqueue(forward<decltype(evt)>(evt))) {
@@ -316,8 +285,7 @@ void controller::read_events() {
         fds.emplace_back((fd_confwatch = m_confwatch->get_file_descriptor()));
       }
       m_log.info("Configuration file changed");
-      g_terminate = 1;
-      g_reload = 1;
+      enqueue(make_reload_evt());
     }
 
     // Process event on the xcb connection fd
@@ -353,6 +321,7 @@ void controller::process_eventqueue() {
   while (!g_terminate) {
     event evt{};
     m_queue.wait_dequeue(evt);
+    dequeued(evt);
 
     if (g_terminate) {
       break;
@@ -364,16 +333,20 @@ void controller::process_eventqueue() {
       }
     } else if (evt.type == event_type::INPUT) {
       process_inputdata();
+    } else if (evt.type == event_type::RELOAD) {
+      process_reload();
     } else if (evt.type == event_type::UPDATE && evt.flag) {
       process_update(true);
     } else {
       event next{};
       size_t swallowed{0};
       while (swallowed++ < m_swallow_limit && m_queue.wait_dequeue_timed(next, m_swallow_update)) {
+        dequeued(next);
+
         if (next.type == event_type::QUIT) {
           evt = next;
           break;
-        } else if (next.type == event_type::INPUT) {
+        } else if (next.type == event_type::INPUT || next.type == event_type::RELOAD) {
           evt = next;
           break;
         } else if (evt.type != next.type) {
@@ -396,7 +369,9 @@ void controller::process_eventqueue() {
           on(signals::eventqueue::exit_terminate{});
         }
       } else if (evt.type == event_type::CHECK) {
-        on(signals::eventqueue::check_state{});
+        process_check();
+      } else if (evt.type == event_type::RELOAD) {
+        process_reload();
       } else {
         m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
       }
@@ -404,6 +379,227 @@ void controller::process_eventqueue() {
   }
 }
 
+/**
+ * Create the modules listed in the bar sections
+ *
+ * Bars listing the same module share a single instance, unless the
+ * bar settings used by the module differ (see module_key). Instances
+ * found in `reusable` are moved into place instead of creating new
+ * ones. Returns the newly created modules
+ */
+vector<modules::module_interface*> controller::setup_modules(modulemap_t& reusable) {
+  vector<modules::module_interface*> created_modules;
+
+  m_layouts.clear();
+
+  for (auto&& bar : m_bars) {
+    const bar_settings settings{bar->settings()};
+    layout_t layout;
+
+    for (int i = 0; i < 3; i++) {
+      alignment align{static_cast<alignment>(i + 1)};
+      string configured_modules;
+
+      if (align == alignment::LEFT) {
+        configured_modules = m_conf.get(settings.section, "modules-left", ""s);
+      } else if (align == alignment::CENTER) {
+        configured_modules = m_conf.get(settings.section, "modules-center", ""s);
+      } else if (align == alignment::RIGHT) {
+        configured_modules = m_conf.get(settings.section, "modules-right", ""s);
+      }
+
+      for (auto& module_name : string_util::split(configured_modules, ' ')) {
+        if (module_name.empty()) {
+          continue;
+        }
+
+        auto key = module_key(module_name, settings);
+        auto module = m_modules.find(key);
+
+        if (module == m_modules.end()) {
+          auto existing = reusable.find(key);
+          if (existing != reusable.end()) {
+            module = m_modules.emplace(key, move(existing->second)).first;
+            reusable.erase(existing);
+          }
+        }
+
+        if (module == m_modules.end()) {
+          try {
+            auto type = m_conf.get("module/" + module_name, "type");
+
+            if (type == "custom/ipc" && !m_ipc) {
+              throw application_error("Inter-process messaging needs to be enabled");
+            }
+
+            module_t instance{make_module(move(type), settings, module_name, m_log)};
+            module = m_modules.emplace(key, move(instance)).first;
+            created_modules.emplace_back(module->second.get());
+          } catch (const runtime_error& err) {
+            m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
+            continue;
+          }
+        }
+
+        layout[align].emplace_back(module->second.get());
+      }
+    }
+
+    m_layouts.emplace_back(move(layout));
+  }
+
+  return created_modules;
+}
+
+/**
+ * Connect the module to the X event loop and start it
+ */
+bool controller::start_module(modules::module_interface& module) {
+  auto evt_handler = dynamic_cast<event_handler_interface*>(&module);
+
+  if (evt_handler != nullptr) {
+    evt_handler->connect(m_connection);
+  }
+
+  try {
+    m_log.info("Starting %s", module.name());
+    module.start();
+    return true;
+  } catch (const application_error& err) {
+    m_log.err("Failed to start '%s' (reason: %s)", module.name(), err.what());
+    return false;
+  }
+}
+
+/**
+ * Detach the module from the X event loop, stop and release it
+ *
+ * The sink is removed first so that no events are dispatched to the
+ * module while, or after, it is destroyed
+ */
+void controller::stop_module(module_t& module) {
+  auto evt_handler = dynamic_cast<event_handler_interface*>(module.get());
+
+  if (evt_handler != nullptr) {
+    evt_handler->disconnect(m_connection);
+  }
+
+  auto module_name = module->name();
+  auto cleanup_ms = time_util::measure([&module] {
+    module->stop();
+    module.reset();
+  });
+  m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
+}
+
+/**
+ * Rebuild the list of modules that handle input events
+ */
+void controller::collect_inputhandlers() {
+  m_inputhandlers.clear();
+
+  for (const auto& module : m_modules) {
+    auto inp_handler = dynamic_cast<input_handler*>(module.second.get());
+    if (inp_handler != nullptr) {
+      m_inputhandlers.emplace_back(inp_handler);
+    }
+  }
+}
+
+/**
+ * Reload the config without restarting the application
+ *
+ * Modules whose section is unchanged keep running, all other
+ * modules are stopped and created again from the new values.
+ * Falls back to a full restart when the changes affect the
+ * bar window or the global settings
+ */
+void controller::process_reload() {
+  m_log.info("Reloading configuration");
+
+  config::changes_t changes;
+  try {
+    changes = m_conf.reload();
+  } catch (const exception& err) {
+    m_log.err("Failed to reload config, keeping the current one (reason: %s)", err.what());
+    return;
+  }
+
+  if (changes.find("settings") != changes.end() || changes.find("global/wm") != changes.end()) {
+    m_log.info("Global settings changed, restart required");
+    on(signals::eventqueue::exit_reload{});
+    return;
+  }
+
+  for (auto&& bar : m_bars) {
+    auto bar_changes = changes.find(bar->settings().section);
+    if (bar_changes != changes.end() && !bar->reload(bar_changes->second)) {
+      on(signals::eventqueue::exit_reload{});
+      return;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(m_modules_mutex);
+  modulemap_t reusable;
+
+  for (auto&& module : m_modules) {
+    if (changes.find(module.second->name()) == changes.end()) {
+      reusable.emplace(module.first, move(module.second));
+    }
+  }
+
+  // Modules left in m_modules have changed and are
+  // stopped before their replacements are created
+  m_layouts.clear();
+  for (auto&& module : m_modules) {
+    if (module.second) {
+      stop_module(module.second);
+    }
+  }
+
+  m_modules.clear();
+  auto created_modules = setup_modules(reusable);
+
+  // Modules no longer listed in any bar section
+  for (auto&& module : reusable) {
+    stop_module(module.second);
+  }
+
+  for (auto&& module : created_modules) {
+    start_module(*module);
+  }
+
+  collect_inputhandlers();
+
+  m_log.info("Configuration reloaded (%lu modules replaced)", created_modules.size());
+  process_update(true);
+}
+
+/**
+ * Reset the pending flag of a dequeued update so
+ * that the next broadcast queues a new event
+ */
+void controller::dequeued(const event& evt) {
+  if (evt.type == event_type::UPDATE && evt.flag) {
+    m_pending_forceupdate = false;
+  } else if (evt.type == event_type::UPDATE) {
+    m_pending_update = false;
+  }
+}
+
+/**
+ * Terminate if there are no running modules left
+ */
+void controller::process_check() {
+  for (const auto& module : m_modules) {
+    if (module.second->running()) {
+      return;
+    }
+  }
+  m_log.warn("No running modules...");
+  on(signals::eventqueue::exit_terminate{});
+}
+
 /**
  * Process stored input data
  */
@@ -442,7 +638,27 @@ void controller::process_inputdata() {
  * Process eventqueue update event
  */
 bool controller::process_update(bool force) {
-  const bar_settings& bar{m_bar->settings()};
+  for (size_t i = 0; i < m_bars.size(); i++) {
+    string contents{build_contents(m_bars[i]->settings(), m_layouts[i])};
+
+    try {
+      if (!m_writeback) {
+        m_bars[i]->parse(move(contents), force);
+      } else {
+        std::cout << contents << std::endl;
+      }
+    } catch (const exception& err) {
+      m_log.err("Failed to update bar contents (reason: %s)", err.what());
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Join the contents of the modules placed in the bar
+ */
+string controller::build_contents(const bar_settings& bar, const layout_t& layout) {
   string contents;
   string separator{bar.separator};
   string padding_left(bar.padding.left, ' ');
@@ -450,7 +666,7 @@ bool controller::process_update(bool force) {
   string margin_left(bar.module_margin.left, ' ');
   string margin_right(bar.module_margin.right, ' ');
 
-  for (const auto& block : m_modules) {
+  for (const auto& block : layout) {
     string block_contents;
     bool is_left = false;
     bool is_center = false;
@@ -470,15 +686,15 @@ bool controller::process_update(bool force) {
         continue;
       }
 
-      string module_contents;
+      const string* module_contents{nullptr};
 
       try {
-        module_contents = module->contents();
+        module_contents = &module->contents();
       } catch (const exception& err) {
         m_log.err("Failed to get contents for \"%s\" (err: %s)", module->name(), err.what());
       }
 
-      if (module_contents.empty()) {
+      if (module_contents == nullptr || module_contents->empty()) {
         continue;
       }
 
@@ -494,8 +710,7 @@ bool controller::process_update(bool force) {
         block_contents += margin_left;
       }
 
-      block_contents.reserve(module_contents.size());
-      block_contents += module_contents;
+      block_contents += *module_contents;
 
       is_first = false;
     }
@@ -524,31 +739,35 @@ bool controller::process_update(bool force) {
     contents += string_util::replace_all(block_contents, "}%{", " ");
   }
 
-  try {
-    if (!m_writeback) {
-      m_bar->parse(move(contents), force);
-    } else {
-      std::cout << contents << std::endl;
-    }
-  } catch (const exception& err) {
-    m_log.err("Failed to update bar contents (reason: %s)", err.what());
-  }
-
-  return true;
+  return contents;
 }
 
 /**
  * Process broadcast events
  */
 bool controller::on(const signals::eventqueue::notify_change&) {
-  return enqueue(make_update_evt(false));
+  // Broadcasts from several modules collapse into a single
+  // queued update until the eventqueue thread picks it up
+  if (m_pending_update.exchange(true)) {
+    return true;
+  } else if (!enqueue(make_update_evt(false))) {
+    m_pending_update = false;
+    return false;
+  }
+  return true;
 }
 
 /**
  * Process forced broadcast events
  */
 bool controller::on(const signals::eventqueue::notify_forcechange&) {
-  return enqueue(make_update_evt(true));
+  if (m_pending_forceupdate.exchange(true)) {
+    return true;
+  } else if (!enqueue(make_update_evt(true))) {
+    m_pending_forceupdate = false;
+    return false;
+  }
+  return true;
 }
 
 /**
@@ -569,25 +788,23 @@ bool controller::on(const signals::eventqueue::exit_reload&) {
 
 /**
  * Process eventqueue check event
+ *
+ * The check is deferred to the eventqueue thread since the signal
+ * is emitted by module threads while they are being stopped
  */
 bool controller::on(const signals::eventqueue::check_state&) {
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      if (module->running()) {
-        return true;
-      }
-    }
-  }
-  m_log.warn("No running modules...");
-  on(signals::eventqueue::exit_terminate{});
-  return true;
+  return enqueue(make_check_evt());
 }
 
 /**
  * Process ui ready event
  */
 bool controller::on(const signals::ui::ready&) {
-  m_process_events = true;
+  // Each bar reports when its window is ready
+  if (m_process_events.exchange(true)) {
+    return false;
+  }
+
   enqueue(make_update_evt(true));
 
   if (!m_snapshot_dst.empty()) {
@@ -646,13 +863,19 @@ bool controller::on(const signals::ipc::command& evt) {
   if (command == "quit") {
     enqueue(make_quit_evt(false));
   } else if (command == "restart") {
-    enqueue(make_quit_evt(true));
+    enqueue(make_reload_evt());
   } else if (command == "hide") {
-    m_bar->hide();
+    for (auto&& bar : m_bars) {
+      bar->hide();
+    }
   } else if (command == "show") {
-    m_bar->show();
+    for (auto&& bar : m_bars) {
+      bar->show();
+    }
   } else if (command == "toggle") {
-    m_bar->toggle();
+    for (auto&& bar : m_bars) {
+      bar->toggle();
+    }
   } else {
     m_log.warn("\"%s\" is not a valid ipc command", command);
   }
@@ -665,16 +888,15 @@ bool controller::on(const signals::ipc::command& evt) {
  */
 bool controller::on(const signals::ipc::hook& evt) {
   string hook{evt.cast()};
+  std::lock_guard<std::mutex> guard(m_modules_mutex);
 
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      if (!module->running()) {
-        continue;
-      }
-      auto ipc = dynamic_cast<ipc_module*>(module.get());
-      if (ipc != nullptr) {
-        ipc->on_message(hook);
-      }
+  for (const auto& module : m_modules) {
+    if (!module.second->running()) {
+      continue;
+    }
+    auto ipc = dynamic_cast<ipc_module*>(module.second.get());
+    if (ipc != nullptr) {
+      ipc->on_message(hook);
     }
   }
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 
 #include "components/parser.hpp"
@@ -30,18 +31,27 @@ parser::parser(signal_emitter& emitter) : m_sig(emitter) {}
 
 /**
  * Process input string
+ *
+ * The input is walked by index and the tag values and text nodes
+ * are copied into a reused buffer, so parsing doesn't allocate
+ * once the buffer has grown to fit the longest text node
  */
-void parser::parse(const bar_settings& bar, string data) {
-  while (!data.empty()) {
-    size_t pos{string::npos};
-
-    if (data.compare(0, 2, "%{") == 0 && (pos = data.find('}')) != string::npos) {
-      codeblock(data.substr(2, pos - 2), bar);
-      data.erase(0, pos + 1);
-    } else if ((pos = data.find("%{")) != string::npos) {
-      data.erase(0, text(data.substr(0, pos)));
+void parser::parse(const bar_settings& bar, const string& data) {
+  size_t pos{0};
+
+  while (pos < data.size()) {
+    size_t start{data.find("%{", pos)};
+    size_t end{start != string::npos ? data.find('}', start) : string::npos};
+
+    if (start == pos && end != string::npos) {
+      codeblock(data, start + 2, end, bar);
+      pos = end + 1;
+    } else if (start != string::npos && start > pos) {
+      text(data, pos, start);
+      pos = start;
     } else {
-      data.erase(0, text(data.substr(0)));
+      text(data, pos, data.size());
+      pos = data.size();
     }
   }
 
@@ -51,54 +61,48 @@ void parser::parse(const bar_settings& bar, string data) {
 }
 
 /**
- * Process contents within tag blocks, i.e: %{...}
+ * Process contents within tag blocks, i.e: %{...}, found at data[pos, end)
  */
-void parser::codeblock(string&& data, const bar_settings& bar) {
-  size_t pos;
-
-  while (data.length()) {
-    data = string_util::ltrim(move(data), ' ');
-
-    if (data.empty()) {
-      break;
+void parser::codeblock(const string& data, size_t pos, size_t end, const bar_settings& bar) {
+  while (pos < end) {
+    if (data[pos] == ' ') {
+      pos++;
+      continue;
     }
 
-    char tag{data[0]};
-    string value;
-
-    // Remove the tag
-    data.erase(0, 1);
+    char tag{data[pos++]};
+    size_t value_end{data.find(' ', pos)};
 
-    if ((pos = data.find_first_of(" }")) != string::npos) {
-      value = data.substr(0, pos);
-    } else {
-      value = data;
+    if (value_end > end) {
+      value_end = end;
     }
 
+    m_value.assign(data, pos, value_end - pos);
+
     switch (tag) {
       case 'B':
-        m_sig.emit(change_background{parse_color(value, bar.background)});
+        m_sig.emit(change_background{parse_color(m_value, bar.background)});
         break;
 
       case 'F':
-        m_sig.emit(change_foreground{parse_color(value, bar.foreground)});
+        m_sig.emit(change_foreground{parse_color(m_value, bar.foreground)});
         break;
 
       case 'T':
-        m_sig.emit(change_font{parse_fontindex(value)});
+        m_sig.emit(change_font{parse_fontindex(m_value)});
         break;
 
       case 'U':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        m_sig.emit(change_underline{parse_color(m_value, bar.underline.color)});
+        m_sig.emit(change_overline{parse_color(m_value, bar.overline.color)});
         break;
 
       case 'u':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
+        m_sig.emit(change_underline{parse_color(m_value, bar.underline.color)});
         break;
 
       case 'o':
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        m_sig.emit(change_overline{parse_color(m_value, bar.overline.color)});
         break;
 
       case 'R':
@@ -106,7 +110,7 @@ void parser::codeblock(string&& data, const bar_settings& bar) {
         break;
 
       case 'O':
-        m_sig.emit(offset_pixel{static_cast<int>(std::strtol(value.c_str(), nullptr, 10))});
+        m_sig.emit(offset_pixel{static_cast<int>(std::strtol(m_value.c_str(), nullptr, 10))});
         break;
 
       case 'l':
@@ -122,31 +126,27 @@ void parser::codeblock(string&& data, const bar_settings& bar) {
         break;
 
       case '+':
-        m_sig.emit(attribute_set{parse_attr(value[0])});
+        m_sig.emit(attribute_set{parse_attr(m_value[0])});
         break;
 
       case '-':
-        m_sig.emit(attribute_unset{parse_attr(value[0])});
+        m_sig.emit(attribute_unset{parse_attr(m_value[0])});
         break;
 
       case '!':
-        m_sig.emit(attribute_toggle{parse_attr(value[0])});
+        m_sig.emit(attribute_toggle{parse_attr(m_value[0])});
         break;
 
       case 'A':
-        if (isdigit(data[0]) || data[0] == ':') {
-          value = parse_action_cmd(data.substr(data[0] != ':' ? 1 : 0));
-          mousebtn btn = parse_action_btn(data);
+        if (pos < end && (isdigit(data[pos]) || data[pos] == ':')) {
+          mousebtn btn = parse_action_btn(data[pos]);
+          value_end = parse_action_cmd(data, data[pos] != ':' ? pos + 1 : pos, end);
           m_actions.push_back(static_cast<int>(btn));
-          m_sig.emit(action_begin{action{btn, value}});
-
-          // make sure we strip the correct length (btn+wrapping colons)
-          if (value[0] != ':') {
-            value += "0";
-          }
-          value += "::";
+          m_action.button = btn;
+          m_action.command.assign(m_value);
+          m_sig.emit(action_begin{move(m_action)});
         } else if (!m_actions.empty()) {
-          m_sig.emit(action_end{parse_action_btn(value)});
+          m_sig.emit(action_end{parse_action_btn(m_value[0])});
           m_actions.pop_back();
         }
         break;
@@ -155,25 +155,21 @@ void parser::codeblock(string&& data, const bar_settings& bar) {
         throw unrecognized_token("Unrecognized token '" + string{tag} + "'");
     }
 
-    if (!data.empty()) {
-      data.erase(0, !value.empty() ? value.length() : 1);
-    }
+    pos = std::max(value_end, pos + 1);
   }
 }
 
 /**
- * Process text contents
+ * Process text contents found at data[start, end)
  */
-size_t parser::text(string&& data) {
+void parser::text(const string& data, size_t start, size_t end) {
+  m_value.assign(data, start, end - start);
+
 #ifdef DEBUG_WHITESPACE
-  string::size_type p;
-  while ((p = data.find(' ')) != string::npos) {
-    data.replace(p, 1, "-"s);
-  }
+  std::replace(m_value.begin(), m_value.end(), ' ', '-');
 #endif
 
-  m_sig.emit(signals::parser::text{forward<string>(data)});
-  return data.size();
+  m_sig.emit(signals::parser::text{move(m_value)});
 }
 
 /**
@@ -218,11 +214,11 @@ attribute parser::parse_attr(const char attr) {
 /**
  * Process action button token and convert it to the correct value
  */
-mousebtn parser::parse_action_btn(const string& data) {
-  if (data[0] == ':') {
+mousebtn parser::parse_action_btn(const char btn) {
+  if (btn == ':') {
     return mousebtn::LEFT;
-  } else if (isdigit(data[0])) {
-    return static_cast<mousebtn>(data[0] - '0');
+  } else if (isdigit(btn)) {
+    return static_cast<mousebtn>(btn - '0');
   } else if (!m_actions.empty()) {
     return static_cast<mousebtn>(m_actions.back());
   } else {
@@ -231,23 +227,29 @@ mousebtn parser::parse_action_btn(const string& data) {
 }
 
 /**
- * Process action command string
+ * Process action command string starting at data[start] and store
+ * the command in the value buffer
+ *
+ * @return Position after the closing colon
  */
-string parser::parse_action_cmd(string&& data) {
-  if (data[0] != ':') {
-    return "";
+size_t parser::parse_action_cmd(const string& data, size_t start, size_t end) {
+  m_value.clear();
+
+  if (start >= end || data[start] != ':') {
+    return start;
   }
 
-  size_t end{1};
-  while ((end = data.find(':', end)) != string::npos && data[end - 1] == '\\') {
-    end++;
+  size_t pos{start + 1};
+  while ((pos = data.find(':', pos)) < end && data[pos - 1] == '\\') {
+    pos++;
   }
 
-  if (end == string::npos) {
-    return "";
+  if (pos >= end) {
+    return end;
   }
 
-  return data.substr(1, end - 1);
+  m_value.assign(data, start + 1, pos - start - 1);
+  return pos + 1;
 }
 
 POLYBAR_NS_END
@@ -118,14 +118,14 @@ renderer::renderer(
   m_log.trace("renderer: Load fonts");
   {
     double dpi_x = 96, dpi_y = 96;
-    if (m_conf.has(m_conf.section(), "dpi")) {
-      dpi_x = dpi_y = m_conf.get<double>("dpi");
+    if (m_conf.has(m_bar.section, "dpi")) {
+      dpi_x = dpi_y = m_conf.get<double>(m_bar.section, "dpi");
     } else {
-      if (m_conf.has(m_conf.section(), "dpi-x")) {
-        dpi_x = m_conf.get<double>("dpi-x");
+      if (m_conf.has(m_bar.section, "dpi-x")) {
+        dpi_x = m_conf.get<double>(m_bar.section, "dpi-x");
       }
-      if (m_conf.has(m_conf.section(), "dpi-y")) {
-        dpi_y = m_conf.get<double>("dpi-y");
+      if (m_conf.has(m_bar.section, "dpi-y")) {
+        dpi_y = m_conf.get<double>(m_bar.section, "dpi-y");
       }
     }
 
@@ -142,7 +142,7 @@ renderer::renderer(
 
     m_log.info("Configured DPI = %gx%g", dpi_x, dpi_y);
 
-    auto fonts = m_conf.get_list<string>(m_conf.section(), "font", {});
+    auto fonts = m_conf.get_list<string>(m_bar.section, "font", {});
     if (fonts.empty()) {
       m_log.warn("No fonts specified, using fallback font \"fixed\"");
       fonts.emplace_back("fixed");
@@ -168,7 +168,7 @@ renderer::renderer(
   m_comp_ul = m_conf.get<cairo_operator_t>("settings", "compositing-underline", m_comp_ul);
   m_comp_border = m_conf.get<cairo_operator_t>("settings", "compositing-border", m_comp_border);
 
-  m_fixedcenter = m_conf.get(m_conf.section(), "fixed-center", true);
+  m_fixedcenter = m_conf.get(m_bar.section, "fixed-center", true);
 }
 
 /**
@@ -199,6 +199,7 @@ void renderer::begin(xcb_rectangle_t rect) {
   m_log.trace_x("renderer: begin (geom=%ix%i+%i+%i)", rect.width, rect.height, rect.x, rect.y);
 
   // Reset state
+  m_drawing = true;
   m_rect = rect;
   m_actions.clear();
   m_attr.reset();
@@ -247,6 +248,7 @@ void renderer::begin(xcb_rectangle_t rect) {
  */
 void renderer::end() {
   m_log.trace_x("renderer: end");
+  m_drawing = false;
 
   for (auto&& a : m_actions) {
     a.start_x += block_x(a.align) + m_rect.x;
@@ -659,6 +661,9 @@ bool renderer::on(const signals::ui::request_snapshot& evt) {
 }
 
 bool renderer::on(const signals::parser::change_background& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   const unsigned int color{evt.cast()};
   if (color != m_bg) {
     m_log.trace_x("renderer: change_background(#%08x)", color);
@@ -668,6 +673,9 @@ bool renderer::on(const signals::parser::change_background& evt) {
 }
 
 bool renderer::on(const signals::parser::change_foreground& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   const unsigned int color{evt.cast()};
   if (color != m_fg) {
     m_log.trace_x("renderer: change_foreground(#%08x)", color);
@@ -677,6 +685,9 @@ bool renderer::on(const signals::parser::change_foreground& evt) {
 }
 
 bool renderer::on(const signals::parser::change_underline& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   const unsigned int color{evt.cast()};
   if (color != m_ul) {
     m_log.trace_x("renderer: change_underline(#%08x)", color);
@@ -686,6 +697,9 @@ bool renderer::on(const signals::parser::change_underline& evt) {
 }
 
 bool renderer::on(const signals::parser::change_overline& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   const unsigned int color{evt.cast()};
   if (color != m_ol) {
     m_log.trace_x("renderer: change_overline(#%08x)", color);
@@ -695,6 +709,9 @@ bool renderer::on(const signals::parser::change_overline& evt) {
 }
 
 bool renderer::on(const signals::parser::change_font& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   const int font{evt.cast()};
   if (font != m_font) {
     m_log.trace_x("renderer: change_font(%i)", font);
@@ -704,6 +721,9 @@ bool renderer::on(const signals::parser::change_font& evt) {
 }
 
 bool renderer::on(const signals::parser::change_alignment& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   auto align = static_cast<const alignment&>(evt.cast());
   if (align != m_align) {
     m_log.trace_x("renderer: change_alignment(%i)", static_cast<int>(align));
@@ -725,6 +745,9 @@ bool renderer::on(const signals::parser::change_alignment& evt) {
 }
 
 bool renderer::on(const signals::parser::reverse_colors&) {
+  if (!m_drawing) {
+    return false;
+  }
   m_log.trace_x("renderer: reverse_colors");
   m_fg = m_fg + m_bg;
   m_bg = m_fg - m_bg;
@@ -733,30 +756,45 @@ bool renderer::on(const signals::parser::reverse_colors&) {
 }
 
 bool renderer::on(const signals::parser::offset_pixel& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   m_log.trace_x("renderer: offset_pixel(%f)", evt.cast());
   m_blocks[m_align].x += evt.cast();
   return true;
 }
 
 bool renderer::on(const signals::parser::attribute_set& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   m_log.trace_x("renderer: attribute_set(%i)", static_cast<int>(evt.cast()));
   m_attr.set(static_cast<int>(evt.cast()), true);
   return true;
 }
 
 bool renderer::on(const signals::parser::attribute_unset& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   m_log.trace_x("renderer: attribute_unset(%i)", static_cast<int>(evt.cast()));
   m_attr.set(static_cast<int>(evt.cast()), false);
   return true;
 }
 
 bool renderer::on(const signals::parser::attribute_toggle& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   m_log.trace_x("renderer: attribute_toggle(%i)", static_cast<int>(evt.cast()));
   m_attr.flip(static_cast<int>(evt.cast()));
   return true;
 }
 
 bool renderer::on(const signals::parser::action_begin& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   auto a = evt.cast();
   m_log.trace_x("renderer: action_begin(btn=%i, command=%s)", static_cast<int>(a.button), a.command);
   action_block action{};
@@ -770,6 +808,9 @@ bool renderer::on(const signals::parser::action_begin& evt) {
 }
 
 bool renderer::on(const signals::parser::action_end& evt) {
+  if (!m_drawing) {
+    return false;
+  }
   auto btn = evt.cast();
 
   /*
@@ -787,8 +828,10 @@ bool renderer::on(const signals::parser::action_end& evt) {
 }
 
 bool renderer::on(const signals::parser::text& evt) {
-  auto text = evt.cast();
-  draw_text(text);
+  if (!m_drawing) {
+    return false;
+  }
+  draw_text(evt.get());
   return true;
 }
 
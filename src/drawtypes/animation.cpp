@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "drawtypes/animation.hpp"
 #include "drawtypes/label.hpp"
 #include "utils/factory.hpp"
@@ -37,6 +39,82 @@ namespace drawtypes {
     m_lastupdate = now;
   }
 
+  /**
+   * Get the clock shared by all modules
+   */
+  animation_clock::make_type animation_clock::make() {
+    return *factory_util::singleton<std::remove_reference_t<animation_clock::make_type>>();
+  }
+
+  animation_clock::~animation_clock() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_running = false;
+    }
+    m_cond.notify_all();
+
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  /**
+   * Call `fn` every `framerate` until the owner unsubscribes,
+   * the thread is started with the first subscription
+   */
+  void animation_clock::subscribe(const void* owner, chrono::milliseconds framerate, callback fn) {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_subscribers.emplace_back(subscriber{owner, framerate, move(fn), clock::now() + framerate});
+
+      if (!m_thread.joinable()) {
+        m_thread = std::thread(&animation_clock::run, this);
+      }
+    }
+    m_cond.notify_all();
+  }
+
+  /**
+   * Remove all callbacks registered by the owner
+   */
+  void animation_clock::unsubscribe(const void* owner) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(),
+                            [&](const subscriber& s) { return s.owner == owner; }),
+        m_subscribers.end());
+  }
+
+  /**
+   * Sleep until the next frame is due and call
+   * the callbacks of all subscribers that are due
+   */
+  void animation_clock::run() {
+    std::unique_lock<std::mutex> guard(m_mutex);
+
+    while (m_running) {
+      if (m_subscribers.empty()) {
+        m_cond.wait(guard);
+        continue;
+      }
+
+      auto next = std::min_element(m_subscribers.begin(), m_subscribers.end(),
+          [](const subscriber& a, const subscriber& b) { return a.next < b.next; })->next;
+
+      if (m_cond.wait_until(guard, next) != std::cv_status::timeout) {
+        continue;
+      }
+
+      auto now = clock::now();
+
+      for (auto&& s : m_subscribers) {
+        if (s.next <= now) {
+          s.next = now + s.framerate;
+          s.fn();
+        }
+      }
+    }
+  }
+
   /**
    * Create an animation by loading values
    * from the configuration
@@ -7,12 +7,12 @@
 POLYBAR_NS
 
 namespace drawtypes {
-  string label::get() const {
+  const string& label::get() const {
     return m_tokenized;
   }
 
   label::operator bool() {
-    return !m_tokenized.empty();
+    return !get().empty();
   }
 
   label_t label::clone() {
@@ -27,53 +27,74 @@ namespace drawtypes {
 
   void label::clear() {
     m_tokenized.clear();
+    m_cleared = true;
   }
 
   void label::reset_tokens() {
-    m_tokenized = m_text;
-  }
-
-  void label::reset_tokens(const string& tokenized) {
-    m_tokenized = tokenized;
+    for (auto&& seg : m_segments) {
+      seg.filled = false;
+    }
+    m_cleared = false;
+    rebuild();
   }
 
   bool label::has_token(const string& token) const {
-    return m_tokenized.find(token) != string::npos;
+    if (m_cleared) {
+      return false;
+    }
+    for (auto&& seg : m_segments) {
+      if (seg.token != string::npos && !seg.filled && m_tokens[seg.token].token == token) {
+        return true;
+      }
+    }
+    return false;
   }
 
-  void label::replace_token(const string& token, string replacement) {
-    if (!has_token(token)) {
+  void label::replace_token(const string& token, const string& replacement) {
+    if (m_cleared) {
       return;
     }
 
-    for (auto&& tok : m_tokens) {
-      string repl{replacement};
-      if (token == tok.token) {
-        if (tok.max != 0_z && string_util::char_len(repl) > tok.max) {
-          repl = string_util::utf8_truncate(std::move(repl), tok.max) + tok.suffix;
-        } else if (tok.min != 0_z && repl.length() < tok.min) {
-          repl.insert(0_z, tok.min - repl.length(), ' ');
-        }
+    bool replaced{false};
 
-        /*
-         * Only replace first occurence, so that the proper token objects can be used
-         */
-        m_tokenized = string_util::replace(m_tokenized, token, move(repl));
+    for (auto&& seg : m_segments) {
+      if (seg.token == string::npos || seg.filled) {
+        continue;
       }
+
+      auto& tok = m_tokens[seg.token];
+      if (token != tok.token) {
+        continue;
+      }
+
+      seg.value.assign(replacement);
+
+      if (tok.max != 0_z && string_util::char_len(seg.value) > tok.max) {
+        seg.value = string_util::utf8_truncate(std::move(seg.value), tok.max) + tok.suffix;
+      } else if (tok.min != 0_z && seg.value.length() < tok.min) {
+        seg.value.insert(0_z, tok.min - seg.value.length(), ' ');
+      }
+
+      seg.filled = true;
+      replaced = true;
+    }
+
+    if (replaced) {
+      rebuild();
     }
   }
 
   void label::replace_defined_values(const label_t& label) {
-    if (!label->m_foreground.empty()) {
+    if (label->m_foreground) {
       m_foreground = label->m_foreground;
     }
-    if (!label->m_background.empty()) {
+    if (label->m_background) {
       m_background = label->m_background;
     }
-    if (!label->m_underline.empty()) {
+    if (label->m_underline) {
       m_underline = label->m_underline;
     }
-    if (!label->m_overline.empty()) {
+    if (label->m_overline) {
       m_overline = label->m_overline;
     }
     if (label->m_font != 0) {
@@ -98,16 +119,16 @@ namespace drawtypes {
   }
 
   void label::copy_undefined(const label_t& label) {
-    if (m_foreground.empty() && !label->m_foreground.empty()) {
+    if (!m_foreground && label->m_foreground) {
       m_foreground = label->m_foreground;
     }
-    if (m_background.empty() && !label->m_background.empty()) {
+    if (!m_background && label->m_background) {
       m_background = label->m_background;
     }
-    if (m_underline.empty() && !label->m_underline.empty()) {
+    if (!m_underline && label->m_underline) {
       m_underline = label->m_underline;
     }
-    if (m_overline.empty() && !label->m_overline.empty()) {
+    if (!m_overline && label->m_overline) {
       m_overline = label->m_overline;
     }
     if (m_font == 0 && label->m_font != 0) {
@@ -132,129 +153,59 @@ namespace drawtypes {
   }
 
   /**
-   * Create a label by loading values from the configuration
+   * Split the template text into literal segments and token slots
+   *
+   * Tokens are matched in the order they were defined, each one
+   * consuming the first occurence following the previous slot
    */
-  label_t load_label(const config& conf, const string& section, string name, bool required, string def) {
-    vector<token> tokens;
-    size_t start, end, pos;
-
-    name = string_util::ltrim(string_util::rtrim(move(name), '>'), '<');
-
-    string text;
-
-    struct side_values padding {
-    }, margin{};
-
-    if (required) {
-      text = conf.get(section, name);
-    } else {
-      text = conf.get(section, name, move(def));
-    }
-
-    size_t len{text.size()};
-
-    if (len > 2 && text[0] == '"' && text[len - 1] == '"') {
-      text = text.substr(1, len - 2);
-    }
-
-    const auto get_left_right = [&](string key) {
-      auto value = conf.get(section, key, 0U);
-      auto left = conf.get(section, key + "-left", value);
-      auto right = conf.get(section, key + "-right", value);
-      return side_values{static_cast<unsigned short int>(left), static_cast<unsigned short int>(right)};
-    };
-
-    padding = get_left_right(name + "-padding");
-    margin = get_left_right(name + "-margin");
-
-    string line{text};
-
-    while ((start = line.find('%')) != string::npos && (end = line.find('%', start + 1)) != string::npos) {
-      auto token_str = line.substr(start, end - start + 1);
+  void label::compile() {
+    m_segments.clear();
 
-      // ignore false positives
-      //   lemonbar tags %{...}
-      //   trailing percentage signs %token%%
-      if (token_str.find_first_of("abcdefghijklmnopqrstuvwxyz") != 1) {
-        line.erase(0, end);
+    size_t pos{0_z};
+    for (size_t i = 0; i < m_tokens.size(); i++) {
+      size_t start{m_text.find(m_tokens[i].token, pos)};
+      if (start == string::npos) {
         continue;
       }
+      m_segments.emplace_back();
+      m_segments.back().text = m_text.substr(pos, start - pos);
+      m_segments.back().token = i;
+      pos = start + m_tokens[i].token.size();
+    }
 
-      line.erase(start, end - start + 1);
-      tokens.emplace_back(token{token_str, 0_z, 0_z});
-      auto& token = tokens.back();
-
-      // find min delimiter
-      if ((pos = token_str.find(':')) == string::npos) {
-        continue;
-      }
-
-      // strip min/max specifiers from the label string token
-      token.token = token_str.substr(0, pos) + '%';
-      text = string_util::replace(text, token_str, token.token);
-
-      try {
-        token.min = std::stoul(&token_str[pos + 1], nullptr, 10);
-      } catch (const std::invalid_argument& err) {
-        continue;
-      }
-
-      // find max delimiter
-      if ((pos = token_str.find(':', pos + 1)) == string::npos) {
-        continue;
-      }
-
-      try {
-        token.max = std::stoul(&token_str[pos + 1], nullptr, 10);
-      } catch (const std::invalid_argument& err) {
-        continue;
-      }
-
-      // ignore max lengths less than min
-      if (token.max < token.min) {
-        token.max = 0_z;
-      }
-
-      // find suffix delimiter
-      if ((pos = token_str.find(':', pos + 1)) != string::npos) {
-        token.suffix = token_str.substr(pos + 1, token_str.size() - pos - 2);
-      }
+    if (pos < m_text.size() || m_segments.empty()) {
+      m_segments.emplace_back();
+      m_segments.back().text = m_text.substr(pos);
     }
 
-    // clang-format off
-    return factory_util::shared<label>(text,
-        conf.get(section, name + "-foreground", ""s),
-        conf.get(section, name + "-background", ""s),
-        conf.get(section, name + "-underline", ""s),
-        conf.get(section, name + "-overline", ""s),
-        conf.get(section, name + "-font", 0),
-        padding,
-        margin,
-        conf.get(section, name + "-maxlen", 0_z),
-        conf.get(section, name + "-ellipsis", true),
-        move(tokens));
-    // clang-format on
+    rebuild();
   }
 
   /**
-   * Create a label by loading optional values from the configuration
+   * Join the segments into the tokenized text, token slots
+   * that are not filled in keep the token itself
+   *
+   * This is done whenever a slot changes rather than in get(), so
+   * that getting the text never modifies the label
    */
-  label_t load_optional_label(const config& conf, string section, string name, string def) {
-    return load_label(conf, move(section), move(name), false, move(def));
-  }
+  void label::rebuild() {
+    size_t len{0_z};
+    for (auto&& seg : m_segments) {
+      len += seg.text.size();
+      if (seg.token != string::npos) {
+        len += seg.filled ? seg.value.size() : m_tokens[seg.token].token.size();
+      }
+    }
 
-  /**
-   * Create an icon by loading values from the configuration
-   */
-  icon_t load_icon(const config& conf, string section, string name, bool required, string def) {
-    return load_label(conf, move(section), move(name), required, move(def));
-  }
+    m_tokenized.clear();
+    m_tokenized.reserve(len);
 
-  /**
-   * Create an icon by loading optional values from the configuration
-   */
-  icon_t load_optional_icon(const config& conf, string section, string name, string def) {
-    return load_icon(conf, move(section), move(name), false, move(def));
+    for (auto&& seg : m_segments) {
+      m_tokenized += seg.text;
+      if (seg.token != string::npos) {
+        m_tokenized += seg.filled ? seg.value : m_tokens[seg.token].token;
+      }
+    }
   }
 }
 
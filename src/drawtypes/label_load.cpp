@@ -0,0 +1,137 @@
+#include <utility>
+
+#include "drawtypes/label.hpp"
+#include "utils/factory.hpp"
+#include "utils/string.hpp"
+
+POLYBAR_NS
+
+namespace drawtypes {
+  /**
+   * Create a label by loading values from the configuration
+   */
+  label_t load_label(const config& conf, const string& section, string name, bool required, string def) {
+    vector<token> tokens;
+    size_t start, end, pos;
+
+    name = string_util::ltrim(string_util::rtrim(move(name), '>'), '<');
+
+    string text;
+
+    struct side_values padding {
+    }, margin{};
+
+    if (required) {
+      text = conf.get(section, name);
+    } else {
+      text = conf.get(section, name, move(def));
+    }
+
+    size_t len{text.size()};
+
+    if (len > 2 && text[0] == '"' && text[len - 1] == '"') {
+      text = text.substr(1, len - 2);
+    }
+
+    const auto get_left_right = [&](string key) {
+      auto value = conf.get(section, key, 0U);
+      auto left = conf.get(section, key + "-left", value);
+      auto right = conf.get(section, key + "-right", value);
+      return side_values{static_cast<unsigned short int>(left), static_cast<unsigned short int>(right)};
+    };
+
+    padding = get_left_right(name + "-padding");
+    margin = get_left_right(name + "-margin");
+
+    string line{text};
+
+    while ((start = line.find('%')) != string::npos && (end = line.find('%', start + 1)) != string::npos) {
+      auto token_str = line.substr(start, end - start + 1);
+
+      // ignore false positives
+      //   lemonbar tags %{...}
+      //   trailing percentage signs %token%%
+      if (token_str.find_first_of("abcdefghijklmnopqrstuvwxyz") != 1) {
+        line.erase(0, end);
+        continue;
+      }
+
+      line.erase(start, end - start + 1);
+      tokens.emplace_back(token{token_str, 0_z, 0_z});
+      auto& token = tokens.back();
+
+      // find min delimiter
+      if ((pos = token_str.find(':')) == string::npos) {
+        continue;
+      }
+
+      // strip min/max specifiers from the label string token
+      token.token = token_str.substr(0, pos) + '%';
+      text = string_util::replace(text, token_str, token.token);
+
+      try {
+        token.min = std::stoul(&token_str[pos + 1], nullptr, 10);
+      } catch (const std::invalid_argument& err) {
+        continue;
+      }
+
+      // find max delimiter
+      if ((pos = token_str.find(':', pos + 1)) == string::npos) {
+        continue;
+      }
+
+      try {
+        token.max = std::stoul(&token_str[pos + 1], nullptr, 10);
+      } catch (const std::invalid_argument& err) {
+        continue;
+      }
+
+      // ignore max lengths less than min
+      if (token.max < token.min) {
+        token.max = 0_z;
+      }
+
+      // find suffix delimiter
+      if ((pos = token_str.find(':', pos + 1)) != string::npos) {
+        token.suffix = token_str.substr(pos + 1, token_str.size() - pos - 2);
+      }
+    }
+
+    // clang-format off
+    return factory_util::shared<label>(text,
+        conf.get(section, name + "-foreground", argb{}),
+        conf.get(section, name + "-background", argb{}),
+        conf.get(section, name + "-underline", argb{}),
+        conf.get(section, name + "-overline", argb{}),
+        conf.get(section, name + "-font", 0),
+        padding,
+        margin,
+        conf.get(section, name + "-maxlen", 0_z),
+        conf.get(section, name + "-ellipsis", true),
+        move(tokens));
+    // clang-format on
+  }
+
+  /**
+   * Create a label by loading optional values from the configuration
+   */
+  label_t load_optional_label(const config& conf, string section, string name, string def) {
+    return load_label(conf, move(section), move(name), false, move(def));
+  }
+
+  /**
+   * Create an icon by loading values from the configuration
+   */
+  icon_t load_icon(const config& conf, string section, string name, bool required, string def) {
+    return load_label(conf, move(section), move(name), required, move(def));
+  }
+
+  /**
+   * Create an icon by loading optional values from the configuration
+   */
+  icon_t load_optional_icon(const config& conf, string section, string name, string def) {
+    return load_icon(conf, move(section), move(name), false, move(def));
+  }
+}
+
+POLYBAR_NS_END
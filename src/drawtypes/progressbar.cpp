@@ -10,14 +10,18 @@ POLYBAR_NS
 
 namespace drawtypes {
   progressbar::progressbar(const bar_settings& bar, int width, string format)
-      : m_builder(factory_util::unique<builder>(bar)), m_format(move(format)), m_width(width) {}
+      : m_builder(factory_util::unique<builder>(bar)), m_format(move(format)), m_width(width) {
+    invalidate();
+  }
 
   void progressbar::set_fill(icon_t&& fill) {
     m_fill = forward<decltype(fill)>(fill);
+    invalidate();
   }
 
   void progressbar::set_empty(icon_t&& empty) {
     m_empty = forward<decltype(empty)>(empty);
+    invalidate();
   }
 
   void progressbar::set_indicator(icon_t&& indicator) {
@@ -25,13 +29,15 @@ namespace drawtypes {
       m_width--;
     }
     m_indicator = forward<decltype(indicator)>(indicator);
+    invalidate();
   }
 
   void progressbar::set_gradient(bool mode) {
     m_gradient = mode;
+    invalidate();
   }
 
-  void progressbar::set_colors(vector<string>&& colors) {
+  void progressbar::set_colors(vector<argb>&& colors) {
     m_colors = forward<decltype(colors)>(colors);
 
     if (m_colors.empty()) {
@@ -39,29 +45,85 @@ namespace drawtypes {
     } else {
       m_colorstep = m_width / m_colors.size();
     }
-  }
 
-  string progressbar::output(float percentage) {
-    string output{m_format};
+    invalidate();
+  }
 
-    // Get fill/empty widths based on percentage
+  /**
+   * Get the rendered progressbar for given percentage
+   *
+   * There is only a limited number of distinct outputs, so each
+   * one is rendered the first time it's needed and then reused.
+   * The returned reference stays valid until the progressbar
+   * is changed by one of the setters
+   */
+  const string& progressbar::output(float percentage) {
+    // Get fill width based on percentage
     unsigned int perc = math_util::cap(percentage, 0.0f, 100.0f);
     unsigned int fill_width = math_util::percentage_to_value(perc, m_width);
+
+    // Without a gradient the fill color is picked by percentage
+    // rather than by the number of filled cells
+    size_t step{m_colors.empty() || m_gradient ? fill_width : perc};
+
+    if (m_outputs[step].empty()) {
+      render(m_outputs[step], perc, fill_width);
+    }
+
+    return m_outputs[step];
+  }
+
+  /**
+   * Drop all rendered outputs
+   *
+   * The memo has a slot for every possible step, so that it never
+   * grows and references handed out by output() are not moved
+   */
+  void progressbar::invalidate() {
+    m_outputs.assign(std::max(m_width, 100U) + 1, string{});
+  }
+
+  /**
+   * Render the format, substituting the fill, indicator and
+   * empty tokens with their built icons
+   */
+  void progressbar::render(string& output, unsigned int perc, unsigned int fill_width) {
     unsigned int empty_width = m_width - fill_width;
 
     // Output fill icons
     fill(perc, fill_width);
-    output = string_util::replace_all(output, "%fill%", m_builder->flush());
+    m_builder->flush(m_fill_output);
 
     // Output indicator icon
     m_builder->node(m_indicator);
-    output = string_util::replace_all(output, "%indicator%", m_builder->flush());
+    m_builder->flush(m_indicator_output);
 
     // Output empty icons
     m_builder->node_repeat(m_empty, empty_width);
-    output = string_util::replace_all(output, "%empty%", m_builder->flush());
+    m_builder->flush(m_empty_output);
+
+    output.clear();
+
+    size_t pos{0}, start;
+    while ((start = m_format.find('%', pos)) != string::npos) {
+      output.append(m_format, pos, start - pos);
+
+      if (m_format.compare(start, 6, "%fill%") == 0) {
+        output += m_fill_output;
+        pos = start + 6;
+      } else if (m_format.compare(start, 11, "%indicator%") == 0) {
+        output += m_indicator_output;
+        pos = start + 11;
+      } else if (m_format.compare(start, 7, "%empty%") == 0) {
+        output += m_empty_output;
+        pos = start + 7;
+      } else {
+        output += '%';
+        pos = start + 1;
+      }
+    }
 
-    return output;
+    output.append(m_format, pos, string::npos);
   }
 
   void progressbar::fill(unsigned int perc, unsigned int fill_width) {
@@ -81,61 +143,6 @@ namespace drawtypes {
       m_builder->node_repeat(m_fill, fill_width);
     }
   }
-
-  /**
-   * Create a progressbar by loading values
-   * from the configuration
-   */
-  progressbar_t load_progressbar(const bar_settings& bar, const config& conf, const string& section, string name) {
-    // Remove the start and end tag from the name in case a format tag is passed
-    name = string_util::ltrim(string_util::rtrim(move(name), '>'), '<');
-
-    string format = "%fill%%indicator%%empty%";
-    unsigned int width;
-
-    if ((format = conf.get(section, name + "-format", format)).empty()) {
-      throw application_error("Invalid format defined at [" + section + "." + name + "]");
-    }
-    if ((width = conf.get<decltype(width)>(section, name + "-width")) < 1) {
-      throw application_error("Invalid width defined at [" + section + "." + name + "]");
-    }
-
-    auto pbar = factory_util::shared<progressbar>(bar, width, format);
-    pbar->set_gradient(conf.get(section, name + "-gradient", true));
-    pbar->set_colors(conf.get_list(section, name + "-foreground", {}));
-
-    icon_t icon_empty;
-    icon_t icon_fill;
-    icon_t icon_indicator;
-
-    if (format.find("%empty%") != string::npos) {
-      icon_empty = load_icon(conf, section, name + "-empty");
-    }
-    if (format.find("%fill%") != string::npos) {
-      icon_fill = load_icon(conf, section, name + "-fill");
-    }
-    if (format.find("%indicator%") != string::npos) {
-      icon_indicator = load_icon(conf, section, name + "-indicator");
-    }
-
-    // If a foreground/background color is defined for the indicator
-    // but not for the empty icon we use the bar's default colors to
-    // avoid color bleed
-    if (icon_empty && icon_indicator) {
-      if (!icon_indicator->m_background.empty() && icon_empty->m_background.empty()) {
-        icon_empty->m_background = color_util::hex<unsigned short int>(bar.background);
-      }
-      if (!icon_indicator->m_foreground.empty() && icon_empty->m_foreground.empty()) {
-        icon_empty->m_foreground = color_util::hex<unsigned short int>(bar.foreground);
-      }
-    }
-
-    pbar->set_empty(move(icon_empty));
-    pbar->set_fill(move(icon_fill));
-    pbar->set_indicator(move(icon_indicator));
-
-    return pbar;
-  }
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,64 @@
+#include "drawtypes/label.hpp"
+#include "drawtypes/progressbar.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+namespace drawtypes {
+  /**
+   * Create a progressbar by loading values
+   * from the configuration
+   */
+  progressbar_t load_progressbar(const bar_settings& bar, const config& conf, const string& section, string name) {
+    // Remove the start and end tag from the name in case a format tag is passed
+    name = string_util::ltrim(string_util::rtrim(move(name), '>'), '<');
+
+    string format = "%fill%%indicator%%empty%";
+    unsigned int width;
+
+    if ((format = conf.get(section, name + "-format", format)).empty()) {
+      throw application_error("Invalid format defined at [" + section + "." + name + "]");
+    }
+    if ((width = conf.get<decltype(width)>(section, name + "-width")) < 1) {
+      throw application_error("Invalid width defined at [" + section + "." + name + "]");
+    }
+
+    auto pbar = factory_util::shared<progressbar>(bar, width, format);
+    pbar->set_gradient(conf.get(section, name + "-gradient", true));
+    pbar->set_colors(conf.get_list<argb>(section, name + "-foreground", {}));
+
+    icon_t icon_empty;
+    icon_t icon_fill;
+    icon_t icon_indicator;
+
+    if (format.find("%empty%") != string::npos) {
+      icon_empty = load_icon(conf, section, name + "-empty");
+    }
+    if (format.find("%fill%") != string::npos) {
+      icon_fill = load_icon(conf, section, name + "-fill");
+    }
+    if (format.find("%indicator%") != string::npos) {
+      icon_indicator = load_icon(conf, section, name + "-indicator");
+    }
+
+    // If a foreground/background color is defined for the indicator
+    // but not for the empty icon we use the bar's default colors to
+    // avoid color bleed
+    if (icon_empty && icon_indicator) {
+      if (icon_indicator->m_background && !icon_empty->m_background) {
+        icon_empty->m_background = argb{bar.background, argb::type::ARGB};
+      }
+      if (icon_indicator->m_foreground && !icon_empty->m_foreground) {
+        icon_empty->m_foreground = argb{bar.foreground, argb::type::ARGB};
+      }
+    }
+
+    pbar->set_empty(move(icon_empty));
+    pbar->set_fill(move(icon_fill));
+    pbar->set_indicator(move(icon_indicator));
+
+    return pbar;
+  }
+}
+
+POLYBAR_NS_END
@@ -95,10 +95,12 @@ int main(int argc, char** argv) {
     if (!cli->has(0)) {
       cli->usage();
       return EXIT_FAILURE;
-    } else if (cli->has(1)) {
-      fprintf(stderr, "Unrecognized argument \"%s\"\n", cli->get(1).c_str());
-      cli->usage();
-      return EXIT_FAILURE;
+    }
+
+    // Additional bar names are run from the same process
+    vector<string> bars;
+    for (size_t i = 0; cli->has(i); i++) {
+      bars.emplace_back(cli->get(i));
     }
 
     if (cli->has("config")) {
@@ -121,7 +123,7 @@ int main(int argc, char** argv) {
       return EXIT_SUCCESS;
     }
     if (cli->has("print-wmname")) {
-      printf("%s\n", bar::make(true)->settings().wmname.c_str());
+      printf("%s\n", bar::make("", true)->settings().wmname.c_str());
       return EXIT_SUCCESS;
     }
 
@@ -138,7 +140,7 @@ int main(int argc, char** argv) {
       config_watch = inotify_util::make_watch(conf.filepath());
     }
 
-    auto ctrl = controller::make(move(ipc), move(config_watch));
+    auto ctrl = controller::make(bars, move(ipc), move(config_watch));
 
     if (!ctrl->run(cli->has("stdout"), cli->get("png"))) {
       reload = true;
@@ -1,3 +1,6 @@
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "modules/alsa.hpp"
 #include "adapters/alsa/control.hpp"
 #include "adapters/alsa/generic.hpp"
@@ -55,18 +58,39 @@ namespace modules {
       if (!headphone_mixer_name.empty()) {
         m_mixer[mixer::HEADPHONE].reset(new mixer_t::element_type{move(headphone_mixer_name), move(h_soundcard_name)});
       }
-      if (m_mixer[mixer::HEADPHONE]) {
+      if (m_mixer.count(mixer::HEADPHONE)) {
         m_ctrl[control::HEADPHONE].reset(new control_t::element_type{m_headphoneid});
       }
       if (m_mixer.empty()) {
         throw module_error("No configured mixers");
       }
+
+      // Collect the descriptors that signal changes
+      for (auto&& mixer : m_mixer) {
+        if (mixer.second) {
+          mixer.second->get_poll_descriptors(m_fds);
+        }
+      }
+      for (auto&& ctrl : m_ctrl) {
+        if (ctrl.second) {
+          ctrl.second->get_poll_descriptors(m_fds);
+        }
+      }
     } catch (const mixer_error& err) {
       throw module_error(err.what());
     } catch (const control_error& err) {
       throw module_error(err.what());
     }
 
+    // Pipe used to interrupt idle() when the module is stopped
+    int wakeupfd[2];
+    if (pipe2(wakeupfd, O_CLOEXEC) != 0) {
+      throw module_error("Failed to create wakeup pipe");
+    }
+    m_wakeupfd[PIPE_READ] = make_unique<file_descriptor>(wakeupfd[PIPE_READ]);
+    m_wakeupfd[PIPE_WRITE] = make_unique<file_descriptor>(wakeupfd[PIPE_WRITE]);
+    m_fds.push_back(pollfd{*m_wakeupfd[PIPE_READ], POLLIN, 0});
+
     // Add formats and elements
     m_formatter->add(FORMAT_VOLUME, TAG_LABEL_VOLUME, {TAG_RAMP_VOLUME, TAG_LABEL_VOLUME, TAG_BAR_VOLUME});
     m_formatter->add(FORMAT_MUTED, TAG_LABEL_MUTED, {TAG_RAMP_VOLUME, TAG_LABEL_MUTED, TAG_BAR_VOLUME});
@@ -92,43 +116,56 @@ namespace modules {
     snd_config_update_free_global();
   }
 
-  bool alsa_module::has_event() {
-    // Poll for mixer and control events
-    try {
-      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(25)) {
-        return true;
+  /**
+   * Block until ALSA signals activity on one of the mixers
+   * or controls, or until the module is stopped
+   */
+  void alsa_module::idle() {
+    if (!running() || poll(m_fds.data(), m_fds.size(), -1) <= 0) {
+      return;
+    }
+
+    for (auto&& fd : m_fds) {
+      if (fd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        // Keep a removed device from waking the module in a loop
+        m_log.err("%s: Error on descriptor %i, ignoring it", name(), fd.fd);
+        fd.fd = -1;
       }
-      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(25)) {
-        return true;
+    }
+
+    if (m_fds.back().revents & POLLIN) {
+      char buffer[16];
+      if (read(*m_wakeupfd[PIPE_READ], buffer, sizeof(buffer)) == -1) {
+        m_log.err("%s: Failed to read from wakeup pipe", name());
       }
-      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(25)) {
-        return true;
+    }
+  }
+
+  void alsa_module::wakeup() {
+    if (write(*m_wakeupfd[PIPE_WRITE], "", 1) == -1) {
+      m_log.err("%s: Failed to wake up module thread", name());
+    }
+  }
+
+  bool alsa_module::has_event() {
+    bool changed{false};
+
+    // Consume pending mixer and control events
+    try {
+      for (auto&& mixer : m_mixer) {
+        changed = (mixer.second && mixer.second->process_events()) || changed;
       }
-      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(25)) {
-        return true;
+      for (auto&& ctrl : m_ctrl) {
+        changed = (ctrl.second && ctrl.second->process_events()) || changed;
       }
     } catch (const alsa_exception& e) {
       m_log.err("%s: %s", name(), e.what());
     }
 
-    return false;
+    return changed;
   }
 
   bool alsa_module::update() {
-    // Consume pending events
-    if (m_mixer[mixer::MASTER]) {
-      m_mixer[mixer::MASTER]->process_events();
-    }
-    if (m_mixer[mixer::SPEAKER]) {
-      m_mixer[mixer::SPEAKER]->process_events();
-    }
-    if (m_mixer[mixer::HEADPHONE]) {
-      m_mixer[mixer::HEADPHONE]->process_events();
-    }
-    if (m_ctrl[control::HEADPHONE]) {
-      m_ctrl[control::HEADPHONE]->process_events();
-    }
-
     // Get volume, mute and headphone state
     m_volume = 100;
     m_muted = false;
@@ -179,15 +216,15 @@ namespace modules {
     return true;
   }
 
-  string alsa_module::get_format() const {
+  const char* alsa_module::get_format() const {
     return m_muted ? FORMAT_MUTED : FORMAT_VOLUME;
   }
 
-  string alsa_module::get_output() {
+  void alsa_module::get_output(string& output) {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    module::get_output(output);
 
     if (m_handle_events) {
       m_builder->cmd(mousebtn::LEFT, EVENT_TOGGLE_MUTE);
@@ -197,7 +234,7 @@ namespace modules {
 
     m_builder->append(output);
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   bool alsa_module::build(builder* builder, const string& tag) const {
@@ -227,20 +264,20 @@ namespace modules {
     }
 
     try {
+      // The mixers are shared with the module thread, which
+      // picks up the resulting events on its own
+      std::lock_guard<std::mutex> guard(m_updatelock);
       vector<mixer_t> mixers;
       bool headphones{m_headphones};
 
       if (m_mixer[mixer::MASTER] && !m_mixer[mixer::MASTER]->get_name().empty()) {
-        mixers.emplace_back(new mixer_t::element_type(
-            string{m_mixer[mixer::MASTER]->get_name()}, string{m_mixer[mixer::MASTER]->get_sound_card()}));
+        mixers.emplace_back(m_mixer[mixer::MASTER]);
       }
       if (m_mixer[mixer::HEADPHONE] && !m_mixer[mixer::HEADPHONE]->get_name().empty() && headphones) {
-        mixers.emplace_back(new mixer_t::element_type(
-            string{m_mixer[mixer::HEADPHONE]->get_name()}, string{m_mixer[mixer::HEADPHONE]->get_sound_card()}));
+        mixers.emplace_back(m_mixer[mixer::HEADPHONE]);
       }
       if (m_mixer[mixer::SPEAKER] && !m_mixer[mixer::SPEAKER]->get_name().empty() && !headphones) {
-        mixers.emplace_back(new mixer_t::element_type(
-            string{m_mixer[mixer::SPEAKER]->get_name()}, string{m_mixer[mixer::SPEAKER]->get_sound_card()}));
+        mixers.emplace_back(m_mixer[mixer::SPEAKER]);
       }
 
       if (cmd.compare(0, strlen(EVENT_TOGGLE_MUTE), EVENT_TOGGLE_MUTE) == 0) {
@@ -260,12 +297,6 @@ namespace modules {
       } else {
         return false;
       }
-
-      for (auto&& mixer : mixers) {
-        if (mixer->wait(0)) {
-          mixer->process_events();
-        }
-      }
     } catch (const exception& err) {
       m_log.err("%s: Failed to handle command (%s)", name(), err.what());
     }
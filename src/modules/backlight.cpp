@@ -16,11 +16,11 @@ namespace modules {
     if (!file_util::exists(path)) {
       throw module_error("The file '" + path + "' does not exist");
     }
-    m_path = path;
+    m_reader = make_unique<file_reader>(path);
   }
 
-  float backlight_module::brightness_handle::read() const {
-    return std::strtof(file_util::contents(m_path).c_str(), nullptr);
+  float backlight_module::brightness_handle::read() {
+    return m_reader->read() ? std::strtof(m_reader->data(), nullptr) : 0.0f;
   }
 
   backlight_module::backlight_module(const bar_settings& bar, string name_)
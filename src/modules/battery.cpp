@@ -20,13 +20,19 @@ namespace modules {
     return reader.read();
   }
 
+  /**
+   * Each value reader keeps its own files open, as
+   * the readers are only guarded by their own lock
+   */
   void battery_module::create_battery_context(string path_adapter, string path_battery, struct battery_module::battery_context *ctx) {
     // Make state reader
     if (file_util::exists((ctx->m_fstate = path_adapter + "online"))) {
-      ctx->m_state_reader = make_unique<state_reader>([=] { return file_util::contents(ctx->m_fstate).compare(0, 1, "1") == 0; });
+      auto state = make_shared<file_reader>(ctx->m_fstate);
+      ctx->m_state_reader = make_unique<state_reader>([=] { return state->read() && state->data()[0] == '1'; });
     } else if (file_util::exists((ctx->m_fstate = path_battery + "status"))) {
+      auto state = make_shared<file_reader>(ctx->m_fstate);
       ctx->m_state_reader =
-          make_unique<state_reader>([=] { return file_util::contents(ctx->m_fstate).compare(0, 8, "Charging") == 0; });
+          make_unique<state_reader>([=] { return state->read() && strncmp(state->data(), "Charging", 8) == 0; });
     } else {
       throw module_error("No suitable way to get current charge state");
     }
@@ -38,9 +44,12 @@ namespace modules {
       throw module_error("No suitable way to get max capacity value");
     }
 
+    auto capnow = make_shared<file_reader>(ctx->m_fcapnow);
+    auto capfull = make_shared<file_reader>(ctx->m_fcapfull);
+
     ctx->m_capacity_reader = make_unique<capacity_reader>([=] {
-      auto cap_now = std::strtoul(file_util::contents(ctx->m_fcapnow).c_str(), nullptr, 10);
-      auto cap_max = std::strtoul(file_util::contents(ctx->m_fcapfull).c_str(), nullptr, 10);
+      unsigned long cap_now = capnow->integer();
+      unsigned long cap_max = capfull->integer();
       return math_util::percentage(cap_now, 0UL, cap_max);
     });
 
@@ -51,11 +60,16 @@ namespace modules {
       throw module_error("No suitable way to get current charge rate value");
     }
 
+    auto rate_file = make_shared<file_reader>(ctx->m_frate);
+    auto voltage_file = make_shared<file_reader>(ctx->m_fvoltage);
+    auto rate_capnow = make_shared<file_reader>(ctx->m_fcapnow);
+    auto rate_capfull = make_shared<file_reader>(ctx->m_fcapfull);
+
     ctx->m_rate_reader = make_unique<rate_reader>([=] {
-      unsigned long rate{std::strtoul(file_util::contents(ctx->m_frate).c_str(), nullptr, 10)};
-      unsigned long volt{std::strtoul(file_util::contents(ctx->m_fvoltage).c_str(), nullptr, 10) / 1000UL};
-      unsigned long now{std::strtoul(file_util::contents(ctx->m_fcapnow).c_str(), nullptr, 10)};
-      unsigned long max{std::strtoul(file_util::contents(ctx->m_fcapfull).c_str(), nullptr, 10)};
+      unsigned long rate = rate_file->integer();
+      unsigned long volt = voltage_file->integer() / 1000UL;
+      unsigned long now = rate_capnow->integer();
+      unsigned long max = rate_capfull->integer();
       unsigned long cap{read(*ctx->m_state_reader) ? max - now : now};
 
       if (rate && volt && cap) {
@@ -71,18 +85,21 @@ namespace modules {
     });
 
     // Make consumption reader
+    auto consumption_rate = make_shared<file_reader>(ctx->m_frate);
+    auto consumption_voltage = make_shared<file_reader>(ctx->m_fvoltage);
+
     ctx->m_consumption_reader = make_unique<consumption_reader>([=] {
       float consumption;
 
       // if the rate we found was the current, calculate power (P = I*V)
       if (string_util::contains(ctx->m_frate, "current_now")) {
-        unsigned long current{std::strtoul(file_util::contents(ctx->m_frate).c_str(), nullptr, 10)};
-        unsigned long voltage{std::strtoul(file_util::contents(ctx->m_fvoltage).c_str(), nullptr, 10)};
+        unsigned long current = consumption_rate->integer();
+        unsigned long voltage = consumption_voltage->integer();
 
         consumption = ((voltage / 1000.0) * (current /  1000.0)) / 1e6;
       // if it was power, just use as is
       } else {
-        unsigned long power{std::strtoul(file_util::contents(ctx->m_frate).c_str(), nullptr, 10)};
+        unsigned long power = consumption_rate->integer();
 
         consumption = power / 1e6;
       }
@@ -100,16 +117,21 @@ namespace modules {
    * Bootstrap module by setting up required components
    */
   battery_module::battery_module(const bar_settings& bar, string name_)
-      : inotify_module<battery_module>(bar, move(name_)) {
+      : event_module<battery_module>(bar, move(name_)) {
     // Load configuration values
     m_fullat = math_util::min(m_conf.get(name(), "full-at", m_fullat), 100);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "poll-interval", 5s);
     m_lastpoll = chrono::system_clock::now();
 
     vector<string> battery_names = m_conf.get_list(name(), "battery", vector<string>{"BAT0"s});
-    auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", m_conf.get(name(), "adapter", "ADP1"s)) + "/";
+    auto adapter = m_conf.get(name(), "adapter", "ADP1"s);
+    auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", adapter) + "/";
+
+    m_supplies.emplace(adapter);
 
     for (string bat : battery_names) {
+      m_supplies.emplace(bat);
+
       auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", bat) + "/";
 
       struct battery_module::battery_context *ctx = new struct battery_context;
@@ -122,12 +144,17 @@ namespace modules {
       return read(*m_batteries[0]->m_state_reader);
     });
 
+    vector<pair<shared_ptr<file_reader>, shared_ptr<file_reader>>> capacities;
+    for (struct battery_context *ctx : m_batteries) {
+      capacities.emplace_back(make_shared<file_reader>(ctx->m_fcapnow), make_shared<file_reader>(ctx->m_fcapfull));
+    }
+
     m_capacity_reader = make_unique<capacity_reader>([=] {
       unsigned long cap_now = 0;
       unsigned long cap_max = 0;
-      for (struct battery_context *ctx : m_batteries) {
-        cap_now += std::strtoul(file_util::contents(ctx->m_fcapnow).c_str(), nullptr, 10);
-        cap_max += std::strtoul(file_util::contents(ctx->m_fcapfull).c_str(), nullptr, 10);
+      for (auto&& capacity : capacities) {
+        cap_now += capacity.first->integer();
+        cap_max += capacity.second->integer();
       }
       return math_util::percentage(cap_now, 0UL, cap_max);
     });
@@ -140,10 +167,6 @@ namespace modules {
       return read(*m_batteries[0]->m_consumption_reader);
     });
 
-    // Load state and capacity level
-    m_state = current_state();
-    m_percentage = current_percentage(m_state);
-
     // Add formats and elements
     m_formatter->add(FORMAT_CHARGING, TAG_LABEL_CHARGING,
         {TAG_BAR_CAPACITY, TAG_RAMP_CAPACITY, TAG_ANIMATION_CHARGING, TAG_LABEL_CHARGING});
@@ -173,10 +196,12 @@ namespace modules {
       m_label_full = load_optional_label(m_conf, name(), TAG_LABEL_FULL, "%percentage%%");
     }
 
-    // Create inotify watches
-    for (struct battery_context *ctx : m_batteries) {
-      watch((ctx)->m_fcapnow, IN_ACCESS);
-      watch((ctx)->m_fstate, IN_ACCESS);
+    // Listen for changes reported by the kernel, polling
+    // the values is only a fallback if this isn't possible
+    try {
+      m_monitor = uevent_util::make_monitor("power_supply");
+    } catch (const system_error& err) {
+      m_log.warn("%s: Failed to listen for power supply events, polling values instead (%s)", name(), err.what());
     }
 
     // Setup time if token is used
@@ -187,68 +212,82 @@ namespace modules {
       }
       m_timeformat = m_conf.get(name(), "time-format", "%H:%M:%S"s);
     }
-  }
 
-  /**
-   * Dispatch the subthread used to update the
-   * charging animation when the module is started
-   */
-  void battery_module::start() {
-    this->inotify_module::start();
-    m_subthread = thread(&battery_module::subthread, this);
+    // Redraw animations through the shared clock
+    if (m_animation_charging) {
+      animation_clock::make().subscribe(this, chrono::milliseconds{m_animation_charging->framerate()},
+          [this] { animate(battery_module::state::CHARGING); });
+    }
+    if (m_animation_discharging) {
+      animation_clock::make().subscribe(this, chrono::milliseconds{m_animation_discharging->framerate()},
+          [this] { animate(battery_module::state::DISCHARGING); });
+    }
   }
 
   /**
-   * Release wake lock when stopping the module
+   * Stop redrawing the animations
    */
   void battery_module::teardown() {
-    if (m_subthread.joinable()) {
-      m_subthread.join();
-    }
+    animation_clock::make().unsubscribe(this);
   }
 
   /**
-   * Idle between polling inotify watches for events.
+   * Wait for a power supply event of the adapter or one of the batteries
    *
    * If the defined interval has been reached, trigger a manual
-   * poll in case the inotify events aren't fired.
+   * poll in case the kernel doesn't report all changes.
    *
-   * This fallback is needed because some systems won't
-   * report inotify events for files on sysfs.
+   * This fallback is needed because some drivers only send
+   * events when the adapter is plugged or unplugged.
    */
-  void battery_module::idle() {
+  bool battery_module::has_event() {
+    auto now = chrono::system_clock::now();
+    auto wait = chrono::milliseconds{1000};
+
     if (m_interval.count() > 0) {
-      auto now = chrono::system_clock::now();
-      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
-        m_lastpoll = now;
-        m_log.info("%s: Polling values (inotify fallback)", name());
-        read(*m_capacity_reader);
+      auto remaining = chrono::duration_cast<chrono::milliseconds>(m_interval - (now - m_lastpoll));
+
+      if (remaining.count() <= 0) {
+        m_log.info("%s: Polling values (uevent fallback)", name());
+        return true;
       }
+
+      wait = std::min(wait, remaining);
     }
 
-    this->inotify_module::idle();
+    if (!m_monitor) {
+      sleep(wait);
+      return false;
+    } else if (!m_monitor->poll(wait.count())) {
+      return false;
+    }
+
+    auto event = m_monitor->get_event();
+
+    if (!event || !m_supplies.count(event->property("POWER_SUPPLY_NAME"))) {
+      return false;
+    }
+
+    m_log.trace("%s: %s event reported for %s", name(), event->action, event->property("POWER_SUPPLY_NAME"));
+    return true;
   }
 
   /**
-   * Update values when tracked files have changed
+   * Update values after the power supply has changed
    */
-  bool battery_module::on_event(inotify_event* event) {
+  bool battery_module::update() {
     auto state = current_state();
     auto percentage = current_percentage(state);
 
     // Reset timer to avoid unnecessary polling
     m_lastpoll = chrono::system_clock::now();
 
-    if (event != nullptr) {
-      m_log.trace("%s: Inotify event reported for %s", name(), event->filename);
-
-      if (state == m_state && percentage == m_percentage && m_unchanged--) {
-        return false;
-      }
-
-      m_unchanged = SKIP_N_UNCHANGED;
+    if (state == m_state && percentage == m_percentage && m_unchanged--) {
+      return false;
     }
 
+    m_unchanged = SKIP_N_UNCHANGED;
+
     m_state = state;
     m_percentage = percentage;
 
@@ -278,7 +317,7 @@ namespace modules {
   /**
    * Get the output format based on state
    */
-  string battery_module::get_format() const {
+  const char* battery_module::get_format() const {
     if (m_state == battery_module::state::CHARGING) {
       return FORMAT_CHARGING;
     } else if (m_state == battery_module::state::DISCHARGING) {
@@ -367,33 +406,13 @@ namespace modules {
   }
 
   /**
-   * Subthread runner that emits update events to refresh <animation-charging>
-   * or <animation-discharging> in case they are used. Note, that it is ok to
-   * use a single thread, because the two animations are never shown at the
-   * same time.
+   * Redraw the animation of given state, called by the animation clock.
+   * Note, that the two animations are never shown at the same time.
    */
-  void battery_module::subthread() {
-    chrono::duration<double> dur{0.0};
-
-    if (battery_module::state::CHARGING == m_state && m_animation_charging) {
-      dur += chrono::milliseconds{m_animation_charging->framerate()};
-    } else if (battery_module::state::DISCHARGING == m_state && m_animation_discharging) {
-      dur += chrono::milliseconds{m_animation_discharging->framerate()};
-    } else {
-      dur += 1s;
+  void battery_module::animate(state state) {
+    if (running() && m_state == state) {
+      broadcast();
     }
-
-    while (running()) {
-      for (int i = 0; running() && i < dur.count(); ++i) {
-        if (m_state == battery_module::state::CHARGING ||
-            m_state == battery_module::state::DISCHARGING) {
-          broadcast();
-        }
-        sleep(dur);
-      }
-    }
-
-    m_log.trace("%s: End of subthread", name());
   }
 }
 
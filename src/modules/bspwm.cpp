@@ -145,109 +145,151 @@ namespace modules {
     event_module::stop();
   }
 
+  /**
+   * Wait for data from the subscriber, returns true
+   * once at least one complete report was received
+   */
   bool bspwm_module::has_event() {
-    if (m_subscriber->poll(POLLHUP, 0)) {
+    if (m_reconnect) {
       m_log.warn("%s: Reconnecting to socket...", name());
       m_subscriber = bspwm_util::make_subscriber();
+      m_buffer.clear();
+      m_reconnect = false;
     }
-    return m_subscriber->peek(1);
-  }
 
-  bool bspwm_module::update() {
-    if (!m_subscriber) {
+    if (!m_subscriber->poll(POLLIN | POLLHUP)) {
       return false;
     }
 
-    string data{m_subscriber->receive(BUFSIZ)};
-    bool result = false;
-
-    for (auto&& status_line : string_util::split(data, '\n')) {
-      // Need to return true if ANY of the handle_status calls
-      // return true
-      result = this->handle_status(status_line) || result;
+    // Reconnect on the next call, which is skipped when the module is stopping
+    if (!m_subscriber->receive_available(m_buffer)) {
+      m_reconnect = true;
     }
 
-    return result;
+    return m_buffer.find('\n') != string::npos;
   }
 
-  bool bspwm_module::handle_status(string& data) {
-    if (data.empty()) {
-      return false;
+  /**
+   * Parse the received reports, incomplete data is kept
+   * in the buffer until the rest of the report arrives
+   */
+  bool bspwm_module::update() {
+    const size_t prefix_len{strlen(BSPWM_STATUS_PREFIX)};
+    const char* report{nullptr};
+    const char* report_end{nullptr};
+    size_t pos{0U};
+    size_t eol;
+
+    // Each report describes the complete state, so only the last one has to be parsed
+    while ((eol = m_buffer.find('\n', pos)) != string::npos) {
+      if (m_buffer.compare(pos, prefix_len, BSPWM_STATUS_PREFIX) == 0) {
+        report = m_buffer.data() + pos;
+        report_end = m_buffer.data() + eol;
+      } else if (eol > pos) {
+        m_log.err("%s: Unknown status '%s'", name(), m_buffer.substr(pos, eol - pos));
+      }
+      pos = eol + 1;
     }
 
-    size_t prefix_len{strlen(BSPWM_STATUS_PREFIX)};
-    if (data.compare(0, prefix_len, BSPWM_STATUS_PREFIX) != 0) {
-      m_log.err("%s: Unknown status '%s'", name(), data);
-      return false;
-    }
+    bool result = report != nullptr && handle_status(report + prefix_len, report_end);
+    m_buffer.erase(0, pos);
 
-    string_util::hash_type hash;
-    if ((hash = string_util::hash(data)) == m_hash) {
-      return false;
-    }
+    return result;
+  }
 
-    m_hash = hash;
+  /**
+   * Update the monitors with the given report, the labels of desktops
+   * that are unchanged since the last report are kept
+   */
+  bool bspwm_module::handle_status(const char* begin, const char* end) {
+    m_log.trace("%s: Parsing socket data: %s", name(), string{begin, end});
 
-    size_t pos;
+    vector<unique_ptr<bspwm_monitor>> monitors;
+    parse_status(begin, end, monitors);
 
-    // Extract the string for the defined monitor
-    if (m_pinworkspaces) {
-      const auto needle_active = ":M" + m_bar.monitor->name + ":";
-      const auto needle_inactive = ":m" + m_bar.monitor->name + ":";
+    bool changed{monitors.size() != m_monitors.size()};
 
-      if ((pos = data.find(BSPWM_STATUS_PREFIX)) != string::npos) {
-        data = data.replace(pos, prefix_len, ":");
+    for (size_t i = 0U; i < monitors.size(); i++) {
+      auto& mon = *monitors[i];
+      bspwm_monitor* prev{nullptr};
+
+      if (i < m_monitors.size() && m_monitors[i]->name == mon.name) {
+        prev = m_monitors[i].get();
       }
-      if ((pos = data.find(needle_active)) != string::npos) {
-        data.erase(0, pos + 1);
+
+      if (prev == nullptr || prev->focused != mon.focused || prev->workspaces.size() != mon.workspaces.size()) {
+        changed = true;
       }
-      if ((pos = data.find(needle_inactive)) != string::npos) {
-        data.erase(0, pos + 1);
+
+      if (m_monitorlabel && prev != nullptr) {
+        mon.label = move(prev->label);
+      } else if (m_monitorlabel) {
+        mon.label = m_monitorlabel->clone();
+        mon.label->replace_token("%name%", mon.name);
       }
-      if ((pos = data.find(":m", 1)) != string::npos) {
-        data.erase(pos);
+
+      for (size_t j = 0U; j < mon.workspaces.size(); j++) {
+        auto& ws = mon.workspaces[j];
+
+        if (prev != nullptr && prev->focused == mon.focused && j < prev->workspaces.size() &&
+            prev->workspaces[j].mask == ws.mask && prev->workspaces[j].index == ws.index &&
+            prev->workspaces[j].name == ws.name) {
+          ws.label = move(prev->workspaces[j].label);
+        } else {
+          ws.label = make_workspace_label(ws, mon.focused);
+          changed = true;
+        }
       }
-      if ((pos = data.find(":M", 1)) != string::npos) {
-        data.erase(pos);
+
+      if (prev != nullptr && prev->mode_flags == mon.mode_flags) {
+        mon.modes = move(prev->modes);
+      } else {
+        for (auto&& flag : mon.mode_flags) {
+          mon.modes.emplace_back(m_modelabels.find(flag)->second->clone());
+        }
+        changed = true;
       }
-    } else if ((pos = data.find(BSPWM_STATUS_PREFIX)) != string::npos) {
-      data = data.replace(pos, prefix_len, ":");
-    } else {
-      return false;
     }
 
-    m_log.info("%s: Parsing socket data: %s", name(), data);
+    m_monitors = move(monitors);
 
-    m_monitors.clear();
+    return changed;
+  }
 
-    size_t workspace_n{0U};
+  /**
+   * Split the report into monitors, their desktops and modes
+   */
+  void bspwm_module::parse_status(const char* begin, const char* end, vector<unique_ptr<bspwm_monitor>>& monitors) {
+    bspwm_monitor* monitor{nullptr};
 
-    for (auto&& tag : string_util::split(data, ':')) {
-      if (tag.empty()) {
+    for (const char* pos = begin; pos < end;) {
+      auto separator = static_cast<const char*>(memchr(pos, ':', end - pos));
+      separator = separator != nullptr ? separator : end;
+
+      if (separator == pos) {
+        pos++;
         continue;
       }
 
-      auto value = !tag.empty() ? tag.substr(1) : "";
-      auto mode_flag = mode::NONE;
-      unsigned int workspace_mask{0U};
-
-      if (tag[0] == 'm' || tag[0] == 'M') {
-        m_monitors.emplace_back(factory_util::unique<bspwm_monitor>());
-        m_monitors.back()->name = value;
+      const char tag{*pos};
+      string value{pos + 1, separator};
+      pos = separator + 1;
 
-        if (m_monitorlabel) {
-          m_monitors.back()->label = m_monitorlabel->clone();
-          m_monitors.back()->label->replace_token("%name%", value);
-        }
+      if (tag == 'm' || tag == 'M') {
+        monitors.emplace_back(factory_util::unique<bspwm_monitor>());
+        monitor = monitors.back().get();
+        monitor->name = move(value);
+        monitor->focused = tag == 'M';
+        continue;
+      } else if (monitor == nullptr) {
+        m_log.warn("%s: No monitor created", name());
+        continue;
       }
 
-      switch (tag[0]) {
-        case 'm':
-          m_monitors.back()->focused = false;
-          break;
-        case 'M':
-          m_monitors.back()->focused = true;
-          break;
+      auto mode_flag = mode::NONE;
+      unsigned int workspace_mask{0U};
+
+      switch (tag) {
         case 'F':
           workspace_mask = make_mask(state::FOCUSED, state::EMPTY);
           break;
@@ -302,14 +344,12 @@ namespace modules {
           break;
 
         case 'G':
-          if (!m_monitors.back()->focused) {
+          if (!monitor->focused) {
             break;
           }
 
           for (size_t i = 0U; i < value.length(); i++) {
             switch (value[i]) {
-              case 0:
-                break;
               case 'L':
                 mode_flag = mode::NODE_LOCKED;
                 break;
@@ -321,71 +361,95 @@ namespace modules {
                 break;
               default:
                 m_log.warn("%s: Undefined G => '%s'", name(), value.substr(i, 1));
+                continue;
             }
 
-            if (mode_flag != mode::NONE && !m_modelabels.empty()) {
-              m_monitors.back()->modes.emplace_back(m_modelabels.find(mode_flag)->second->clone());
+            if (!m_modelabels.empty()) {
+              monitor->mode_flags.emplace_back(mode_flag);
             }
           }
           continue;
 
         default:
-          m_log.warn("%s: Undefined tag => '%s'", name(), tag.substr(0, 1));
+          m_log.warn("%s: Undefined tag => '%s'", name(), string(1, tag));
           continue;
       }
 
-      if (!m_monitors.back()) {
-        m_log.warn("%s: No monitor created", name());
-        continue;
-      }
-
       if (workspace_mask && m_formatter->has(TAG_LABEL_STATE)) {
-        auto icon = m_icons->get(value, DEFAULT_ICON, m_fuzzy_match);
-        auto label = m_statelabels.at(workspace_mask)->clone();
+        monitor->workspaces.emplace_back();
+        monitor->workspaces.back().mask = workspace_mask;
+        monitor->workspaces.back().name = move(value);
+      }
 
-        if (!m_monitors.back()->focused) {
-          if (m_statelabels[make_mask(state::DIMMED)]) {
-            label->replace_defined_values(m_statelabels[make_mask(state::DIMMED)]);
-          }
-          if (workspace_mask & make_mask(state::EMPTY)) {
-            label->replace_defined_values(m_statelabels[make_mask(state::DIMMED, state::EMPTY)]);
-          }
-          if (workspace_mask & make_mask(state::OCCUPIED)) {
-            label->replace_defined_values(m_statelabels[make_mask(state::DIMMED, state::OCCUPIED)]);
-          }
-          if (workspace_mask & make_mask(state::FOCUSED)) {
-            label->replace_defined_values(m_statelabels[make_mask(state::DIMMED, state::FOCUSED)]);
-          }
-          if (workspace_mask & make_mask(state::URGENT)) {
-            label->replace_defined_values(m_statelabels[make_mask(state::DIMMED, state::URGENT)]);
-          }
-        }
+      if (mode_flag != mode::NONE && !m_modelabels.empty()) {
+        monitor->mode_flags.emplace_back(mode_flag);
+      }
+    }
 
-        label->reset_tokens();
-        label->replace_token("%name%", value);
-        label->replace_token("%icon%", icon->get());
-        label->replace_token("%index%", to_string(++workspace_n));
+    // Only keep the monitor of the bar, or the first one if it is not reported
+    if (m_pinworkspaces && !monitors.empty()) {
+      auto pinned = find_if(monitors.begin(), monitors.end(),
+          [&](const unique_ptr<bspwm_monitor>& mon) { return mon->name == m_bar.monitor->name; });
+      auto mon = move(pinned != monitors.end() ? *pinned : monitors.front());
+      monitors.clear();
+      monitors.emplace_back(move(mon));
+    }
 
-        m_monitors.back()->workspaces.emplace_back(workspace_mask, move(label));
+    size_t workspace_n{0U};
+    for (auto&& mon : monitors) {
+      for (auto&& ws : mon->workspaces) {
+        ws.index = ++workspace_n;
       }
+    }
+  }
 
-      if (mode_flag != mode::NONE && !m_modelabels.empty()) {
-        m_monitors.back()->modes.emplace_back(m_modelabels.find(mode_flag)->second->clone());
+  /**
+   * Create the label of a desktop
+   */
+  label_t bspwm_module::make_workspace_label(const bspwm_workspace& ws, bool focused_monitor) const {
+    const auto state_label = [&](unsigned int mask) {
+      auto it = m_statelabels.find(mask);
+      return it != m_statelabels.end() ? it->second : label_t{};
+    };
+
+    auto icon = m_icons->get(ws.name, DEFAULT_ICON, m_fuzzy_match);
+    auto label = m_statelabels.at(ws.mask)->clone();
+
+    if (!focused_monitor) {
+      if (state_label(make_mask(state::DIMMED))) {
+        label->replace_defined_values(state_label(make_mask(state::DIMMED)));
+      }
+      if (ws.mask & make_mask(state::EMPTY)) {
+        label->replace_defined_values(state_label(make_mask(state::DIMMED, state::EMPTY)));
+      }
+      if (ws.mask & make_mask(state::OCCUPIED)) {
+        label->replace_defined_values(state_label(make_mask(state::DIMMED, state::OCCUPIED)));
+      }
+      if (ws.mask & make_mask(state::FOCUSED)) {
+        label->replace_defined_values(state_label(make_mask(state::DIMMED, state::FOCUSED)));
+      }
+      if (ws.mask & make_mask(state::URGENT)) {
+        label->replace_defined_values(state_label(make_mask(state::DIMMED, state::URGENT)));
       }
     }
 
-    return true;
+    label->reset_tokens();
+    label->replace_token("%name%", ws.name);
+    label->replace_token("%icon%", icon->get());
+    label->replace_token("%index%", to_string(ws.index));
+
+    return label;
   }
 
-  string bspwm_module::get_output() {
-    string output;
+  void bspwm_module::get_output(string& output) {
+    output.clear();
     for (m_index = 0U; m_index < m_monitors.size(); m_index++) {
       if (m_index > 0) {
         m_builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
       }
-      output += this->event_module::get_output();
+      this->event_module::get_output(m_monitoroutput);
+      output += m_monitoroutput;
     }
-    return output;
   }
 
   bool bspwm_module::build(builder* builder, const string& tag) const {
@@ -401,7 +465,7 @@ namespace modules {
       }
 
       for (auto&& ws : m_monitors[m_index]->workspaces) {
-        if (ws.second.get()) {
+        if (ws.label) {
           if(workspace_n != 0 && *m_labelseparator) {
             builder->node(m_labelseparator);
           }
@@ -409,12 +473,12 @@ namespace modules {
           workspace_n++;
 
           if (m_click) {
-            builder->cmd(mousebtn::LEFT, sstream() << EVENT_CLICK << m_index << "+" << workspace_n, ws.second);
+            builder->cmd(mousebtn::LEFT, sstream() << EVENT_CLICK << m_index << "+" << workspace_n, ws.label);
           } else {
-            builder->node(ws.second);
+            builder->node(ws.label);
           }
 
-          if (m_inlinemode && m_monitors[m_index]->focused && check_mask(ws.first, bspwm_state::FOCUSED)) {
+          if (m_inlinemode && m_monitors[m_index]->focused && check_mask(ws.mask, bspwm_state::FOCUSED)) {
             for (auto&& mode : m_monitors[m_index]->modes) {
               builder->node(mode);
             }
@@ -1,6 +1,3 @@
-#include <fstream>
-#include <istream>
-
 #include "modules/cpu.hpp"
 
 #include "drawtypes/label.hpp"
@@ -20,6 +17,8 @@ namespace modules {
 
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
 
+    m_provider = procfs::stat_provider::acquire(PATH_CPU_INFO, PATH_CPU_INFO);
+
     // warmup cpu times
     read_values();
     read_values();
@@ -34,16 +33,6 @@ namespace modules {
       m_rampload_core = load_ramp(m_conf, name(), TAG_RAMP_LOAD_PER_CORE);
     }
     if (m_formatter->has(TAG_LABEL)) {
-      // Update the label parameter and replace the %percentag-cores% token with the individual core tokens
-      string key{&TAG_LABEL[1], strlen(TAG_LABEL) - 2};
-      auto label = m_conf.get<string>(name(), key, "%percentage%%");
-      vector<string> cores;
-      for (size_t i = 1; i <= m_cputimes.size(); i++) {
-        cores.emplace_back("%percentage-core" + to_string(i) + "%%");
-      }
-      label = string_util::replace_all(label, "%percentage-cores%", string_util::join(cores, " "));
-      const_cast<config&>(m_conf).set(name(), key, move(label));
-
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "%percentage%%");
     }
   }
@@ -56,7 +45,7 @@ namespace modules {
     m_total = 0.0f;
     m_load.clear();
 
-    auto cores_n = m_cputimes.size();
+    auto cores_n = m_cputimes->size();
     if (!cores_n) {
       return false;
     }
@@ -81,6 +70,15 @@ namespace modules {
       for (size_t i = 0; i < percentage_cores.size(); i++) {
         m_label->replace_token("%percentage-core" + to_string(i + 1) + "%", percentage_cores[i]);
       }
+
+      // %percentage-cores% is filled in here instead of rewriting the
+      // configured label, which would make every reload see a change
+      if (m_label->has_token("%percentage-cores%")) {
+        for (auto&& core : percentage_cores) {
+          core += '%';
+        }
+        m_label->replace_token("%percentage-cores%", string_util::join(percentage_cores, " "));
+      }
     }
 
     return true;
@@ -109,50 +107,34 @@ namespace modules {
   }
 
   bool cpu_module::read_values() {
-    m_cputimes_prev.swap(m_cputimes);
-    m_cputimes.clear();
-
-    try {
-      std::ifstream in(PATH_CPU_INFO);
-      string str;
-
-      while (std::getline(in, str) && str.compare(0, 3, "cpu") == 0) {
-        // skip line with accumulated value
-        if (str.compare(0, 4, "cpu ") == 0) {
-          continue;
-        }
-
-        auto values = string_util::split(str, ' ');
-
-        m_cputimes.emplace_back(new cpu_time);
-        m_cputimes.back()->user = std::stoull(values[1], nullptr, 10);
-        m_cputimes.back()->nice = std::stoull(values[2], nullptr, 10);
-        m_cputimes.back()->system = std::stoull(values[3], nullptr, 10);
-        m_cputimes.back()->idle = std::stoull(values[4], nullptr, 10);
-        m_cputimes.back()->total =
-            m_cputimes.back()->user + m_cputimes.back()->nice + m_cputimes.back()->system + m_cputimes.back()->idle;
-      }
-    } catch (const std::ios_base::failure& e) {
-      m_log.err("Failed to read CPU values (what: %s)", e.what());
+    // Modules polling on the same interval share the read, the half
+    // interval leaves room for timers that fire slightly early
+    auto times = m_provider->get(m_interval / 2);
+
+    if (!times) {
+      m_log.err("%s: Failed to read CPU values", name());
+    } else if (times != m_cputimes) {
+      m_cputimes_prev = move(m_cputimes);
+      m_cputimes = move(times);
     }
 
-    return !m_cputimes.empty();
+    return m_cputimes && !m_cputimes->empty();
   }
 
   float cpu_module::get_load(size_t core) const {
-    if (m_cputimes.empty() || m_cputimes_prev.empty()) {
+    if (!m_cputimes || !m_cputimes_prev) {
       return 0;
-    } else if (core >= m_cputimes.size() || core >= m_cputimes_prev.size()) {
+    } else if (core >= m_cputimes->size() || core >= m_cputimes_prev->size()) {
       return 0;
     }
 
-    auto& last = m_cputimes[core];
-    auto& prev = m_cputimes_prev[core];
+    auto& last = (*m_cputimes)[core];
+    auto& prev = (*m_cputimes_prev)[core];
 
-    auto last_idle = last->idle;
-    auto prev_idle = prev->idle;
+    auto last_idle = last.idle;
+    auto prev_idle = prev.idle;
 
-    auto diff = last->total - prev->total;
+    auto diff = last.total - prev.total;
 
     if (diff == 0) {
       return 0;
@@ -1,5 +1,4 @@
-#include <sys/statvfs.h>
-#include <fstream>
+#include <poll.h>
 
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
@@ -13,14 +12,127 @@
 
 POLYBAR_NS
 
-// Columns in /proc/self/mountinfo
-#define MOUNTINFO_DIR 4
-#define MOUNTINFO_TYPE 7
-#define MOUNTINFO_FSNAME 8
-
 namespace modules {
   template class module<fs_module>;
 
+  // class : fs_stat_pool {{{
+
+  fs_stat_pool::fs_stat_pool(size_t max_workers) : m_state(make_shared<shared_state>()) {
+    m_state->max_workers = max_workers;
+  }
+
+  /**
+   * Let idle workers exit, busy ones exit once their call returns
+   */
+  fs_stat_pool::~fs_stat_pool() {
+    std::lock_guard<std::mutex> guard(m_state->mtx);
+    m_state->stopped = true;
+    m_state->queued.notify_all();
+  }
+
+  /**
+   * Query the given mountpoints, waiting at most for the given timeout
+   *
+   * Mountpoints whose previous call is still in progress are not queried
+   * again, they are returned with `pending` set like those that timed out.
+   * Workers still blocked once the timeout expired are replaced
+   */
+  map<string, fs_stat> fs_stat_pool::query(const vector<string>& mountpoints, chrono::duration<double> timeout) {
+    const auto until = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(timeout);
+    std::unique_lock<std::mutex> guard(m_state->mtx);
+
+    for (auto&& mountpoint : mountpoints) {
+      auto& stat = m_state->stats[mountpoint];
+      if (!stat.pending) {
+        stat.pending = true;
+        m_state->queue.emplace_back(mountpoint);
+      }
+    }
+
+    grow();
+    m_state->queued.notify_all();
+    m_state->finished.wait_until(guard, until, [&] {
+      return std::none_of(mountpoints.begin(), mountpoints.end(),
+          [&](const string& mountpoint) { return m_state->stats[mountpoint].pending; });
+    });
+
+    // Calls that are in progress, i.e. no longer queued, have hung
+    bool hung{false};
+    for (auto&& mountpoint : mountpoints) {
+      auto& stat = m_state->stats[mountpoint];
+      if (stat.pending && !stat.hung &&
+          std::find(m_state->queue.begin(), m_state->queue.end(), mountpoint) == m_state->queue.end()) {
+        stat.hung = true;
+        m_state->hung++;
+        hung = true;
+      }
+    }
+
+    // Let the queued mountpoints be served until the next query
+    if (hung) {
+      grow();
+      m_state->queued.notify_all();
+    }
+
+    map<string, fs_stat> result;
+    for (auto&& mountpoint : mountpoints) {
+      result.emplace(mountpoint, m_state->stats[mountpoint]);
+    }
+    return result;
+  }
+
+  /**
+   * Start workers for queued mountpoints while the current ones
+   * are busy, not counting those blocked by a hung mount
+   */
+  void fs_stat_pool::grow() {
+    while (m_state->idle < m_state->queue.size() && m_state->workers - m_state->hung < m_state->max_workers) {
+      m_state->workers++;
+      m_state->idle++;
+      thread(&fs_stat_pool::work, m_state).detach();
+    }
+  }
+
+  void fs_stat_pool::work(shared_ptr<shared_state> state) {
+    std::unique_lock<std::mutex> guard(state->mtx);
+
+    while (true) {
+      state->queued.wait(guard, [&] { return state->stopped || !state->queue.empty(); });
+
+      if (state->stopped) {
+        state->workers--;
+        return;
+      }
+
+      auto mountpoint = move(state->queue.front());
+      state->queue.pop_front();
+      state->idle--;
+      guard.unlock();
+
+      fs_stat stat{};
+      if (statvfs(mountpoint.c_str(), &stat.buffer) == -1) {
+        stat.error = errno;
+      }
+
+      guard.lock();
+      auto& result = state->stats[mountpoint];
+      if (result.hung) {
+        state->hung--;
+      }
+      result = stat;
+      state->finished.notify_all();
+
+      // Exit if this worker was replaced while it was blocked
+      if (state->workers - state->hung > state->max_workers) {
+        state->workers--;
+        return;
+      }
+      state->idle++;
+    }
+  }
+
+  // }}}
+
   /**
    * Bootstrap the module by reading config values and
    * setting up required components
@@ -31,11 +143,16 @@ namespace modules {
     m_fixed = m_conf.get(name(), "fixed-values", m_fixed);
     m_spacing = m_conf.get(name(), "spacing", m_spacing);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 30s);
+    m_timeout = m_conf.get<decltype(m_timeout)>(name(), "query-timeout", 1s);
+
+    m_mountinfo = make_unique<file_reader>("/proc/self/mountinfo");
+    m_pool = make_unique<fs_stat_pool>(std::min(m_mountpoints.size(), 4_z));
 
     // Add formats and elements
     m_formatter->add(
         FORMAT_MOUNTED, TAG_LABEL_MOUNTED, {TAG_LABEL_MOUNTED, TAG_BAR_FREE, TAG_BAR_USED, TAG_RAMP_CAPACITY});
     m_formatter->add(FORMAT_UNMOUNTED, TAG_LABEL_UNMOUNTED, {TAG_LABEL_UNMOUNTED});
+    m_formatter->add(FORMAT_UNRESPONSIVE, TAG_LABEL_UNRESPONSIVE, {TAG_LABEL_UNRESPONSIVE});
 
     if (m_formatter->has(TAG_LABEL_MOUNTED)) {
       m_labelmounted = load_optional_label(m_conf, name(), TAG_LABEL_MOUNTED, "%mountpoint% %percentage_free%%");
@@ -43,6 +160,10 @@ namespace modules {
     if (m_formatter->has(TAG_LABEL_UNMOUNTED)) {
       m_labelunmounted = load_optional_label(m_conf, name(), TAG_LABEL_UNMOUNTED, "%mountpoint% is not mounted");
     }
+    if (m_formatter->has(TAG_LABEL_UNRESPONSIVE)) {
+      m_labelunresponsive =
+          load_optional_label(m_conf, name(), TAG_LABEL_UNRESPONSIVE, "%mountpoint% is not responding");
+    }
     if (m_formatter->has(TAG_BAR_FREE)) {
       m_barfree = load_progressbar(m_bar, m_conf, name(), TAG_BAR_FREE);
     }
@@ -60,41 +181,71 @@ namespace modules {
     }
   }
 
+  /**
+   * Wait for the next update, which is due after the given duration
+   * or as soon as a filesystem is mounted or unmounted
+   */
+  void fs_module::sleep(chrono::duration<double> duration) {
+    const auto until = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(duration);
+
+    while (running()) {
+      auto remaining = chrono::duration_cast<chrono::milliseconds>(until - chrono::steady_clock::now());
+
+      if (remaining.count() <= 0) {
+        return;
+      }
+
+      // Wait in short steps to not delay stopping the module
+      if (mountinfo_changed(std::min(remaining, chrono::milliseconds{1000}).count())) {
+        m_log.trace("%s: Mount table changed", name());
+        return;
+      }
+    }
+  }
+
   /**
    * Update mountpoints
    */
   bool fs_module::update() {
-    m_mounts.clear();
-
-    vector<vector<string>> mountinfo;
-    std::ifstream filestream("/proc/self/mountinfo");
-    string line;
+    if (mountinfo_changed(0)) {
+      parse_mountinfo();
+      m_remount = false;
+    }
 
-    // Get details for mounted filesystems
-    while (std::getline(filestream, line)) {
-      auto cols = string_util::split(line, ' ');
-      if (std::find(m_mountpoints.begin(), m_mountpoints.end(), cols[MOUNTINFO_DIR]) != m_mountpoints.end()) {
-        mountinfo.emplace_back(move(cols));
+    vector<string> mounted;
+    for (auto&& mountpoint : m_mountpoints) {
+      if (m_mounted.find(mountpoint) != m_mounted.end()) {
+        mounted.emplace_back(mountpoint);
       }
     }
 
+    auto stats = m_pool->query(mounted, m_timeout);
+
     // Get data for defined mountpoints
-    for (auto&& mountpoint : m_mountpoints) {
-      auto details = std::find_if(mountinfo.begin(), mountinfo.end(),
-          [&](const vector<string>& m) { return m.size() > 4 && m[4] == mountpoint; });
+    m_mounts.clear();
 
-      m_mounts.emplace_back(new fs_mount{mountpoint, details != mountinfo.end()});
-      struct statvfs buffer {};
+    for (auto&& mountpoint : m_mountpoints) {
+      auto details = m_mounted.find(mountpoint);
+      m_mounts.emplace_back(new fs_mount{mountpoint, details != m_mounted.end()});
+      auto& mount = m_mounts.back();
 
-      if (!m_mounts.back()->mounted) {
+      if (!mount->mounted) {
         m_log.warn("%s: Mountpoint %s is not mounted", name(), mountpoint);
-      } else if (statvfs(mountpoint.c_str(), &buffer) == -1) {
-        m_log.err("%s: Failed to query filesystem (statvfs() error: %s)", name(), strerror(errno));
+        continue;
+      }
+
+      mount->type = details->second.first;
+      mount->fsname = details->second.second;
+
+      const auto& stat = stats[mountpoint];
+
+      if (stat.pending) {
+        m_log.warn("%s: Mountpoint %s is not responding", name(), mountpoint);
+        mount->unresponsive = true;
+      } else if (stat.error != 0) {
+        m_log.err("%s: Failed to query filesystem (statvfs() error: %s)", name(), strerror(stat.error));
       } else {
-        auto& mount = m_mounts.back();
-        mount->mountpoint = details->at(MOUNTINFO_DIR);
-        mount->type = details->at(MOUNTINFO_TYPE);
-        mount->fsname = details->at(MOUNTINFO_FSNAME);
+        const auto& buffer = stat.buffer;
 
         // see: http://en.cppreference.com/w/cpp/filesystem/space
         mount->bytes_total = buffer.f_frsize * buffer.f_blocks;
@@ -121,27 +272,62 @@ namespace modules {
     return true;
   }
 
+  /**
+   * Check if the mount table changed since the last call, waiting
+   * at most for the given time. The kernel signals changes of
+   * /proc/self/mountinfo with POLLPRI and POLLERR
+   */
+  bool fs_module::mountinfo_changed(int wait_ms) {
+    struct pollfd fds[1]{};
+    fds[0].fd = *m_mountinfo;
+    fds[0].events = POLLPRI;
+
+    if (poll(fds, 1, m_remount ? 0 : wait_ms) > 0 && (fds[0].revents & (POLLPRI | POLLERR))) {
+      m_remount = true;
+    }
+
+    return m_remount;
+  }
+
+  /**
+   * Find the configured mountpoints in /proc/self/mountinfo
+   */
+  void fs_module::parse_mountinfo() {
+    if (!m_mountinfo->read()) {
+      m_mounted.clear();
+      m_log.err("%s: Failed to read /proc/self/mountinfo (%s)", name(), strerror(errno));
+      return;
+    }
+
+    procfs::parse_mountinfo(m_mountinfo->data(), m_mountinfo->size(), m_mountpoints, m_mounted);
+  }
+
   /**
    * Generate the module output
    */
-  string fs_module::get_output() {
-    string output;
+  void fs_module::get_output(string& output) {
+    output.clear();
 
     for (m_index = 0_z; m_index < m_mounts.size(); ++m_index) {
       if (!output.empty()) {
         m_builder->space(m_spacing);
       }
-      output += timer_module::get_output();
+      timer_module::get_output(m_mountoutput);
+      output += m_mountoutput;
     }
-
-    return output;
   }
 
   /**
    * Select format based on fs state
    */
-  string fs_module::get_format() const {
-    return m_mounts[m_index]->mounted ? FORMAT_MOUNTED : FORMAT_UNMOUNTED;
+  const char* fs_module::get_format() const {
+    if (!m_mounts[m_index]->mounted) {
+      return FORMAT_UNMOUNTED;
+    } else if (m_mounts[m_index]->unresponsive) {
+      return FORMAT_UNRESPONSIVE;
+    } else {
+      return FORMAT_MOUNTED;
+    }
   }
 
   /**
@@ -174,6 +360,12 @@ namespace modules {
       m_labelunmounted->reset_tokens();
       m_labelunmounted->replace_token("%mountpoint%", mount->mountpoint);
       builder->node(m_labelunmounted);
+    } else if (tag == TAG_LABEL_UNRESPONSIVE) {
+      m_labelunresponsive->reset_tokens();
+      m_labelunresponsive->replace_token("%mountpoint%", mount->mountpoint);
+      m_labelunresponsive->replace_token("%type%", mount->type);
+      m_labelunresponsive->replace_token("%fsname%", mount->fsname);
+      builder->node(m_labelunresponsive);
     } else {
       return false;
     }
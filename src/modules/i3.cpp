@@ -1,5 +1,3 @@
-#include <sys/socket.h>
-
 #include "drawtypes/iconset.hpp"
 #include "drawtypes/label.hpp"
 #include "modules/i3.hpp"
@@ -20,7 +18,7 @@ namespace modules {
       throw module_error("Could not find socket: " + (socket_path.empty() ? "<empty>" : socket_path));
     }
 
-    m_ipc = factory_util::unique<i3ipc::connection>();
+    m_socketpath = move(socket_path);
 
     // Load configuration values
     m_click = m_conf.get(name(), "enable-click", m_click);
@@ -65,16 +63,8 @@ namespace modules {
     }
 
     try {
-      if (m_modelabel) {
-        m_ipc->on_mode_event = [this](const i3ipc::mode_t& mode) {
-          m_modeactive = (mode.change != DEFAULT_MODE);
-          if (m_modeactive) {
-            m_modelabel->reset_tokens();
-            m_modelabel->replace_token("%mode%", mode.change);
-          }
-        };
-      }
-      m_ipc->subscribe(i3ipc::ET_WORKSPACE | i3ipc::ET_MODE);
+      m_source = i3::ipc_source::acquire(m_log, m_socketpath);
+      m_events = m_source->subscribe();
     } catch (const exception& err) {
       throw module_error(err.what());
     }
@@ -85,90 +75,200 @@ namespace modules {
   }
 
   void i3_module::stop() {
-    try {
-      if (m_ipc) {
-        m_log.info("%s: Disconnecting from socket", name());
-        shutdown(m_ipc->get_event_socket_fd(), SHUT_RDWR);
-        shutdown(m_ipc->get_main_socket_fd(), SHUT_RDWR);
-      }
-    } catch (...) {
+    // Closed before taking the update lock, which is held while has_event() waits
+    if (m_events) {
+      m_events->close();
     }
 
     event_module::stop();
   }
 
+  void i3_module::teardown() {
+    std::lock_guard<std::mutex> guard(m_commandlock);
+    m_events.reset();
+    m_source.reset();
+  }
+
+  /**
+   * Wait for the next event received by the shared source
+   */
   bool i3_module::has_event() {
-    try {
-      m_ipc->handle_event();
-      return true;
-    } catch (const exception& err) {
-      try {
-        m_log.warn("%s: Attempting to reconnect socket (reason: %s)", name(), err.what());
-        m_ipc->connect_event_socket(true);
-        m_log.info("%s: Reconnecting socket succeeded", name());
-      } catch (const exception& err) {
-        m_log.err("%s: Failed to reconnect socket (reason: %s)", name(), err.what());
-      }
+    shared_ptr<const i3::event> ev;
+
+    if (!m_events || !m_events->wait(ev)) {
       return false;
     }
+
+    switch (ev->type) {
+      case i3::event::kind::WORKSPACE:
+        apply_event(ev->workspace);
+        return true;
+      case i3::event::kind::MODE:
+        if (!m_modelabel) {
+          return false;
+        }
+        m_modeactive = (ev->mode.change != DEFAULT_MODE);
+        if (m_modeactive) {
+          m_modelabel->reset_tokens();
+          m_modelabel->replace_token("%mode%", ev->mode.change);
+        }
+        return true;
+      case i3::event::kind::RESYNC:
+        m_resync = true;
+        return true;
+    }
+
+    return false;
   }
 
   bool i3_module::update() {
-    m_workspaces.clear();
-    i3_util::connection_t ipc;
-
     try {
-      vector<shared_ptr<i3_util::workspace_t>> workspaces;
+      if (m_resync) {
+        resync();
+      }
 
-      if (m_pinworkspaces) {
-        workspaces = i3_util::workspaces(ipc, m_bar.monitor->name);
+      if (m_workspaces.size() != m_model.size()) {
+        m_workspaces.clear();
+        for (auto&& ws : m_model) {
+          m_workspaces.emplace_back(make_workspace(ws));
+        }
       } else {
-        workspaces = i3_util::workspaces(ipc);
+        for (size_t i = 0; i < m_model.size(); i++) {
+          if (m_changed.find(m_model[i].name) != m_changed.end()) {
+            m_workspaces[i] = make_workspace(m_model[i]);
+          }
+        }
       }
 
-      if (m_indexsort) {
-        sort(workspaces.begin(), workspaces.end(), i3_util::ws_numsort);
-      }
+      m_changed.clear();
+      return true;
+    } catch (const exception& err) {
+      m_log.err("%s: %s", name(), err.what());
+      return false;
+    }
+  }
 
-      for (auto&& ws : workspaces) {
-        state ws_state{state::NONE};
+  /**
+   * Get the current workspaces
+   *
+   * The caller has to hold m_commandlock
+   */
+  void i3_module::query_workspaces(vector<i3::workspace>& workspaces) {
+    m_source->query(i3::message_type::GET_WORKSPACES, "", m_reply);
 
-        if (ws->focused) {
-          ws_state = state::FOCUSED;
-        } else if (ws->urgent) {
-          ws_state = state::URGENT;
-        } else if (ws->visible) {
-          ws_state = state::VISIBLE;
-        } else {
-          ws_state = state::UNFOCUSED;
-        }
+    if (!i3::decode(m_reply, workspaces)) {
+      throw i3::ipc_error("Failed to decode workspaces");
+    }
+  }
 
-        string ws_name{ws->name};
+  /**
+   * Replace the model with the workspaces currently reported by i3
+   */
+  void i3_module::resync() {
+    std::lock_guard<std::mutex> guard(m_commandlock);
+    query_workspaces(m_model);
+
+    if (m_pinworkspaces) {
+      m_model.erase(std::remove_if(m_model.begin(), m_model.end(),
+                        [&](const i3::workspace& ws) { return ws.output != m_bar.monitor->name; }),
+          m_model.end());
+    }
 
-        // Remove workspace numbers "0:"
-        if (m_strip_wsnumbers) {
-          ws_name.erase(0, string_util::find_nth(ws_name, 0, ":", 1) + 1);
-        }
+    if (m_indexsort) {
+      std::stable_sort(m_model.begin(), m_model.end(),
+          [](const i3::workspace& a, const i3::workspace& b) { return a.num < b.num; });
+    }
 
-        // Trim leading and trailing whitespace
-        ws_name = string_util::trim(move(ws_name), ' ');
+    m_workspaces.clear();
+    m_changed.clear();
+    m_resync = false;
+  }
 
-        auto icon = m_icons->get(ws->name, DEFAULT_WS_ICON, m_fuzzy_match);
-        auto label = m_statelabels.find(ws_state)->second->clone();
+  /**
+   * Apply a workspace event to the model
+   *
+   * Focus, urgency and empty events carry all that is needed. New, renamed
+   * and moved workspaces lack their number or output, so these events as
+   * well as any that refer to an unknown workspace trigger a full resync
+   */
+  void i3_module::apply_event(const i3::workspace_event& event) {
+    if (m_resync) {
+      return;
+    } else if (!event.has_current) {
+      m_resync = true;
+      return;
+    }
 
-        label->reset_tokens();
-        label->replace_token("%output%", ws->output);
-        label->replace_token("%name%", ws_name);
-        label->replace_token("%icon%", icon->get());
-        label->replace_token("%index%", to_string(ws->num));
-        m_workspaces.emplace_back(factory_util::unique<workspace>(ws->name, ws_state, move(label)));
+    const auto& name = event.current.name;
+    auto current =
+        find_if(m_model.begin(), m_model.end(), [&](const i3::workspace& ws) { return ws.name == name; });
+
+    // Workspaces on other outputs are expected to be missing from a pinned model
+    if (current == m_model.end() && !m_pinworkspaces && event.change != "empty") {
+      m_resync = true;
+      return;
+    }
+
+    if (event.change == "focus") {
+      for (auto&& ws : m_model) {
+        bool focused = ws.name == name;
+        bool visible = focused || (ws.visible && (current == m_model.end() || ws.output != current->output));
+
+        if (ws.focused != focused || ws.visible != visible) {
+          ws.focused = focused;
+          ws.visible = visible;
+          m_changed.emplace(ws.name);
+        }
+      }
+    } else if (event.change == "urgent") {
+      if (current != m_model.end()) {
+        current->urgent = event.current.urgent;
+        m_changed.emplace(name);
       }
+    } else if (event.change == "empty") {
+      if (current != m_model.end()) {
+        m_model.erase(current);
+      }
+    } else {
+      m_resync = true;
+    }
+  }
 
-      return true;
-    } catch (const exception& err) {
-      m_log.err("%s: %s", name(), err.what());
-      return false;
+  /**
+   * Create the label for a workspace of the model
+   */
+  unique_ptr<i3_module::workspace> i3_module::make_workspace(const i3::workspace& ws) const {
+    state ws_state{state::NONE};
+
+    if (ws.focused) {
+      ws_state = state::FOCUSED;
+    } else if (ws.urgent) {
+      ws_state = state::URGENT;
+    } else if (ws.visible) {
+      ws_state = state::VISIBLE;
+    } else {
+      ws_state = state::UNFOCUSED;
     }
+
+    string ws_name{ws.name};
+
+    // Remove workspace numbers "0:"
+    if (m_strip_wsnumbers) {
+      ws_name.erase(0, string_util::find_nth(ws_name, 0, ":", 1) + 1);
+    }
+
+    // Trim leading and trailing whitespace
+    ws_name = string_util::trim(move(ws_name), ' ');
+
+    auto icon = m_icons->get(ws.name, DEFAULT_WS_ICON, m_fuzzy_match);
+    auto label = m_statelabels.find(ws_state)->second->clone();
+
+    label->reset_tokens();
+    label->replace_token("%output%", ws.output);
+    label->replace_token("%name%", ws_name);
+    label->replace_token("%icon%", icon->get());
+    label->replace_token("%index%", to_string(ws.num));
+    return factory_util::unique<workspace>(ws.name, ws_state, move(label));
   }
 
   bool i3_module::build(builder* builder, const string& tag) const {
@@ -218,14 +318,23 @@ namespace modules {
       return false;
     }
 
+    std::lock_guard<std::mutex> guard(m_commandlock);
+
+    if (!m_source) {
+      return true;
+    }
+
     try {
-      const i3_util::connection_t conn{};
+      vector<i3::workspace> workspaces;
+      query_workspaces(workspaces);
 
       if (cmd.compare(0, strlen(EVENT_CLICK), EVENT_CLICK) == 0) {
         cmd.erase(0, strlen(EVENT_CLICK));
-        if (i3_util::focused_workspace(conn)->name != cmd) {
+        auto focused =
+            find_if(workspaces.begin(), workspaces.end(), [](const i3::workspace& ws) { return ws.focused; });
+        if (focused == workspaces.end() || focused->name != cmd) {
           m_log.info("%s: Sending workspace focus command to ipc handler", name());
-          conn.send_command("workspace " + cmd);
+          m_source->query(i3::message_type::RUN_COMMAND, "workspace " + cmd, m_reply);
         }
         return true;
       }
@@ -240,9 +349,11 @@ namespace modules {
         return false;
       }
 
-      auto workspaces = i3_util::workspaces(conn, m_bar.monitor->name);
-      auto current_ws = find_if(workspaces.begin(), workspaces.end(),
-                                [](auto ws) { return ws->visible; });
+      workspaces.erase(std::remove_if(workspaces.begin(), workspaces.end(),
+                           [&](const i3::workspace& ws) { return ws.output != m_bar.monitor->name; }),
+          workspaces.end());
+      auto current_ws =
+          find_if(workspaces.begin(), workspaces.end(), [](const i3::workspace& ws) { return ws.visible; });
 
       if (current_ws == workspaces.end()) {
         m_log.warn("%s: Current workspace not found", name());
@@ -250,19 +361,19 @@ namespace modules {
       }
 
       if (scrolldir == "next" && (m_wrap || next(current_ws) != workspaces.end())) {
-        if (!(*current_ws)->focused) {
+        if (!current_ws->focused) {
           m_log.info("%s: Sending workspace focus command to ipc handler", name());
-          conn.send_command("workspace " + (*current_ws)->name);
+          m_source->query(i3::message_type::RUN_COMMAND, "workspace " + current_ws->name, m_reply);
         }
         m_log.info("%s: Sending workspace next_on_output command to ipc handler", name());
-        conn.send_command("workspace next_on_output");
+        m_source->query(i3::message_type::RUN_COMMAND, "workspace next_on_output", m_reply);
       } else if (scrolldir == "prev" && (m_wrap || current_ws != workspaces.begin())) {
-        if (!(*current_ws)->focused) {
+        if (!current_ws->focused) {
           m_log.info("%s: Sending workspace focus command to ipc handler", name());
-          conn.send_command("workspace " + (*current_ws)->name);
+          m_source->query(i3::message_type::RUN_COMMAND, "workspace " + current_ws->name, m_reply);
         }
         m_log.info("%s: Sending workspace prev_on_output command to ipc handler", name());
-        conn.send_command("workspace prev_on_output");
+        m_source->query(i3::message_type::RUN_COMMAND, "workspace prev_on_output", m_reply);
       }
 
     } catch (const exception& err) {
@@ -70,11 +70,11 @@ namespace modules {
   /**
    * Wrap the output with defined mouse actions
    */
-  string ipc_module::get_output() {
+  void ipc_module::get_output(string& output) {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    module::get_output(output);
 
     for (auto&& action : m_actions) {
       if (!action.second.empty()) {
@@ -83,7 +83,7 @@ namespace modules {
     }
 
     m_builder->append(output);
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   /**
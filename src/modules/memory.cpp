@@ -1,6 +1,4 @@
-#include <fstream>
 #include <iomanip>
-#include <istream>
 
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
@@ -17,6 +15,7 @@ namespace modules {
 
   memory_module::memory_module(const bar_settings& bar, string name_) : timer_module<memory_module>(bar, move(name_)) {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
+    m_provider = procfs::meminfo_provider::acquire(PATH_MEMORY_INFO, PATH_MEMORY_INFO);
 
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_USED, TAG_BAR_FREE, TAG_RAMP_USED, TAG_RAMP_FREE});
 
@@ -43,37 +42,17 @@ namespace modules {
     unsigned long long kb_swap_total{0ULL};
     unsigned long long kb_swap_free{0ULL};
 
-    try {
-      std::ifstream meminfo(PATH_MEMORY_INFO);
-      std::map<std::string, unsigned long long int> parsed;
+    // Modules polling on the same interval share the read, the half
+    // interval leaves room for timers that fire slightly early
+    auto info = m_provider->get(m_interval / 2);
 
-      std::string line;
-      while (std::getline(meminfo, line)) {
-        size_t sep_off = line.find(':');
-        size_t value_off = line.find_first_of("123456789", sep_off);
-
-        if (sep_off == std::string::npos || value_off == std::string::npos) continue;
-
-        std::string id = line.substr(0, sep_off);
-        unsigned long long int value = std::strtoull(&line[value_off], nullptr, 10);
-        parsed[id] = value;
-      }
-
-      kb_total = parsed["MemTotal"];
-      kb_swap_total = parsed["SwapTotal"];
-      kb_swap_free = parsed["SwapFree"];
-
-      // newer kernels (3.4+) have an accurate available memory field,
-      // see https://git.kernel.org/cgit/linux/kernel/git/torvalds/linux.git/commit/?id=34e431b0ae398fc54ea69ff85ec700722c9da773
-      // for details
-      if (parsed.count("MemAvailable")) {
-        kb_avail = parsed["MemAvailable"];
-      } else {
-        // old kernel; give a best-effort approximation of available memory
-        kb_avail = parsed["MemFree"] + parsed["Buffers"] + parsed["Cached"] + parsed["SReclaimable"] - parsed["Shmem"];
-      }
-    } catch (const std::exception& err) {
-      m_log.err("Failed to read memory values (what: %s)", err.what());
+    if (info) {
+      kb_total = info->total;
+      kb_avail = info->avail;
+      kb_swap_total = info->swap_total;
+      kb_swap_free = info->swap_free;
+    } else {
+      m_log.err("%s: Failed to read memory values", name());
     }
 
     m_perc_memfree = math_util::percentage(kb_avail, kb_total);
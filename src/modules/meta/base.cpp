@@ -9,10 +9,11 @@ POLYBAR_NS
 namespace modules {
   // module_format {{{
 
-  string module_format::decorate(builder* builder, string output) {
+  void module_format::decorate(builder* builder, string& output) {
     if (output.empty()) {
-      builder->flush();
-      return "";
+      builder->flush(output);
+      output.clear();
+      return;
     }
     if (offset != 0) {
       builder->offset(offset);
@@ -20,16 +21,16 @@ namespace modules {
     if (margin > 0) {
       builder->space(margin);
     }
-    if (!bg.empty()) {
+    if (bg) {
       builder->background(bg);
     }
-    if (!fg.empty()) {
+    if (fg) {
       builder->color(fg);
     }
-    if (!ul.empty()) {
+    if (ul) {
       builder->underline(ul);
     }
-    if (!ol.empty()) {
+    if (ol) {
       builder->overline(ol);
     }
     if (padding > 0) {
@@ -38,42 +39,74 @@ namespace modules {
 
     builder->node(prefix);
 
-    if (!bg.empty()) {
+    if (bg) {
       builder->background(bg);
     }
-    if (!fg.empty()) {
+    if (fg) {
       builder->color(fg);
     }
-    if (!ul.empty()) {
+    if (ul) {
       builder->underline(ul);
     }
-    if (!ol.empty()) {
+    if (ol) {
       builder->overline(ol);
     }
 
-    builder->append(move(output));
+    builder->append(output);
     builder->node(suffix);
 
     if (padding > 0) {
       builder->space(padding);
     }
-    if (!ol.empty()) {
+    if (ol) {
       builder->overline_close();
     }
-    if (!ul.empty()) {
+    if (ul) {
       builder->underline_close();
     }
-    if (!fg.empty()) {
+    if (fg) {
       builder->color_close();
     }
-    if (!bg.empty()) {
+    if (bg) {
       builder->background_close();
     }
     if (margin > 0) {
       builder->space(margin);
     }
 
-    return builder->flush();
+    builder->flush(output);
+  }
+
+  /**
+   * Split the format value into literal text and tags
+   *
+   * This is only done again if the value has been changed since
+   * the last call so that building the output doesn't need to
+   * re-parse the format value
+   */
+  void module_format::compile() {
+    if (value == compiled) {
+      return;
+    }
+
+    segments.clear();
+
+    size_t pos{0}, start, end;
+    while ((start = value.find('<', pos)) != string::npos && (end = value.find('>', start)) != string::npos) {
+      segments.emplace_back();
+      segments.back().text = value.substr(pos, start - pos);
+      segments.back().tag = value.substr(start, end - start + 1);
+
+      auto indent = segments.back().text.find_first_not_of(' ');
+      if (indent != string::npos) {
+        segments.back().trimmed = segments.back().text.substr(indent);
+      }
+
+      pos = end + 1;
+    }
+
+    tail = value.substr(pos);
+    compiled = value;
   }
 
   // }}}
@@ -149,10 +182,10 @@ namespace modules {
     return false;
   }
 
-  shared_ptr<module_format> module_formatter::get(const string& format_name) {
+  shared_ptr<module_format> module_formatter::get(const char* format_name) {
     auto format = m_formats.find(format_name);
     if (format == m_formats.end()) {
-      throw undefined_format("Format \"" + format_name + "\" has not been added");
+      throw undefined_format("Format \"" + string{format_name} + "\" has not been added");
     }
     return format->second;
   }
@@ -95,8 +95,8 @@ namespace modules {
     if (m_formatter->has(TAG_ICON_RANDOM) || m_formatter->has(TAG_ICON_REPEAT) ||
         m_formatter->has(TAG_ICON_REPEAT_ONE) || m_formatter->has(TAG_ICON_SINGLE) ||
         m_formatter->has(TAG_ICON_CONSUME)) {
-      m_toggle_on_color = m_conf.get(name(), "toggle-on-foreground", ""s);
-      m_toggle_off_color = m_conf.get(name(), "toggle-off-foreground", ""s);
+      m_toggle_on_color = m_conf.get(name(), "toggle-on-foreground", argb{});
+      m_toggle_off_color = m_conf.get(name(), "toggle-off-foreground", argb{});
     }
     if (m_formatter->has(TAG_LABEL_OFFLINE, FORMAT_OFFLINE)) {
       m_label_offline = load_label(m_conf, name(), TAG_LABEL_OFFLINE);
@@ -107,91 +107,71 @@ namespace modules {
 
     // }}}
 
-    m_lastsync = chrono::system_clock::now();
-
+    // Subscribe last, so that a failing constructor leaves no callback behind
     try {
-      m_mpd = factory_util::unique<mpdconnection>(m_log, m_host, m_port, m_pass);
-      m_mpd->connect();
-      m_status = m_mpd->get_status();
+      m_source = mpdsource::acquire(m_log, m_host, m_port, m_pass);
+      m_subscription = m_source->subscribe([this] {
+        m_changed = true;
+        wakeup();
+      });
+      take_state();
     } catch (const mpd_exception& err) {
-      m_log.err("%s: %s", name(), err.what());
-      m_mpd.reset();
+      throw module_error(err.what());
     }
   }
 
   void mpd_module::teardown() {
-    m_mpd.reset();
+    if (m_source) {
+      m_source->unsubscribe(m_subscription);
+      m_source.reset();
+    }
+  }
+
+  /**
+   * Wake up the module thread, the sleep lock is taken so that
+   * the notification can't get lost while idle() checks for changes
+   */
+  void mpd_module::wakeup() {
+    { std::lock_guard<std::mutex> guard(m_sleeplock); }
+    m_sleephandler.notify_all();
   }
 
   inline bool mpd_module::connected() const {
-    return m_mpd && m_mpd->connected();
+    return m_state && m_state->connected;
   }
 
+  /**
+   * Pick up the state last published by the source
+   */
+  void mpd_module::take_state() {
+    m_state = m_source->get();
+    m_status = connected() && m_state->status ? make_unique<mpdstatus>(*m_state->status) : nullptr;
+    m_newstate = true;
+  }
+
+  /**
+   * Wait for the source to publish a new state or until the
+   * displayed elapsed time has to be advanced
+   */
   void mpd_module::idle() {
-    if (connected()) {
-      m_quick_attempts = 0;
-      sleep(80ms);
+    std::unique_lock<std::mutex> guard(m_sleeplock);
+    const auto woken = [&] { return !running() || m_changed; };
+
+    if ((m_label_time || m_bar_progress) && m_status && m_status->match_state(mpdstate::PLAYING)) {
+      m_sleephandler.wait_until(guard, m_nexttick, woken);
     } else {
-      sleep(m_quick_attempts++ < 5 ? 0.5s : 2s);
+      m_sleephandler.wait(guard, woken);
     }
   }
 
   bool mpd_module::has_event() {
-    bool def = false;
-
-    if (!connected() && m_statebroadcasted == mpd::connection_state::CONNECTED) {
-      def = true;
-    } else if (connected() && m_statebroadcasted == mpd::connection_state::DISCONNECTED) {
-      def = true;
-    }
-
-    try {
-      if (!m_mpd) {
-        m_mpd = factory_util::unique<mpdconnection>(m_log, m_host, m_port, m_pass);
-      }
-      if (!connected()) {
-        m_mpd->connect();
-      }
-    } catch (const mpd_exception& err) {
-      m_log.err("%s: %s", name(), err.what());
-      m_mpd.reset();
-      return def;
-    }
-
-    if (!connected()) {
-      return def;
-    }
-
-    if (!m_status) {
-      m_status = m_mpd->get_status_safe();
-    }
-
-    try {
-      m_mpd->idle();
-
-      int idle_flags = 0;
-      if ((idle_flags = m_mpd->noidle()) != 0) {
-        // Update status on every event
-        m_status->update(idle_flags, m_mpd.get());
-        return true;
-      }
-    } catch (const mpd_exception& err) {
-      m_log.err("%s: %s", name(), err.what());
-      m_mpd.reset();
-      return def;
+    if (m_changed.exchange(false) && m_source) {
+      take_state();
+      return true;
     }
 
-    if ((m_label_time || m_bar_progress) && m_status->match_state(mpdstate::PLAYING)) {
-      auto now = chrono::system_clock::now();
-      auto diff = now - m_lastsync;
-
-      if (chrono::duration_cast<chrono::milliseconds>(diff).count() > m_synctime * 1000) {
-        m_lastsync = now;
-        return true;
-      }
-    }
-
-    return def;
+    return (m_label_time || m_bar_progress) && m_status && m_status->match_state(mpdstate::PLAYING) &&
+           chrono::steady_clock::now() >= m_nexttick;
   }
 
   bool mpd_module::update() {
@@ -203,60 +183,35 @@ namespace modules {
       return false;
     }
 
-    if (!m_status) {
-      if (connected() && (m_status = m_mpd->get_status_safe())) {
-        return false;
-      }
+    if (m_status) {
+      m_status->update_timer();
+      m_nexttick = chrono::steady_clock::now() + next_tick();
     }
 
-    if (m_status && m_status->match_state(mpdstate::PLAYING)) {
-      // Always update the status while playing
-      m_status->update(-1, m_mpd.get());
-    }
+    // The song labels only change with a new state
+    if (m_newstate) {
+      m_newstate = false;
 
-    string artist;
-    string album_artist;
-    string album;
-    string title;
-    string date;
-    string elapsed_str;
-    string total_str;
+      const auto& artist = m_state->artist;
+      const auto& album_artist = m_state->album_artist;
+      const auto& album = m_state->album;
+      const auto& title = m_state->title;
+      const auto& date = m_state->date;
 
-    try {
-      if (m_status) {
-        elapsed_str = m_status->get_formatted_elapsed();
-        total_str = m_status->get_formatted_total();
+      if (m_label_song) {
+        m_label_song->reset_tokens();
+        m_label_song->replace_token("%artist%", !artist.empty() ? artist : "untitled artist");
+        m_label_song->replace_token("%album-artist%", !album_artist.empty() ? album_artist : "untitled album artist");
+        m_label_song->replace_token("%album%", !album.empty() ? album : "untitled album");
+        m_label_song->replace_token("%title%", !title.empty() ? title : "untitled track");
+        m_label_song->replace_token("%date%", !date.empty() ? date : "unknown date");
       }
-
-      if (m_mpd) {
-        auto song = m_mpd->get_song();
-
-        if (song && song.get()) {
-          artist = song->get_artist();
-          album_artist = song->get_album_artist();
-          album = song->get_album();
-          title = song->get_title();
-          date = song->get_date();
-        }
-      }
-    } catch (const mpd_exception& err) {
-      m_log.err("%s: %s", name(), err.what());
-      m_mpd.reset();
-    }
-
-    if (m_label_song) {
-      m_label_song->reset_tokens();
-      m_label_song->replace_token("%artist%", !artist.empty() ? artist : "untitled artist");
-      m_label_song->replace_token("%album-artist%", !album_artist.empty() ? album_artist : "untitled album artist");
-      m_label_song->replace_token("%album%", !album.empty() ? album : "untitled album");
-      m_label_song->replace_token("%title%", !title.empty() ? title : "untitled track");
-      m_label_song->replace_token("%date%", !date.empty() ? date : "unknown date");
     }
 
     if (m_label_time) {
       m_label_time->reset_tokens();
-      m_label_time->replace_token("%elapsed%", elapsed_str);
-      m_label_time->replace_token("%total%", total_str);
+      m_label_time->replace_token("%elapsed%", m_status ? m_status->get_formatted_elapsed() : "");
+      m_label_time->replace_token("%total%", m_status ? m_status->get_formatted_total() : "");
     }
 
     if (m_icons->has("random")) {
@@ -276,7 +231,34 @@ namespace modules {
     return true;
   }
 
-  string mpd_module::get_format() const {
+  /**
+   * Time until the displayed elapsed time or progress changes next,
+   * rounded up to whole seconds when the interval is longer than that
+   */
+  chrono::milliseconds mpd_module::next_tick() const {
+    auto elapsed = m_status->get_elapsed_time_ms();
+    auto total = m_status->get_total_time() * 1000UL;
+    auto interval = static_cast<unsigned long>(m_synctime * 1000);
+    auto next = (elapsed / 1000 + 1) * 1000;
+
+    if (!m_label_time && total > 0) {
+      // Skip the seconds that don't change the progress
+      const auto percentage = [&](unsigned long ms) {
+        return static_cast<int>(float(ms / 1000) / float(total / 1000) * 100.0 + 0.5f);
+      };
+      while (next < total && percentage(next) == percentage(elapsed)) {
+        next += 1000;
+      }
+    }
+
+    while (next - elapsed + 1000 <= interval) {
+      next += 1000;
+    }
+
+    return chrono::milliseconds{next - elapsed};
+  }
+
+  const char* mpd_module::get_format() const {
     if (!connected()) {
       return FORMAT_OFFLINE;
     } else if (m_status->match_state(mpdstate::PLAYING)) {
@@ -288,12 +270,12 @@ namespace modules {
     }
   }
 
-  string mpd_module::get_output() {
+  void mpd_module::get_output(string& output) {
     if (m_status && m_status->get_queuelen() == 0) {
       m_log.info("%s: Hiding module since queue is empty", name());
-      return "";
+      output.clear();
     } else {
-      return event_module::get_output();
+      event_module::get_output(output);
     }
   }
 
@@ -346,54 +328,54 @@ namespace modules {
 
     m_log.info("%s: event: %s", name(), cmd);
 
-    try {
-      auto mpd = factory_util::unique<mpdconnection>(m_log, m_host, m_port, m_pass);
-      mpd->connect();
+    if (cmd != EVENT_PLAY && cmd != EVENT_PAUSE && cmd != EVENT_STOP && cmd != EVENT_PREV && cmd != EVENT_NEXT &&
+        cmd != EVENT_SINGLE && cmd != EVENT_REPEAT && cmd != EVENT_RANDOM && cmd != EVENT_CONSUME &&
+        (cmd.compare(0, strlen(EVENT_SEEK), EVENT_SEEK) != 0 || cmd.size() == strlen(EVENT_SEEK))) {
+      return false;
+    } else if (!m_source) {
+      return true;
+    }
 
-      auto status = mpd->get_status();
+    // Run by the thread of the shared source, with the
+    // current status since this one may not be up to date
+    m_source->send([cmd](mpdconnection& mpd) {
+      auto status = mpd.get_status();
 
       bool is_playing = status->match_state(mpdstate::PLAYING);
       bool is_paused = status->match_state(mpdstate::PAUSED);
       bool is_stopped = status->match_state(mpdstate::STOPPED);
 
       if (cmd == EVENT_PLAY && !is_playing) {
-        mpd->play();
+        mpd.play();
       } else if (cmd == EVENT_PAUSE && !is_paused) {
-        mpd->pause(true);
+        mpd.pause(true);
       } else if (cmd == EVENT_STOP && !is_stopped) {
-        mpd->stop();
+        mpd.stop();
       } else if (cmd == EVENT_PREV && !is_stopped) {
-        mpd->prev();
+        mpd.prev();
       } else if (cmd == EVENT_NEXT && !is_stopped) {
-        mpd->next();
+        mpd.next();
       } else if (cmd == EVENT_SINGLE) {
-        mpd->set_single(!status->single());
+        mpd.set_single(!status->single());
       } else if (cmd == EVENT_REPEAT) {
-        mpd->set_repeat(!status->repeat());
+        mpd.set_repeat(!status->repeat());
       } else if (cmd == EVENT_RANDOM) {
-        mpd->set_random(!status->random());
+        mpd.set_random(!status->random());
       } else if (cmd == EVENT_CONSUME) {
-        mpd->set_consume(!status->consume());
+        mpd.set_consume(!status->consume());
       } else if (cmd.compare(0, strlen(EVENT_SEEK), EVENT_SEEK) == 0) {
         auto s = cmd.substr(strlen(EVENT_SEEK));
         int percentage = 0;
-        if (s.empty()) {
-          return false;
-        } else if (s[0] == '+') {
+        if (s[0] == '+') {
           percentage = status->get_elapsed_percentage() + std::strtol(s.substr(1).c_str(), nullptr, 10);
         } else if (s[0] == '-') {
           percentage = status->get_elapsed_percentage() - std::strtol(s.substr(1).c_str(), nullptr, 10);
         } else {
           percentage = std::strtol(s.c_str(), nullptr, 10);
         }
-        mpd->seek(status->get_songid(), status->get_seek_position(percentage));
-      } else {
-        return false;
+        mpd.seek(status->get_songid(), status->get_seek_position(percentage));
       }
-    } catch (const mpd_exception& err) {
-      m_log.err("%s: %s", name(), err.what());
-      m_mpd.reset();
-    }
+    });
 
     return true;
   }
@@ -49,6 +49,12 @@ namespace modules {
 
     // Create elements for format-packetloss if we are told to test connectivity
     if (m_ping_nth_update > 0) {
+      auto target = m_conf.get(name(), "ping-target", string{CONNECTION_TEST_IP});
+      auto count = m_conf.get(name(), "ping-count", 2);
+      auto timeout = m_conf.get<chrono::duration<double>>(name(), "ping-timeout", 2s);
+      auto port = m_conf.get<unsigned short>(name(), "ping-fallback-port", 53);
+      m_probe = make_unique<net::probe>(move(target), count, timeout, port);
+
       m_formatter->add(FORMAT_PACKETLOSS, TAG_LABEL_CONNECTED,
           {TAG_ANIMATION_PACKETLOSS, TAG_LABEL_PACKETLOSS, TAG_LABEL_CONNECTED});
 
@@ -64,22 +70,62 @@ namespace modules {
     if (net::is_wireless_interface(m_interface)) {
       m_wireless = factory_util::unique<net::wireless_network>(m_interface);
       m_wireless->set_unknown_up(m_unknown_up);
+      m_wireless->set_interval(m_interval);
     } else {
       m_wired = factory_util::unique<net::wired_network>(m_interface);
       m_wired->set_unknown_up(m_unknown_up);
+      m_wired->set_interval(m_interval);
     };
 
-    // We only need to start the subthread if the packetloss animation is used
+    // We only need to redraw periodically if the packetloss animation is used
     if (m_animation_packetloss) {
-      m_threads.emplace_back(thread(&network_module::subthread_routine, this));
+      animation_clock::make().subscribe(this, chrono::milliseconds{m_animation_packetloss->framerate()}, [this] {
+        if (running() && m_connected && m_packetloss) {
+          broadcast();
+        }
+      });
     }
   }
 
   void network_module::teardown() {
+    animation_clock::make().unsubscribe(this);
+    m_probe.reset();
     m_wireless.reset();
     m_wired.reset();
   }
 
+  /**
+   * Wait for the next update, which is due after the given duration
+   * to refresh the rate counters or as soon as the link, addresses or
+   * wireless association of the interface change
+   */
+  void network_module::sleep(chrono::duration<double> duration) {
+    const auto until = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(duration);
+
+    while (running()) {
+      auto remaining = chrono::duration_cast<chrono::milliseconds>(until - chrono::steady_clock::now());
+
+      if (remaining.count() <= 0) {
+        return;
+      }
+
+      // The lock keeps the interface alive during teardown, so
+      // wait in short steps to not delay stopping the module
+      std::unique_lock<std::mutex> guard(m_updatelock);
+      net::network* network =
+          m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
+
+      if (network == nullptr || !network->subscribed()) {
+        guard.unlock();
+        timer_module::sleep(until - chrono::steady_clock::now());
+        return;
+      } else if (network->wait_for_change(std::min(remaining, chrono::milliseconds{1000}).count())) {
+        m_log.trace("%s: Change of %s reported", name(), m_interface);
+        return;
+      }
+    }
+  }
+
   bool network_module::update() {
     net::network* network =
         m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
@@ -105,10 +151,18 @@ namespace modules {
     if (m_counter == -1) {
       m_counter = 0;
     } else if (m_ping_nth_update > 0 && m_connected && (++m_counter % m_ping_nth_update) == 0) {
-      m_packetloss = !network->ping();
+      // Runs in the background, the result is picked up by a later update
+      m_probe->start(network->ip());
       m_counter = 0;
     }
 
+    net::probe_result result{};
+    if (m_probe && m_probe->result(result)) {
+      m_packetloss = result.received == 0;
+      m_loss = result.loss();
+      m_latency = result.received > 0 ? to_string(static_cast<int>(result.latency.count() + 0.5)) : "N/A";
+    }
+
     auto upspeed = network->upspeed(m_udspeed_minwidth);
     auto downspeed = network->downspeed(m_udspeed_minwidth);
 
@@ -120,6 +174,8 @@ namespace modules {
       label->replace_token("%local_ip6%", network->ip6());
       label->replace_token("%upspeed%", upspeed);
       label->replace_token("%downspeed%", downspeed);
+      label->replace_token("%latency%", m_latency);
+      label->replace_token("%packetloss%", to_string(m_loss));
 
       if (m_wired) {
         label->replace_token("%linkspeed%", m_wired->linkspeed());
@@ -140,7 +196,7 @@ namespace modules {
     return true;
   }
 
-  string network_module::get_format() const {
+  const char* network_module::get_format() const {
     if (!m_connected) {
       return FORMAT_DISCONNECTED;
     } else if (m_packetloss && m_ping_nth_update > 0) {
@@ -168,20 +224,6 @@ namespace modules {
     }
     return true;
   }
-
-  void network_module::subthread_routine() {
-    const chrono::milliseconds framerate{m_animation_packetloss->framerate()};
-    const auto dur = chrono::duration<double>(framerate);
-
-    while (running()) {
-      if (m_connected && m_packetloss) {
-        broadcast();
-      }
-      sleep(dur);
-    }
-
-    m_log.trace("%s: Reached end of network subthread", name());
-  }
 }
 
 POLYBAR_NS_END
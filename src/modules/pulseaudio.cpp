@@ -17,13 +17,7 @@ namespace modules {
   pulseaudio_module::pulseaudio_module(const bar_settings& bar, string name_) : event_module<pulseaudio_module>(bar, move(name_)) {
     // Load configuration values
     auto sink_name = m_conf.get(name(), "sink", ""s);
-    bool m_max_volume = m_conf.get(name(), "use-ui-max", true);
-
-    try {
-      m_pulseaudio = factory_util::unique<pulseaudio>(m_log, move(sink_name), m_max_volume);
-    } catch (const pulseaudio_error& err) {
-      throw module_error(err.what());
-    }
+    m_max_volume = m_conf.get(name(), "use-ui-max", m_max_volume);
 
     // Add formats and elements
     m_formatter->add(FORMAT_VOLUME, TAG_LABEL_VOLUME, {TAG_RAMP_VOLUME, TAG_LABEL_VOLUME, TAG_BAR_VOLUME});
@@ -41,27 +35,52 @@ namespace modules {
     if (m_formatter->has(TAG_RAMP_VOLUME)) {
       m_ramp_volume = load_ramp(m_conf, name(), TAG_RAMP_VOLUME);
     }
+
+    // Subscribe last, so that a failing constructor leaves no callback behind
+    try {
+      m_pulseaudio = pulseaudio::acquire(m_log, sink_name);
+      m_subscription = m_pulseaudio->subscribe([this] {
+        m_sinkchanged = true;
+        wakeup();
+      });
+    } catch (const pulseaudio_error& err) {
+      throw module_error(err.what());
+    }
   }
 
   void pulseaudio_module::teardown() {
-    m_pulseaudio.reset();
+    if (m_pulseaudio) {
+      m_pulseaudio->unsubscribe(m_subscription);
+      m_pulseaudio.reset();
+    }
+  }
+
+  /**
+   * Wait until the adapter reports a change of the sink, updates are
+   * spaced by a frame so that changes while dragging a volume slider
+   * only cause one update per frame
+   */
+  void pulseaudio_module::idle() {
+    sleep(25ms);
+
+    std::unique_lock<std::mutex> guard(m_sleeplock);
+    m_sleephandler.wait(guard, [&] { return !running() || m_sinkchanged; });
+  }
+
+  /**
+   * Wake up the module thread, the sleep lock is taken so that
+   * the notification can't get lost while idle() checks for changes
+   */
+  void pulseaudio_module::wakeup() {
+    { std::lock_guard<std::mutex> guard(m_sleeplock); }
+    m_sleephandler.notify_all();
   }
 
   bool pulseaudio_module::has_event() {
-    // Poll for mixer and control events
-    try {
-      if (m_pulseaudio->wait())
-        return true;
-    } catch (const pulseaudio_error& e) {
-      m_log.err("%s: %s", name(), e.what());
-    }
-    return false;
+    return m_sinkchanged.exchange(false);
   }
 
   bool pulseaudio_module::update() {
-    // Consume pending events
-    m_pulseaudio->process_events();
-
     // Get volume and mute state
     m_volume = 100;
     m_muted = false;
@@ -89,15 +108,15 @@ namespace modules {
     return true;
   }
 
-  string pulseaudio_module::get_format() const {
+  const char* pulseaudio_module::get_format() const {
     return m_muted ? FORMAT_MUTED : FORMAT_VOLUME;
   }
 
-  string pulseaudio_module::get_output() {
+  void pulseaudio_module::get_output(string& output) {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    module::get_output(output);
 
     if (m_handle_events) {
       m_builder->cmd(mousebtn::LEFT, EVENT_TOGGLE_MUTE);
@@ -107,7 +126,7 @@ namespace modules {
 
     m_builder->append(output);
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   bool pulseaudio_module::build(builder* builder, const string& tag) const {
@@ -138,9 +157,9 @@ namespace modules {
           m_pulseaudio->toggle_mute();
         } else if (cmd.compare(0, strlen(EVENT_VOLUME_UP), EVENT_VOLUME_UP) == 0) {
           // cap above 100 (~150)?
-          m_pulseaudio->inc_volume(5);
+          m_pulseaudio->inc_volume(5, m_max_volume);
         } else if (cmd.compare(0, strlen(EVENT_VOLUME_DOWN), EVENT_VOLUME_DOWN) == 0) {
-          m_pulseaudio->inc_volume(-5);
+          m_pulseaudio->inc_volume(-5, m_max_volume);
         } else {
           return false;
         }
@@ -161,9 +161,10 @@ namespace modules {
   /**
    * Generate module output
    */
-  string script_module::get_output() {
+  void script_module::get_output(string& output) {
     if (m_output.empty()) {
-      return "";
+      output.clear();
+      return;
     }
 
     if (m_label) {
@@ -172,7 +173,7 @@ namespace modules {
     }
 
     string cnt{to_string(m_counter)};
-    string output{module::get_output()};
+    module::get_output(output);
 
     for (auto btn : {mousebtn::LEFT, mousebtn::MIDDLE, mousebtn::RIGHT, mousebtn::SCROLL_UP, mousebtn::SCROLL_DOWN}) {
 
@@ -193,7 +194,7 @@ namespace modules {
 
     m_builder->append(output);
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   /**
@@ -29,6 +29,8 @@ namespace modules {
       throw module_error("The file '" + m_path + "' does not exist");
     }
 
+    m_reader = make_unique<file_reader>(m_path);
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_RAMP});
     m_formatter->add(FORMAT_WARN, TAG_LABEL_WARN, {TAG_LABEL_WARN, TAG_RAMP});
 
@@ -50,7 +52,7 @@ namespace modules {
   }
 
   bool temperature_module::update() {
-    m_temp = std::strtol(file_util::contents(m_path).c_str(), nullptr, 10) / 1000.0f + 0.5f;
+    m_temp = m_reader->integer() / 1000.0f + 0.5f;
     int m_temp_f = floor(((1.8 * m_temp) + 32) + 0.5);
     m_perc = math_util::cap(math_util::percentage(m_temp, 0, m_tempwarn), 0, 100);
 
@@ -82,7 +84,7 @@ namespace modules {
     return true;
   }
 
-  string temperature_module::get_format() const {
+  const char* temperature_module::get_format() const {
     if (m_temp > m_tempwarn) {
       return FORMAT_WARN;
     } else {
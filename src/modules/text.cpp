@@ -14,45 +14,37 @@ namespace modules {
       throw module_error(name() + ".content is empty or undefined");
     }
 
-    m_formatter->get("content")->value =
-        string_util::replace_all(m_formatter->get("content")->value, " ", BUILDER_SPACE_TOKEN);
+    // The config is only read here, it may be replaced by a reload
+    // while the module is running
+    const pair<mousebtn, const char*> actions[]{{mousebtn::LEFT, "click-left"}, {mousebtn::MIDDLE, "click-middle"},
+        {mousebtn::RIGHT, "click-right"}, {mousebtn::SCROLL_UP, "scroll-up"},
+        {mousebtn::SCROLL_DOWN, "scroll-down"}};
+
+    for (auto&& action : actions) {
+      auto cmd = m_conf.get(name(), action.second, ""s);
+      if (!cmd.empty()) {
+        m_actions.emplace_back(action.first, move(cmd));
+      }
+    }
   }
 
-  string text_module::get_format() const {
+  const char* text_module::get_format() const {
     return "content";
   }
 
-  string text_module::get_output() {
+  void text_module::get_output(string& output) {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
-
-    auto click_left = m_conf.get(name(), "click-left", ""s);
-    auto click_middle = m_conf.get(name(), "click-middle", ""s);
-    auto click_right = m_conf.get(name(), "click-right", ""s);
-    auto scroll_up = m_conf.get(name(), "scroll-up", ""s);
-    auto scroll_down = m_conf.get(name(), "scroll-down", ""s);
+    module::get_output(output);
 
-    if (!click_left.empty()) {
-      m_builder->cmd(mousebtn::LEFT, click_left);
-    }
-    if (!click_middle.empty()) {
-      m_builder->cmd(mousebtn::MIDDLE, click_middle);
-    }
-    if (!click_right.empty()) {
-      m_builder->cmd(mousebtn::RIGHT, click_right);
-    }
-    if (!scroll_up.empty()) {
-      m_builder->cmd(mousebtn::SCROLL_UP, scroll_up);
-    }
-    if (!scroll_down.empty()) {
-      m_builder->cmd(mousebtn::SCROLL_DOWN, scroll_down);
+    for (auto&& action : m_actions) {
+      m_builder->cmd(action.first, action.second);
     }
 
     m_builder->append(output);
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 }
 
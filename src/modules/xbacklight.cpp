@@ -114,11 +114,11 @@ namespace modules {
   /**
    * Generate the module output
    */
-  string xbacklight_module::get_output() {
+  void xbacklight_module::get_output(string& output) {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output{module::get_output()};
+    module::get_output(output);
 
     if (m_scroll) {
       m_builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLLUP);
@@ -130,7 +130,7 @@ namespace modules {
     m_builder->cmd_close();
     m_builder->cmd_close();
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   /**
@@ -80,8 +80,8 @@ namespace modules {
    * Build module output and wrap it in a click handler use
    * to cycle between configured layout groups
    */
-  string xkeyboard_module::get_output() {
-    string output{module::get_output()};
+  void xkeyboard_module::get_output(string& output) {
+    module::get_output(output);
 
     if (m_keyboard && m_keyboard->size() > 1) {
       m_builder->cmd(mousebtn::LEFT, EVENT_SWITCH);
@@ -91,7 +91,7 @@ namespace modules {
       m_builder->append(output);
     }
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   /**
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "modules/xwindow.hpp"
 #include "drawtypes/label.hpp"
 #include "utils/factory.hpp"
@@ -11,53 +13,6 @@ POLYBAR_NS
 namespace modules {
   template class module<xwindow_module>;
 
-  /**
-   * Wrapper used to update the event mask of the
-   * currently active to enable title tracking
-   */
-  active_window::active_window(xcb_connection_t* conn, xcb_window_t win) : m_connection(conn), m_window(win) {
-    if (m_window != XCB_NONE) {
-      const unsigned int mask{XCB_EVENT_MASK_PROPERTY_CHANGE};
-      xcb_change_window_attributes(m_connection, m_window, XCB_CW_EVENT_MASK, &mask);
-    }
-  }
-
-  /**
-   * Deconstruct window object
-   */
-  active_window::~active_window() {
-    if (m_window != XCB_NONE) {
-      const unsigned int mask{XCB_EVENT_MASK_NO_EVENT};
-      xcb_change_window_attributes(m_connection, m_window, XCB_CW_EVENT_MASK, &mask);
-    }
-  }
-
-  /**
-   * Check if current window matches passed value
-   */
-  bool active_window::match(const xcb_window_t win) const {
-    return m_window == win;
-  }
-
-  /**
-   * Get the title by returning the first non-empty value of:
-   *  _NET_WM_NAME
-   *  _NET_WM_VISIBLE_NAME
-   */
-  string active_window::title() const {
-    string title;
-
-    if (!(title = ewmh_util::get_wm_name(m_window)).empty()) {
-      return title;
-    } else if (!(title = ewmh_util::get_visible_name(m_window)).empty()) {
-      return title;
-    } else if (!(title = icccm_util::get_wm_name(m_connection, m_window)).empty()) {
-      return title;
-    } else {
-      return "";
-    }
-  }
-
   /**
    * Construct module
    */
@@ -87,13 +42,24 @@ namespace modules {
    */
   void xwindow_module::handle(const evt::property_notify& evt) {
     if (evt->atom == _NET_ACTIVE_WINDOW) {
-      update(true);
-    } else if (evt->atom == _NET_CURRENT_DESKTOP) {
-      update(true);
-    } else if (evt->atom == _NET_WM_VISIBLE_NAME) {
       update();
-    } else if (evt->atom == _NET_WM_NAME) {
+    } else if (evt->atom == _NET_CURRENT_DESKTOP) {
       update();
+    } else if (evt->atom == _NET_WM_NAME || evt->atom == _NET_WM_VISIBLE_NAME || evt->atom == XCB_ATOM_WM_NAME) {
+      // Titles of inactive windows are only invalidated and
+      // fetched again once the window becomes active
+      {
+        std::lock_guard<std::mutex> guard(m_updatelock);
+        auto entry = find(evt->window);
+        if (entry == m_titles.end()) {
+          return;
+        }
+        entry->valid = false;
+        if (evt->window != m_active) {
+          return;
+        }
+      }
+      refresh(evt->window);
     } else {
       return;
     }
@@ -102,29 +68,114 @@ namespace modules {
   }
 
   /**
-   * Update the currently active window and query its title
+   * Update the currently active window and fetch
+   * its title unless it is already cached
    */
-  void xwindow_module::update(bool force) {
-    std::lock(m_buildlock, m_updatelock);
-    std::lock_guard<std::mutex> guard_a(m_buildlock, std::adopt_lock);
-    std::lock_guard<std::mutex> guard_b(m_updatelock, std::adopt_lock);
+  void xwindow_module::update() {
+    auto win = ewmh_util::get_active_window();
+    bool fetch{false};
+
+    {
+      std::lock_guard<std::mutex> guard(m_updatelock);
+      if ((m_active = win) != XCB_NONE) {
+        fetch = !track(win).valid;
+      }
+    }
 
-    xcb_window_t win;
+    if (fetch) {
+      refresh(win);
+    }
+  }
 
-    if (force) {
-      m_active.reset();
+  /**
+   * Generate the module output from the cached title
+   */
+  void xwindow_module::get_output(string& output) {
+    {
+      std::lock_guard<std::mutex> guard(m_updatelock);
+      if (m_active != XCB_NONE) {
+        m_label = m_statelabels.at(state::ACTIVE)->clone();
+        m_label->reset_tokens();
+        m_label->replace_token("%title%", m_titles.back().title);
+      } else {
+        m_label = m_statelabels.at(state::EMPTY)->clone();
+      }
     }
 
-    if (!m_active && (win = ewmh_util::get_active_window()) != XCB_NONE) {
-      m_active = make_unique<active_window>(m_connection, win);
+    module::get_output(output);
+  }
+
+  /**
+   * Move the window to the back of the cache
+   *
+   * New windows are added with an invalid title and start reporting
+   * property changes so that retitles of inactive windows invalidate
+   * their entry. Evicted windows release their selection, it stays in
+   * place while other modules, e.g. xworkspaces, still select it
+   */
+  window_title& xwindow_module::track(xcb_window_t win) {
+    auto entry = find(win);
+
+    if (entry != m_titles.end()) {
+      std::rotate(entry, entry + 1, m_titles.end());
+      return m_titles.back();
+    }
+
+    if (m_titles.size() == MAX_CACHED_TITLES) {
+      m_connection.release_event_mask(vector<xcb_window_t>{m_titles.front().window}, XCB_EVENT_MASK_PROPERTY_CHANGE);
+      m_titles.erase(m_titles.begin());
     }
 
-    if (m_active) {
-      m_label = m_statelabels.at(state::ACTIVE)->clone();
-      m_label->reset_tokens();
-      m_label->replace_token("%title%", m_active->title());
+    m_connection.ensure_event_mask(vector<xcb_window_t>{win}, XCB_EVENT_MASK_PROPERTY_CHANGE);
+    m_titles.emplace_back(window_title{win, "", false});
+    return m_titles.back();
+  }
+
+  /**
+   * Fetch the title of a cached window
+   *
+   * The lock is not held during the round trips. Property events are
+   * handled in order, so a retitle in the meantime fetches it again
+   */
+  void xwindow_module::refresh(xcb_window_t win) {
+    auto title = fetch_title(win);
+
+    std::lock_guard<std::mutex> guard(m_updatelock);
+    auto entry = find(win);
+    if (entry != m_titles.end()) {
+      entry->title = move(title);
+      entry->valid = true;
+    }
+  }
+
+  vector<window_title>::iterator xwindow_module::find(xcb_window_t win) {
+    return std::find_if(m_titles.begin(), m_titles.end(), [&](const window_title& t) { return t.window == win; });
+  }
+
+  /**
+   * Get the title by returning the first non-empty value of:
+   *  _NET_WM_NAME
+   *  _NET_WM_VISIBLE_NAME
+   *  WM_NAME
+   *
+   * All properties are requested before waiting for the first reply
+   */
+  string xwindow_module::fetch_title(xcb_window_t win) const {
+    auto ewmh = ewmh_util::initialize().get();
+    auto wm_name = xcb_ewmh_get_wm_name(ewmh, win);
+    auto visible_name = xcb_ewmh_get_wm_visible_name(ewmh, win);
+    auto icccm_name = xcb_icccm_get_wm_name(m_connection, win);
+
+    auto title = ewmh_util::get_wm_name(wm_name);
+    auto visible = ewmh_util::get_visible_name(visible_name);
+    auto name = icccm_util::get_wm_name(m_connection, icccm_name);
+
+    if (!title.empty()) {
+      return title;
+    } else if (!visible.empty()) {
+      return visible;
     } else {
-      m_label = m_statelabels.at(state::EMPTY)->clone();
+      return name;
     }
   }
 
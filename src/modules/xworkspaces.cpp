@@ -80,15 +80,24 @@ namespace modules {
     // Get list of monitors
     m_monitors = randr_util::get_monitors(m_connection, m_connection.root(), false);
 
+    // Send all queries before waiting for the first reply
+    auto names = xcb_ewmh_get_desktop_names(m_ewmh.get(), 0);
+    auto current = xcb_ewmh_get_current_desktop(m_ewmh.get(), 0);
+    auto clients = xcb_ewmh_get_client_list(m_ewmh.get(), 0);
+    xcb_get_property_cookie_t viewports{};
+    if (m_monitorsupport) {
+      viewports = xcb_ewmh_get_desktop_viewport(m_ewmh.get(), 0);
+    }
+
     // Get desktop details
-    m_desktop_names = ewmh_util::get_desktop_names();
-    m_current_desktop = ewmh_util::get_current_desktop();
+    m_desktop_names = ewmh_util::get_desktop_names(names);
+    m_current_desktop = ewmh_util::get_current_desktop(current);
 
-    rebuild_desktops();
-    rebuild_desktop_states();
+    rebuild_desktops(m_monitorsupport ? ewmh_util::get_desktop_viewports(viewports) : vector<position>{});
 
     // Get _NET_CLIENT_LIST
-    rebuild_clientlist();
+    rebuild_clientlist(ewmh_util::get_client_list(clients));
+    rebuild_desktop_states();
   }
 
   /**
@@ -96,22 +105,35 @@ namespace modules {
    */
   void xworkspaces_module::handle(const evt::property_notify& evt) {
     if (evt->atom == m_ewmh->_NET_CLIENT_LIST) {
-      rebuild_clientlist();
+      rebuild_clientlist(ewmh_util::get_client_list());
     } else if (evt->atom == m_ewmh->_NET_DESKTOP_NAMES) {
-      m_desktop_names = ewmh_util::get_desktop_names();
-      rebuild_desktops();
-      rebuild_desktop_states();
+      auto names = xcb_ewmh_get_desktop_names(m_ewmh.get(), 0);
+      xcb_get_property_cookie_t viewports{};
+      if (m_monitorsupport) {
+        viewports = xcb_ewmh_get_desktop_viewport(m_ewmh.get(), 0);
+      }
+      m_desktop_names = ewmh_util::get_desktop_names(names);
+      rebuild_desktops(m_monitorsupport ? ewmh_util::get_desktop_viewports(viewports) : vector<position>{});
     } else if (evt->atom == m_ewmh->_NET_CURRENT_DESKTOP) {
       m_current_desktop = ewmh_util::get_current_desktop();
-      rebuild_desktop_states();
+    } else if (evt->atom == m_ewmh->_NET_WM_DESKTOP) {
+      auto it = m_clients.find(evt->window);
+      if (it == m_clients.end()) {
+        return;
+      }
+      it->second.desktop = ewmh_util::get_desktop_from_window(evt->window);
     } else if (evt->atom == WM_HINTS) {
-      if (icccm_util::get_wm_urgency(m_connection, evt->window)) {
-        set_desktop_urgent(evt->window);
+      auto it = m_clients.find(evt->window);
+      if (it == m_clients.end()) {
+        return;
       }
+      it->second.urgent = icccm_util::get_wm_urgency(m_connection, evt->window);
     } else {
       return;
     }
 
+    rebuild_desktop_states();
+
     if (m_timer.allow(evt->time)) {
       broadcast();
     }
@@ -119,47 +141,60 @@ namespace modules {
 
   /**
    * Rebuild the list of managed clients
+   *
+   * Only clients that are new to the list are queried and all
+   * requests are sent before waiting for the first reply
    */
-  void xworkspaces_module::rebuild_clientlist() {
-    vector<xcb_window_t> clients = ewmh_util::get_client_list();
-    vector<xcb_window_t> diff;
-    std::sort(clients.begin(), clients.end());
-    std::sort(m_clientlist.begin(), m_clientlist.end());
-
-    if (m_clientlist.size() > clients.size()) {
-      std::set_difference(
-          m_clientlist.begin(), m_clientlist.end(), clients.begin(), clients.end(), back_inserter(diff));
-      for (auto&& win : diff) {
-        // untrack window
-        m_clientlist.erase(std::remove(m_clientlist.begin(), m_clientlist.end(), win), m_clientlist.end());
+  void xworkspaces_module::rebuild_clientlist(const vector<xcb_window_t>& windows) {
+    map<xcb_window_t, client> clients;
+    vector<xcb_window_t> added;
+
+    for (auto&& win : windows) {
+      auto it = m_clients.find(win);
+      if (it != m_clients.end()) {
+        clients.emplace(win, it->second);
+      } else {
+        added.emplace_back(win);
       }
-    } else {
-      std::set_difference(
-          clients.begin(), clients.end(), m_clientlist.begin(), m_clientlist.end(), back_inserter(diff));
-      for (auto&& win : diff) {
-        // listen for wm_hint (urgency) changes
-        m_connection.ensure_event_mask(win, XCB_EVENT_MASK_PROPERTY_CHANGE);
-        // track window
-        m_clientlist.emplace_back(win);
+    }
+
+    // Listen for _NET_WM_DESKTOP and WM_HINTS (urgency) changes before
+    // querying them. Other modules select events on the same windows,
+    // the shared connection keeps the mask until all released it
+    m_connection.ensure_event_mask(added, XCB_EVENT_MASK_PROPERTY_CHANGE);
+
+    vector<pair<xcb_get_property_cookie_t, xcb_get_property_cookie_t>> cookies;
+    cookies.reserve(added.size());
+
+    for (auto&& win : added) {
+      cookies.emplace_back(xcb_ewmh_get_wm_desktop(m_ewmh.get(), win), xcb_icccm_get_wm_hints(m_connection, win));
+    }
+
+    for (size_t i = 0; i < added.size(); i++) {
+      clients[added[i]] = client{ewmh_util::get_desktop_from_window(cookies[i].first),
+          icccm_util::get_wm_urgency(m_connection, cookies[i].second)};
+    }
+
+    vector<xcb_window_t> removed;
+    for (auto&& c : m_clients) {
+      if (clients.find(c.first) == clients.end()) {
+        removed.emplace_back(c.first);
       }
     }
+    m_connection.release_event_mask(removed, XCB_EVENT_MASK_PROPERTY_CHANGE);
+
+    m_clients.swap(clients);
   }
 
   /**
    * Rebuild the desktop tree
    */
-  void xworkspaces_module::rebuild_desktops() {
+  void xworkspaces_module::rebuild_desktops(vector<position>&& bounds) {
     m_viewports.clear();
 
-    auto bounds = [&] {
-      if (m_monitorsupport) {
-        return ewmh_util::get_desktop_viewports();
-      } else {
-        vector<position> b;
-        std::fill_n(std::back_inserter(b), m_desktop_names.size(), position{m_bar.monitor->x, m_bar.monitor->y});
-        return b;
-      }
-    }();
+    if (!m_monitorsupport) {
+      bounds.assign(m_desktop_names.size(), position{m_bar.monitor->x, m_bar.monitor->y});
+    }
 
     bounds.erase(std::unique(bounds.begin(), bounds.end(), [](auto& a, auto& b) { return a == b; }), bounds.end());
 
@@ -199,17 +234,33 @@ namespace modules {
   }
 
   /**
-   * Update active state of current desktops
+   * Update the state of all desktops from the cached clients,
+   * labels are only rebuilt for desktops whose state changed
    */
   void xworkspaces_module::rebuild_desktop_states() {
+    vector<desktop_state> states(m_desktop_names.size(), desktop_state::EMPTY);
+
+    for (auto&& c : m_clients) {
+      if (c.second.desktop >= states.size()) {
+        continue;
+      } else if (c.second.urgent) {
+        states[c.second.desktop] = desktop_state::URGENT;
+      } else if (states[c.second.desktop] == desktop_state::EMPTY) {
+        states[c.second.desktop] = desktop_state::OCCUPIED;
+      }
+    }
+
+    if (m_current_desktop < states.size()) {
+      states[m_current_desktop] = desktop_state::ACTIVE;
+    }
+
     for (auto&& v : m_viewports) {
       for (auto&& d : v->desktops) {
-        if (d->index == m_current_desktop) {
-          d->state = desktop_state::ACTIVE;
-        } else {
-          d->state = desktop_state::EMPTY;
-        } 
+        if (d->label && d->state == states[d->index]) {
+          continue;
+        }
 
+        d->state = states[d->index];
         d->label = m_labels.at(d->state)->clone();
         d->label->reset_tokens();
         d->label->replace_token("%index%", to_string(d->index - d->offset + 1));
@@ -219,31 +270,6 @@ namespace modules {
     }
   }
 
-  /**
-   * Find window and set corresponding desktop to urgent
-   */
-  void xworkspaces_module::set_desktop_urgent(xcb_window_t window) {
-    auto desk = ewmh_util::get_desktop_from_window(window);
-    if(desk == m_current_desktop)
-      // ignore if current desktop is urgent
-      return;
-    for (auto&& v : m_viewports) {
-      for (auto&& d : v->desktops) {
-        if (d->index == desk && d->state != desktop_state::URGENT) {
-          d->state = desktop_state::URGENT;
-
-          d->label = m_labels.at(d->state)->clone();
-          d->label->reset_tokens();
-          d->label->replace_token("%index%", to_string(d->index - d->offset + 1));
-          d->label->replace_token("%name%", m_desktop_names[d->index]);
-          d->label->replace_token("%icon%", m_icons->get(m_desktop_names[d->index], DEFAULT_ICON)->get());
-          return;
-        }
-      }
-    }
-
-  }
-
   /**
    * Fetch and parse data
    */
@@ -252,16 +278,17 @@ namespace modules {
   /**
    * Generate module output
    */
-  string xworkspaces_module::get_output() {
+  void xworkspaces_module::get_output(string& output) {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output;
+    output.clear();
     for (m_index = 0; m_index < m_viewports.size(); m_index++) {
       if (m_index > 0) {
         m_builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
       }
-      output += module::get_output();
+      module::get_output(m_viewportoutput);
+      output += m_viewportoutput;
     }
 
     if (m_scroll) {
@@ -274,7 +301,7 @@ namespace modules {
     m_builder->cmd_close();
     m_builder->cmd_close();
 
-    return m_builder->flush();
+    m_builder->flush(output);
   }
 
   /**
@@ -1,6 +1,7 @@
 #include <fcntl.h>
 #include <glob.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
@@ -162,6 +163,80 @@ int fd_streambuf::underflow() {
   return gptr() == egptr() ? traits_type::eof() : traits_type::to_int_type(*gptr());
 }
 
+// }}}
+// implementation of file_reader {{{
+
+/**
+ * Open the file if it exists, a missing file is not an error
+ *
+ * @see file_reader
+ */
+file_reader::file_reader(string path)
+    : m_path(move(path)), m_fd(open(m_path.c_str(), O_RDONLY | O_CLOEXEC)), m_buffer(bufsize, '\0') {}
+
+/**
+ * Read the current contents of the file
+ *
+ * The buffer grows until it fits the whole file. If the read fails,
+ * e.g. because the device was removed and added again or the file did
+ * not exist yet, the file is reopened and read once more
+ */
+bool file_reader::read() {
+  bool reopened{false};
+
+  while (true) {
+    auto bytes = pread(m_fd, m_buffer.data(), m_buffer.size() - 1, 0);
+
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes == -1 && !reopened) {
+      m_fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+      reopened = true;
+      continue;
+    } else if (bytes == -1) {
+      m_size = 0;
+      m_buffer[0] = '\0';
+      return false;
+    } else if (static_cast<size_t>(bytes) == m_buffer.size() - 1) {
+      m_buffer.resize(m_buffer.size() * 2);
+      continue;
+    }
+
+    m_size = bytes;
+    m_buffer[m_size] = '\0';
+    return true;
+  }
+}
+
+/**
+ * Read the file and parse its contents as an integer,
+ * returning 0 if the read fails
+ */
+long long file_reader::integer() {
+  return read() ? std::strtoll(data(), nullptr, 10) : 0LL;
+}
+
+/**
+ * Get the contents of the last read, always null-terminated
+ */
+const char* file_reader::data() const {
+  return m_buffer.data();
+}
+
+size_t file_reader::size() const {
+  return m_size;
+}
+
+/**
+ * Get the underlying descriptor, e.g. to poll(2) for changes
+ */
+file_reader::operator int() {
+  return static_cast<const file_reader&>(*this);
+}
+file_reader::operator int() const {
+  return m_fd;
+}
+
 // }}}
 
 namespace file_util {
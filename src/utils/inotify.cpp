@@ -117,4 +117,73 @@ int inotify_watch::get_file_descriptor() const {
   return m_fd;
 }
 
+/**
+ * Construct inotify instance
+ */
+inotify_instance::inotify_instance() {
+  if ((m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) {
+    throw system_error("Failed to allocate inotify fd");
+  }
+}
+
+/**
+ * Deconstruct inotify instance, which also removes all watches
+ */
+inotify_instance::~inotify_instance() {
+  close(m_fd);
+}
+
+/**
+ * Add a watch for the given path
+ */
+void inotify_instance::attach(const string& path, int mask) {
+  int wd{-1};
+  if ((wd = inotify_add_watch(m_fd, path.c_str(), mask)) == -1) {
+    throw system_error("Failed to attach inotify watch");
+  }
+  m_watches[wd] = path;
+}
+
+/**
+ * Read all queued events, the result has the
+ * union of their masks and the name of the last one
+ */
+unique_ptr<inotify_event> inotify_instance::get_event() const {
+  auto event = factory_util::unique<inotify_event>();
+
+  // Large enough for at least one event with the longest name
+  alignas(::inotify_event) char buffer[4096];
+  ssize_t bytes;
+
+  while ((bytes = read(m_fd, buffer, sizeof(buffer))) > 0) {
+    ssize_t len = 0;
+
+    while (len < bytes) {
+      auto* e = reinterpret_cast<::inotify_event*>(&buffer[len]);
+      auto watch = m_watches.find(e->wd);
+
+      if (e->len) {
+        event->filename = e->name;
+      } else if (watch != m_watches.end()) {
+        event->filename = watch->second;
+      }
+      event->wd = e->wd;
+      event->cookie = e->cookie;
+      event->is_dir = e->mask & IN_ISDIR;
+      event->mask |= e->mask;
+
+      len += sizeof(*e) + e->len;
+    }
+  }
+
+  return event;
+}
+
+/**
+ * Get the file descriptor of the instance
+ */
+int inotify_instance::get_file_descriptor() const {
+  return m_fd;
+}
+
 POLYBAR_NS_END
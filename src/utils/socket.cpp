@@ -2,6 +2,7 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <cerrno>
 
 #include "errors.hpp"
 #include "utils/file.hpp"
@@ -92,6 +93,31 @@ namespace socket_util {
     return receive(receive_bytes, &bytes, flags);
   }
 
+  /**
+   * Append all data that can be read without blocking to the given
+   * buffer, returns false if the connection was closed by the peer
+   */
+  bool unix_connection::receive_available(string& buffer) {
+    char chunk[BUFSIZ];
+
+    while (true) {
+      auto bytes = ::recv(m_fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+
+      if (bytes > 0) {
+        buffer.append(chunk, bytes);
+        if (static_cast<size_t>(bytes) < sizeof(chunk)) {
+          return true;
+        }
+      } else if (bytes == 0) {
+        return false;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+      } else if (errno != EINTR) {
+        throw system_error("Failed to receive data");
+      }
+    }
+  }
+
   /**
    * Peek at the specified number of bytes
    */
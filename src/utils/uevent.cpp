@@ -0,0 +1,131 @@
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "errors.hpp"
+#include "utils/uevent.hpp"
+
+POLYBAR_NS
+
+/**
+ * Get the value of given property, or an empty string
+ */
+string uevent::property(const string& key) const {
+  auto it = properties.find(key);
+  return it != properties.end() ? it->second : "";
+}
+
+/**
+ * Open a socket bound to the uevents broadcast by the kernel
+ */
+uevent_monitor::uevent_monitor(string subsystem) : m_subsystem(move(subsystem)) {
+  if ((m_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT)) == -1) {
+    throw system_error("Failed to open uevent socket");
+  }
+
+  struct sockaddr_nl addr {};
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = 1;  // kernel events, not the ones rebroadcast by udev
+
+  if (bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+    close(m_fd);
+    throw system_error("Failed to bind uevent socket");
+  }
+}
+
+/**
+ * Listen on a socket that is already set up, the
+ * monitor takes ownership of the file descriptor
+ */
+uevent_monitor::uevent_monitor(string subsystem, int fd) : m_subsystem(move(subsystem)), m_fd(fd) {}
+
+uevent_monitor::~uevent_monitor() {
+  if (m_fd != -1) {
+    close(m_fd);
+  }
+}
+
+/**
+ * Poll the socket for events
+ *
+ * @brief A wait_ms of -1 blocks until an event is received
+ */
+bool uevent_monitor::poll(int wait_ms) const {
+  struct pollfd fds[1]{};
+  fds[0].fd = m_fd;
+  fds[0].events = POLLIN;
+
+  return ::poll(fds, 1, wait_ms) > 0 && (fds[0].revents & POLLIN);
+}
+
+/**
+ * Read the next event, returns nullptr if it was
+ * not sent by the kernel or is of another subsystem
+ */
+unique_ptr<uevent> uevent_monitor::get_event() const {
+  char buffer[8192];
+  struct sockaddr_storage addr {};
+  socklen_t addrlen = sizeof(addr);
+
+  auto bytes = recvfrom(m_fd, buffer, sizeof(buffer), MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&addr), &addrlen);
+
+  if (bytes <= 0) {
+    return nullptr;
+  }
+
+  // Only trust events sent by the kernel itself
+  if (addr.ss_family == AF_NETLINK && reinterpret_cast<struct sockaddr_nl*>(&addr)->nl_pid != 0) {
+    return nullptr;
+  }
+
+  auto event = uevent_util::parse(buffer, bytes);
+
+  if (!event || event->property("SUBSYSTEM") != m_subsystem) {
+    return nullptr;
+  }
+
+  return event;
+}
+
+int uevent_monitor::get_file_descriptor() const {
+  return m_fd;
+}
+
+namespace uevent_util {
+  /**
+   * Parse a kernel uevent message, a header of the form "action@devpath"
+   * followed by null-separated "KEY=value" properties
+   */
+  unique_ptr<uevent> parse(const char* data, size_t len) {
+    const char* end = data + len;
+    const char* header_end = static_cast<const char*>(memchr(data, '\0', len));
+    const char* at = static_cast<const char*>(memchr(data, '@', len));
+
+    if (header_end == nullptr || at == nullptr || at > header_end) {
+      return nullptr;
+    }
+
+    auto event = factory_util::unique<uevent>();
+    event->action = string(data, at);
+    event->devpath = string(at + 1, header_end);
+
+    for (const char* pos = header_end + 1; pos < end;) {
+      const char* next = static_cast<const char*>(memchr(pos, '\0', end - pos));
+      if (next == nullptr) {
+        next = end;
+      }
+
+      const char* sep = static_cast<const char*>(memchr(pos, '=', next - pos));
+      if (sep != nullptr) {
+        event->properties.emplace(string(pos, sep), string(sep + 1, next));
+      }
+
+      pos = next + 1;
+    }
+
+    return event;
+  }
+}
+
+POLYBAR_NS_END
@@ -101,17 +101,85 @@ xcb_screen_t* connection::screen(bool realloc) {
  * Add given event to the event mask unless already added
  */
 void connection::ensure_event_mask(xcb_window_t win, unsigned int event) {
-  auto attributes = get_window_attributes(win);
-  attributes->your_event_mask = attributes->your_event_mask | event;
-  change_window_attributes(win, XCB_CW_EVENT_MASK, &attributes->your_event_mask);
+  ensure_event_mask(vector<xcb_window_t>{win}, event);
 }
 
 /**
- * Clear event mask for the given window
+ * Add given event to the event mask of all windows, the current masks
+ * are requested at once. The selection of a client is shared by all
+ * modules, so each selected event is counted and only removed from the
+ * mask once it was released as often, see release_event_mask().
+ * Windows that no longer exist are skipped
  */
-void connection::clear_event_mask(xcb_window_t win) {
-  unsigned int mask{XCB_EVENT_MASK_NO_EVENT};
-  change_window_attributes(win, XCB_CW_EVENT_MASK, &mask);
+void connection::ensure_event_mask(const vector<xcb_window_t>& windows, unsigned int event) {
+  std::lock_guard<std::mutex> guard(m_eventmasks_mutex);
+  vector<xcb_get_window_attributes_cookie_t> cookies;
+  cookies.reserve(windows.size());
+
+  for (auto&& win : windows) {
+    for (unsigned int bit = 1; bit != 0 && bit <= event; bit <<= 1) {
+      if (event & bit) {
+        m_eventmasks[make_pair(win, bit)]++;
+      }
+    }
+    cookies.emplace_back(xcb_get_window_attributes(*this, win));
+  }
+
+  for (size_t i = 0; i < windows.size(); i++) {
+    xcb_generic_error_t* err{nullptr};
+    auto* reply = xcb_get_window_attributes_reply(*this, cookies[i], &err);
+
+    if (reply != nullptr && (reply->your_event_mask & event) != event) {
+      const unsigned int mask{reply->your_event_mask | event};
+      xcb_change_window_attributes(*this, windows[i], XCB_CW_EVENT_MASK, &mask);
+    }
+
+    free(reply);
+    free(err);
+  }
+}
+
+/**
+ * Release a selection made with ensure_event_mask(), the event is
+ * removed from the mask of windows where it is no longer selected
+ */
+void connection::release_event_mask(const vector<xcb_window_t>& windows, unsigned int event) {
+  std::lock_guard<std::mutex> guard(m_eventmasks_mutex);
+  vector<pair<xcb_window_t, unsigned int>> released;
+
+  for (auto&& win : windows) {
+    unsigned int unused{0};
+    for (unsigned int bit = 1; bit != 0 && bit <= event; bit <<= 1) {
+      auto it = m_eventmasks.find(make_pair(win, bit));
+      if ((event & bit) && it != m_eventmasks.end() && --it->second == 0) {
+        m_eventmasks.erase(it);
+        unused |= bit;
+      }
+    }
+    if (unused != 0) {
+      released.emplace_back(win, unused);
+    }
+  }
+
+  vector<xcb_get_window_attributes_cookie_t> cookies;
+  cookies.reserve(released.size());
+
+  for (auto&& win : released) {
+    cookies.emplace_back(xcb_get_window_attributes(*this, win.first));
+  }
+
+  for (size_t i = 0; i < released.size(); i++) {
+    xcb_generic_error_t* err{nullptr};
+    auto* reply = xcb_get_window_attributes_reply(*this, cookies[i], &err);
+
+    if (reply != nullptr && (reply->your_event_mask & released[i].second) != 0) {
+      const unsigned int mask{reply->your_event_mask & ~released[i].second};
+      xcb_change_window_attributes(*this, released[i].first, XCB_CW_EVENT_MASK, &mask);
+    }
+
+    free(reply);
+    free(err);
+  }
 }
 
 /**
@@ -225,6 +293,7 @@ string connection::error_str(int error_code) {
  * Dispatch event through the registry
  */
 void connection::dispatch_event(const shared_ptr<xcb_generic_event_t>& evt) const {
+  std::lock_guard<std::recursive_mutex> guard(m_registry_mutex);
   m_registry.dispatch(evt);
 }
 
@@ -35,18 +35,24 @@ namespace ewmh_util {
   }
 
   string get_wm_name(xcb_window_t win) {
-    auto conn = initialize().get();
+    return get_wm_name(xcb_ewmh_get_wm_name(initialize().get(), win));
+  }
+
+  string get_wm_name(xcb_get_property_cookie_t cookie) {
     xcb_ewmh_get_utf8_strings_reply_t utf8_reply{};
-    if (xcb_ewmh_get_wm_name_reply(conn, xcb_ewmh_get_wm_name(conn, win), &utf8_reply, nullptr)) {
+    if (xcb_ewmh_get_wm_name_reply(initialize().get(), cookie, &utf8_reply, nullptr)) {
       return get_reply_string(&utf8_reply);
     }
     return "";
   }
 
   string get_visible_name(xcb_window_t win) {
-    auto conn = initialize().get();
+    return get_visible_name(xcb_ewmh_get_wm_visible_name(initialize().get(), win));
+  }
+
+  string get_visible_name(xcb_get_property_cookie_t cookie) {
     xcb_ewmh_get_utf8_strings_reply_t utf8_reply{};
-    if (xcb_ewmh_get_wm_visible_name_reply(conn, xcb_ewmh_get_wm_visible_name(conn, win), &utf8_reply, nullptr)) {
+    if (xcb_ewmh_get_wm_visible_name_reply(initialize().get(), cookie, &utf8_reply, nullptr)) {
       return get_reply_string(&utf8_reply);
     }
     return "";
@@ -71,30 +77,42 @@ namespace ewmh_util {
   }
 
   unsigned int get_current_desktop(int screen) {
-    auto conn = initialize().get();
+    return get_current_desktop(xcb_ewmh_get_current_desktop(initialize().get(), screen));
+  }
+
+  unsigned int get_current_desktop(xcb_get_property_cookie_t cookie) {
     unsigned int desktop = XCB_NONE;
-    xcb_ewmh_get_current_desktop_reply(conn, xcb_ewmh_get_current_desktop(conn, screen), &desktop, nullptr);
+    xcb_ewmh_get_current_desktop_reply(initialize().get(), cookie, &desktop, nullptr);
     return desktop;
   }
 
   vector<position> get_desktop_viewports(int screen) {
-    auto conn = initialize().get();
+    return get_desktop_viewports(xcb_ewmh_get_desktop_viewport(initialize().get(), screen));
+  }
+
+  vector<position> get_desktop_viewports(xcb_get_property_cookie_t cookie) {
     vector<position> viewports;
     xcb_ewmh_get_desktop_viewport_reply_t reply{};
-    if (xcb_ewmh_get_desktop_viewport_reply(conn, xcb_ewmh_get_desktop_viewport(conn, screen), &reply, nullptr)) {
+    if (xcb_ewmh_get_desktop_viewport_reply(initialize().get(), cookie, &reply, nullptr)) {
       for (size_t n = 0; n < reply.desktop_viewport_len; n++) {
         viewports.emplace_back(position{
             static_cast<short int>(reply.desktop_viewport[n].x), static_cast<short int>(reply.desktop_viewport[n].y)});
       }
+      xcb_ewmh_get_desktop_viewport_reply_wipe(&reply);
     }
     return viewports;
   }
 
   vector<string> get_desktop_names(int screen) {
-    auto conn = initialize().get();
+    return get_desktop_names(xcb_ewmh_get_desktop_names(initialize().get(), screen));
+  }
+
+  vector<string> get_desktop_names(xcb_get_property_cookie_t cookie) {
     xcb_ewmh_get_utf8_strings_reply_t reply{};
-    if (xcb_ewmh_get_desktop_names_reply(conn, xcb_ewmh_get_desktop_names(conn, screen), &reply, nullptr)) {
-      return string_util::split(string(reply.strings, reply.strings_len), '\0');
+    if (xcb_ewmh_get_desktop_names_reply(initialize().get(), cookie, &reply, nullptr)) {
+      auto names = string_util::split(string(reply.strings, reply.strings_len), '\0');
+      xcb_ewmh_get_utf8_strings_reply_wipe(&reply);
+      return names;
     }
     return {};
   }
@@ -113,9 +131,12 @@ namespace ewmh_util {
   }
 
   unsigned int get_desktop_from_window(xcb_window_t window) {
-    auto conn = initialize().get();
+    return get_desktop_from_window(xcb_ewmh_get_wm_desktop(initialize().get(), window));
+  }
+
+  unsigned int get_desktop_from_window(xcb_get_property_cookie_t cookie) {
     unsigned int desktop = XCB_NONE;
-    xcb_ewmh_get_wm_desktop_reply(conn, xcb_ewmh_get_wm_desktop(conn, window), &desktop, nullptr);
+    xcb_ewmh_get_wm_desktop_reply(initialize().get(), cookie, &desktop, nullptr);
     return desktop;
   }
 
@@ -166,10 +187,15 @@ namespace ewmh_util {
   }
 
   vector<xcb_window_t> get_client_list(int screen) {
-    auto conn = initialize().get();
+    return get_client_list(xcb_ewmh_get_client_list(initialize().get(), screen));
+  }
+
+  vector<xcb_window_t> get_client_list(xcb_get_property_cookie_t cookie) {
     xcb_ewmh_get_windows_reply_t reply;
-    if (xcb_ewmh_get_client_list_reply(conn, xcb_ewmh_get_client_list(conn, screen), &reply, nullptr)) {
-      return {reply.windows, reply.windows + reply.windows_len};
+    if (xcb_ewmh_get_client_list_reply(initialize().get(), cookie, &reply, nullptr)) {
+      vector<xcb_window_t> windows{reply.windows, reply.windows + reply.windows_len};
+      xcb_ewmh_get_windows_reply_wipe(&reply);
+      return windows;
     }
     return {};
   }
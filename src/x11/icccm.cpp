@@ -5,8 +5,12 @@ POLYBAR_NS
 
 namespace icccm_util {
   string get_wm_name(xcb_connection_t* c, xcb_window_t w) {
+    return get_wm_name(c, xcb_icccm_get_wm_name(c, w));
+  }
+
+  string get_wm_name(xcb_connection_t* c, xcb_get_property_cookie_t cookie) {
     xcb_icccm_get_text_property_reply_t reply{};
-    if (xcb_icccm_get_wm_name_reply(c, xcb_icccm_get_wm_name(c, w), &reply, nullptr)) {
+    if (xcb_icccm_get_wm_name_reply(c, cookie, &reply, nullptr)) {
       return get_reply_string(&reply);
     }
     return "";
@@ -31,8 +35,12 @@ namespace icccm_util {
   }
 
   bool get_wm_urgency(xcb_connection_t* c, xcb_window_t w) {
+    return get_wm_urgency(c, xcb_icccm_get_wm_hints(c, w));
+  }
+
+  bool get_wm_urgency(xcb_connection_t* c, xcb_get_property_cookie_t cookie) {
     xcb_icccm_wm_hints_t hints;
-    if (xcb_icccm_get_wm_hints_reply(c, xcb_icccm_get_wm_hints(c, w), &hints, NULL)) {
+    if (xcb_icccm_get_wm_hints_reply(c, cookie, &hints, NULL)) {
       if(xcb_icccm_wm_hints_get_urgency(&hints) == XCB_ICCCM_WM_HINT_X_URGENCY)
         return true;
     }
@@ -55,7 +55,7 @@ tray_manager::~tray_manager() {
 
 void tray_manager::setup(const bar_settings& bar_opts) {
   const config& conf = config::make();
-  auto bs = conf.section();
+  auto bs = bar_opts.section;
   string position;
 
   try {
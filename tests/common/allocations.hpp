@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Replaces the global allocation functions to count the number of
+ * allocations, only include this once per test executable
+ */
+namespace {
+  std::atomic<size_t> g_allocations{0};
+}
+
+void* operator new(size_t size) {
+  g_allocations++;
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+/**
+ * Number of allocations made since the counter was created
+ */
+class allocation_counter {
+ public:
+  size_t count() const {
+    return g_allocations - m_start;
+  }
+
+ private:
+  size_t m_start{g_allocations};
+};
@@ -0,0 +1,237 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "adapters/i3.hpp"
+#include "common/test.hpp"
+#include "components/logger.hpp"
+
+using namespace polybar;
+
+namespace {
+  /**
+   * GET_WORKSPACES reply as sent by i3 4.14
+   */
+  string workspaces_reply(int count) {
+    string reply{"["};
+    for (int i = 1; i <= count; i++) {
+      reply += (i > 1 ? "," : "");
+      reply += R"({"id":9460368)" + to_string(i) + R"(,"num":)" + to_string(i) + R"(,"name":")" + to_string(i) +
+               R"(: term","visible":)" + (i <= 2 ? "true" : "false") + R"(,"focused":)" + (i == 1 ? "true" : "false") +
+               R"(,"rect":{"x":0,"y":0,"width":1920,"height":1080},"output":")" + (i % 2 ? "DP-1" : "HDMI-1") +
+               R"(","urgent":)" + (i == 5 ? "true" : "false") + "}";
+    }
+    return reply + "]";
+  }
+
+  /**
+   * Workspace event with the container tree of the workspace
+   */
+  const string focus_event{R"({
+    "change": "focus",
+    "current": {"id": 94603681, "type": "workspace", "orientation": "horizontal", "num": 2,
+      "name": "2: \"www\" é😀", "urgent": false, "focused": true, "output": "HDMI-1",
+      "rect": {"x": 1920, "y": 0, "width": 1920, "height": 1080},
+      "nodes": [{"id": 94603682, "type": "con", "name": "Firefox } ]", "urgent": true, "focused": false,
+        "window_properties": {"class": "Firefox", "title": "\\ [x]"}, "nodes": [], "floating_nodes": []}],
+      "floating_nodes": []},
+    "old": {"id": 94603680, "type": "workspace", "num": 1, "name": "1: term", "nodes": []}
+  })"};
+}
+
+TEST(I3, decodeWorkspaces) {
+  vector<i3::workspace> workspaces;
+
+  ASSERT_TRUE(i3::decode(workspaces_reply(5), workspaces));
+  ASSERT_EQ(5U, workspaces.size());
+  EXPECT_EQ(1, workspaces[0].num);
+  EXPECT_EQ("1: term", workspaces[0].name);
+  EXPECT_EQ("DP-1", workspaces[0].output);
+  EXPECT_TRUE(workspaces[0].focused);
+  EXPECT_TRUE(workspaces[1].visible);
+  EXPECT_FALSE(workspaces[1].focused);
+  EXPECT_EQ("HDMI-1", workspaces[1].output);
+  EXPECT_FALSE(workspaces[2].visible);
+  EXPECT_TRUE(workspaces[4].urgent);
+
+  // Existing elements are reused, the list shrinks
+  ASSERT_TRUE(i3::decode(workspaces_reply(2), workspaces));
+  EXPECT_EQ(2U, workspaces.size());
+
+  ASSERT_TRUE(i3::decode("[]", workspaces));
+  EXPECT_TRUE(workspaces.empty());
+
+  EXPECT_FALSE(i3::decode(R"([{"num":1,"name":"1")", workspaces));
+  EXPECT_FALSE(i3::decode(R"({"num":1})", workspaces));
+}
+
+TEST(I3, decodeEvents) {
+  i3::workspace_event event;
+
+  ASSERT_TRUE(i3::decode(focus_event, event));
+  EXPECT_EQ("focus", event.change);
+  ASSERT_TRUE(event.has_current);
+  EXPECT_EQ(2, event.current.num);
+  EXPECT_EQ("2: \"www\" \xc3\xa9\xf0\x9f\x98\x80", event.current.name);
+  EXPECT_EQ("HDMI-1", event.current.output);
+  EXPECT_TRUE(event.current.focused);
+  EXPECT_FALSE(event.current.urgent);
+
+  ASSERT_TRUE(i3::decode(R"({"change":"reload","current":null,"old":null})", event));
+  EXPECT_EQ("reload", event.change);
+  EXPECT_FALSE(event.has_current);
+
+  i3::mode_event mode;
+  ASSERT_TRUE(i3::decode(R"({"change":"resize","pango_markup":false})", mode));
+  EXPECT_EQ("resize", mode.change);
+  EXPECT_FALSE(i3::decode(R"({"change":"resize")", mode));
+}
+
+TEST(I3, connection) {
+  string path{"/tmp/polybar_i3_test.sock"};
+  unlink(path.c_str());
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr {};
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+  ASSERT_EQ(0, bind(server, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+  ASSERT_EQ(0, listen(server, 1));
+
+  i3::ipc_connection conn{path};
+  int client = accept(server, nullptr, nullptr);
+  ASSERT_NE(-1, client);
+
+  conn.send(i3::message_type::SUBSCRIBE, R"(["workspace"])");
+
+  char request[6 + 8 + 13]{};
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(request)), recv(client, request, sizeof(request), MSG_WAITALL));
+  EXPECT_EQ(0, memcmp(request, "i3-ipc\x0d\0\0\0\x02\0\0\0[\"workspace\"]", sizeof(request)));
+
+  // A reply split across writes
+  string reply{"i3-ipc\x10\0\0\0\x02\0\0\0{\"success\":true}", 30};
+  ASSERT_EQ(10, send(client, reply.data(), 10, 0));
+  ASSERT_EQ(20, send(client, reply.data() + 10, 20, 0));
+
+  string payload;
+  EXPECT_EQ(i3::message_type::SUBSCRIBE, conn.receive(payload));
+  EXPECT_EQ("{\"success\":true}", payload);
+
+  close(client);
+  EXPECT_THROW(conn.receive(payload), i3::ipc_error);
+
+  close(server);
+  unlink(path.c_str());
+}
+
+TEST(I3, eventQueue) {
+  i3::event_queue queue;
+  auto ev = make_shared<i3::event>();
+  queue.push(ev);
+
+  shared_ptr<const i3::event> received;
+  ASSERT_TRUE(queue.wait(received));
+  EXPECT_EQ(ev, received);
+
+  std::thread closer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    queue.close();
+  });
+  EXPECT_FALSE(queue.wait(received));
+  closer.join();
+
+  // Pending events are dropped once closed
+  queue.push(ev);
+  EXPECT_FALSE(queue.wait(received));
+}
+
+TEST(I3, sourceIsShared) {
+  char dir[] = "/tmp/polybar_i3_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  string path{string{dir} + "/socket"};
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr {};
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+  ASSERT_EQ(0, bind(server, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+  ASSERT_EQ(0, listen(server, 1));
+
+  const auto message = [](uint32_t type, const string& payload) {
+    uint32_t header[2]{static_cast<uint32_t>(payload.size()), type};
+    return "i3-ipc" + string{reinterpret_cast<const char*>(header), sizeof(header)} + payload;
+  };
+
+  // Answer the subscription of the source
+  int client{-1};
+  std::thread i3([&] {
+    client = accept(server, nullptr, nullptr);
+    char request[6 + 8 + 20]{};
+    recv(client, request, sizeof(request), MSG_WAITALL);
+    auto reply = message(2, R"({"success":true})");
+    send(client, reply.data(), reply.size(), 0);
+  });
+
+  logger log{loglevel::NONE};
+  auto source = i3::ipc_source::acquire(log, path);
+  i3.join();
+  ASSERT_NE(-1, client);
+  EXPECT_EQ(source, i3::ipc_source::acquire(log, path));
+
+  auto a = source->subscribe();
+  auto b = source->subscribe();
+
+  auto events = message(0x80000000, R"({"change":"focus","current":{"num":2,"name":"2","output":"DP-1"}})") +
+                message(0x80000002, R"({"change":"resize"})");
+  send(client, events.data(), events.size(), 0);
+
+  // Each event is decoded once for all subscribers
+  shared_ptr<const i3::event> ev_a;
+  shared_ptr<const i3::event> ev_b;
+  ASSERT_TRUE(a->wait(ev_a));
+  ASSERT_TRUE(b->wait(ev_b));
+  EXPECT_EQ(ev_a, ev_b);
+  EXPECT_EQ(i3::event::kind::WORKSPACE, ev_a->type);
+  EXPECT_EQ("2", ev_a->workspace.current.name);
+
+  ASSERT_TRUE(a->wait(ev_a));
+  EXPECT_EQ(i3::event::kind::MODE, ev_a->type);
+  EXPECT_EQ("resize", ev_a->mode.change);
+
+  source.reset();
+
+  close(client);
+  close(server);
+  unlink(path.c_str());
+  rmdir(dir);
+}
+
+/**
+ * Run with --gtest_also_run_disabled_tests
+ */
+TEST(I3, DISABLED_benchmark) {
+  const auto reply = workspaces_reply(32);
+  const int iterations{100000};
+  vector<i3::workspace> workspaces;
+  i3::workspace_event event;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    i3::decode(reply, workspaces);
+  }
+  auto workspaces_time = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    i3::decode(focus_event, event);
+  }
+  auto event_time = std::chrono::steady_clock::now() - start;
+
+  std::cout << "GET_WORKSPACES (32): "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(workspaces_time).count() / iterations
+            << " ns, workspace event: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(event_time).count() / iterations << " ns\n";
+}
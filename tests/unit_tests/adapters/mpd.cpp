@@ -0,0 +1,275 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "adapters/mpd.hpp"
+#include "common/test.hpp"
+#include "components/logger.hpp"
+
+using namespace polybar;
+using namespace mpd;
+
+namespace {
+  /**
+   * Minimal mpd server speaking the text protocol on a unix socket
+   */
+  class fake_server {
+   public:
+    fake_server() {
+      char dir[] = "/tmp/polybar_mpd_test.XXXXXX";
+      m_dir = mkdtemp(dir);
+      m_path = m_dir + "/socket";
+      m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      struct sockaddr_un addr {};
+      addr.sun_family = AF_UNIX;
+      snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", m_path.c_str());
+      bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+      listen(m_fd, 1);
+      m_thread = std::thread(&fake_server::serve, this);
+    }
+
+    ~fake_server() {
+      shutdown(m_fd, SHUT_RDWR);
+      if (m_client != -1) {
+        shutdown(m_client, SHUT_RDWR);
+      }
+      m_thread.join();
+      close(m_fd);
+      if (m_client != -1) {
+        close(m_client);
+      }
+      unlink(m_path.c_str());
+      rmdir(m_dir.c_str());
+    }
+
+    const string& path() const {
+      return m_path;
+    }
+
+    void set_status(string status) {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_status = move(status);
+    }
+
+    /**
+     * Complete a pending idle command with the given subsystem
+     */
+    void notify(const string& subsystem) {
+      write("changed: " + subsystem + "\nOK\n");
+    }
+
+    std::atomic<int> status_queries{0};
+
+   protected:
+    void serve() {
+      if ((m_client = accept(m_fd, nullptr, nullptr)) == -1) {
+        return;
+      }
+
+      write("OK MPD 0.21.0\n");
+
+      string buffer;
+      char data[256];
+      ssize_t bytes;
+
+      while ((bytes = recv(m_client, data, sizeof(data), 0)) > 0) {
+        buffer.append(data, bytes);
+
+        size_t pos;
+        while ((pos = buffer.find('\n')) != string::npos) {
+          respond(buffer.substr(0, pos));
+          buffer.erase(0, pos + 1);
+        }
+      }
+    }
+
+    void respond(const string& command) {
+      if (command == "status") {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        status_queries++;
+        write(m_status + "OK\n");
+      } else if (command == "currentsong") {
+        write("file: music/song.flac\nTitle: Song\nArtist: Artist\nOK\n");
+      } else if (command == "noidle") {
+        // Ignored by mpd unless an idle command is pending
+        if (m_idle.exchange(false)) {
+          write("OK\n");
+        }
+      } else if (command == "idle") {
+        m_idle = true;
+      } else {
+        write("OK\n");
+      }
+    }
+
+    void write(const string& data) {
+      if (data.compare(0, 8, "changed:") == 0) {
+        m_idle = false;
+      }
+      send(m_client, data.data(), data.size(), MSG_NOSIGNAL);
+    }
+
+   private:
+    string m_dir;
+    string m_path;
+    int m_fd{-1};
+    std::atomic<int> m_client{-1};
+    std::atomic<bool> m_idle{false};
+    std::mutex m_mutex;
+    string m_status{"state: play\ntime: 10:200\nelapsed: 10.500\nsong: 0\nsongid: 1\nplaylistlength: 3\n"};
+    std::thread m_thread;
+  };
+}
+
+TEST(Mpd, elapsedTimeIsInterpolated) {
+  fake_server server;
+  logger log{loglevel::NONE};
+  mpdconnection conn{log, server.path(), 0};
+  conn.connect();
+
+  auto status = conn.get_status();
+  EXPECT_TRUE(status->match_state(mpdstate::PLAYING));
+  EXPECT_EQ(10U, status->get_elapsed_time());
+  EXPECT_EQ(200U, status->get_total_time());
+
+  std::this_thread::sleep_for(chrono::milliseconds{600});
+  status->update_timer();
+
+  EXPECT_EQ(11U, status->get_elapsed_time());
+  EXPECT_GE(status->get_elapsed_time_ms(), 11100UL);
+  EXPECT_EQ(1, server.status_queries);
+}
+
+TEST(Mpd, pausedTimeIsNotAdvanced) {
+  fake_server server;
+  server.set_status("state: pause\ntime: 10:200\nelapsed: 10.500\n");
+  logger log{loglevel::NONE};
+  mpdconnection conn{log, server.path(), 0};
+  conn.connect();
+
+  auto status = conn.get_status();
+  std::this_thread::sleep_for(chrono::milliseconds{600});
+  status->update_timer();
+
+  EXPECT_EQ(10U, status->get_elapsed_time());
+  EXPECT_EQ(10500UL, status->get_elapsed_time_ms());
+}
+
+TEST(Mpd, idleEventsResync) {
+  fake_server server;
+  logger log{loglevel::NONE};
+  mpdconnection conn{log, server.path(), 0};
+  conn.connect();
+
+  auto status = conn.get_status();
+  conn.idle();
+  EXPECT_FALSE(conn.poll(100));
+
+  server.set_status("state: play\ntime: 30:200\nelapsed: 30.000\n");
+  server.notify("player");
+
+  ASSERT_TRUE(conn.poll(1000));
+  int flags = conn.noidle();
+  EXPECT_EQ(MPD_IDLE_PLAYER, flags);
+
+  status->update(flags, &conn);
+  EXPECT_EQ(30U, status->get_elapsed_time());
+  EXPECT_EQ(2, server.status_queries);
+
+  // Without a pending change leaving idle mode is answered right away
+  conn.idle();
+  EXPECT_EQ(0, conn.noidle());
+}
+
+TEST(Mpd, pollIsInterrupted) {
+  fake_server server;
+  logger log{loglevel::NONE};
+  mpdconnection conn{log, server.path(), 0};
+  conn.connect();
+  conn.idle();
+
+  auto start = chrono::steady_clock::now();
+  std::thread waker([&] {
+    std::this_thread::sleep_for(chrono::milliseconds{50});
+    conn.interrupt();
+  });
+  EXPECT_FALSE(conn.poll(-1));
+  EXPECT_LT(chrono::steady_clock::now() - start, chrono::seconds{1});
+  waker.join();
+
+  // An interrupt before the wait makes the next poll return right away, once
+  conn.interrupt();
+  conn.interrupt();
+  EXPECT_FALSE(conn.poll(-1));
+  start = chrono::steady_clock::now();
+  EXPECT_FALSE(conn.poll(100));
+  EXPECT_GE(chrono::steady_clock::now() - start, chrono::milliseconds{100});
+
+  server.notify("player");
+  EXPECT_TRUE(conn.poll(1000));
+  EXPECT_EQ(MPD_IDLE_PLAYER, conn.noidle());
+}
+
+TEST(Mpd, sourceIsShared) {
+  fake_server server;
+  logger log{loglevel::NONE};
+
+  // The fake server only accepts a single connection
+  auto source = mpdsource::acquire(log, server.path(), 0, "");
+  EXPECT_EQ(source, mpdsource::acquire(log, server.path(), 0, ""));
+
+  auto state = source->get();
+  ASSERT_TRUE(state->connected);
+  EXPECT_TRUE(state->status->match_state(mpdstate::PLAYING));
+  EXPECT_EQ("Song", state->title);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  int notified{0};
+  const auto wait = [&](int count) {
+    std::unique_lock<std::mutex> guard(mutex);
+    return cv.wait_for(guard, chrono::seconds{1}, [&] { return notified >= count; });
+  };
+
+  auto a = source->subscribe([&] {
+    std::lock_guard<std::mutex> guard(mutex);
+    notified++;
+    cv.notify_all();
+  });
+  auto b = source->subscribe([&] {
+    std::lock_guard<std::mutex> guard(mutex);
+    notified++;
+    cv.notify_all();
+  });
+
+  // Commands are run by the thread of the source
+  std::atomic<bool> sent{false};
+  source->send([&](mpdconnection& conn) {
+    conn.pause(true);
+    sent = true;
+  });
+
+  server.set_status("state: pause\ntime: 10:200\nelapsed: 10.500\n");
+  std::this_thread::sleep_for(chrono::milliseconds{100});
+  EXPECT_TRUE(sent);
+  server.notify("player");
+
+  ASSERT_TRUE(wait(2));
+  state = source->get();
+  EXPECT_TRUE(state->status->match_state(mpdstate::PAUSED));
+  EXPECT_EQ("Song", state->title);
+
+  // Option changes keep the song of the previous state
+  source->unsubscribe(b);
+  std::this_thread::sleep_for(chrono::milliseconds{100});
+  server.notify("options");
+  ASSERT_TRUE(wait(3));
+  EXPECT_EQ("Artist", source->get()->artist);
+  EXPECT_EQ(3, notified);
+
+  source->unsubscribe(a);
+}
@@ -0,0 +1,59 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "adapters/probe.hpp"
+#include "common/test.hpp"
+
+using namespace polybar;
+using namespace std::chrono_literals;
+
+namespace {
+  /**
+   * Wait for the result of a probe started in the background
+   */
+  net::probe_result await_result(net::probe& probe) {
+    net::probe_result result{};
+    for (int i = 0; i < 100 && !probe.result(result); i++) {
+      std::this_thread::sleep_for(20ms);
+    }
+    return result;
+  }
+}
+
+TEST(Probe, loopback) {
+  // Responder for the TCP fallback if ICMP sockets aren't permitted
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr {};
+  socklen_t len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  ASSERT_EQ(0, bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+  ASSERT_EQ(0, listen(listener, 4));
+  ASSERT_EQ(0, getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &len));
+
+  net::probe probe("127.0.0.1", 2, 1s, ntohs(addr.sin_port));
+  net::probe_result result{};
+
+  EXPECT_FALSE(probe.result(result));
+  EXPECT_TRUE(probe.start());
+
+  result = await_result(probe);
+  EXPECT_EQ(2, result.sent);
+  EXPECT_EQ(2, result.received);
+  EXPECT_EQ(0, result.loss());
+  EXPECT_LT(result.latency, 1s);
+
+  // The result is only reported once
+  EXPECT_FALSE(probe.result(result));
+
+  close(listener);
+}
+
+TEST(Probe, loss) {
+  net::probe_result result{};
+  result.sent = 4;
+  result.received = 1;
+  EXPECT_EQ(75, result.loss());
+}
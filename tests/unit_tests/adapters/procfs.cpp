@@ -0,0 +1,50 @@
+#include "adapters/procfs.hpp"
+#include "common/test.hpp"
+
+using namespace polybar;
+
+namespace {
+  const string mountinfo{
+      "22 1 8:2 / / rw,relatime shared:1 - ext4 /dev/sda2 rw\n"
+      "23 22 0:21 / /proc rw,nosuid,nodev,noexec,relatime shared:12 - proc proc rw\n"
+      "24 22 8:3 / /home rw,relatime shared:2 master:1 - btrfs /dev/sda3 rw,space_cache\n"
+      "25 22 0:22 / /mnt rw,relatime - tmpfs tmpfs rw\n"
+      "26 25 0:23 / /mnt/nas rw,relatime - nfs4 nas:/export rw,vers=4.2\n"
+      "27 22 0:24 / /mnt rw,relatime shared:3 - nfs4 server:/share rw\n"
+      "28 22 0:25 / /media/usb rw - vfat /dev/sdb1 rw"};
+
+  procfs::mounts parse(const string& data, const vector<string>& mountpoints) {
+    procfs::mounts mounted;
+    procfs::parse_mountinfo(data.data(), data.size(), mountpoints, mounted);
+    return mounted;
+  }
+}
+
+TEST(Procfs, parseMountinfo) {
+  auto mounted = parse(mountinfo, {"/", "/home", "/mnt/nas", "/media/usb", "/missing", "/mnt/na"});
+
+  EXPECT_EQ(4U, mounted.size());
+  EXPECT_EQ(make_pair(string{"ext4"}, string{"/dev/sda2"}), mounted["/"]);
+  EXPECT_EQ(make_pair(string{"btrfs"}, string{"/dev/sda3"}), mounted["/home"]);
+  EXPECT_EQ(make_pair(string{"nfs4"}, string{"nas:/export"}), mounted["/mnt/nas"]);
+  EXPECT_EQ(make_pair(string{"vfat"}, string{"/dev/sdb1"}), mounted["/media/usb"]);
+}
+
+TEST(Procfs, parseMountinfoStacked) {
+  // The last entry is mounted on top of the earlier ones
+  auto mounted = parse(mountinfo, {"/mnt"});
+
+  EXPECT_EQ(1U, mounted.size());
+  EXPECT_EQ(make_pair(string{"nfs4"}, string{"server:/share"}), mounted["/mnt"]);
+}
+
+TEST(Procfs, parseMountinfoClears) {
+  procfs::mounts mounted{{"/old", {"ext4", "/dev/sdc1"}}};
+  procfs::parse_mountinfo(mountinfo.data(), mountinfo.size(), {"/proc"}, mounted);
+
+  EXPECT_EQ(1U, mounted.size());
+  EXPECT_EQ(make_pair(string{"proc"}, string{"proc"}), mounted["/proc"]);
+
+  procfs::parse_mountinfo("", 0, {"/proc"}, mounted);
+  EXPECT_TRUE(mounted.empty());
+}
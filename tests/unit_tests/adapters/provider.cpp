@@ -0,0 +1,70 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "adapters/provider.hpp"
+#include "common/test.hpp"
+
+using namespace polybar;
+
+namespace {
+  struct source {
+    explicit source(string name) : name(move(name)) {}
+    string name;
+  };
+}
+
+TEST(SharedInstances, sharedByKey) {
+  auto a = shared_instances<source>::acquire("a", "a");
+  auto b = shared_instances<source>::acquire("b", "b");
+
+  // Arguments of other types still share the registry
+  string key{"a"};
+  EXPECT_EQ(a, shared_instances<source>::acquire(key, key));
+  EXPECT_NE(a, b);
+  EXPECT_EQ("b", b->name);
+}
+
+TEST(SharedInstances, releasedWithLastReference) {
+  std::weak_ptr<source> released = shared_instances<source>::acquire("released", "first");
+  EXPECT_TRUE(released.expired());
+
+  auto instance = shared_instances<source>::acquire("released", "second");
+  EXPECT_EQ("second", instance->name);
+}
+
+TEST(Subscribers, notify) {
+  subscribers subs;
+  int a{0};
+  int b{0};
+
+  auto id = subs.add([&] { a++; });
+  subs.add([&] { b++; });
+  subs.notify();
+  subs.remove(id);
+  subs.notify();
+
+  EXPECT_EQ(1, a);
+  EXPECT_EQ(2, b);
+}
+
+TEST(Subscribers, removeWaitsForNotification) {
+  subscribers subs;
+  std::atomic<bool> notifying{false};
+  std::atomic<bool> done{false};
+
+  auto id = subs.add([&] {
+    notifying = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    done = true;
+  });
+
+  std::thread source([&] { subs.notify(); });
+  while (!notifying) {
+    std::this_thread::yield();
+  }
+
+  subs.remove(id);
+  EXPECT_TRUE(done);
+  source.join();
+}
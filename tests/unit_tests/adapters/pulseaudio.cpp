@@ -0,0 +1,93 @@
+#include "adapters/pulseaudio.hpp"
+#include "common/test.hpp"
+
+using namespace polybar;
+
+using target = sink_query::target;
+
+TEST(SinkQuery, lookup) {
+  sink_query named{true};
+  EXPECT_EQ(target::NAME, named.request(true));
+  EXPECT_TRUE(named.querying());
+
+  sink_query unnamed{false};
+  EXPECT_EQ(target::DEFAULT, unnamed.request(true));
+  EXPECT_EQ(target::NONE, unnamed.request());
+
+  sink_query fallback{true};
+  EXPECT_EQ(target::DEFAULT, fallback.request(true, true));
+}
+
+TEST(SinkQuery, coalesced) {
+  sink_query query{true};
+  bool notify{false};
+
+  EXPECT_EQ(target::INDEX, query.request());
+
+  // Requests while a query is in flight are merged into one
+  EXPECT_EQ(target::NONE, query.request());
+  EXPECT_EQ(target::NONE, query.request());
+  EXPECT_EQ(target::NONE, query.request());
+
+  query.found();
+  EXPECT_EQ(target::INDEX, query.complete(notify));
+  EXPECT_TRUE(notify);
+  EXPECT_TRUE(query.querying());
+
+  query.found();
+  EXPECT_EQ(target::NONE, query.complete(notify));
+  EXPECT_TRUE(notify);
+  EXPECT_FALSE(query.querying());
+}
+
+TEST(SinkQuery, coalescedLookup) {
+  sink_query query{true};
+  bool notify{false};
+
+  EXPECT_EQ(target::INDEX, query.request());
+
+  // A lookup requested by any of the merged requests is kept
+  EXPECT_EQ(target::NONE, query.request(true));
+  EXPECT_EQ(target::NONE, query.request());
+
+  query.found();
+  EXPECT_EQ(target::NAME, query.complete(notify));
+}
+
+TEST(SinkQuery, fallback) {
+  sink_query query{true};
+  bool notify{true};
+
+  EXPECT_EQ(target::NAME, query.request(true));
+  EXPECT_EQ(target::NONE, query.request());
+
+  // A missing sink falls back to the default sink before anything is
+  // reported, the merged request is only sent after that
+  EXPECT_EQ(target::DEFAULT, query.complete(notify));
+  EXPECT_FALSE(notify);
+
+  query.found();
+  EXPECT_EQ(target::INDEX, query.complete(notify));
+  EXPECT_TRUE(notify);
+
+  // Without a default sink there is nothing to fall back to
+  query.found();
+  EXPECT_EQ(target::NONE, query.complete(notify));
+  EXPECT_EQ(target::DEFAULT, query.request(true, true));
+  EXPECT_EQ(target::NONE, query.complete(notify));
+  EXPECT_FALSE(notify);
+}
+
+TEST(SinkQuery, abort) {
+  sink_query query{true};
+  bool notify{false};
+
+  EXPECT_EQ(target::INDEX, query.request());
+  query.abort();
+  EXPECT_FALSE(query.querying());
+
+  // Nothing is merged into a query that couldn't be sent
+  EXPECT_EQ(target::INDEX, query.request());
+  query.found();
+  EXPECT_EQ(target::NONE, query.complete(notify));
+}
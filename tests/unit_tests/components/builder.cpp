@@ -0,0 +1,82 @@
+#include "common/allocations.hpp"
+#include "common/test.hpp"
+#include "components/builder.hpp"
+#include "drawtypes/label.hpp"
+#include "drawtypes/progressbar.hpp"
+#include "utils/factory.hpp"
+
+using namespace polybar;
+using namespace drawtypes;
+
+TEST(Builder, node) {
+  bar_settings bar{};
+  builder b{bar};
+  string output;
+
+  b.node("foo %{F#f00}bar%{F-} baz");
+  b.flush(output);
+  EXPECT_EQ("foo %{F#f00}bar%{F-} baz", output);
+
+  // Unclosed tags are closed when flushing
+  b.underline(argb{0xFFFF0000, argb::type::ARGB});
+  b.node("foo");
+  b.flush(output);
+  EXPECT_EQ("%{u#f00}%{+u}foo%{u-}%{-u}", output);
+}
+
+TEST(Builder, cmdEscapesColons) {
+  bar_settings bar{};
+  builder b{bar};
+  string output;
+
+  // Every unescaped colon is escaped, including leading ones and
+  // those following an already escaped colon
+  b.cmd(mousebtn::LEFT, ":a:b\\:c:d");
+  b.node("x");
+  b.cmd_close();
+  b.flush(output);
+  EXPECT_EQ("%{A1:\\:a\\:b\\:c\\:d:}x%{A}", output);
+}
+
+TEST(Builder, noAllocationsOnceWarm) {
+  bar_settings bar{};
+  builder b{bar};
+  string output;
+
+  vector<token> tokens{{"%percentage%"}};
+  auto lbl = factory_util::shared<label>("volume %percentage%", argb{0xFF00FF00, argb::type::ARGB}, argb{}, argb{},
+      argb{}, 2, side_values{1U, 1U}, side_values{0U, 0U}, 0_z, true, move(tokens));
+
+  auto pbar = factory_util::shared<progressbar>(bar, 10, "[%fill%%indicator%%empty%]");
+  pbar->set_fill(factory_util::shared<label>("#"));
+  pbar->set_empty(factory_util::shared<label>("-"));
+  pbar->set_indicator(factory_util::shared<label>("|"));
+
+  const string action{"pactl set-sink-volume 0 +5%"};
+  const string percentages[]{"0%", "50%", "100%"};
+
+  const auto build = [&](size_t i) {
+    lbl->reset_tokens();
+    lbl->replace_token("%percentage%", percentages[i % 3]);
+
+    b.cmd(mousebtn::SCROLL_UP, action);
+    b.node(lbl);
+    b.space(1);
+    b.node(pbar->output(i % 3 * 50));
+    b.cmd_close();
+    b.flush(output);
+  };
+
+  for (size_t i = 0; i < 3; i++) {
+    build(i);
+  }
+
+  allocation_counter allocations;
+  for (size_t i = 0; i < 30; i++) {
+    build(i);
+  }
+  EXPECT_EQ(0_z, allocations.count());
+
+  EXPECT_EQ(
+      "%{A4:pactl set-sink-volume 0 +5%:}%{F#0f0} %{T2}volume 100%%{T-} %{F-} [#########|]%{A}", output);
+}
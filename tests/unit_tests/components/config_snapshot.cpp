@@ -0,0 +1,233 @@
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "common/test.hpp"
+#include "components/config_snapshot.hpp"
+#include "components/logger.hpp"
+#include "utils/file.hpp"
+
+using namespace polybar;
+
+namespace {
+  /**
+   * Private directory holding config files and a snapshot
+   */
+  class snapshot_dir {
+   public:
+    snapshot_dir() {
+      char dir[] = "/tmp/polybar_config_snapshot_test.XXXXXX";
+      m_dir = mkdtemp(dir);
+      config = file("config");
+      snapshot = m_dir + "/cache/polybar/snapshot";
+    }
+
+    ~snapshot_dir() {
+      for (auto&& f : m_files) {
+        unlink(f.c_str());
+      }
+      unlink(snapshot.c_str());
+      rmdir((m_dir + "/cache/polybar").c_str());
+      rmdir((m_dir + "/cache").c_str());
+      rmdir(m_dir.c_str());
+    }
+
+    string file(const string& name) {
+      m_files.emplace_back(m_dir + "/" + name);
+      return m_files.back();
+    }
+
+    string config;
+    string snapshot;
+
+   private:
+    string m_dir;
+    vector<string> m_files;
+  };
+
+  /**
+   * Write a config of about `lines` lines split across
+   * the main file and `includes` included files
+   */
+  void write_config(snapshot_dir& dir, int lines, int includes) {
+    std::ofstream main(dir.config);
+    main << "[bar/main]\nwidth = 100%\nmodules-left = a b c\n";
+
+    int sections{lines / 10 / includes};
+    for (int i = 0; i < includes; i++) {
+      string name{dir.file("include" + to_string(i))};
+      main << "include-file = " << name << "\n";
+
+      std::ofstream include(name);
+      for (int j = 0; j < sections; j++) {
+        include << "\n[module/m" << i << "_" << j << "]\n";
+        include << "type = internal/cpu\n";
+        for (int k = 0; k < 8; k++) {
+          include << "key-" << k << " = \"value " << k << " ${colors.fg}\"\n";
+        }
+      }
+    }
+  }
+
+  const logger& log() {
+    static logger instance{loglevel::NONE};
+    return instance;
+  }
+}
+
+TEST(ConfigSnapshot, parse) {
+  snapshot_dir dir;
+  string include{dir.file("include")};
+  std::ofstream(dir.config) << "[bar/main]\n\twidth = 100%\n; comment\nlabel = \" padded \"\ninclude-file = " << include
+                            << "\n[colors]\nfg = #fff\n";
+  std::ofstream(include) << "[module/a]\ntype = internal/date\n";
+
+  vector<string> files;
+  auto params = config_snapshot::parse(dir.config, files, log());
+
+  EXPECT_EQ((vector<string>{dir.config, include}), files);
+  ASSERT_EQ(4U, params.size());
+  EXPECT_STREQ("100%", params.find("bar/main", "width"));
+  EXPECT_STREQ(" padded ", params.find("bar/main", "label"));
+  EXPECT_STREQ("#fff", params.find("colors", "fg"));
+  EXPECT_STREQ("internal/date", params.find("module/a", "type"));
+  EXPECT_EQ(nullptr, params.find("colors", "bg"));
+  EXPECT_EQ(nullptr, params.find("bar/other", "width"));
+  EXPECT_TRUE(params.has_section("module/a"));
+  EXPECT_FALSE(params.has_section("module"));
+  EXPECT_EQ(make_pair(size_t{0}, size_t{2}), params.range("bar/main"));
+}
+
+TEST(ConfigSnapshot, parseErrors) {
+  snapshot_dir dir;
+  vector<string> files;
+
+  std::ofstream(dir.config) << "[bar/main]\na = 1\nb = 2\na = 3\nb = 4\n";
+  EXPECT_THROW(config_snapshot::parse(dir.config, files, log()), key_error);
+
+  std::ofstream(dir.config) << "[bar/main]\ninclude-file = " << dir.config << ".missing\n";
+  EXPECT_THROW(config_snapshot::parse(dir.config, files, log()), value_error);
+
+  std::ofstream(dir.config) << "[bar/main]\ninclude-file = " << dir.config << "\n";
+  EXPECT_THROW(config_snapshot::parse(dir.config, files, log()), value_error);
+}
+
+TEST(ConfigSnapshot, roundtrip) {
+  snapshot_dir dir;
+  write_config(dir, 200, 2);
+
+  vector<string> files;
+  auto params = config_snapshot::parse(dir.config, files, log());
+  ASSERT_TRUE(config_snapshot::save(dir.snapshot, files, params));
+
+  vector<string> loaded_files;
+  config_snapshot::table loaded;
+  ASSERT_TRUE(config_snapshot::load(dir.snapshot, dir.config, loaded_files, loaded));
+  EXPECT_EQ(files, loaded_files);
+  ASSERT_EQ(params.size(), loaded.size());
+
+  for (size_t i = 0; i < params.size(); i++) {
+    EXPECT_EQ(params.section(i).str(), loaded.section(i).str());
+    EXPECT_EQ(params.key(i).str(), loaded.key(i).str());
+    EXPECT_EQ(params.value(i).str(), loaded.value(i).str());
+  }
+  EXPECT_STREQ("value 3 ${colors.fg}", loaded.find("module/m1_4", "key-3"));
+
+  // Moving keeps the mapping alive
+  config_snapshot::table moved{move(loaded)};
+  EXPECT_EQ(0U, loaded.size());
+  EXPECT_STREQ("100%", moved.find("bar/main", "width"));
+}
+
+TEST(ConfigSnapshot, staleFile) {
+  snapshot_dir dir;
+  write_config(dir, 20, 1);
+
+  vector<string> files;
+  auto params = config_snapshot::parse(dir.config, files, log());
+  ASSERT_TRUE(config_snapshot::save(dir.snapshot, files, params));
+
+  // Only an included file changes
+  std::ofstream(files.back(), std::ios::app) << "[module/extra]\n";
+
+  vector<string> loaded_files;
+  config_snapshot::table loaded;
+  EXPECT_FALSE(config_snapshot::load(dir.snapshot, dir.config, loaded_files, loaded));
+  EXPECT_FALSE(config_snapshot::load(dir.snapshot + ".missing", dir.config, loaded_files, loaded));
+  EXPECT_TRUE(loaded_files.empty());
+  EXPECT_EQ(0U, loaded.size());
+}
+
+TEST(ConfigSnapshot, otherMainFile) {
+  snapshot_dir dir;
+  std::ofstream(dir.config) << "[bar/main]\nwidth = 100%\n";
+
+  vector<string> files;
+  auto params = config_snapshot::parse(dir.config, files, log());
+  ASSERT_TRUE(config_snapshot::save(dir.snapshot, files, params));
+
+  vector<string> loaded_files;
+  config_snapshot::table loaded;
+  EXPECT_FALSE(config_snapshot::load(dir.snapshot, dir.config + ".other", loaded_files, loaded));
+}
+
+TEST(ConfigSnapshot, corrupted) {
+  snapshot_dir dir;
+  write_config(dir, 20, 1);
+
+  vector<string> files;
+  auto params = config_snapshot::parse(dir.config, files, log());
+  ASSERT_TRUE(config_snapshot::save(dir.snapshot, files, params));
+
+  // Point the first record past the end of the string pool
+  std::fstream snapshot(dir.snapshot, std::ios::in | std::ios::out | std::ios::binary);
+  snapshot.seekp(-static_cast<std::streamoff>(params.bytes() - 2 * sizeof(uint32_t)), std::ios::end);
+  uint32_t offset{0xffffff};
+  snapshot.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+  snapshot.close();
+
+  vector<string> loaded_files;
+  config_snapshot::table loaded;
+  EXPECT_FALSE(config_snapshot::load(dir.snapshot, dir.config, loaded_files, loaded));
+}
+
+TEST(ConfigSnapshot, path) {
+  snapshot_dir dir;
+  string cache{dir.snapshot.substr(0, dir.snapshot.rfind("/polybar/"))};
+  setenv("XDG_CACHE_HOME", cache.c_str(), 1);
+
+  string path{config_snapshot::path(dir.config)};
+  EXPECT_EQ(cache + "/polybar/config-", path.substr(0, cache.size() + 16));
+  EXPECT_FALSE(file_util::exists(cache));
+}
+
+TEST(ConfigSnapshot, DISABLED_benchmark) {
+  snapshot_dir dir;
+  write_config(dir, 2000, 4);
+  const int iterations{1000};
+
+  vector<string> files;
+  auto params = config_snapshot::parse(dir.config, files, log());
+  config_snapshot::save(dir.snapshot, files, params);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    vector<string> parsed_files;
+    config_snapshot::parse(dir.config, parsed_files, log());
+  }
+  auto parse_time = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    vector<string> loaded_files;
+    config_snapshot::table loaded;
+    config_snapshot::load(dir.snapshot, dir.config, loaded_files, loaded);
+  }
+  auto load_time = std::chrono::steady_clock::now() - start;
+
+  std::cout << "parse (" << params.size() << " params, " << files.size() << " files): "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(parse_time).count() / iterations
+            << " ns, load: " << std::chrono::duration_cast<std::chrono::nanoseconds>(load_time).count() / iterations
+            << " ns\n";
+}
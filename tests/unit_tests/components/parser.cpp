@@ -0,0 +1,126 @@
+#include "common/allocations.hpp"
+#include "common/test.hpp"
+#include "components/parser.hpp"
+#include "events/signal.hpp"
+#include "events/signal_emitter.hpp"
+
+using namespace polybar;
+using namespace signals::parser;
+
+namespace {
+  /**
+   * Records the emitted parser signals as readable strings
+   */
+  class recorder : public signal_receiver<0, change_foreground, offset_pixel, attribute_set, attribute_unset,
+                       action_begin, action_end, signals::parser::text> {
+   public:
+    bool on(const change_foreground& evt) override {
+      return record("F" + std::to_string(evt.cast()));
+    }
+    bool on(const offset_pixel& evt) override {
+      return record("O" + std::to_string(evt.cast()));
+    }
+    bool on(const attribute_set& evt) override {
+      return record("+" + std::to_string(static_cast<int>(evt.cast())));
+    }
+    bool on(const attribute_unset& evt) override {
+      return record("-" + std::to_string(static_cast<int>(evt.cast())));
+    }
+    bool on(const action_begin& evt) override {
+      return record("A" + std::to_string(static_cast<int>(evt.get().button)) + ":" + evt.get().command);
+    }
+    bool on(const action_end& evt) override {
+      return record("/A" + std::to_string(static_cast<int>(evt.cast())));
+    }
+    bool on(const signals::parser::text& evt) override {
+      return record(evt.get());
+    }
+
+    bool record(string event) {
+      m_events.emplace_back(move(event));
+      return true;
+    }
+
+    vector<string> m_events;
+  };
+
+  /**
+   * Counts the emitted text and action signals without copying them
+   */
+  class counter : public signal_receiver<0, action_begin, signals::parser::text> {
+   public:
+    bool on(const action_begin& evt) override {
+      m_chars += evt.get().command.size();
+      return true;
+    }
+    bool on(const signals::parser::text& evt) override {
+      m_chars += evt.get().size();
+      return true;
+    }
+
+    size_t m_chars{0};
+  };
+
+  class Parser : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      m_sig.attach(&m_recorder);
+    }
+    void TearDown() override {
+      m_sig.detach(&m_recorder);
+    }
+
+    vector<string> parse(const string& data) {
+      m_recorder.m_events.clear();
+      m_parser.parse(m_bar, data);
+      return m_recorder.m_events;
+    }
+
+    signal_emitter m_sig;
+    parser m_parser{m_sig};
+    bar_settings m_bar{};
+    recorder m_recorder;
+  };
+}
+
+TEST_F(Parser, text) {
+  EXPECT_EQ(vector<string>{}, parse(""));
+  EXPECT_EQ(vector<string>{"foo bar"}, parse("foo bar"));
+  EXPECT_EQ((vector<string>{"foo", "F" + std::to_string(0xFFFF0000), "bar"}), parse("foo%{F#f00}bar"));
+
+  // Unclosed tags are treated as text
+  EXPECT_EQ((vector<string>{"foo", "%{F#f00"}), parse("foo%{F#f00"));
+}
+
+TEST_F(Parser, codeblock) {
+  EXPECT_EQ((vector<string>{"O10", "+1", "-2", "x"}), parse("%{O10 +u  -o}x"));
+  EXPECT_EQ(vector<string>{"F" + std::to_string(m_bar.foreground)}, parse("%{F-}"));
+  EXPECT_THROW(parse("%{Z}"), unrecognized_token);
+}
+
+TEST_F(Parser, actions) {
+  EXPECT_EQ((vector<string>{"A1:foo", "x", "/A1"}), parse("%{A:foo:}x%{A}"));
+  EXPECT_EQ((vector<string>{"A3:a\\:b c", "x", "/A3"}), parse("%{A3:a\\:b c:}x%{A}"));
+  EXPECT_EQ((vector<string>{"A1:foo", "O2", "A4:bar", "x", "/A4", "/A1"}),
+      parse("%{A1:foo: O2}%{A4:bar:}x%{A}%{A}"));
+  EXPECT_THROW(parse("%{A1:foo:}x"), unclosed_actionblocks);
+}
+
+TEST_F(Parser, noAllocationsOnceWarm) {
+  const string data{"%{F#f00}%{A1:notify-send --urgency low:}some longer text node%{A} %{O10}tail text"};
+  counter chars;
+
+  parse(data);
+  m_sig.detach(&m_recorder);
+  m_sig.attach(&chars);
+
+  allocation_counter allocations;
+  for (size_t i = 0; i < 10; i++) {
+    m_parser.parse(m_bar, data);
+  }
+  EXPECT_EQ(0_z, allocations.count());
+  EXPECT_EQ(10 * 56_z, chars.m_chars);
+
+  m_sig.detach(&chars);
+  m_sig.attach(&m_recorder);
+}
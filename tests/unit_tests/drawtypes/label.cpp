@@ -0,0 +1,102 @@
+#include "common/test.hpp"
+#include "drawtypes/label.hpp"
+#include "utils/factory.hpp"
+#include "utils/string.hpp"
+
+using namespace polybar;
+using namespace drawtypes;
+
+namespace {
+  /**
+   * Token replacement as it was done before labels were compiled
+   * into segments, used as the reference for the compiled output
+   */
+  string replace_reference(string text, const vector<token>& tokens, const vector<pair<string, string>>& values) {
+    for (auto&& value : values) {
+      if (text.find(value.first) == string::npos) {
+        continue;
+      }
+      for (auto&& tok : tokens) {
+        string repl{value.second};
+        if (value.first == tok.token) {
+          if (tok.max != 0_z && string_util::char_len(repl) > tok.max) {
+            repl = string_util::utf8_truncate(std::move(repl), tok.max) + tok.suffix;
+          } else if (tok.min != 0_z && repl.length() < tok.min) {
+            repl.insert(0_z, tok.min - repl.length(), ' ');
+          }
+          text = string_util::replace(text, value.first, move(repl));
+        }
+      }
+    }
+    return text;
+  }
+
+  label_t make_label(const string& text, const vector<token>& tokens) {
+    return factory_util::shared<label>(text, argb{}, argb{}, argb{}, argb{}, 0, side_values{0U, 0U},
+        side_values{0U, 0U}, 0_z, true, vector<token>{tokens});
+  }
+
+  void expect_reference(const string& text, const vector<token>& tokens, const vector<pair<string, string>>& values) {
+    auto lbl = make_label(text, tokens);
+    for (auto&& value : values) {
+      lbl->replace_token(value.first, value.second);
+    }
+    EXPECT_EQ(replace_reference(text, tokens, values), lbl->get()) << "template: " << text;
+  }
+}
+
+TEST(Label, matchesReplacement) {
+  expect_reference("%percentage%%", {{"%percentage%"}}, {{"%percentage%", "42"}});
+  expect_reference("%{F#f00}%name% %{F-}%value%", {{"%name%"}, {"%value%"}}, {{"%value%", "1"}, {"%name%", "cpu"}});
+  expect_reference("%a% and %a%", {{"%a%"}, {"%a%"}}, {{"%a%", "x"}});
+  expect_reference("%a% %b%", {{"%a%"}, {"%b%"}}, {{"%b%", "y"}});
+  expect_reference("no tokens", {}, {{"%a%", "x"}});
+  expect_reference("%title%", {{"%title%", 0_z, 5_z, "..."}}, {{"%title%", "a very long title"}});
+  expect_reference("[%title%]", {{"%title%", 4_z, 0_z}}, {{"%title%", "ab"}});
+  expect_reference("%title%", {{"%title%", 0_z, 3_z}}, {{"%title%", "äöüß"}});
+  expect_reference("%a%%b%", {{"%a%"}, {"%b%"}}, {{"%a%", ""}, {"%b%", "b"}});
+}
+
+TEST(Label, resetTokens) {
+  auto lbl = make_label("vol %percentage%%", {{"%percentage%"}});
+  EXPECT_EQ("vol %percentage%%", lbl->get());
+  EXPECT_TRUE(lbl->has_token("%percentage%"));
+
+  lbl->replace_token("%percentage%", "50");
+  EXPECT_EQ("vol 50%", lbl->get());
+  EXPECT_FALSE(lbl->has_token("%percentage%"));
+
+  // Replacing a token only fills the first free slot once
+  lbl->replace_token("%percentage%", "60");
+  EXPECT_EQ("vol 50%", lbl->get());
+
+  lbl->reset_tokens();
+  EXPECT_EQ("vol %percentage%%", lbl->get());
+  lbl->replace_token("%percentage%", "60");
+  EXPECT_EQ("vol 60%", lbl->get());
+}
+
+TEST(Label, clear) {
+  auto lbl = make_label("%a%", {{"%a%"}});
+  lbl->clear();
+  EXPECT_EQ("", lbl->get());
+  EXPECT_FALSE(*lbl);
+  EXPECT_FALSE(lbl->has_token("%a%"));
+
+  lbl->replace_token("%a%", "x");
+  EXPECT_EQ("", lbl->get());
+
+  lbl->reset_tokens();
+  EXPECT_EQ("%a%", lbl->get());
+}
+
+TEST(Label, clone) {
+  auto lbl = make_label("%a% %b%", {{"%a%"}, {"%b%"}});
+  lbl->replace_token("%a%", "x");
+
+  auto copy = lbl->clone();
+  EXPECT_EQ("%a% %b%", copy->get());
+  copy->replace_token("%b%", "y");
+  EXPECT_EQ("%a% y", copy->get());
+  EXPECT_EQ("x %b%", lbl->get());
+}
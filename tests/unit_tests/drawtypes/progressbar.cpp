@@ -0,0 +1,82 @@
+#include "common/test.hpp"
+#include "components/types.hpp"
+#include "drawtypes/label.hpp"
+#include "drawtypes/progressbar.hpp"
+#include "utils/factory.hpp"
+
+using namespace polybar;
+using namespace drawtypes;
+
+namespace {
+  progressbar_t make_progressbar(int width, string format = "%fill%%indicator%%empty%") {
+    bar_settings bar{};
+    bool indicator{format.find("%indicator%") != string::npos};
+    auto pbar = factory_util::shared<progressbar>(bar, width, move(format));
+    pbar->set_gradient(false);
+    pbar->set_fill(factory_util::shared<label>("#"));
+    pbar->set_empty(factory_util::shared<label>("-"));
+    if (indicator) {
+      pbar->set_indicator(factory_util::shared<label>("|"));
+    }
+    return pbar;
+  }
+}
+
+TEST(Progressbar, output) {
+  auto pbar = make_progressbar(11);
+
+  EXPECT_EQ("|----------", pbar->output(0));
+  EXPECT_EQ("#####|-----", pbar->output(50));
+  EXPECT_EQ("##########|", pbar->output(100));
+
+  // Out of range values are capped
+  EXPECT_EQ("|----------", pbar->output(-10));
+  EXPECT_EQ("##########|", pbar->output(250));
+}
+
+TEST(Progressbar, memoizedPercentages) {
+  auto pbar = make_progressbar(11);
+
+  // Percentages that fill the same number of cells share an output
+  const auto& half = pbar->output(50);
+  EXPECT_EQ(&half, &pbar->output(52));
+  EXPECT_EQ("#####|-----", pbar->output(52));
+
+  // Rendering other steps does not move earlier outputs
+  for (int i = 0; i <= 100; i++) {
+    pbar->output(i);
+  }
+  EXPECT_EQ(&half, &pbar->output(50));
+  EXPECT_EQ("#####|-----", half);
+}
+
+TEST(Progressbar, memoizedColors) {
+  auto pbar = make_progressbar(5, "%fill%%empty%");
+  pbar->set_colors({argb{0xFFFF0000, argb::type::ARGB}, argb{0xFF00FF00, argb::type::ARGB}});
+
+  // Without a gradient the color is picked by percentage, so the same
+  // number of filled cells can have different outputs
+  EXPECT_NE(pbar->output(10), pbar->output(90));
+  EXPECT_EQ(pbar->output(100), pbar->output(100));
+}
+
+TEST(Progressbar, changedWidth) {
+  auto pbar = make_progressbar(200, "%fill%%empty%");
+  EXPECT_EQ(string(100, '#') + string(100, '-'), pbar->output(50));
+  EXPECT_EQ(string(200, '#'), pbar->output(100));
+
+  // Changing the icons drops outputs rendered before
+  pbar->set_empty(factory_util::shared<label>("."));
+  EXPECT_EQ(string(100, '#') + string(100, '.'), pbar->output(50));
+
+  auto small = make_progressbar(3, "%fill%%empty%");
+  EXPECT_EQ("##-", small->output(50));
+  EXPECT_EQ("###", small->output(100));
+}
+
+TEST(Progressbar, format) {
+  auto pbar = make_progressbar(4, "[%fill%|%empty%] 100% %fill%");
+
+  EXPECT_EQ("[##|--] 100% ##", pbar->output(50));
+  EXPECT_EQ("[|----] 100% ", pbar->output(0));
+}
@@ -0,0 +1,157 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "common/test.hpp"
+#include "events/signal_emitter.hpp"
+
+using namespace polybar;
+
+namespace {
+  struct ping {
+    int value;
+  };
+  struct pong {};
+
+  template <int Priority>
+  class counter : public signal_receiver<Priority, ping, pong> {
+   public:
+    bool on(const ping& sig) override {
+      m_pings += sig.value;
+      return m_consume;
+    }
+    bool on(const pong&) override {
+      throw std::runtime_error("pong");
+    }
+
+    std::atomic<int> m_pings{0};
+    bool m_consume{false};
+  };
+}
+
+TEST(SignalEmitter, priority) {
+  signal_emitter sig;
+  counter<2> late;
+  counter<1> early;
+
+  sig.attach(&late);
+  sig.attach(&early);
+
+  EXPECT_FALSE(sig.emit(ping{1}));
+  EXPECT_EQ(1, early.m_pings);
+  EXPECT_EQ(1, late.m_pings);
+
+  early.m_consume = true;
+  EXPECT_TRUE(sig.emit(ping{1}));
+  EXPECT_EQ(2, early.m_pings);
+  EXPECT_EQ(1, late.m_pings);
+
+  sig.detach(&early);
+  sig.detach(&late);
+
+  EXPECT_FALSE(sig.emit(ping{1}));
+  EXPECT_EQ(2, early.m_pings);
+  EXPECT_EQ(1, late.m_pings);
+}
+
+TEST(SignalEmitter, exceptions) {
+  signal_emitter sig;
+  counter<1> receiver;
+
+  sig.attach(&receiver);
+  EXPECT_THROW(sig.emit(pong{}), std::runtime_error);
+  sig.detach(&receiver);
+
+  EXPECT_FALSE(sig.emit(pong{}));
+}
+
+TEST(SignalEmitter, concurrentAttachDetach) {
+  signal_emitter sig;
+  counter<1> persistent;
+  counter<2> receivers[8];
+  std::atomic<bool> done{false};
+
+  sig.attach(&persistent);
+
+  vector<std::thread> threads;
+  for (size_t i = 0; i < 4; i++) {
+    threads.emplace_back([&] {
+      for (size_t n = 0; n < 20000; n++) {
+        sig.emit(ping{1});
+      }
+    });
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    threads.emplace_back([&, i] {
+      while (!done) {
+        for (size_t n = i; n < 8; n += 2) {
+          sig.attach(&receivers[n]);
+        }
+        for (size_t n = i; n < 8; n += 2) {
+          sig.detach(&receivers[n]);
+        }
+      }
+    });
+  }
+
+  for (size_t i = 0; i < 4; i++) {
+    threads[i].join();
+  }
+  done = true;
+  for (size_t i = 4; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  sig.detach(&persistent);
+
+  EXPECT_EQ(80000, persistent.m_pings);
+}
+
+TEST(SignalEmitter, detachWaitsForEmit) {
+  struct slow : public signal_receiver<1, ping> {
+    bool on(const ping&) override {
+      m_entered = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds{100});
+      m_done = true;
+      return false;
+    }
+    std::atomic<bool> m_entered{false};
+    std::atomic<bool> m_done{false};
+  };
+
+  signal_emitter sig;
+  slow receiver;
+  sig.attach(&receiver);
+
+  std::thread emitter([&] { sig.emit(ping{1}); });
+  while (!receiver.m_entered) {
+    std::this_thread::yield();
+  }
+
+  sig.detach(&receiver);
+  EXPECT_TRUE(receiver.m_done);
+  emitter.join();
+}
+
+TEST(SignalEmitter, detachFromHandler) {
+  struct once : public signal_receiver<1, ping> {
+    explicit once(signal_emitter& sig) : m_sig(sig) {}
+    bool on(const ping&) override {
+      m_sig.detach(this);
+      m_calls++;
+      return false;
+    }
+    signal_emitter& m_sig;
+    int m_calls{0};
+  };
+
+  signal_emitter sig;
+  once receiver{sig};
+  sig.attach(&receiver);
+
+  sig.emit(ping{1});
+  sig.emit(ping{1});
+  EXPECT_EQ(1, receiver.m_calls);
+}
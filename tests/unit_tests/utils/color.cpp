@@ -69,3 +69,21 @@ TEST(String, simplify) {
   EXPECT_EQ("#234567", color_util::simplify_hex("#ff234567"));
   EXPECT_EQ("#00223344", color_util::simplify_hex("#00223344"));
 }
+
+TEST(String, simplifyPacked) {
+  EXPECT_EQ("#111", color_util::simplify_hex(0xFF111111));
+  EXPECT_EQ("#234567", color_util::simplify_hex(0xff234567));
+  EXPECT_EQ("#ee223344", color_util::simplify_hex(0xee223344));
+  EXPECT_EQ("#00223344", color_util::simplify_hex(0x00223344));
+}
+
+TEST(String, parseArgb) {
+  EXPECT_FALSE(color_util::parse_argb(""));
+  EXPECT_FALSE(color_util::parse_argb("invalid"));
+  EXPECT_EQ(argb::type::ARGB, color_util::parse_argb("#00000000").kind);
+  EXPECT_EQ(0x00000000, color_util::parse_argb("#00000000").value);
+  EXPECT_EQ(0xFF889900, color_util::parse_argb("#890").value);
+  EXPECT_EQ(argb::type::ALPHA, color_util::parse_argb("#cc").kind);
+  EXPECT_EQ(0xCC123456, color_util::parse_argb("#cc").resolve(0xFF123456));
+  EXPECT_EQ(0x55888777, color_util::parse_argb("#55888777").resolve(0xFF123456));
+}
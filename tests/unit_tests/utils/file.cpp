@@ -1,5 +1,11 @@
+#include "common/allocations.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <unistd.h>
 
 #include "common/test.hpp"
 #include "utils/command.hpp"
@@ -15,3 +21,100 @@ TEST(File, expand) {
       });
 }
 
+
+namespace {
+  /**
+   * Number of read(2) and pread(2) calls made by this process so far
+   */
+  long long read_syscalls() {
+    file_reader io{"/proc/self/io"};
+    if (!io.read()) {
+      return 0;
+    }
+    auto syscr = strstr(io.data(), "syscr: ");
+    return syscr ? std::strtoll(syscr + 7, nullptr, 10) : 0;
+  }
+}
+
+TEST(FileReader, reread) {
+  char dir[] = "/tmp/polybar_file_reader_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  string path{string{dir} + "/value"};
+  std::ofstream(path) << "42\n";
+
+  file_reader reader(path);
+  EXPECT_EQ(42, reader.integer());
+  EXPECT_EQ(3U, reader.size());
+  EXPECT_STREQ("42\n", reader.data());
+
+  std::ofstream(path) << "-7";
+  EXPECT_EQ(-7, reader.integer());
+
+  string large(10000, 'x');
+  std::ofstream(path) << large;
+  EXPECT_TRUE(reader.read());
+  EXPECT_EQ(large, reader.data());
+
+  unlink(path.c_str());
+  rmdir(dir);
+}
+
+TEST(FileReader, missingFile) {
+  char dir[] = "/tmp/polybar_file_reader_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  string path{string{dir} + "/value"};
+
+  file_reader reader(path);
+  EXPECT_FALSE(reader.read());
+  EXPECT_EQ(0, reader.integer());
+  EXPECT_STREQ("", reader.data());
+
+  // The file is opened once it appears
+  std::ofstream(path) << "1\n";
+  EXPECT_EQ(1, reader.integer());
+
+  unlink(path.c_str());
+  rmdir(dir);
+}
+
+/**
+ * Run with --gtest_also_run_disabled_tests
+ */
+TEST(FileReader, DISABLED_benchmark) {
+  const string path{"/proc/uptime"};
+  const int iterations{100000};
+  file_reader reader(path);
+  long long total{0};
+
+  // Each difference includes one read of /proc/self/io
+  auto contents_reads = read_syscalls();
+  allocation_counter contents_allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    total += std::strtoll(file_util::contents(path).c_str(), nullptr, 10);
+  }
+  auto contents_time = std::chrono::steady_clock::now() - start;
+  auto contents_count = contents_allocations.count();
+  contents_reads = read_syscalls() - contents_reads;
+
+  auto reader_reads = read_syscalls();
+  allocation_counter reader_allocations;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    total += reader.integer();
+  }
+  auto reader_time = std::chrono::steady_clock::now() - start;
+  auto reader_count = reader_allocations.count();
+  reader_reads = read_syscalls() - reader_reads;
+
+  EXPECT_GT(total, 0);
+  EXPECT_EQ(0_z, reader_count);
+
+  const auto report = [&](const char* name, std::chrono::nanoseconds time, size_t allocations, long long reads) {
+    std::cout << path << " " << name << ": " << time.count() / iterations << " ns, " << std::setprecision(3)
+              << double(allocations) / iterations << " allocations, " << double(reads) / iterations
+              << " read syscalls\n";
+  };
+  report("contents", std::chrono::duration_cast<std::chrono::nanoseconds>(contents_time), contents_count, contents_reads);
+  report("file_reader", std::chrono::duration_cast<std::chrono::nanoseconds>(reader_time), reader_count, reader_reads);
+}
@@ -0,0 +1,56 @@
+#include <poll.h>
+#include <unistd.h>
+#include <fstream>
+
+#include "common/test.hpp"
+#include "errors.hpp"
+#include "utils/inotify.hpp"
+
+using namespace polybar;
+
+namespace {
+  bool poll(const inotify_instance& instance, int wait_ms) {
+    struct pollfd fds[1]{};
+    fds[0].fd = instance.get_file_descriptor();
+    fds[0].events = POLLIN;
+    return ::poll(fds, 1, wait_ms) > 0 && (fds[0].revents & POLLIN);
+  }
+}
+
+TEST(InotifyInstance, coalescesEvents) {
+  char dir[] = "/tmp/polybar_inotify_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  string first{string{dir} + "/first"};
+  string second{string{dir} + "/second"};
+  std::ofstream(first) << "0";
+  std::ofstream(second) << "0";
+
+  inotify_instance instance;
+  instance.attach(first, IN_MODIFY);
+  instance.attach(second, IN_MODIFY | IN_DELETE_SELF);
+
+  EXPECT_FALSE(poll(instance, 0));
+
+  // Events of all watches queued in between are read at once
+  std::ofstream(first) << "1";
+  std::ofstream(second) << "1";
+  std::ofstream(first) << "2";
+
+  ASSERT_TRUE(poll(instance, 1000));
+  auto event = instance.get_event();
+  EXPECT_EQ(first, event->filename);
+  EXPECT_EQ(IN_MODIFY, event->mask);
+  EXPECT_FALSE(poll(instance, 0));
+
+  // The watches stay attached after reading
+  unlink(second.c_str());
+  ASSERT_TRUE(poll(instance, 1000));
+  event = instance.get_event();
+  EXPECT_EQ(second, event->filename);
+  EXPECT_TRUE(event->mask & IN_DELETE_SELF);
+  EXPECT_TRUE(event->mask & IN_IGNORED);
+
+  EXPECT_THROW(instance.attach(second), system_error);
+  unlink(first.c_str());
+  rmdir(dir);
+}
@@ -0,0 +1,82 @@
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <csignal>
+#include <unistd.h>
+
+#include "common/test.hpp"
+#include "utils/uevent.hpp"
+
+using namespace polybar;
+
+namespace {
+  /**
+   * Keep the null bytes that separate the properties
+   */
+  template <size_t N>
+  string message(const char (&data)[N]) {
+    return string(data, N - 1);
+  }
+
+  void send_event(int fd, const string& msg) {
+    ASSERT_EQ(static_cast<ssize_t>(msg.size()), send(fd, msg.data(), msg.size(), 0));
+  }
+}
+
+TEST(UEvent, parse) {
+  auto msg = message(
+      "change@/devices/LNXSYSTM:00/PNP0C0A:00/power_supply/BAT0\0ACTION=change\0SUBSYSTEM=power_supply\0"
+      "POWER_SUPPLY_NAME=BAT0\0POWER_SUPPLY_CAPACITY=42\0");
+  auto event = uevent_util::parse(msg.data(), msg.size());
+
+  ASSERT_TRUE(event);
+  EXPECT_EQ("change", event->action);
+  EXPECT_EQ("/devices/LNXSYSTM:00/PNP0C0A:00/power_supply/BAT0", event->devpath);
+  EXPECT_EQ("BAT0", event->property("POWER_SUPPLY_NAME"));
+  EXPECT_EQ("42", event->property("POWER_SUPPLY_CAPACITY"));
+  EXPECT_EQ("", event->property("DEVTYPE"));
+
+  EXPECT_FALSE(uevent_util::parse("libudev", 7));
+}
+
+TEST(UEvent, monitor) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+
+  auto monitor = uevent_util::make_monitor("power_supply", fds[0]);
+  EXPECT_FALSE(monitor->poll(0));
+
+  send_event(fds[1], message("change@/devices/virtual/input/input3\0SUBSYSTEM=input\0"));
+  EXPECT_TRUE(monitor->poll(0));
+  EXPECT_FALSE(monitor->get_event());
+
+  send_event(fds[1], message("change@/devices/ACPI0003:00/power_supply/AC\0SUBSYSTEM=power_supply\0POWER_SUPPLY_NAME=AC\0"));
+  EXPECT_TRUE(monitor->poll(0));
+
+  auto event = monitor->get_event();
+  ASSERT_TRUE(event);
+  EXPECT_EQ("AC", event->property("POWER_SUPPLY_NAME"));
+  EXPECT_FALSE(monitor->poll(0));
+
+  close(fds[1]);
+}
+
+TEST(UEvent, pollInterrupted) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+  auto monitor = uevent_util::make_monitor("power_supply", fds[0]);
+
+  // Without SA_RESTART the alarm makes poll fail with EINTR
+  struct sigaction act {};
+  struct sigaction old {};
+  act.sa_handler = [](int) {};
+  sigaction(SIGALRM, &act, &old);
+
+  struct itimerval timer {};
+  timer.it_value.tv_usec = 10000;
+  setitimer(ITIMER_REAL, &timer, nullptr);
+
+  EXPECT_FALSE(monitor->poll(1000));
+
+  sigaction(SIGALRM, &old, nullptr);
+  close(fds[1]);
+}